@@ -109,6 +109,28 @@ KService::Ptr AppEntry::service() const
     return m_service;
 }
 
+bool AppEntry::setService(KService::Ptr service, NameFormat nameFormat)
+{
+    const QString oldName = m_name;
+    const QString oldDescription = m_description;
+    const QString oldIcon = m_service ? m_service->icon() : QString();
+
+    m_service = service;
+
+    if (!m_service) {
+        return true;
+    }
+
+    init(nameFormat);
+
+    if (m_service->icon() != oldIcon) {
+        m_icon = QIcon();
+        return true;
+    }
+
+    return m_name != oldName || m_description != oldDescription;
+}
+
 QString AppEntry::id() const
 {
     if (!m_id.isEmpty()) {
@@ -306,3 +328,21 @@ bool AppGroupEntry::hasChildren() const
 AbstractModel *AppGroupEntry::childModel() const {
     return m_childModel;
 }
+
+KServiceGroup::Ptr AppGroupEntry::group() const
+{
+    return m_group;
+}
+
+bool AppGroupEntry::setGroup(KServiceGroup::Ptr group)
+{
+    const bool changed = group->caption() != m_group->caption() || group->icon() != m_group->icon();
+
+    m_group = group;
+
+    if (changed) {
+        m_icon = QIcon();
+    }
+
+    return changed;
+}
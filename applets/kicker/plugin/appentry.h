@@ -50,6 +50,12 @@ class AppEntry : public AbstractEntry
         QString description() const override;
         KService::Ptr service() const;
 
+        /**
+         * Replaces the service by @p service, e.g. after KSycoca changed.
+         * @return whether the name, description or icon changed
+         */
+        bool setService(KService::Ptr service, NameFormat nameFormat);
+
         QString id() const override;
         QUrl url() const override;
 
@@ -86,6 +92,14 @@ class AppGroupEntry : public AbstractGroupEntry
         bool hasChildren() const override;
         AbstractModel *childModel() const override;
 
+        KServiceGroup::Ptr group() const;
+
+        /**
+         * Replaces the group by @p group, e.g. after KSycoca changed.
+         * @return whether the name or icon changed
+         */
+        bool setGroup(KServiceGroup::Ptr group);
+
     private:
         KServiceGroup::Ptr m_group;
         mutable QIcon m_icon;
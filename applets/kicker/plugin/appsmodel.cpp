@@ -74,21 +74,20 @@ AppsModel::AppsModel(const QList<AbstractEntry *> entryList, bool deleteEntriesO
 , m_sorted(true)
 , m_appNameFormat(AppEntry::NameOnly)
 {
+    QSet<QString> storageIds;
+
     foreach(AbstractEntry *suggestedEntry, entryList) {
-        bool found = false;
+        if (suggestedEntry->type() == AbstractEntry::RunnableType) {
+            const QString storageId = static_cast<const AppEntry *>(suggestedEntry)->service()->storageId();
 
-        foreach (const AbstractEntry *entry, m_entryList) {
-            if (entry->type() == AbstractEntry::RunnableType
-                && static_cast<const AppEntry *>(entry)->service()->storageId()
-                == static_cast<const AppEntry *>(suggestedEntry)->service()->storageId()) {
-                found = true;
-                break;
+            if (storageIds.contains(storageId)) {
+                continue;
             }
-        }
 
-        if (!found) {
-            m_entryList << suggestedEntry;
+            storageIds.insert(storageId);
         }
+
+        m_entryList << suggestedEntry;
     }
 
     sortEntries();
@@ -488,13 +487,185 @@ void AppsModel::refreshInternal()
         emit cleared();
     }
 
-    m_hiddenEntries.clear();
     m_separatorCount = 0;
 
+    if (m_entryPath.isEmpty() && !KServiceGroup::root()) {
+        m_hiddenEntries.clear();
+        return;
+    }
+
+    const QList<EntryData> entries = collectEntries();
+
+    m_entryList.reserve(entries.count());
+
+    for (const EntryData &data : entries) {
+        m_entryList << createEntry(data);
+
+        if (data.type == AbstractEntry::SeparatorType) {
+            ++m_separatorCount;
+        }
+    }
+
+    if (m_entryPath.isEmpty()) {
+        if (!m_changeTimer) {
+            m_changeTimer = new QTimer(this);
+            m_changeTimer->setSingleShot(true);
+            m_changeTimer->setInterval(100);
+            connect(m_changeTimer, &QTimer::timeout, this, &AppsModel::updateEntries);
+
+            connect(KSycoca::self(), SIGNAL(databaseChanged(QStringList)), SLOT(checkSycocaChanges(QStringList)));
+        }
+    } else if (m_paginate) {
+        QList<AbstractEntry *> groups;
+
+        int at = 0;
+        QList<AbstractEntry *> page;
+
+        foreach(AbstractEntry *app, m_entryList) {
+            page.append(app);
+
+            if (at == (m_pageSize - 1)) {
+                at = 0;
+                AppsModel *model = new AppsModel(page, true, this);
+                groups.append(new GroupEntry(this, QString(), QString(), model));
+                page.clear();
+            } else {
+                ++at;
+            }
+        }
+
+        if (page.count()) {
+            AppsModel *model = new AppsModel(page, true, this);
+            groups.append(new GroupEntry(this, QString(), QString(), model));
+        }
+
+        m_entryList = groups;
+    }
+}
+
+void AppsModel::updateEntries()
+{
+    if (!m_complete || m_staticEntryList) {
+        return;
+    }
+
+    if (rootModel() == this && !m_appletInterface) {
+        return;
+    }
+
+    // pages are made up of whatever entries end up in them, so they are rebuilt
+    if (m_paginate || (m_entryPath.isEmpty() && !KServiceGroup::root())) {
+        refresh();
+        return;
+    }
+
+    const int oldCount = m_entryList.count();
+    const int oldSeparatorCount = m_separatorCount;
+
+    m_separatorCount = updateEntryRange(0, m_entryList.count(), collectEntries());
+
+    if (favoritesModel()) {
+        favoritesModel()->refresh();
+    }
+
+    if (m_entryList.count() != oldCount) {
+        emit countChanged();
+    }
+
+    if (m_separatorCount != oldSeparatorCount) {
+        emit separatorCountChanged();
+    }
+}
+
+int AppsModel::updateEntryRange(int first, int count, const QList<EntryData> &entries)
+{
+    QSet<QString> newKeys;
+    newKeys.reserve(entries.count());
+    for (const EntryData &data : entries) {
+        newKeys.insert(data.key);
+    }
+
+    QStringList keys = entryKeys(first, count);
+
+    // Remove what is gone first, then go through the new entries in order,
+    // moving up the ones which stay and inserting the new ones.
+    for (int i = keys.count() - 1; i >= 0; --i) {
+        if (!newKeys.contains(keys.at(i))) {
+            beginRemoveRows(QModelIndex(), first + i, first + i);
+            AbstractEntry *entry = m_entryList.takeAt(first + i);
+            keys.removeAt(i);
+            endRemoveRows();
+
+            deleteEntry(entry);
+        }
+    }
+
+    int separatorCount = 0;
+
+    for (int i = 0; i < entries.count(); ++i) {
+        const EntryData &data = entries.at(i);
+
+        if (data.type == AbstractEntry::SeparatorType) {
+            ++separatorCount;
+        }
+
+        const int from = (i < keys.count() && keys.at(i) == data.key) ? i : keys.indexOf(data.key, i);
+
+        if (from == -1) {
+            beginInsertRows(QModelIndex(), first + i, first + i);
+            m_entryList.insert(first + i, createEntry(data));
+            keys.insert(i, data.key);
+            endInsertRows();
+
+            continue;
+        }
+
+        if (from != i) {
+            beginMoveRows(QModelIndex(), first + from, first + from, QModelIndex(), first + i);
+            m_entryList.move(first + from, first + i);
+            keys.move(from, i);
+            endMoveRows();
+        }
+
+        AbstractEntry *entry = m_entryList.at(first + i);
+        bool changed = false;
+
+        if (data.type == AbstractEntry::RunnableType) {
+            changed = static_cast<AppEntry *>(entry)->setService(data.service, m_appNameFormat);
+        } else if (data.type == AbstractEntry::GroupType) {
+            AppGroupEntry *groupEntry = static_cast<AppGroupEntry *>(entry);
+            changed = groupEntry->setGroup(data.group);
+
+            AppsModel *childModel = qobject_cast<AppsModel *>(groupEntry->childModel());
+
+            if (childModel) {
+                childModel->updateEntries();
+            }
+        }
+
+        if (changed) {
+            const QModelIndex idx = index(first + i, 0);
+            emit dataChanged(idx, idx);
+        }
+    }
+
+    Q_ASSERT(keys.count() == entries.count());
+
+    return separatorCount;
+}
+
+QList<AppsModel::EntryData> AppsModel::collectEntries()
+{
+    QList<EntryData> entries;
+    // apps may be listed in several groups, they are only shown once
+    QSet<QString> storageIds;
+
+    m_hiddenEntries.clear();
+
     if (m_entryPath.isEmpty()) {
         KServiceGroup::Ptr group = KServiceGroup::root();
         if (!group) {
-            return;
+            return entries;
         }
 
         bool sortByGenericName = (appNameFormat() == AppEntry::GenericNameOnly || appNameFormat() == AppEntry::GenericNameAndName);
@@ -509,9 +680,8 @@ void AppsModel::refreshInternal()
                 KServiceGroup::Ptr subGroup(static_cast<KServiceGroup*>(p.data()));
 
                 if (!subGroup->noDisplay() && subGroup->childCount() > 0) {
-                    AppGroupEntry *groupEntry = new AppGroupEntry(this, subGroup, m_paginate, m_pageSize, m_flat,
-                        m_sorted, m_showSeparators, m_appNameFormat);
-                    m_entryList << groupEntry;
+                    entries.append({AbstractEntry::GroupType, subGroup->entryPath(), subGroup->caption(),
+                        KService::Ptr(), subGroup});
                 }
             } else if (p->isType(KST_KService) && m_showTopLevelItems) {
                 const KService::Ptr service(static_cast<KService*>(p.data()));
@@ -520,94 +690,46 @@ void AppsModel::refreshInternal()
                     continue;
                 }
 
-                bool found = false;
-
-                foreach (const AbstractEntry *entry, m_entryList) {
-                    if (entry->type() == AbstractEntry::RunnableType
-                        && static_cast<const AppEntry *>(entry)->service()->storageId() == service->storageId()) {
-                        found = true;
-                    }
-                }
-
-                if (!found) {
-                    m_entryList << new AppEntry(this, service, m_appNameFormat);
+                if (!storageIds.contains(service->storageId())) {
+                    storageIds.insert(service->storageId());
+                    entries.append({AbstractEntry::RunnableType, service->storageId(),
+                        AppEntry::nameFromService(service, m_appNameFormat), service, KServiceGroup::Ptr()});
                 }
              } else if (p->isType(KST_KServiceSeparator) && m_showSeparators && m_showTopLevelItems) {
-                if (!m_entryList.count()) {
+                if (entries.isEmpty()) {
                     continue;
                 }
 
-                if (m_entryList.last()->type() == AbstractEntry::SeparatorType) {
+                if (entries.last().type == AbstractEntry::SeparatorType) {
                     continue;
                 }
 
-                m_entryList << new SeparatorEntry(this);
-                ++m_separatorCount;
+                entries.append({AbstractEntry::SeparatorType, QString(), QString(), KService::Ptr(), KServiceGroup::Ptr()});
             }
         }
-
-        if (m_entryList.count()) {
-            while (m_entryList.last()->type() == AbstractEntry::SeparatorType) {
-                m_entryList.removeLast();
-                --m_separatorCount;
-            }
-        }
-
-        if (m_sorted) {
-            sortEntries();
-        }
-
-        m_changeTimer = new QTimer(this);
-        m_changeTimer->setSingleShot(true);
-        m_changeTimer->setInterval(100);
-        connect(m_changeTimer, SIGNAL(timeout()), this, SLOT(refresh()));
-
-        connect(KSycoca::self(), SIGNAL(databaseChanged(QStringList)), SLOT(checkSycocaChanges(QStringList)));
     } else {
         KServiceGroup::Ptr group = KServiceGroup::group(m_entryPath);
-        processServiceGroup(group);
-
-        if (m_entryList.count()) {
-            while (m_entryList.last()->type() == AbstractEntry::SeparatorType) {
-                m_entryList.removeLast();
-                --m_separatorCount;
-            }
-        }
-
-        if (m_sorted) {
-            sortEntries();
-        }
-
-        if (m_paginate) {
-            QList<AbstractEntry *> groups;
-
-            int at = 0;
-            QList<AbstractEntry *> page;
-
-            foreach(AbstractEntry *app, m_entryList) {
-                page.append(app);
+        processServiceGroup(group, entries, storageIds);
+    }
 
-                if (at == (m_pageSize - 1)) {
-                    at = 0;
-                    AppsModel *model = new AppsModel(page, true, this);
-                    groups.append(new GroupEntry(this, QString(), QString(), model));
-                    page.clear();
-                } else {
-                    ++at;
-                }
-            }
+    removeTrailingSeparators(entries);
 
-            if (page.count()) {
-                AppsModel *model = new AppsModel(page, true, this);
-                groups.append(new GroupEntry(this, QString(), QString(), model));
-            }
+    if (m_sorted) {
+        sortEntries(entries);
+    }
 
-            m_entryList = groups;
+    // separators have nothing to tell them apart but their order
+    int separator = 0;
+    for (EntryData &data : entries) {
+        if (data.type == AbstractEntry::SeparatorType) {
+            data.key = QStringLiteral("separator:") + QString::number(separator++);
         }
     }
+
+    return entries;
 }
 
-void AppsModel::processServiceGroup(KServiceGroup::Ptr group)
+void AppsModel::processServiceGroup(KServiceGroup::Ptr group, QList<EntryData> &entries, QSet<QString> &storageIds)
 {
     if (!group || !group->isValid()) {
         return;
@@ -658,30 +780,21 @@ void AppsModel::processServiceGroup(KServiceGroup::Ptr group)
                 continue;
             }
 
-            bool found = false;
-
-            foreach (const AbstractEntry *entry, m_entryList) {
-                if (entry->type() == AbstractEntry::RunnableType
-                    && static_cast<const AppEntry *>(entry)->service()->storageId() == service->storageId()) {
-                    found = true;
-                    break;
-                }
-            }
-
-            if (!found) {
-                m_entryList << new AppEntry(this, service, m_appNameFormat);
+            if (!storageIds.contains(service->storageId())) {
+                storageIds.insert(service->storageId());
+                entries.append({AbstractEntry::RunnableType, service->storageId(),
+                    AppEntry::nameFromService(service, m_appNameFormat), service, KServiceGroup::Ptr()});
             }
         } else if (p->isType(KST_KServiceSeparator) && m_showSeparators) {
-            if (!m_entryList.count()) {
+            if (entries.isEmpty()) {
                 continue;
             }
 
-            if (m_entryList.last()->type() == AbstractEntry::SeparatorType) {
+            if (entries.last().type == AbstractEntry::SeparatorType) {
                 continue;
             }
 
-            m_entryList << new SeparatorEntry(this);
-            ++m_separatorCount;
+            entries.append({AbstractEntry::SeparatorType, QString(), QString(), KService::Ptr(), KServiceGroup::Ptr()});
         } else if (p->isType(KST_KServiceGroup)) {
             const KServiceGroup::Ptr subGroup(static_cast<KServiceGroup*>(p.data()));
 
@@ -691,17 +804,72 @@ void AppsModel::processServiceGroup(KServiceGroup::Ptr group)
 
             if (m_flat) {
                 m_sorted = true;
-                const KServiceGroup::Ptr serviceGroup(static_cast<KServiceGroup*>(p.data()));
-                processServiceGroup(serviceGroup);
+                processServiceGroup(subGroup, entries, storageIds);
             } else {
-                AppGroupEntry *groupEntry = new AppGroupEntry(this, subGroup, m_paginate, m_pageSize, m_flat,
-                    m_sorted, m_showSeparators, m_appNameFormat);
-                m_entryList << groupEntry;
+                entries.append({AbstractEntry::GroupType, subGroup->entryPath(), subGroup->caption(),
+                    KService::Ptr(), subGroup});
             }
         }
     }
 }
 
+void AppsModel::removeTrailingSeparators(QList<EntryData> &entries)
+{
+    while (!entries.isEmpty() && entries.last().type == AbstractEntry::SeparatorType) {
+        entries.removeLast();
+    }
+}
+
+AbstractEntry *AppsModel::createEntry(const EntryData &data)
+{
+    switch (data.type) {
+        case AbstractEntry::RunnableType:
+            return new AppEntry(this, data.service, m_appNameFormat);
+        case AbstractEntry::GroupType:
+            return new AppGroupEntry(this, data.group, m_paginate, m_pageSize, m_flat,
+                m_sorted, m_showSeparators, m_appNameFormat);
+        case AbstractEntry::SeparatorType:
+            break;
+    }
+
+    return new SeparatorEntry(this);
+}
+
+QStringList AppsModel::entryKeys(int first, int count) const
+{
+    QStringList keys;
+    keys.reserve(count);
+
+    int separator = 0;
+
+    for (const AbstractEntry *entry : m_entryList.mid(first, count)) {
+        switch (entry->type()) {
+            case AbstractEntry::RunnableType:
+                keys << static_cast<const AppEntry *>(entry)->service()->storageId();
+                break;
+            case AbstractEntry::GroupType:
+                keys << static_cast<const AppGroupEntry *>(entry)->group()->entryPath();
+                break;
+            case AbstractEntry::SeparatorType:
+                keys << QStringLiteral("separator:") + QString::number(separator++);
+                break;
+        }
+    }
+
+    return keys;
+}
+
+void AppsModel::deleteEntry(AbstractEntry *entry)
+{
+    // child models are owned by this model, see AppGroupEntry
+    if (entry->type() == AbstractEntry::GroupType && entry->childModel()) {
+        entry->childModel()->disconnect();
+        entry->childModel()->deleteLater();
+    }
+
+    delete entry;
+}
+
 void AppsModel::sortEntries()
 {
     QCollator c;
@@ -716,6 +884,20 @@ void AppsModel::sortEntries()
         });
 }
 
+void AppsModel::sortEntries(QList<EntryData> &entries) const
+{
+    QCollator c;
+
+    std::sort(entries.begin(), entries.end(),
+        [&c](const EntryData &a, const EntryData &b) {
+            if (a.type != b.type) {
+                return a.type > b.type;
+            } else {
+                return c.compare(a.name, b.name) < 0;
+            }
+        });
+}
+
 void AppsModel::checkSycocaChanges(const QStringList &changes)
 {
     if (changes.contains(QLatin1String("services")) || changes.contains(QLatin1String("apps")) || changes.contains(QLatin1String("xdgdata-apps"))) {
@@ -25,6 +25,7 @@
 #include "appentry.h"
 
 #include <QQmlParserStatus>
+#include <QSet>
 
 #include <KServiceGroup>
 
@@ -119,6 +120,13 @@ class AppsModel : public AbstractModel, public QQmlParserStatus
     protected Q_SLOTS:
         void refresh() override;
 
+        /**
+         * Brings the entries up to date after KSycoca changed, only inserting,
+         * removing, moving and updating the rows which changed. Groups which
+         * stay keep their child models, which are updated the same way.
+         */
+        virtual void updateEntries();
+
     protected:
         void refreshInternal();
 
@@ -138,9 +146,34 @@ class AppsModel : public AbstractModel, public QQmlParserStatus
     private Q_SLOTS:
         void checkSycocaChanges(const QStringList &changes);
 
+    protected:
+        // an entry to be shown, before it is created
+        struct EntryData {
+            AbstractEntry::EntryType type;
+            // storage id of apps, entry path of groups, position of separators
+            QString key;
+            QString name;
+            KService::Ptr service;
+            KServiceGroup::Ptr group;
+        };
+
+        QList<EntryData> collectEntries();
+
+        /**
+         * Turns the @p count rows from @p first on into @p entries the way
+         * updateEntries() does.
+         * @return the number of separators among @p entries
+         */
+        int updateEntryRange(int first, int count, const QList<EntryData> &entries);
+
     private:
-        void processServiceGroup(KServiceGroup::Ptr group);
+        void processServiceGroup(KServiceGroup::Ptr group, QList<EntryData> &entries, QSet<QString> &storageIds);
+        static void removeTrailingSeparators(QList<EntryData> &entries);
         void sortEntries();
+        void sortEntries(QList<EntryData> &entries) const;
+        AbstractEntry *createEntry(const EntryData &data);
+        QStringList entryKeys(int first, int count) const;
+        void deleteEntry(AbstractEntry *entry);
 
         bool m_autoPopulate;
 
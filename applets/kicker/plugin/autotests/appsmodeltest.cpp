@@ -0,0 +1,229 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include <QDir>
+#include <QFile>
+#include <QObject>
+#include <QPointer>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <KSycoca>
+
+#include "../appsmodel.h"
+#include "../rootmodel.h"
+
+#include "testapps.h"
+
+// a menu of about the size of a distribution with everything installed
+static const int s_appCount = 1000;
+
+class AppsModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void testInstallAndRemove();
+    void testRootModel();
+
+    void benchmarkInstallAndRemove_data();
+    void benchmarkInstallAndRemove();
+
+private:
+    static void installApp(const QString &name, const QString &category);
+    static void removeApp(const QString &name);
+    static void updateModel(AppsModel *model, bool inPlace);
+    static int rowForName(AbstractModel *model, const QString &name);
+};
+
+void AppsModelTest::installApp(const QString &name, const QString &category)
+{
+    QVERIFY(TestApps::install(name, "Categories=" + category.toUtf8() + ";\n"));
+}
+
+void AppsModelTest::removeApp(const QString &name)
+{
+    QVERIFY(TestApps::remove(name));
+}
+
+void AppsModelTest::updateModel(AppsModel *model, bool inPlace)
+{
+    KSycoca::self()->ensureCacheValid();
+
+    // what the change timer of the model calls once KSycoca reported the change
+    QVERIFY(QMetaObject::invokeMethod(model, inPlace ? "updateEntries" : "refresh"));
+}
+
+int AppsModelTest::rowForName(AbstractModel *model, const QString &name)
+{
+    for (int row = 0; row < model->count(); ++row) {
+        if (model->data(model->index(row, 0), Qt::DisplayRole).toString() == name) {
+            return row;
+        }
+    }
+
+    return -1;
+}
+
+void AppsModelTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    qunsetenv("XDG_MENU_PREFIX");
+
+    QVERIFY(TestApps::reset());
+
+    // a menu of our own, whatever the system menu looks like
+    const QString menusPath = QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation) + QStringLiteral("/menus");
+    QVERIFY(QDir().mkpath(menusPath));
+    QFile menu(menusPath + QStringLiteral("/applications.menu"));
+    QVERIFY(menu.open(QIODevice::WriteOnly));
+    menu.write("<!DOCTYPE Menu PUBLIC \"-//freedesktop//DTD Menu 1.0//EN\" \"http://www.freedesktop.org/standards/menu-spec/1.0/menu.dtd\">\n"
+               "<Menu>\n"
+               "  <Name>Applications</Name>\n"
+               "  <DefaultAppDirs/>\n"
+               "  <DefaultDirectoryDirs/>\n"
+               "  <Menu><Name>Development</Name><Include><Category>Development</Category></Include></Menu>\n"
+               "  <Menu><Name>Utilities</Name><Include><Category>Utility</Category></Include></Menu>\n"
+               "</Menu>\n");
+    menu.close();
+
+    for (int i = 0; i < s_appCount; ++i) {
+        installApp(QStringLiteral("kickertest%1").arg(i, 4, 10, QLatin1Char('0')),
+                   i % 2 ? QStringLiteral("Utility") : QStringLiteral("Development"));
+    }
+
+    KSycoca::self()->ensureCacheValid();
+}
+
+void AppsModelTest::cleanup()
+{
+    TestApps::remove(QStringLiteral("kickertestnew"));
+    KSycoca::self()->ensureCacheValid();
+}
+
+void AppsModelTest::testInstallAndRemove()
+{
+    AppsModel model;
+    model.componentComplete();
+
+    QCOMPARE(model.count(), 2);
+    const int utilitiesRow = rowForName(&model, QStringLiteral("Utilities"));
+    QVERIFY(utilitiesRow != -1);
+    AbstractModel *utilities = model.modelForRow(utilitiesRow);
+    QCOMPARE(utilities->count(), s_appCount / 2);
+
+    QSignalSpy rootReset(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy reset(utilities, &QAbstractItemModel::modelReset);
+    QSignalSpy inserted(utilities, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removed(utilities, &QAbstractItemModel::rowsRemoved);
+
+    installApp(QStringLiteral("kickertestnew"), QStringLiteral("Utility"));
+    updateModel(&model, true);
+
+    // one row more in the category, which kept its model
+    QCOMPARE(model.modelForRow(utilitiesRow), utilities);
+    QCOMPARE(utilities->count(), s_appCount / 2 + 1);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(inserted.first().at(1).toInt(), rowForName(utilities, QStringLiteral("kickertestnew")));
+
+    removeApp(QStringLiteral("kickertestnew"));
+    updateModel(&model, true);
+
+    QCOMPARE(utilities->count(), s_appCount / 2);
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(rowForName(utilities, QStringLiteral("kickertestnew")), -1);
+
+    QCOMPARE(rootReset.count(), 0);
+    QCOMPARE(reset.count(), 0);
+}
+
+void AppsModelTest::testRootModel()
+{
+    RootModel model;
+    model.setShowAllApps(true);
+    model.setShowRecentApps(false);
+    model.setShowRecentDocs(false);
+    model.componentComplete();
+
+    const int allRow = rowForName(&model, QStringLiteral("All Applications"));
+    const int utilitiesRow = rowForName(&model, QStringLiteral("Utilities"));
+    QVERIFY(allRow != -1);
+    QVERIFY(utilitiesRow != -1);
+    AbstractModel *utilities = model.modelForRow(utilitiesRow);
+    QCOMPARE(model.modelForRow(allRow)->count(), s_appCount);
+
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy changed(&model, &QAbstractItemModel::dataChanged);
+    QPointer<AbstractModel> oldAll = model.modelForRow(allRow);
+
+    installApp(QStringLiteral("kickertestnew"), QStringLiteral("Utility"));
+    updateModel(&model, true);
+
+    // a view may still use the old model until it handled the change
+    QVERIFY(oldAll);
+    QVERIFY(oldAll != model.modelForRow(allRow));
+    QTRY_VERIFY(!oldAll);
+
+    // the category is updated in place, "All Applications" derived again
+    QCOMPARE(reset.count(), 0);
+    QCOMPARE(model.modelForRow(utilitiesRow), utilities);
+    QCOMPARE(utilities->count(), s_appCount / 2 + 1);
+    QCOMPARE(model.modelForRow(allRow)->count(), s_appCount + 1);
+    QVERIFY(rowForName(model.modelForRow(allRow), QStringLiteral("kickertestnew")) != -1);
+    QVERIFY(!changed.isEmpty());
+    QCOMPARE(changed.last().at(0).toModelIndex().row(), allRow);
+
+    removeApp(QStringLiteral("kickertestnew"));
+    updateModel(&model, true);
+
+    QCOMPARE(reset.count(), 0);
+    QCOMPARE(model.modelForRow(allRow)->count(), s_appCount);
+    QCOMPARE(rowForName(model.modelForRow(allRow), QStringLiteral("kickertestnew")), -1);
+}
+
+void AppsModelTest::benchmarkInstallAndRemove_data()
+{
+    QTest::addColumn<bool>("inPlace");
+
+    QTest::newRow("update in place") << true;
+    QTest::newRow("reset") << false;
+}
+
+void AppsModelTest::benchmarkInstallAndRemove()
+{
+    QFETCH(bool, inPlace);
+
+    AppsModel model;
+    model.componentComplete();
+
+    // Rebuilding KSycoca is part of every round and costs the same for both
+    // rows, the difference between them is what the model does
+    QBENCHMARK {
+        installApp(QStringLiteral("kickertestnew"), QStringLiteral("Utility"));
+        updateModel(&model, inPlace);
+        removeApp(QStringLiteral("kickertestnew"));
+        updateModel(&model, inPlace);
+    }
+}
+
+QTEST_MAIN(AppsModelTest)
+
+#include "appsmodeltest.moc"
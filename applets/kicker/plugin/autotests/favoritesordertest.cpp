@@ -0,0 +1,177 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include <QObject>
+#include <QTest>
+
+#include "../favoritesorder.h"
+
+// a long list of favorites, as some people keep them
+static const int s_favoriteCount = 300;
+
+class FavoritesOrderTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testInsertRemoveMove();
+    void testDuplicates();
+    void testSort();
+
+    void benchmarkRemove();
+    void benchmarkSort();
+
+private:
+    static QString id(int i);
+    static void verifyRows(const FavoritesOrder &order);
+};
+
+QString FavoritesOrderTest::id(int i)
+{
+    return QStringLiteral("file:///favorite%1.txt").arg(i, 4, 10, QLatin1Char('0'));
+}
+
+void FavoritesOrderTest::verifyRows(const FavoritesOrder &order)
+{
+    const QStringList ids = order.ids();
+
+    for (int row = 0; row < order.count(); ++row) {
+        QCOMPARE(order.at(row), ids.at(row));
+        QCOMPARE(order.rowOf(ids.at(row)), ids.indexOf(ids.at(row)));
+    }
+}
+
+void FavoritesOrderTest::testInsertRemoveMove()
+{
+    FavoritesOrder order;
+    QStringList expected;
+
+    for (int i = 0; i < s_favoriteCount; ++i) {
+        order.insert(order.count(), id(i));
+        expected << id(i);
+    }
+
+    QCOMPARE(order.ids(), expected);
+    verifyRows(order);
+
+    order.insert(0, id(s_favoriteCount));
+    expected.prepend(id(s_favoriteCount));
+    QCOMPARE(order.ids(), expected);
+    verifyRows(order);
+
+    order.move(order.count() - 1, 0);
+    expected.move(expected.count() - 1, 0);
+    QCOMPARE(order.ids(), expected);
+    verifyRows(order);
+
+    order.move(1, 10);
+    expected.move(1, 10);
+    QCOMPARE(order.ids(), expected);
+    verifyRows(order);
+
+    for (int i = 0; i < s_favoriteCount; i += 3) {
+        order.removeAt(order.rowOf(id(i)));
+        expected.removeOne(id(i));
+
+        QCOMPARE(order.rowOf(id(i)), -1);
+    }
+
+    QCOMPARE(order.ids(), expected);
+    verifyRows(order);
+}
+
+void FavoritesOrderTest::testDuplicates()
+{
+    FavoritesOrder order;
+    order.insert(0, id(0));
+    order.insert(1, id(1));
+    order.insert(2, id(0));
+
+    // an id maps to its first row
+    QCOMPARE(order.rowOf(id(0)), 0);
+
+    order.removeAt(0);
+    QCOMPARE(order.ids(), QStringList({id(1), id(0)}));
+    QCOMPARE(order.rowOf(id(0)), 1);
+    QCOMPARE(order.rowOf(id(1)), 0);
+
+    order.insert(0, id(0));
+    QCOMPARE(order.rowOf(id(0)), 0);
+
+    order.removeAt(2);
+    QCOMPARE(order.rowOf(id(0)), 0);
+    QCOMPARE(order.count(), 2);
+}
+
+void FavoritesOrderTest::testSort()
+{
+    FavoritesOrder order;
+    for (int i = 0; i < 6; ++i) {
+        order.insert(order.count(), id(i));
+    }
+
+    // an id is placed by where it first is in the saved ordering, the
+    // ones which were not saved come last, e.g. the ordering of another
+    // activity listed after the one of the current activity
+    order.sort({id(4), id(1), id(4), QStringLiteral("file:///gone.txt"), id(2), id(1)});
+
+    QCOMPARE(order.ids(), QStringList({id(4), id(1), id(2), id(0), id(3), id(5)}));
+    verifyRows(order);
+}
+
+void FavoritesOrderTest::benchmarkRemove()
+{
+    FavoritesOrder order;
+    for (int i = 0; i < s_favoriteCount; ++i) {
+        order.insert(order.count(), id(i));
+    }
+
+    // the first favorite goes, all the rows after it move up
+    QBENCHMARK {
+        order.removeAt(order.rowOf(id(0)));
+        order.insert(0, id(0));
+        order.removeAt(order.rowOf(id(s_favoriteCount - 1)));
+        order.insert(order.count(), id(s_favoriteCount - 1));
+    }
+
+    QCOMPARE(order.count(), s_favoriteCount);
+}
+
+void FavoritesOrderTest::benchmarkSort()
+{
+    // the favorites of two activities, saved in reverse
+    QStringList ordering;
+    for (int i = s_favoriteCount - 1; i >= 0; --i) {
+        ordering << id(i);
+    }
+    ordering += ordering;
+
+    FavoritesOrder order;
+    for (int i = 0; i < s_favoriteCount; ++i) {
+        order.insert(order.count(), id(i));
+    }
+
+    QBENCHMARK {
+        order.sort(ordering);
+    }
+
+    QCOMPARE(order.at(0), id(s_favoriteCount - 1));
+}
+
+QTEST_MAIN(FavoritesOrderTest)
+
+#include "favoritesordertest.moc"
@@ -0,0 +1,204 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QUrl>
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include "../actionlist.h"
+#include "../kastatsfavoritesmodel.h"
+
+#include "statsdatabase.h"
+
+// a long list of favorites, as some people keep them
+static const int s_favoriteCount = 300;
+
+class KAStatsFavoritesModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testLoad();
+    void testMove();
+
+    void benchmarkLoad();
+    void benchmarkMove();
+
+private:
+    QString document(int i) const;
+    QString url(int i) const;
+    QStringList rows() const;
+
+    QTemporaryDir m_documents;
+    QString m_documentsPath;
+    QString m_activity;
+    // the favorites of the current activity and the global ones, as saved
+    QStringList m_ordering;
+    // the rows after loading
+    QStringList m_expected;
+    KAStatsFavoritesModel *m_model = nullptr;
+};
+
+static const QString s_client = QStringLiteral("org.kde.plasma.kicker.favoritesmodeltest");
+
+QString KAStatsFavoritesModelTest::document(int i) const
+{
+    // zero padded, so favorites which are not in the saved ordering sort by number
+    return m_documentsPath + QStringLiteral("/favorite%1.txt").arg(i, 4, 10, QLatin1Char('0'));
+}
+
+QString KAStatsFavoritesModelTest::url(int i) const
+{
+    return QUrl::fromLocalFile(document(i)).toString();
+}
+
+QStringList KAStatsFavoritesModelTest::rows() const
+{
+    QStringList documents;
+
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        documents << m_model->index(row, 0).data(Kicker::UrlRole).toUrl().toLocalFile();
+    }
+
+    return documents;
+}
+
+void KAStatsFavoritesModelTest::initTestCase()
+{
+    // the favorites are read from the stats database, the ordering from the configuration
+    QStandardPaths::setTestModeEnabled(true);
+
+    QVERIFY(m_documents.isValid());
+    m_documentsPath = QFileInfo(m_documents.path()).canonicalFilePath();
+
+    QVERIFY(StatsDatabase::create());
+    m_activity = StatsDatabase::currentActivity();
+
+    // A third of the favorites each is on the current activity, on all
+    // activities and on another activity, which the model does not list
+    const QString otherActivity = QStringLiteral("a8b1e2c4-0000-4000-8000-000000000001");
+    const QString agent = QStringLiteral("org.kde.plasma.favorites.documents");
+    QStringList shown;
+
+    for (int i = 0; i < s_favoriteCount * 3 / 2; ++i) {
+        QFile file(document(i));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("text\n");
+
+        const QString activity = i % 3 == 0 ? m_activity
+                               : i % 3 == 1 ? QStringLiteral(":global")
+                               : otherActivity;
+        QVERIFY(StatsDatabase::addLink(activity, url(i), agent));
+
+        if (i % 3 != 2) {
+            shown << document(i);
+        }
+    }
+
+    QCOMPARE(shown.count(), s_favoriteCount);
+
+    // saved in reverse, the first few favorites were added after it was saved
+    for (int i = shown.count() - 1; i >= 30; --i) {
+        m_ordering << QUrl::fromLocalFile(shown.at(i)).toString();
+        m_expected << shown.at(i);
+    }
+
+    m_expected += shown.mid(0, 30);
+}
+
+void KAStatsFavoritesModelTest::init()
+{
+    // what the model saved last, for the current activity and for all of them
+    const auto cfg = KSharedConfig::openConfig(QStringLiteral("kactivitymanagerd-statsrc"));
+    KConfigGroup(cfg, QStringLiteral("Favorites-") + s_client + QStringLiteral("-") + m_activity).writeEntry("ordering", m_ordering);
+    KConfigGroup(cfg, QStringLiteral("Favorites-") + s_client + QStringLiteral("-global")).writeEntry("ordering", m_ordering);
+    cfg->sync();
+
+    m_model = new KAStatsFavoritesModel(this);
+    m_model->initForClient(s_client);
+}
+
+void KAStatsFavoritesModelTest::cleanup()
+{
+    delete m_model;
+    m_model = nullptr;
+}
+
+void KAStatsFavoritesModelTest::testLoad()
+{
+    QCOMPARE(m_model->rowCount(), s_favoriteCount);
+    QCOMPARE(rows(), m_expected);
+
+    QVERIFY(m_model->isFavorite(url(0)));
+    QVERIFY(m_model->isFavorite(url(1)));
+    QVERIFY(!m_model->isFavorite(url(2)));
+}
+
+void KAStatsFavoritesModelTest::testMove()
+{
+    QStringList expected = m_expected;
+
+    m_model->moveRow(expected.count() - 1, 0);
+    expected.move(expected.count() - 1, 0);
+    QCOMPARE(rows(), expected);
+
+    m_model->moveRow(1, 10);
+    expected.move(1, 10);
+    QCOMPARE(rows(), expected);
+
+    // the next time, the favorites are loaded in the order they were left in
+    m_model->initForClient(s_client);
+    QCOMPARE(rows(), expected);
+}
+
+void KAStatsFavoritesModelTest::benchmarkLoad()
+{
+    // reading the favorites of the activities and sorting them by the saved ordering
+    QBENCHMARK {
+        m_model->initForClient(s_client);
+    }
+
+    QCOMPARE(rows(), m_expected);
+}
+
+void KAStatsFavoritesModelTest::benchmarkMove()
+{
+    const int last = m_model->rowCount() - 1;
+
+    // dragging a favorite from the bottom to the top and back
+    QBENCHMARK {
+        m_model->moveRow(last, 0);
+        m_model->moveRow(0, last);
+    }
+
+    QCOMPARE(rows(), m_expected);
+}
+
+QTEST_MAIN(KAStatsFavoritesModelTest)
+
+#include "kastatsfavoritesmodeltest.moc"
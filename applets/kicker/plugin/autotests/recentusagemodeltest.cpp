@@ -0,0 +1,203 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include <QFile>
+#include <QObject>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <KSycoca>
+
+#include <KActivities/Stats/ResultModel>
+
+#include "../actionlist.h"
+#include "../recentusagemodel.h"
+
+#include "statsdatabase.h"
+#include "testapps.h"
+
+// every other row an application, a document else
+static const int s_rowCount = 500;
+
+class RecentUsageModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testData();
+    void testRecentDocumentActions();
+
+    void benchmarkData_data();
+    void benchmarkData();
+
+private:
+    void setUsage(RecentUsageModel *model);
+    static QStringList actionTexts(const QModelIndex &index);
+
+    QString m_activity;
+    QTemporaryDir m_documents;
+    QStandardItemModel m_usage;
+    QSortFilterProxyModel m_usageProxy;
+};
+
+void RecentUsageModelTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_documents.isValid());
+
+    // before the first model queries it
+    QVERIFY(StatsDatabase::create());
+    m_activity = StatsDatabase::currentActivity();
+
+    QVERIFY(TestApps::reset());
+
+    // what the stats model reports for the resources, most recent first
+    for (int i = 0; i < s_rowCount; ++i) {
+        QString resource;
+
+        if (i % 2) {
+            const QString name = QStringLiteral("kickertest%1").arg(i);
+            QVERIFY(TestApps::install(name, "Icon=utilities-terminal\n"));
+            resource = QStringLiteral("applications:") + name + QStringLiteral(".desktop");
+        } else {
+            resource = m_documents.path() + QStringLiteral("/document%1.txt").arg(i);
+            QFile document(resource);
+            QVERIFY(document.open(QIODevice::WriteOnly));
+            document.write("text\n");
+        }
+
+        QStandardItem *item = new QStandardItem();
+        item->setData(resource, KActivities::Stats::ResultModel::ResourceRole);
+        m_usage.appendRow(item);
+    }
+
+    KSycoca::self()->ensureCacheValid();
+
+    // the model only maps rows to resources through a proxy, as it has one in use
+    m_usageProxy.setSourceModel(&m_usage);
+}
+
+void RecentUsageModelTest::setUsage(RecentUsageModel *model)
+{
+    // instead of the stats of the activity manager
+    delete model->sourceModel();
+    model->setSourceModel(&m_usageProxy);
+}
+
+QStringList RecentUsageModelTest::actionTexts(const QModelIndex &index)
+{
+    QStringList texts;
+
+    foreach (const QVariant &action, index.data(Kicker::ActionListRole).toList()) {
+        texts << action.toMap().value(QStringLiteral("text")).toString();
+    }
+
+    return texts;
+}
+
+void RecentUsageModelTest::testData()
+{
+    RecentUsageModel model;
+    setUsage(&model);
+
+    QCOMPARE(model.rowCount(), s_rowCount);
+
+    const QModelIndex document = model.index(0, 0);
+    QCOMPARE(document.data(Qt::DisplayRole).toString(), QStringLiteral("document0.txt"));
+    QCOMPARE(document.data(Kicker::UrlRole).toString(), QUrl::fromLocalFile(m_documents.path() + QStringLiteral("/document0.txt")).toString());
+
+    const QModelIndex app = model.index(1, 0);
+    QCOMPARE(app.data(Qt::DisplayRole).toString(), QStringLiteral("kickertest1"));
+    QCOMPARE(app.data(Kicker::FavoriteIdRole).toString(), QStringLiteral("kickertest1.desktop"));
+
+    // the same once it is cached
+    QCOMPARE(document.data(Qt::DisplayRole).toString(), QStringLiteral("document0.txt"));
+    QCOMPARE(app.data(Qt::DisplayRole).toString(), QStringLiteral("kickertest1"));
+    QCOMPARE(app.data(Kicker::ActionListRole), app.data(Kicker::ActionListRole));
+}
+
+void RecentUsageModelTest::testRecentDocumentActions()
+{
+    // apps report usage under their storage id without the .desktop suffix
+    const QString agent = QStringLiteral("kickertest1");
+    QVERIFY(StatsDatabase::addUsage(m_activity, QStringLiteral("applications:kickertest1.desktop"),
+                                    QStringLiteral("org.kde.plasmashell"), 100));
+    QVERIFY(StatsDatabase::addUsage(m_activity, QStringLiteral("applications:kickertest3.desktop"),
+                                    QStringLiteral("org.kde.plasmashell"), 200));
+    QVERIFY(StatsDatabase::addUsage(m_activity, m_documents.path() + QStringLiteral("/document0.txt"), agent, 150));
+
+    // what the stats of the activity manager list, through the model's own proxies
+    RecentUsageModel model(nullptr, RecentUsageModel::OnlyApps);
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.index(0, 0).data(Qt::DisplayRole).toString(), QStringLiteral("kickertest3"));
+
+    const QModelIndex app = model.index(1, 0);
+    QCOMPARE(app.data(Qt::DisplayRole).toString(), QStringLiteral("kickertest1"));
+    QVERIFY(actionTexts(app).contains(QStringLiteral("document0.txt")));
+    QVERIFY(!actionTexts(app).contains(QStringLiteral("document2.txt")));
+
+    // the app opened another document since its actions were first asked for
+    QVERIFY(StatsDatabase::addUsage(m_activity, m_documents.path() + QStringLiteral("/document2.txt"), agent, 300));
+
+    const QStringList texts = actionTexts(app);
+    QVERIFY(texts.contains(QStringLiteral("document0.txt")));
+    QVERIFY(texts.contains(QStringLiteral("document2.txt")));
+    QVERIFY(texts.indexOf(QStringLiteral("document2.txt")) < texts.indexOf(QStringLiteral("document0.txt")));
+}
+
+void RecentUsageModelTest::benchmarkData_data()
+{
+    QTest::addColumn<int>("role");
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("display") << int(Qt::DisplayRole) << true;
+    QTest::newRow("display, uncached") << int(Qt::DisplayRole) << false;
+    QTest::newRow("decoration") << int(Qt::DecorationRole) << true;
+    QTest::newRow("decoration, uncached") << int(Qt::DecorationRole) << false;
+    QTest::newRow("favorite id") << int(Kicker::FavoriteIdRole) << true;
+    QTest::newRow("action list") << int(Kicker::ActionListRole) << true;
+    QTest::newRow("action list, uncached") << int(Kicker::ActionListRole) << false;
+}
+
+void RecentUsageModelTest::benchmarkData()
+{
+    QFETCH(int, role);
+    QFETCH(bool, cached);
+
+    RecentUsageModel model;
+    setUsage(&model);
+
+    // what a view scrolling through all rows asks for
+    QBENCHMARK {
+        if (!cached) {
+            QMetaObject::invokeMethod(&model, "checkSycocaChanges", Q_ARG(QStringList, QStringList({QStringLiteral("apps")})));
+        }
+
+        for (int row = 0; row < s_rowCount; ++row) {
+            model.data(model.index(row, 0), role);
+        }
+    }
+}
+
+QTEST_MAIN(RecentUsageModelTest)
+
+#include "recentusagemodeltest.moc"
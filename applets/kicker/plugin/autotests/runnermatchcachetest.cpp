@@ -0,0 +1,246 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include <algorithm>
+
+#include <QObject>
+#include <QTest>
+
+#include <KRunner/AbstractRunner>
+#include <KRunner/QueryMatch>
+
+#include "../runnermatchcache.h"
+
+class TestRunner : public Plasma::AbstractRunner
+{
+public:
+    explicit TestRunner(const QString &id, QObject *parent = nullptr)
+        : Plasma::AbstractRunner(parent, QString())
+    {
+        // without metadata, the id of a runner is its object name
+        setObjectName(id);
+    }
+
+    void match(Plasma::RunnerContext &context) override
+    {
+        Q_UNUSED(context)
+    }
+};
+
+class RunnerMatchCacheTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    RunnerMatchCacheTest();
+
+private Q_SLOTS:
+    void init();
+
+    void testCacheHit();
+    void testEmptyResultsCached();
+    void testRefinement();
+    void testChangedResultsInvalidate();
+    void testInvalidate();
+    void testCacheableRunnersChanged();
+
+    void benchmarkInterimMatches();
+
+private:
+    Plasma::QueryMatch match(TestRunner *runner, const QString &text,
+        const QString &subtext = QString()) const;
+    QStringList texts(const QList<Plasma::QueryMatch> &matches) const;
+
+    TestRunner m_services;
+    TestRunner m_bookmarks;
+    TestRunner m_shell;
+    RunnerMatchCache m_cache;
+};
+
+RunnerMatchCacheTest::RunnerMatchCacheTest()
+    : m_services(QStringLiteral("services"))
+    , m_bookmarks(QStringLiteral("bookmarks"))
+    , m_shell(QStringLiteral("shell"))
+{
+}
+
+Plasma::QueryMatch RunnerMatchCacheTest::match(TestRunner *runner, const QString &text,
+    const QString &subtext) const
+{
+    Plasma::QueryMatch match(runner);
+    match.setId(text);
+    match.setText(text);
+    match.setSubtext(subtext);
+    match.setRelevance(1.0);
+    return match;
+}
+
+QStringList RunnerMatchCacheTest::texts(const QList<Plasma::QueryMatch> &matches) const
+{
+    QStringList texts;
+    foreach (const Plasma::QueryMatch &match, matches) {
+        texts << match.text();
+    }
+    std::sort(texts.begin(), texts.end());
+    return texts;
+}
+
+void RunnerMatchCacheTest::init()
+{
+    m_cache.clear();
+    m_cache.setCacheableRunners({QStringLiteral("services"), QStringLiteral("bookmarks")});
+    m_cache.setRefinableRunners({QStringLiteral("services")});
+}
+
+void RunnerMatchCacheTest::testCacheHit()
+{
+    m_cache.insert(QStringLiteral("fire"), {
+        match(&m_services, QStringLiteral("Firefox")),
+        match(&m_bookmarks, QStringLiteral("Fireworks")),
+        match(&m_shell, QStringLiteral("fire"))});
+
+    QVERIFY(m_cache.contains(QStringLiteral("fire")));
+
+    // the shell runner is not cacheable
+    QCOMPARE(texts(m_cache.interimMatches(QStringLiteral("fire"), {})),
+        QStringList({QStringLiteral("Firefox"), QStringLiteral("Fireworks")}));
+
+    // runners which reported already show their own matches
+    QCOMPARE(texts(m_cache.interimMatches(QStringLiteral("fire"), {QStringLiteral("bookmarks")})),
+        QStringList({QStringLiteral("Firefox")}));
+
+    QVERIFY(m_cache.interimMatches(QStringLiteral("water"), {}).isEmpty());
+    QVERIFY(m_cache.interimMatches(QString(), {}).isEmpty());
+}
+
+void RunnerMatchCacheTest::testEmptyResultsCached()
+{
+    m_cache.insert(QStringLiteral("xyz"), {});
+
+    QVERIFY(m_cache.contains(QStringLiteral("xyz")));
+    QVERIFY(m_cache.interimMatches(QStringLiteral("xyz"), {}).isEmpty());
+
+    // an empty query is never cached
+    m_cache.insert(QString(), {match(&m_services, QStringLiteral("Firefox"))});
+    QVERIFY(!m_cache.contains(QString()));
+}
+
+void RunnerMatchCacheTest::testRefinement()
+{
+    m_cache.insert(QStringLiteral("fi"), {
+        match(&m_services, QStringLiteral("Firefox")),
+        match(&m_services, QStringLiteral("Filelight")),
+        match(&m_services, QStringLiteral("Dolphin"), QStringLiteral("File Manager")),
+        match(&m_services, QStringLiteral("Konsole"), QStringLiteral("Terminal")),
+        match(&m_bookmarks, QStringLiteral("Fireworks"))});
+
+    // the last matches of a refinable runner which still show the term are kept
+    QCOMPARE(texts(m_cache.interimMatches(QStringLiteral("fil"), {})),
+        QStringList({QStringLiteral("Dolphin"), QStringLiteral("Filelight")}));
+    QCOMPARE(texts(m_cache.interimMatches(QStringLiteral("FIRE"), {})),
+        QStringList({QStringLiteral("Firefox")}));
+
+    // once the runner reports, its fresh matches are shown instead
+    QVERIFY(m_cache.interimMatches(QStringLiteral("fil"), {QStringLiteral("services")}).isEmpty());
+
+    // a term which does not extend the last one is not refined from it
+    QVERIFY(m_cache.interimMatches(QStringLiteral("f"), {}).isEmpty());
+    QVERIFY(m_cache.interimMatches(QStringLiteral("kon"), {}).isEmpty());
+
+    // a cached result for the term wins over refining the last one
+    m_cache.insert(QStringLiteral("fir"), {match(&m_services, QStringLiteral("Firewall"))});
+    m_cache.insert(QStringLiteral("f"), {match(&m_services, QStringLiteral("Firefox"))});
+    QCOMPARE(texts(m_cache.interimMatches(QStringLiteral("fir"), {})),
+        QStringList({QStringLiteral("Firewall")}));
+}
+
+void RunnerMatchCacheTest::testChangedResultsInvalidate()
+{
+    m_cache.insert(QStringLiteral("fi"), {
+        match(&m_services, QStringLiteral("Firefox")),
+        match(&m_bookmarks, QStringLiteral("Fireworks"))});
+    m_cache.insert(QStringLiteral("fire"), {
+        match(&m_services, QStringLiteral("Firefox")),
+        match(&m_bookmarks, QStringLiteral("Fireworks"))});
+
+    // the same results again keep what is cached for other queries
+    m_cache.insert(QStringLiteral("fi"), {
+        match(&m_services, QStringLiteral("Firefox")),
+        match(&m_bookmarks, QStringLiteral("Fireworks"))});
+    QCOMPARE(texts(m_cache.interimMatches(QStringLiteral("fire"), {})),
+        QStringList({QStringLiteral("Firefox"), QStringLiteral("Fireworks")}));
+
+    // a bookmark was added, the cached bookmarks of all queries are stale
+    m_cache.insert(QStringLiteral("fi"), {
+        match(&m_services, QStringLiteral("Firefox")),
+        match(&m_bookmarks, QStringLiteral("Fireworks")),
+        match(&m_bookmarks, QStringLiteral("Firebird"))});
+    QCOMPARE(texts(m_cache.interimMatches(QStringLiteral("fire"), {})),
+        QStringList({QStringLiteral("Firefox")}));
+    QCOMPARE(texts(m_cache.interimMatches(QStringLiteral("fi"), {})),
+        QStringList({QStringLiteral("Firebird"), QStringLiteral("Firefox"), QStringLiteral("Fireworks")}));
+}
+
+void RunnerMatchCacheTest::testInvalidate()
+{
+    m_cache.insert(QStringLiteral("fire"), {
+        match(&m_services, QStringLiteral("Firefox")),
+        match(&m_bookmarks, QStringLiteral("Fireworks"))});
+    m_cache.insert(QStringLiteral("fi"), {
+        match(&m_services, QStringLiteral("Firefox")),
+        match(&m_services, QStringLiteral("Filelight"))});
+
+    m_cache.invalidate(QStringLiteral("services"));
+
+    QCOMPARE(texts(m_cache.interimMatches(QStringLiteral("fire"), {})),
+        QStringList({QStringLiteral("Fireworks")}));
+
+    // neither cached nor refined from the last query anymore
+    QVERIFY(m_cache.interimMatches(QStringLiteral("fi"), {}).isEmpty());
+    QVERIFY(m_cache.interimMatches(QStringLiteral("fil"), {}).isEmpty());
+}
+
+void RunnerMatchCacheTest::testCacheableRunnersChanged()
+{
+    m_cache.insert(QStringLiteral("fire"), {match(&m_services, QStringLiteral("Firefox"))});
+
+    m_cache.setCacheableRunners({QStringLiteral("services"), QStringLiteral("bookmarks")});
+    QVERIFY(m_cache.contains(QStringLiteral("fire")));
+
+    m_cache.setCacheableRunners({QStringLiteral("bookmarks")});
+    QVERIFY(!m_cache.contains(QStringLiteral("fire")));
+}
+
+void RunnerMatchCacheTest::benchmarkInterimMatches()
+{
+    QList<Plasma::QueryMatch> matches;
+    for (int i = 0; i < 200; ++i) {
+        matches << match(&m_services, QStringLiteral("Application %1").arg(i));
+        matches << match(&m_bookmarks, QStringLiteral("Bookmark %1").arg(i));
+    }
+
+    m_cache.insert(QStringLiteral("a"), matches);
+
+    QBENCHMARK {
+        QCOMPARE(m_cache.interimMatches(QStringLiteral("a"), {}).count(), 400);
+        QCOMPARE(m_cache.interimMatches(QStringLiteral("application 1"), {}).count(), 111);
+    }
+}
+
+QTEST_MAIN(RunnerMatchCacheTest)
+
+#include "runnermatchcachetest.moc"
@@ -0,0 +1,292 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include <QObject>
+#include <QSet>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <KRunner/AbstractRunner>
+#include <KRunner/QueryMatch>
+
+#include "../actionlist.h"
+#include "../runnermatchesmodel.h"
+
+class TestRunner : public Plasma::AbstractRunner
+{
+public:
+    explicit TestRunner(QObject *parent = nullptr)
+        : Plasma::AbstractRunner(parent, QString())
+    {
+    }
+
+    void match(Plasma::RunnerContext &context) override
+    {
+        Q_UNUSED(context)
+    }
+};
+
+class RunnerMatchesModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testSignals();
+    void testReplay();
+
+    void benchmarkReplay();
+
+private:
+    QList<Plasma::QueryMatch> matchesFor(const QString &query, int limit);
+    Plasma::QueryMatch match(const QString &name, const QString &subtext = QString());
+    static int rowCount(const QSignalSpy &spy);
+
+    TestRunner m_runner;
+    QStringList m_names;
+    // what matchesChanged reported while the queries were typed
+    QVector<QList<Plasma::QueryMatch>> m_stream;
+};
+
+QList<Plasma::QueryMatch> RunnerMatchesModelTest::matchesFor(const QString &query, int limit)
+{
+    QList<Plasma::QueryMatch> matches;
+
+    for (int i = 0; i < m_names.count() && matches.count() < limit; ++i) {
+        const QString &name = m_names.at(i);
+        const int position = name.indexOf(query, 0, Qt::CaseInsensitive);
+        if (position == -1) {
+            continue;
+        }
+
+        Plasma::QueryMatch match(&m_runner);
+        match.setId(name);
+        match.setText(name);
+        match.setIconName(QStringLiteral("application-x-executable"));
+        match.setData(name);
+        match.setRelevance(position == 0 ? 1.0 : 0.5 / position);
+        matches << match;
+    }
+
+    std::sort(matches.begin(), matches.end(), qGreater<Plasma::QueryMatch>());
+
+    return matches;
+}
+
+Plasma::QueryMatch RunnerMatchesModelTest::match(const QString &name, const QString &subtext)
+{
+    Plasma::QueryMatch match(&m_runner);
+    match.setId(name);
+    match.setText(name);
+    match.setSubtext(subtext);
+    return match;
+}
+
+int RunnerMatchesModelTest::rowCount(const QSignalSpy &spy)
+{
+    // the rows of all ranges reported by rowsInserted or rowsRemoved
+    int count = 0;
+    for (const QList<QVariant> &arguments : spy) {
+        count += arguments.at(2).toInt() - arguments.at(1).toInt() + 1;
+    }
+    return count;
+}
+
+void RunnerMatchesModelTest::initTestCase()
+{
+    const QStringList apps({
+        QStringLiteral("Konsole"), QStringLiteral("Kate"), QStringLiteral("KWrite"), QStringLiteral("Dolphin"),
+        QStringLiteral("Firefox"), QStringLiteral("Kontact"), QStringLiteral("KMail"), QStringLiteral("Korganizer"),
+        QStringLiteral("Okular"), QStringLiteral("Gwenview"), QStringLiteral("Spectacle"), QStringLiteral("Ark"),
+        QStringLiteral("Kdenlive"), QStringLiteral("Krita"), QStringLiteral("Kdevelop"), QStringLiteral("Konversation"),
+        QStringLiteral("Kcalc"), QStringLiteral("Elisa"), QStringLiteral("Discover"), QStringLiteral("Filelight")
+    });
+    const QStringList variants({
+        QString(), QStringLiteral(" Settings"), QStringLiteral(" Help"), QStringLiteral(" Profile"),
+        QStringLiteral(" Session"), QStringLiteral(" Document"), QStringLiteral(" Window"), QStringLiteral(" Plugin"),
+        QStringLiteral(" Preview"), QStringLiteral(" Bookmark")
+    });
+
+    for (const QString &variant : variants) {
+        for (const QString &app : apps) {
+            m_names << app + variant;
+        }
+    }
+
+    // typing "konsole", correcting it to "kontact" and going for "kate",
+    // every query reporting its matches twice, as the runners finish
+    const QStringList queries({
+        QStringLiteral("k"), QStringLiteral("ko"), QStringLiteral("kon"), QStringLiteral("kons"),
+        QStringLiteral("konso"), QStringLiteral("konsol"), QStringLiteral("konsole"), QStringLiteral("konsol"),
+        QStringLiteral("konso"), QStringLiteral("kons"), QStringLiteral("kon"), QStringLiteral("kont"),
+        QStringLiteral("konta"), QStringLiteral("kontac"), QStringLiteral("kontact"), QStringLiteral("k"),
+        QStringLiteral("ka"), QStringLiteral("kat"), QStringLiteral("kate")
+    });
+
+    for (const QString &query : queries) {
+        m_stream << matchesFor(query, 10) << matchesFor(query, 50);
+    }
+}
+
+void RunnerMatchesModelTest::testSignals()
+{
+    RunnerMatchesModel model(QString(), QStringLiteral("Search results"), nullptr);
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy moved(&model, &QAbstractItemModel::rowsMoved);
+    QSignalSpy changed(&model, &QAbstractItemModel::dataChanged);
+
+    auto clearSpies = [&]() {
+        inserted.clear();
+        removed.clear();
+        moved.clear();
+        changed.clear();
+    };
+
+    // one insertion per new match
+    model.setMatches({match(QStringLiteral("A")), match(QStringLiteral("B")),
+                      match(QStringLiteral("C")), match(QStringLiteral("D"))});
+    QCOMPARE(inserted.count(), 4);
+    QCOMPARE(rowCount(inserted), 4);
+    QCOMPARE(removed.count(), 0);
+    QCOMPARE(moved.count(), 0);
+    QCOMPARE(changed.count(), 0);
+
+    // one removal and one insertion, the others stay where they are
+    clearSpies();
+    model.setMatches({match(QStringLiteral("A")), match(QStringLiteral("C")),
+                      match(QStringLiteral("D")), match(QStringLiteral("E"))});
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(removed.first().at(1).toInt(), 1);
+    QCOMPARE(rowCount(removed), 1);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(inserted.first().at(1).toInt(), 3);
+    QCOMPARE(moved.count(), 0);
+    QCOMPARE(changed.count(), 0);
+
+    // a match moving up is one move
+    clearSpies();
+    model.setMatches({match(QStringLiteral("D")), match(QStringLiteral("A")),
+                      match(QStringLiteral("C")), match(QStringLiteral("E"))});
+    QCOMPARE(moved.count(), 1);
+    QCOMPARE(moved.first().at(1).toInt(), 2);
+    QCOMPARE(moved.first().at(4).toInt(), 0);
+    QCOMPARE(inserted.count(), 0);
+    QCOMPARE(removed.count(), 0);
+    QCOMPARE(changed.count(), 0);
+
+    // a match showing something else is one change
+    clearSpies();
+    model.setMatches({match(QStringLiteral("D")), match(QStringLiteral("A")),
+                      match(QStringLiteral("C"), QStringLiteral("changed")), match(QStringLiteral("E"))});
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(changed.first().at(0).toModelIndex().row(), 2);
+    QCOMPARE(model.index(2, 0).data(Kicker::DescriptionRole).toString(), QStringLiteral("changed"));
+    QCOMPARE(inserted.count(), 0);
+    QCOMPARE(removed.count(), 0);
+    QCOMPARE(moved.count(), 0);
+
+    // matches which are not adjacent are removed one by one, adjacent ones in one range
+    clearSpies();
+    model.setMatches({match(QStringLiteral("A")), match(QStringLiteral("E"))});
+    QCOMPARE(removed.count(), 2);
+    QCOMPARE(rowCount(removed), 2);
+    QCOMPARE(inserted.count(), 0);
+    QCOMPARE(changed.count(), 0);
+
+    clearSpies();
+    model.setMatches({});
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(rowCount(removed), 2);
+    QCOMPARE(model.rowCount(), 0);
+
+    QCOMPARE(reset.count(), 0);
+}
+
+void RunnerMatchesModelTest::testReplay()
+{
+    RunnerMatchesModel model(QString(), QStringLiteral("Search results"), nullptr);
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy changed(&model, &QAbstractItemModel::dataChanged);
+
+    QSet<QString> shown;
+
+    for (const QList<Plasma::QueryMatch> &matches : qAsConst(m_stream)) {
+        // a match shown before and after keeps its index
+        QPersistentModelIndex kept;
+        for (int row = 0; row < model.rowCount() && !kept.isValid(); ++row) {
+            for (const Plasma::QueryMatch &match : matches) {
+                if (match.text() == model.index(row, 0).data().toString()) {
+                    kept = model.index(row, 0);
+                    break;
+                }
+            }
+        }
+        const QString keptText = kept.data().toString();
+
+        QSet<QString> ids;
+        for (const Plasma::QueryMatch &match : matches) {
+            ids.insert(match.id());
+        }
+
+        inserted.clear();
+        removed.clear();
+
+        model.setMatches(matches);
+
+        QCOMPARE(model.rowCount(), matches.count());
+        for (int row = 0; row < matches.count(); ++row) {
+            QCOMPARE(model.index(row, 0).data().toString(), matches.at(row).text());
+        }
+
+        if (!keptText.isEmpty()) {
+            QVERIFY(kept.isValid());
+            QCOMPARE(kept.data().toString(), keptText);
+        }
+
+        // only the matches which came or went are inserted or removed, one
+        // insertion each; the others are moved and keep their rows
+        QCOMPARE(inserted.count(), (ids - shown).count());
+        QCOMPARE(rowCount(removed), (shown - ids).count());
+        QVERIFY(removed.count() <= (shown - ids).count());
+
+        shown = ids;
+    }
+
+    // the same name always shows the same
+    QCOMPARE(changed.count(), 0);
+    QCOMPARE(reset.count(), 0);
+}
+
+void RunnerMatchesModelTest::benchmarkReplay()
+{
+    QBENCHMARK {
+        RunnerMatchesModel model(QString(), QStringLiteral("Search results"), nullptr);
+
+        for (const QList<Plasma::QueryMatch> &matches : qAsConst(m_stream)) {
+            model.setMatches(matches);
+        }
+    }
+}
+
+QTEST_MAIN(RunnerMatchesModelTest)
+
+#include "runnermatchesmodeltest.moc"
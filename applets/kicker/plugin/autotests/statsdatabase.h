@@ -0,0 +1,152 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#ifndef STATSDATABASE_H
+#define STATSDATABASE_H
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <KActivities/Consumer>
+
+/**
+ * Helpers to record usage in the resources database of the activity
+ * manager, in the test mode of QStandardPaths. KActivities::Stats reads
+ * its queries from there, so the models see the usage as they would in a
+ * session, without the activity manager writing to it.
+ */
+namespace StatsDatabase
+{
+    static const QString s_connectionName = QStringLiteral("kickerteststats");
+
+    inline QString path()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+            + QStringLiteral("/kactivitymanagerd/resources/database");
+    }
+
+    inline QSqlDatabase database()
+    {
+        if (QSqlDatabase::contains(s_connectionName)) {
+            return QSqlDatabase::database(s_connectionName);
+        }
+
+        QSqlDatabase database = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), s_connectionName);
+        database.setDatabaseName(path());
+        database.open();
+        return database;
+    }
+
+    // the activity "current" resolves to for the models, none without the activity manager
+    inline QString currentActivity()
+    {
+        KActivities::Consumer consumer;
+        QTest::qWaitFor([&consumer] {
+            return consumer.serviceStatus() != KActivities::Consumer::Unknown;
+        }, 5000);
+
+        return consumer.currentActivity();
+    }
+
+    // an empty database, as the activity manager creates it
+    inline bool create()
+    {
+        if (QSqlDatabase::contains(s_connectionName)) {
+            QSqlDatabase::database(s_connectionName).close();
+        }
+
+        QFile::remove(path());
+        if (!QDir().mkpath(QFileInfo(path()).path())) {
+            return false;
+        }
+
+        QSqlDatabase db = database();
+        if (!db.open()) {
+            return false;
+        }
+
+        static const char *const schema[] = {
+            "CREATE TABLE SchemaInfo (key text PRIMARY KEY, value text)",
+            "INSERT INTO SchemaInfo VALUES ('version', '2015.02.09')",
+            "CREATE TABLE ResourceEvent (usedActivity TEXT, initiatingAgent TEXT, targettedResource TEXT, "
+                "start INTEGER, end INTEGER)",
+            "CREATE TABLE ResourceScoreCache (usedActivity TEXT, initiatingAgent TEXT, targettedResource TEXT, "
+                "scoreType INTEGER, cachedScore FLOAT, firstUpdate INTEGER, lastUpdate INTEGER, "
+                "PRIMARY KEY(usedActivity, initiatingAgent, targettedResource))",
+            "CREATE TABLE ResourceLink (usedActivity TEXT, initiatingAgent TEXT, targettedResource TEXT, "
+                "PRIMARY KEY(usedActivity, initiatingAgent, targettedResource))",
+            "CREATE TABLE ResourceInfo (targettedResource TEXT, title TEXT, mimetype TEXT, "
+                "autoTitle INTEGER, autoMimetype INTEGER, PRIMARY KEY(targettedResource))",
+        };
+
+        QSqlQuery query(db);
+        for (const char *statement : schema) {
+            if (!query.exec(QString::fromLatin1(statement))) {
+                qWarning() << "Could not create the stats database" << query.lastError().text();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // @p agent used @p resource in @p activity, last at @p time seconds since the epoch
+    inline bool addUsage(const QString &activity, const QString &resource, const QString &agent, qint64 time)
+    {
+        QSqlQuery query(database());
+        query.prepare(QStringLiteral("INSERT OR REPLACE INTO ResourceScoreCache VALUES "
+                                     "(:activity, :agent, :resource, 0, 1.0, :first, :last)"));
+        query.bindValue(QStringLiteral(":activity"), activity);
+        query.bindValue(QStringLiteral(":agent"), agent);
+        query.bindValue(QStringLiteral(":resource"), resource);
+        query.bindValue(QStringLiteral(":first"), time);
+        query.bindValue(QStringLiteral(":last"), time);
+
+        if (!query.exec()) {
+            qWarning() << "Could not record usage" << query.lastError().text();
+            return false;
+        }
+
+        return true;
+    }
+
+    // @p agent linked @p resource to @p activity, e.g. a favorite
+    inline bool addLink(const QString &activity, const QString &resource, const QString &agent)
+    {
+        QSqlQuery query(database());
+        query.prepare(QStringLiteral("INSERT OR REPLACE INTO ResourceLink VALUES (:activity, :agent, :resource)"));
+        query.bindValue(QStringLiteral(":activity"), activity);
+        query.bindValue(QStringLiteral(":agent"), agent);
+        query.bindValue(QStringLiteral(":resource"), resource);
+
+        if (!query.exec()) {
+            qWarning() << "Could not record a link" << query.lastError().text();
+            return false;
+        }
+
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,66 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#ifndef TESTAPPS_H
+#define TESTAPPS_H
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+
+/**
+ * Helpers to install applications for the menu in the applications
+ * directory of the test mode of QStandardPaths.
+ */
+namespace TestApps
+{
+    inline QString desktopFilePath(const QString &name)
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::ApplicationsLocation)
+            + QLatin1Char('/') + name + QStringLiteral(".desktop");
+    }
+
+    // removes all applications installed before
+    inline bool reset()
+    {
+        const QString appsPath = QStandardPaths::writableLocation(QStandardPaths::ApplicationsLocation);
+        QDir(appsPath).removeRecursively();
+        return QDir().mkpath(appsPath);
+    }
+
+    // @p keys are more lines of the [Desktop Entry] group, e.g. "Categories=Utility;\n"
+    inline bool install(const QString &name, const QByteArray &keys = QByteArray())
+    {
+        QFile file(desktopFilePath(name));
+        if (!file.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+
+        return file.write("[Desktop Entry]\n"
+                          "Type=Application\n"
+                          "Exec=true\n"
+                          "Name=" + name.toUtf8() + "\n"
+                          + keys) != -1;
+    }
+
+    inline bool remove(const QString &name)
+    {
+        return QFile::remove(desktopFilePath(name));
+    }
+}
+
+#endif
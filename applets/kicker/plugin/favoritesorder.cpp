@@ -0,0 +1,119 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "favoritesorder.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+int FavoritesOrder::count() const
+{
+    return m_ids.count();
+}
+
+QString FavoritesOrder::at(int row) const
+{
+    return m_ids.at(row);
+}
+
+QStringList FavoritesOrder::ids() const
+{
+    return m_ids.toList();
+}
+
+int FavoritesOrder::rowOf(const QString &id) const
+{
+    return m_rows.value(id, -1);
+}
+
+void FavoritesOrder::insert(int row, const QString &id)
+{
+    m_ids.insert(row, id);
+    updateRows(row);
+}
+
+void FavoritesOrder::removeAt(int row)
+{
+    const QString id = m_ids.at(row);
+
+    m_ids.removeAt(row);
+
+    // a later copy of the id is found again by updateRows()
+    if (m_rows.value(id) == row) {
+        m_rows.remove(id);
+    }
+
+    updateRows(row);
+}
+
+void FavoritesOrder::move(int from, int to)
+{
+    m_ids.move(from, to);
+    updateRows(qMin(from, to));
+}
+
+void FavoritesOrder::sort(const QStringList &ordering)
+{
+    QHash<QString, int> positions;
+    positions.reserve(ordering.count());
+
+    for (int i = 0; i < ordering.count(); ++i) {
+        if (!positions.contains(ordering.at(i))) {
+            positions.insert(ordering.at(i), i);
+        }
+    }
+
+    std::sort(m_ids.begin(), m_ids.end(),
+            [&positions] (const QString &left, const QString &right) {
+                const int leftIndex = positions.value(left, -1);
+                const int rightIndex = positions.value(right, -1);
+
+                return (leftIndex == -1 && rightIndex == -1) ?
+                           left < right :
+
+                       (leftIndex == -1) ?
+                           false :
+
+                       (rightIndex == -1) ?
+                           true :
+
+                       // otherwise
+                           leftIndex < rightIndex;
+            });
+
+    m_rows.clear();
+    updateRows(0);
+}
+
+void FavoritesOrder::updateRows(int from)
+{
+    QSet<QString> seen;
+
+    for (int row = from; row < m_ids.count(); ++row) {
+        const QString &id = m_ids.at(row);
+        auto it = m_rows.find(id);
+
+        if (it == m_rows.end()) {
+            m_rows.insert(id, row);
+        } else if (*it >= from && !seen.contains(id)) {
+            *it = row;
+        }
+
+        seen.insert(id);
+    }
+}
@@ -0,0 +1,56 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#ifndef FAVORITESORDER_H
+#define FAVORITESORDER_H
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+// The ids of the favorites in the order they are shown, with the row of
+// each id at hand. The same id may be in the list more than once, it then
+// maps to its first row.
+class FavoritesOrder
+{
+    public:
+        int count() const;
+        QString at(int row) const;
+        QStringList ids() const;
+
+        // @return the first row of @p id, -1 if it is not in the list
+        int rowOf(const QString &id) const;
+
+        void insert(int row, const QString &id);
+        void removeAt(int row);
+        void move(int from, int to);
+
+        // Sorts the ids by where they first are in @p ordering, the ones not
+        // in it come last, sorted by id.
+        void sort(const QStringList &ordering);
+
+    private:
+        // Brings the rows from row @p from on up to date. This walks all the
+        // rows after @p from, as changing m_ids does anyway, finding a row is
+        // what needs to be fast.
+        void updateRows(int from);
+
+        QVector<QString> m_ids;
+        QHash<QString, int> m_rows;
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include "fileentry.h"
 #include "actionlist.h"
 #include "debug.h"
+#include "favoritesorder.h"
 
 #include <QFileInfo>
 #include <QTimer>
@@ -32,6 +33,7 @@
 #include <KLocalizedString>
 #include <KSharedConfig>
 #include <KConfigGroup>
+#include <KSycoca>
 
 #include <KActivities/Consumer>
 #include <KActivities/Stats/Terms>
@@ -92,6 +94,8 @@ public:
                 return;
             }
 
+            m_resolved = true;
+
             const auto url = entry->url();
 
             qCDebug(KICKER_DEBUG) << "Original id is: " << id << ", and the url is" << url;
@@ -133,6 +137,12 @@ public:
             return m_id;
         }
 
+        // whether the id belongs to a valid entry, otherwise it is kept as is
+        bool isResolved() const
+        {
+            return m_resolved;
+        }
+
         bool operator==(const NormalizedId &other) const
         {
             return m_id == other.m_id;
@@ -140,11 +150,25 @@ public:
 
     private:
         QString m_id;
+        bool m_resolved = false;
     };
 
     NormalizedId normalizedId(const QString &id) const
     {
-        return NormalizedId(this, id);
+        // Resolving an id may need to create an entry, do it only once
+        const auto it = m_normalizedIds.constFind(id);
+        if (it != m_normalizedIds.constEnd()) {
+            return *it;
+        }
+
+        const NormalizedId normalized(this, id);
+
+        // Invalid entries may become valid later on, e.g. when an application gets installed
+        if (normalized.isResolved()) {
+            m_normalizedIds.insert(id, normalized);
+        }
+
+        return normalized;
     }
 
     QSharedPointer<AbstractEntry> entryForResource(const QString &resource) const
@@ -204,6 +228,13 @@ public:
                     removeResult(resource);
                 });
 
+        // An id may resolve differently once applications got installed,
+        // removed or moved around in the menu
+        connect(KSycoca::self(), static_cast<void (KSycoca::*)(const QStringList &)>(&KSycoca::databaseChanged),
+                this, [this] () {
+                    m_normalizedIds.clear();
+                });
+
         // Loading the items order
         const auto cfg = KSharedConfig::openConfig(QStringLiteral("kactivitymanagerd-statsrc"));
 
@@ -233,38 +264,17 @@ public:
             addResult(result.resource(), -1, false);
         }
 
-        // Normalizing all the ids
-        std::transform(ordering.begin(), ordering.end(), ordering.begin(),
-                       [&] (const QString &item) {
-                          return normalizedId(item).value();
-                       });
+        // Normalizing all the ids, and sorting the items in the cache by them
+        QStringList normalizedOrdering;
+        normalizedOrdering.reserve(ordering.count());
 
-        // Sorting the items in the cache
-        std::sort(m_items.begin(), m_items.end(),
-                [&] (const NormalizedId &left, const NormalizedId &right) {
-                    auto leftIndex = ordering.indexOf(left.value());
-                    auto rightIndex = ordering.indexOf(right.value());
-
-                    return (leftIndex == -1 && rightIndex == -1) ?
-                               left.value() < right.value() :
-
-                           (leftIndex == -1) ?
-                               false :
-
-                           (rightIndex == -1) ?
-                               true :
+        for (const QString &id : qAsConst(ordering)) {
+            normalizedOrdering << normalizedId(id).value();
+        }
 
-                           // otherwise
-                               leftIndex < rightIndex;
-                });
+        m_items.sort(normalizedOrdering);
 
-        // Debugging:
-        QVector<QString> itemStrings(m_items.size());
-        std::transform(m_items.cbegin(), m_items.cend(), itemStrings.begin(),
-                [] (const NormalizedId &item) {
-                    return item.value();
-                });
-        qCDebug(KICKER_DEBUG) << "After ordering: " << itemStrings;
+        qCDebug(KICKER_DEBUG) << "After ordering: " << m_items.ids();
     }
 
     void addResult(const QString &_resource, int index, bool notifyModel = true)
@@ -301,8 +311,11 @@ public:
             = entry;
 
         auto normalized = normalizedId(resource);
-        m_items.insert(index, normalized);
+        m_items.insert(index, normalized.value());
         m_itemEntries[normalized.value()] = entry;
+        m_entryKeys[normalized.value()] = {
+            resource, entry->id(), url.toString(), url.toLocalFile(), normalized.value()
+        };
 
         if (notifyModel) {
             endInsertRows();
@@ -324,20 +337,18 @@ public:
 
         qCDebug(KICKER_DEBUG) << "Removing result" << resource;
 
-        auto index = m_items.indexOf(normalizedId(resource));
+        auto index = m_items.rowOf(normalized.value());
 
         if (index == -1) return;
 
         beginRemoveRows(QModelIndex(), index, index);
-        auto entry = m_itemEntries[resource];
+        auto entry = m_itemEntries.value(normalized.value());
         m_items.removeAt(index);
 
-        // Removing the entry from the cache
-        QMutableHashIterator<QString, QSharedPointer<AbstractEntry>> i(m_itemEntries);
-        while (i.hasNext()) {
-            i.next();
-            if (i.value() == entry) {
-                i.remove();
+        // Removing the entry from the cache, under the keys it was added with
+        for (const QString &key : m_entryKeys.take(normalized.value())) {
+            if (m_itemEntries.value(key) == entry) {
+                m_itemEntries.remove(key);
             }
         }
 
@@ -359,7 +370,7 @@ public:
 
         const auto index = item.row();
 
-        const auto entry = m_itemEntries[m_items[index].value()];
+        const auto entry = m_itemEntries[m_items.at(index)];
 
         return entry == nullptr ? QVariant()
              : role == Qt::DisplayRole ? entry->name()
@@ -408,14 +419,8 @@ public:
 
     void saveOrdering()
     {
-        QStringList ids;
-
-        for (const auto& item: m_items) {
-            ids << item.value();
-        }
-
         qCDebug(KICKER_DEBUG) << "Save ordering (from Private::saveOrdering) -->";
-        saveOrdering(ids, m_clientId, m_activities.currentActivity());
+        saveOrdering(m_items.ids(), m_clientId, m_activities.currentActivity());
     }
 
     static void saveOrdering(const QStringList &ids, const QString &clientId, const QString &currentActivity)
@@ -447,8 +452,13 @@ public:
     ResultWatcher m_watcher;
     QString m_clientId;
 
-    QVector<NormalizedId> m_items;
+    // normalized ids
+    FavoritesOrder m_items;
     QHash<QString, QSharedPointer<AbstractEntry>> m_itemEntries;
+    // the keys of m_itemEntries by the normalized id of their entry
+    QHash<QString, QStringList> m_entryKeys;
+    // normalized ids by the ids they were resolved from
+    mutable QHash<QString, NormalizedId> m_normalizedIds;
     QStringList m_ignoredItems;
 };
 
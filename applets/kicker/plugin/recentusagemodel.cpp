@@ -41,6 +41,7 @@
 #include <KRun>
 #include <KService>
 #include <KStartupInfo>
+#include <KSycoca>
 
 #include <KActivities/Stats/Cleaning>
 #include <KActivities/Stats/ResultModel>
@@ -128,6 +129,8 @@ RecentUsageModel::RecentUsageModel(QObject *parent, IncludeUsage usage, int orde
 , m_ordering((Ordering)ordering)
 , m_complete(false)
 {
+    connect(KSycoca::self(), SIGNAL(databaseChanged(QStringList)), this, SLOT(checkSycocaChanges(QStringList)));
+
     refresh();
 }
 
@@ -180,29 +183,81 @@ QVariant RecentUsageModel::data(const QModelIndex &index, int role) const
     }
 }
 
-QVariant RecentUsageModel::appData(const QString &resource, int role) const
+RecentUsageModel::AppData &RecentUsageModel::cachedAppData(const QString &resource) const
 {
-    const QString storageId = resource.section(QLatin1Char(':'), 1);
-    KService::Ptr service = KService::serviceByStorageId(storageId);
+    auto it = m_appData.find(resource);
+
+    if (it == m_appData.end()) {
+        AppData data;
 
-    QStringList allowedTypes({ QLatin1String("Service"), QLatin1String("Application") });
+        const QString storageId = resource.section(QLatin1Char(':'), 1);
+        KService::Ptr service = KService::serviceByStorageId(storageId);
 
-    if (!service || !allowedTypes.contains(service->property(QLatin1String("Type")).toString())
-            || service->exec().isEmpty()) {
+        static const QStringList allowedTypes({ QLatin1String("Service"), QLatin1String("Application") });
+
+        if (service && allowedTypes.contains(service->property(QLatin1String("Type")).toString())
+                && !service->exec().isEmpty()) {
+            data.service = service;
+            data.icon = QIcon::fromTheme(service->icon(), QIcon::fromTheme(QStringLiteral("unknown")));
+        }
+
+        it = m_appData.insert(resource, data);
+    }
+
+    return *it;
+}
+
+RecentUsageModel::DocData &RecentUsageModel::cachedDocData(const QString &resource) const
+{
+    auto it = m_docData.find(resource);
+
+    if (it == m_docData.end()) {
+        DocData data;
+
+        data.url = QUrl(resource);
+
+        if (data.url.scheme().isEmpty()) {
+            data.url.setScheme(QStringLiteral("file"));
+        }
+
+#if KIO_VERSION >= QT_VERSION_CHECK(5,57,0)
+        // Avoid calling QT_LSTAT and accessing recent documents
+        data.fileItem = KFileItem(data.url, KFileItem::SkipMimeTypeFromContent);
+#else
+        data.fileItem = KFileItem(data.url);
+#endif
+
+        if (data.url.isValid()) {
+            data.icon = QIcon::fromTheme(data.fileItem.iconName(), QIcon::fromTheme(QStringLiteral("unknown")));
+        }
+
+        it = m_docData.insert(resource, data);
+    }
+
+    return *it;
+}
+
+QVariant RecentUsageModel::appData(const QString &resource, int role) const
+{
+    AppData &data = cachedAppData(resource);
+    const KService::Ptr &service = data.service;
+
+    if (!service) {
         return QVariant();
     }
 
     if (role == Qt::DisplayRole) {
         AppsModel *parentModel = qobject_cast<AppsModel *>(QObject::parent());
+        const int nameFormat = parentModel ? parentModel->appNameFormat() : AppEntry::NameOnly;
 
-        if (parentModel)  {
-            return AppEntry::nameFromService(service,
-                (AppEntry::NameFormat)qobject_cast<AppsModel *>(QObject::parent())->appNameFormat());
-        } else {
-            return AppEntry::nameFromService(service, AppEntry::NameOnly);
+        if (data.nameFormat != nameFormat) {
+            data.name = AppEntry::nameFromService(service, (AppEntry::NameFormat)nameFormat);
+            data.nameFormat = nameFormat;
         }
+
+        return data.name;
     } else if (role == Qt::DecorationRole) {
-        return QIcon::fromTheme(service->icon(), QIcon::fromTheme(QStringLiteral("unknown")));
+        return data.icon;
     } else if (role == Kicker::DescriptionRole) {
         return service->comment();
     } else if (role == Kicker::GroupRole) {
@@ -212,11 +267,15 @@ QVariant RecentUsageModel::appData(const QString &resource, int role) const
     } else if (role == Kicker::HasActionListRole) {
         return true;
     } else if (role == Kicker::ActionListRole) {
+        if (!data.hasJumpListActions) {
+            data.jumpListActions = Kicker::jumpListActions(service);
+            data.hasJumpListActions = true;
+        }
+
         QVariantList actionList;
 
-        const QVariantList &jumpList = Kicker::jumpListActions(service);
-        if (!jumpList.isEmpty()) {
-            actionList << jumpList << Kicker::createSeparatorActionItem();
+        if (!data.jumpListActions.isEmpty()) {
+            actionList << data.jumpListActions << Kicker::createSeparatorActionItem();
         }
 
         const QVariantList &recentDocuments = Kicker::recentDocumentActions(service);
@@ -238,18 +297,9 @@ QVariant RecentUsageModel::appData(const QString &resource, int role) const
 
 QVariant RecentUsageModel::docData(const QString &resource, int role) const
 {
-    QUrl url(resource);
-
-    if (url.scheme().isEmpty()) {
-        url.setScheme(QStringLiteral("file"));
-    }
-
-#if KIO_VERSION >= QT_VERSION_CHECK(5,57,0)
-    // Avoid calling QT_LSTAT and accessing recent documents
-    const KFileItem fileItem(url, KFileItem::SkipMimeTypeFromContent);
-#else
-    const KFileItem fileItem(url);
-#endif
+    DocData &data = cachedDocData(resource);
+    const QUrl &url = data.url;
+    const KFileItem &fileItem = data.fileItem;
 
     if (!url.isValid()) {
         return QVariant();
@@ -258,7 +308,7 @@ QVariant RecentUsageModel::docData(const QString &resource, int role) const
     if (role == Qt::DisplayRole) {
         return fileItem.text();
     } else if (role == Qt::DecorationRole) {
-        return QIcon::fromTheme(fileItem.iconName(), QIcon::fromTheme(QStringLiteral("unknown")));
+        return data.icon;
     } else if (role == Kicker::GroupRole) {
         return i18n("Documents");
     } else if (role == Kicker::FavoriteIdRole || role == Kicker::UrlRole) {
@@ -268,6 +318,10 @@ QVariant RecentUsageModel::docData(const QString &resource, int role) const
     } else if (role == Kicker::HasActionListRole) {
         return true;
     } else if (role == Kicker::ActionListRole) {
+        if (data.hasActionList) {
+            return data.actionList;
+        }
+
         QVariantList actionList = Kicker::createActionListForFileItem(fileItem);
 
         actionList << Kicker::createSeparatorActionItem();
@@ -278,6 +332,9 @@ QVariant RecentUsageModel::docData(const QString &resource, int role) const
         const QVariantMap &forgetAllAction = Kicker::createActionItem(forgetAllActionName(), QStringLiteral("forgetAll"));
         actionList << forgetAllAction;
 
+        data.actionList = actionList;
+        data.hasActionList = true;
+
         return actionList;
     }
 
@@ -446,6 +503,9 @@ void RecentUsageModel::refresh()
     setSourceModel(nullptr);
     delete oldModel;
 
+    m_appData.clear();
+    m_docData.clear();
+
     auto query = UsedResources
                     | (m_ordering == Recent ? RecentlyUsedFirst : HighScoredFirst)
                     | Agent::any()
@@ -473,6 +533,18 @@ void RecentUsageModel::refresh()
     m_activitiesModel = new ResultModel(query);
     QAbstractItemModel *model = m_activitiesModel;
 
+    // a resource whose stats changed or which went away is resolved again when shown next
+    connect(model, &QAbstractItemModel::dataChanged, this,
+        [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+            invalidateResources(topLeft.row(), bottomRight.row());
+        });
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+        [this](const QModelIndex &parent, int first, int last) {
+            Q_UNUSED(parent)
+            invalidateResources(first, last);
+        });
+    connect(model, &QAbstractItemModel::modelReset, this, &RecentUsageModel::clearCache);
+
     QModelIndex index;
 
     if (model->canFetchMore(index)) {
@@ -489,3 +561,37 @@ void RecentUsageModel::refresh()
 
     setSourceModel(model);
 }
+
+void RecentUsageModel::invalidateResources(int first, int last)
+{
+    if (!m_activitiesModel) {
+        return;
+    }
+
+    for (int row = first; row <= last; ++row) {
+        const QString resource = m_activitiesModel->index(row, 0).data(ResultModel::ResourceRole).toString();
+
+        m_appData.remove(resource);
+        m_docData.remove(resource);
+    }
+}
+
+void RecentUsageModel::clearCache()
+{
+    m_appData.clear();
+    m_docData.clear();
+}
+
+void RecentUsageModel::checkSycocaChanges(const QStringList &changes)
+{
+    if (!changes.contains(QLatin1String("services")) && !changes.contains(QLatin1String("apps"))
+        && !changes.contains(QLatin1String("xdgdata-apps")) && !changes.contains(QLatin1String("xdgdata-mime"))) {
+        return;
+    }
+
+    clearCache();
+
+    if (rowCount()) {
+        emit dataChanged(index(0, 0), index(rowCount() - 1, 0));
+    }
+}
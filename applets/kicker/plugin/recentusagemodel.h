@@ -22,8 +22,14 @@
 
 #include "forwardingmodel.h"
 
+#include <QHash>
+#include <QIcon>
 #include <QQmlParserStatus>
 #include <QSortFilterProxyModel>
+#include <QUrl>
+
+#include <KFileItem>
+#include <KService>
 
 class GroupSortProxy : public QSortFilterProxyModel
 {
@@ -95,11 +101,37 @@ class RecentUsageModel : public ForwardingModel, public QQmlParserStatus
 
     private Q_SLOTS:
         void refresh() override;
+        void checkSycocaChanges(const QStringList &changes);
 
     private:
+        // what is shown for a resource, resolved on first use
+        struct AppData {
+            KService::Ptr service;
+            int nameFormat = -1;
+            QString name;
+            QIcon icon;
+            // the recent documents of the app change with every document
+            // it opens, so they are not cached
+            QVariantList jumpListActions;
+            bool hasJumpListActions = false;
+        };
+
+        struct DocData {
+            QUrl url;
+            KFileItem fileItem;
+            QIcon icon;
+            QVariantList actionList;
+            bool hasActionList = false;
+        };
+
         QVariant appData(const QString &resource, int role) const;
         QVariant docData(const QString &resource, int role) const;
 
+        AppData &cachedAppData(const QString &resource) const;
+        DocData &cachedDocData(const QString &resource) const;
+        void invalidateResources(int first, int last);
+        void clearCache();
+
         QString resourceAt(int row) const;
 
         QString forgetAllActionName() const;
@@ -110,6 +142,10 @@ class RecentUsageModel : public ForwardingModel, public QQmlParserStatus
         Ordering m_ordering;
 
         bool m_complete;
+
+        // keyed by resource, so rows moving around in the stats model keep them
+        mutable QHash<QString, AppData> m_appData;
+        mutable QHash<QString, DocData> m_docData;
 };
 
 #endif
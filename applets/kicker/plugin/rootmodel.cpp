@@ -25,6 +25,7 @@
 #include "systemmodel.h"
 
 #include <KLocalizedString>
+#include <KServiceGroup>
 
 #include <QCollator>
 
@@ -75,6 +76,8 @@ RootModel::RootModel(QObject *parent) : AppsModel(QString(), parent)
 , m_recentAppsModel(nullptr)
 , m_recentDocsModel(nullptr)
 , m_recentContactsModel(nullptr)
+, m_allAppsRow(-1)
+, m_appsOffset(0)
 {
 }
 
@@ -270,127 +273,197 @@ AbstractModel* RootModel::systemFavoritesModel()
     return nullptr;
 }
 
-void RootModel::refresh()
+void RootModel::updateEntries()
 {
     if (!m_complete) {
         return;
     }
 
-    beginResetModel();
+    // the pages come with their own favorites model, see createAllModel()
+    if (m_paginate || !KServiceGroup::root()) {
+        refresh();
+        return;
+    }
 
-    AppsModel::refreshInternal();
+    const int oldCount = m_entryList.count();
+    const int oldSeparatorCount = m_separatorCount;
 
-    AppsModel *allModel = nullptr;
-    m_recentAppsModel = nullptr;
-    m_recentDocsModel = nullptr;
-    m_recentContactsModel = nullptr;
+    // "All Applications" lists the apps of the categories, which may be
+    // deleted below, so it has to go first; it is derived again afterwards.
+    // Views may still hold the old models until they see the new entry,
+    // so those are deleted once control returns to the event loop.
+    GroupEntry *oldAllEntry = nullptr;
 
-    if (m_showAllApps) {
-        QHash<QString, AbstractEntry *> appsHash;
+    if (m_allAppsRow != -1) {
+        oldAllEntry = static_cast<GroupEntry *>(m_entryList.at(m_allAppsRow));
+        AbstractModel *allModel = oldAllEntry->childModel();
 
-        std::function<void(AbstractEntry *)> processEntry = [&](AbstractEntry *entry) {
-            if (entry->type() == AbstractEntry::RunnableType) {
-                AppEntry *appEntry = static_cast<AppEntry*>(entry);
-                appsHash.insert(appEntry->service()->menuId(), appEntry);
-            } else if (entry->type() == AbstractEntry::GroupType) {
-                GroupEntry *groupEntry = static_cast<GroupEntry*>(entry);
-                AbstractModel *model = groupEntry->childModel();
+        // the models of the letter groups belong to us, not to their entries
+        for (int i = 0; i < allModel->count(); ++i) {
+            const AbstractEntry *entry = static_cast<AbstractEntry *>(allModel->index(i, 0).internalPointer());
 
-                if (!model) {
-                    return;
-                }
+            if (entry->type() == AbstractEntry::GroupType) {
+                entry->childModel()->deleteLater();
+            }
+        }
 
-                for (int i = 0; i < model->count(); ++i) {
-                    processEntry(static_cast<AbstractEntry*>(model->index(i, 0).internalPointer()));
-                }
+        allModel->deleteLater();
+    }
+
+    // The recent models and the system model follow KSycoca on their own,
+    // only the application menu in between is updated.
+    const int powerSessionRows = m_showPowerSession ? 1 : 0;
+    const int separatorCount = updateEntryRange(m_appsOffset, m_entryList.count() - m_appsOffset - powerSessionRows, collectEntries());
+    const bool hasOwnSeparator = m_appsOffset > 0 && m_entryList.at(m_appsOffset - 1)->type() == AbstractEntry::SeparatorType;
+    m_separatorCount = separatorCount + (hasOwnSeparator ? 1 : 0);
+
+    if (oldAllEntry) {
+        AppsModel *allModel = createAllModel(m_entryList.mid(m_appsOffset, m_entryList.count() - m_appsOffset - powerSessionRows));
+        m_entryList[m_allAppsRow] = new GroupEntry(this, oldAllEntry->name(), QStringLiteral("applications-all"), allModel);
+        delete oldAllEntry;
+
+        const QModelIndex idx = index(m_allAppsRow, 0);
+        emit dataChanged(idx, idx);
+    }
+
+    m_favorites->refresh();
+
+    if (m_entryList.count() != oldCount) {
+        emit countChanged();
+    }
+
+    if (m_separatorCount != oldSeparatorCount) {
+        emit separatorCountChanged();
+    }
+}
+
+AppsModel *RootModel::createAllModel(const QList<AbstractEntry *> &entries)
+{
+    AppsModel *allModel = nullptr;
+
+    QHash<QString, AbstractEntry *> appsHash;
+
+    std::function<void(AbstractEntry *)> processEntry = [&](AbstractEntry *entry) {
+        if (entry->type() == AbstractEntry::RunnableType) {
+            AppEntry *appEntry = static_cast<AppEntry*>(entry);
+            appsHash.insert(appEntry->service()->menuId(), appEntry);
+        } else if (entry->type() == AbstractEntry::GroupType) {
+            GroupEntry *groupEntry = static_cast<GroupEntry*>(entry);
+            AbstractModel *model = groupEntry->childModel();
+
+            if (!model) {
+                return;
             }
-        };
 
-        for (AbstractEntry *entry : m_entryList) {
-            processEntry(entry);
+            for (int i = 0; i < model->count(); ++i) {
+                processEntry(static_cast<AbstractEntry*>(model->index(i, 0).internalPointer()));
+            }
         }
+    };
 
-        QList<AbstractEntry *> apps(appsHash.values());
-        QCollator c;
+    for (AbstractEntry *entry : entries) {
+        processEntry(entry);
+    }
 
-        std::sort(apps.begin(), apps.end(),
-            [&c](AbstractEntry* a, AbstractEntry* b) {
-                if (a->type() != b->type()) {
-                    return a->type() > b->type();
-                } else {
-                    return c.compare(a->name(), b->name()) < 0;
-                }
-            });
-
-        if (!m_showAllAppsCategorized && !m_paginate) { // The app list built above goes into a model.
-            allModel = new AppsModel(apps, false, this);
-        } else if (m_paginate) { // We turn the apps list into a subtree of pages.
-            m_favorites = new KAStatsFavoritesModel(this);
-            emit favoritesModelChanged();
-
-            QList<AbstractEntry *> groups;
-
-            int at = 0;
-            QList<AbstractEntry *> page;
-            page.reserve(m_pageSize);
-
-            foreach(AbstractEntry *app, apps) {
-                page.append(app);
-
-                if (at == (m_pageSize - 1)) {
-                    at = 0;
-                    AppsModel *model = new AppsModel(page, false, this);
-                    groups.append(new GroupEntry(this, QString(), QString(), model));
-                    page.clear();
-                } else {
-                    ++at;
-                }
+    QList<AbstractEntry *> apps(appsHash.values());
+    QCollator c;
+
+    std::sort(apps.begin(), apps.end(),
+        [&c](AbstractEntry* a, AbstractEntry* b) {
+            if (a->type() != b->type()) {
+                return a->type() > b->type();
+            } else {
+                return c.compare(a->name(), b->name()) < 0;
             }
+        });
+
+    if (!m_showAllAppsCategorized && !m_paginate) { // The app list built above goes into a model.
+        allModel = new AppsModel(apps, false, this);
+    } else if (m_paginate) { // We turn the apps list into a subtree of pages.
+        m_favorites = new KAStatsFavoritesModel(this);
+        emit favoritesModelChanged();
 
-            if (!page.isEmpty()) {
+        QList<AbstractEntry *> groups;
+
+        int at = 0;
+        QList<AbstractEntry *> page;
+        page.reserve(m_pageSize);
+
+        foreach(AbstractEntry *app, apps) {
+            page.append(app);
+
+            if (at == (m_pageSize - 1)) {
+                at = 0;
                 AppsModel *model = new AppsModel(page, false, this);
                 groups.append(new GroupEntry(this, QString(), QString(), model));
+                page.clear();
+            } else {
+                ++at;
             }
+        }
 
-            groups.prepend(new GroupEntry(this, QString(), QString(), m_favorites));
+        if (!page.isEmpty()) {
+            AppsModel *model = new AppsModel(page, false, this);
+            groups.append(new GroupEntry(this, QString(), QString(), model));
+        }
 
-            allModel = new AppsModel(groups, true, this);
-        } else { // We turn the apps list into a subtree of apps by starting letter.
-            QList<AbstractEntry *> groups;
-            QHash<QString, QList<AbstractEntry *>> m_categoryHash;
+        groups.prepend(new GroupEntry(this, QString(), QString(), m_favorites));
 
-            foreach (const AbstractEntry *groupEntry, m_entryList) {
-                AbstractModel *model = groupEntry->childModel();
+        allModel = new AppsModel(groups, true, this);
+    } else { // We turn the apps list into a subtree of apps by starting letter.
+        QList<AbstractEntry *> groups;
+        QHash<QString, QList<AbstractEntry *>> m_categoryHash;
 
-                if (!model) continue;
+        foreach (const AbstractEntry *groupEntry, entries) {
+            AbstractModel *model = groupEntry->childModel();
 
-                for (int i = 0; i < model->count(); ++i) {
-                    AbstractEntry *appEntry = static_cast<AbstractEntry *>(model->index(i, 0).internalPointer());
+            if (!model) continue;
 
-                    if (appEntry->name().isEmpty()) {
-                        continue;
-                    }
+            for (int i = 0; i < model->count(); ++i) {
+                AbstractEntry *appEntry = static_cast<AbstractEntry *>(model->index(i, 0).internalPointer());
 
-                    const QChar &first = appEntry->name().at(0).toUpper();
-                    m_categoryHash[first.isDigit() ? QStringLiteral("0-9") : first].append(appEntry);
+                if (appEntry->name().isEmpty()) {
+                    continue;
                 }
-            }
 
-            QHashIterator<QString, QList<AbstractEntry *>> i(m_categoryHash);
-
-            while (i.hasNext()) {
-                i.next();
-                AppsModel *model = new AppsModel(i.value(), false, this);
-                model->setDescription(i.key());
-                groups.append(new GroupEntry(this, i.key(), QString(), model));
+                const QChar &first = appEntry->name().at(0).toUpper();
+                m_categoryHash[first.isDigit() ? QStringLiteral("0-9") : first].append(appEntry);
             }
+        }
 
-            allModel = new AppsModel(groups, true, this);
+        QHashIterator<QString, QList<AbstractEntry *>> i(m_categoryHash);
+
+        while (i.hasNext()) {
+            i.next();
+            AppsModel *model = new AppsModel(i.value(), false, this);
+            model->setDescription(i.key());
+            groups.append(new GroupEntry(this, i.key(), QString(), model));
         }
 
-        allModel->setDescription(QStringLiteral("KICKER_ALL_MODEL")); // Intentionally no i18n.
+        allModel = new AppsModel(groups, true, this);
     }
 
+    allModel->setDescription(QStringLiteral("KICKER_ALL_MODEL")); // Intentionally no i18n.
+
+    return allModel;
+}
+
+void RootModel::refresh()
+{
+    if (!m_complete) {
+        return;
+    }
+
+    beginResetModel();
+
+    AppsModel::refreshInternal();
+
+    m_recentAppsModel = nullptr;
+    m_recentDocsModel = nullptr;
+    m_recentContactsModel = nullptr;
+
+    AppsModel *allModel = m_showAllApps ? createAllModel(m_entryList) : nullptr;
+
     int separatorPosition = 0;
 
     if (allModel) {
@@ -430,9 +503,14 @@ void RootModel::refresh()
         ++separatorPosition;
     }
 
+    // "All Applications" comes right before the separator
+    m_allAppsRow = allModel ? separatorPosition - 1 : -1;
+    m_appsOffset = separatorPosition;
+
     if (m_showSeparators && separatorPosition > 0) {
         m_entryList.insert(separatorPosition, new SeparatorEntry(this));
         ++m_separatorCount;
+        ++m_appsOffset;
     }
 
     m_systemModel = new SystemModel(this);
@@ -107,7 +107,19 @@ class RootModel : public AppsModel
     protected Q_SLOTS:
         void refresh() override;
 
+        /**
+         * Updates the application menu in place like AppsModel does and
+         * derives "All Applications" from it again.
+         */
+        void updateEntries() override;
+
     private:
+        /**
+         * Builds the "All Applications" model from the apps in @p entries and
+         * their child models, which it doesn't take ownership of.
+         */
+        AppsModel *createAllModel(const QList<AbstractEntry *> &entries);
+
         KAStatsFavoritesModel *m_favorites;
         SystemModel *m_systemModel;
 
@@ -122,6 +134,12 @@ class RootModel : public AppsModel
         RecentUsageModel *m_recentAppsModel;
         RecentUsageModel *m_recentDocsModel;
         RecentContactsModel *m_recentContactsModel;
+
+        // -1 without "All Applications"
+        int m_allAppsRow;
+        // the first row of the application menu, after the recent models
+        // and "All Applications"
+        int m_appsOffset;
 };
 
 #endif
@@ -0,0 +1,169 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "runnermatchcache.h"
+
+#include <algorithm>
+
+#include <KRunner/AbstractRunner>
+
+static QStringList sortedIds(const QList<Plasma::QueryMatch> &matches)
+{
+    QStringList ids;
+    ids.reserve(matches.count());
+
+    foreach (const Plasma::QueryMatch &match, matches) {
+        ids << match.id();
+    }
+
+    std::sort(ids.begin(), ids.end());
+
+    return ids;
+}
+
+RunnerMatchCache::RunnerMatchCache(int maxQueries)
+    : m_cache(maxQueries)
+{
+}
+
+RunnerMatchCache::~RunnerMatchCache()
+{
+}
+
+QSet<QString> RunnerMatchCache::cacheableRunners() const
+{
+    return m_cacheableRunners;
+}
+
+void RunnerMatchCache::setCacheableRunners(const QSet<QString> &runnerIds)
+{
+    if (m_cacheableRunners != runnerIds) {
+        m_cacheableRunners = runnerIds;
+        m_cache.clear();
+    }
+}
+
+QSet<QString> RunnerMatchCache::refinableRunners() const
+{
+    return m_refinableRunners;
+}
+
+void RunnerMatchCache::setRefinableRunners(const QSet<QString> &runnerIds)
+{
+    m_refinableRunners = runnerIds;
+}
+
+void RunnerMatchCache::insert(const QString &term, const QList<Plasma::QueryMatch> &matches)
+{
+    if (term.isEmpty()) {
+        return;
+    }
+
+    MatchesForRunner matchesForRunner;
+    foreach (const Plasma::QueryMatch &match, matches) {
+        matchesForRunner[match.runner()->id()].append(match);
+    }
+
+    // A cacheable runner without matches is cached as well, it has none for this query.
+    const MatchesForRunner *previous = m_cache.object(term);
+    MatchesForRunner *cached = new MatchesForRunner;
+
+    foreach (const QString &runnerId, m_cacheableRunners) {
+        const QList<Plasma::QueryMatch> runnerMatches = matchesForRunner.value(runnerId);
+
+        if (previous && previous->contains(runnerId)
+            && sortedIds(previous->value(runnerId)) != sortedIds(runnerMatches)) {
+            invalidate(runnerId);
+            previous = m_cache.object(term);
+        }
+
+        cached->insert(runnerId, runnerMatches);
+    }
+
+    m_cache.insert(term, cached);
+
+    m_lastTerm = term;
+    m_lastMatches = matchesForRunner;
+}
+
+QList<Plasma::QueryMatch> RunnerMatchCache::interimMatches(const QString &term,
+    const QSet<QString> &reportedRunners) const
+{
+    QList<Plasma::QueryMatch> matches;
+
+    if (term.isEmpty()) {
+        return matches;
+    }
+
+    // Cacheable runners give the same matches as before.
+    QSet<QString> knownRunners = reportedRunners;
+    if (const MatchesForRunner *cached = m_cache.object(term)) {
+        for (auto it = cached->constBegin(); it != cached->constEnd(); ++it) {
+            if (!knownRunners.contains(it.key())) {
+                matches.append(it.value());
+                knownRunners.insert(it.key());
+            }
+        }
+    }
+
+    // Refinable runners narrow down their matches for the last query soon.
+    // Until then, keep those which still show the extended term rather than
+    // dropping the runner's results; matches on e.g. keywords come back when
+    // the runner reports.
+    if (!m_lastTerm.isEmpty() && term.startsWith(m_lastTerm, Qt::CaseInsensitive)) {
+        for (auto it = m_lastMatches.constBegin(); it != m_lastMatches.constEnd(); ++it) {
+            if (knownRunners.contains(it.key()) || !m_refinableRunners.contains(it.key())) {
+                continue;
+            }
+
+            foreach (const Plasma::QueryMatch &match, it.value()) {
+                if (match.text().contains(term, Qt::CaseInsensitive)
+                    || match.subtext().contains(term, Qt::CaseInsensitive)) {
+                    matches.append(match);
+                }
+            }
+        }
+    }
+
+    return matches;
+}
+
+bool RunnerMatchCache::contains(const QString &term) const
+{
+    return m_cache.contains(term);
+}
+
+void RunnerMatchCache::invalidate(const QString &runnerId)
+{
+    foreach (const QString &term, m_cache.keys()) {
+        MatchesForRunner *cached = m_cache.object(term);
+        cached->remove(runnerId);
+
+        if (cached->isEmpty()) {
+            m_cache.remove(term);
+        }
+    }
+
+    m_lastMatches.remove(runnerId);
+}
+
+void RunnerMatchCache::clear()
+{
+    m_cache.clear();
+    m_lastTerm.clear();
+    m_lastMatches.clear();
+}
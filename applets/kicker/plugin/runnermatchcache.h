@@ -0,0 +1,69 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#ifndef RUNNERMATCHCACHE_H
+#define RUNNERMATCHCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QSet>
+
+#include <KRunner/QueryMatch>
+
+// Remembers what runners matched for the queries of a session, to show
+// something for a query before the runners report their fresh matches.
+class RunnerMatchCache
+{
+    public:
+        typedef QHash<QString, QList<Plasma::QueryMatch> > MatchesForRunner;
+
+        explicit RunnerMatchCache(int maxQueries = 50);
+        ~RunnerMatchCache();
+
+        // runners giving the same matches for a query while their data does not change
+        QSet<QString> cacheableRunners() const;
+        void setCacheableRunners(const QSet<QString> &runnerIds);
+
+        // runners narrowing down the matches of a query when it is extended
+        QSet<QString> refinableRunners() const;
+        void setRefinableRunners(const QSet<QString> &runnerIds);
+
+        // Stores the complete results of a query. A cacheable runner which
+        // reports other matches than cached for the query before has changed
+        // its data, its matches for other queries are dropped.
+        void insert(const QString &term, const QList<Plasma::QueryMatch> &matches);
+
+        // What is known about term, for the runners not in reportedRunners.
+        QList<Plasma::QueryMatch> interimMatches(const QString &term,
+            const QSet<QString> &reportedRunners) const;
+
+        bool contains(const QString &term) const;
+
+        void invalidate(const QString &runnerId);
+        void clear();
+
+    private:
+        QSet<QString> m_cacheableRunners;
+        QSet<QString> m_refinableRunners;
+
+        QCache<QString, MatchesForRunner> m_cache;
+        // complete results of the last query, used for refinable runners
+        QString m_lastTerm;
+        MatchesForRunner m_lastMatches;
+};
+
+#endif
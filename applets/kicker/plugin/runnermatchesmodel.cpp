@@ -212,42 +212,107 @@ bool RunnerMatchesModel::trigger(int row, const QString &actionId, const QVarian
     return true;
 }
 
+static QString matchKey(const Plasma::QueryMatch &match)
+{
+    // runners only keep their own match ids apart
+    return match.runner()->id() + QLatin1Char('\n') + match.id();
+}
+
+static bool showsSameData(const Plasma::QueryMatch &a, const Plasma::QueryMatch &b)
+{
+    return a.text() == b.text()
+        && a.subtext() == b.subtext()
+        && a.iconName() == b.iconName()
+        && a.icon().cacheKey() == b.icon().cacheKey()
+        && a.data() == b.data();
+}
+
 void RunnerMatchesModel::setMatches(const QList< Plasma::QueryMatch > &matches)
 {
-    int oldCount = m_matches.count();
-    int newCount = matches.count();
+    const int oldCount = m_matches.count();
 
-    bool emitCountChange = (oldCount != newCount);
+    QStringList keys;
+    keys.reserve(m_matches.count());
+    foreach (const Plasma::QueryMatch &match, m_matches) {
+        keys << matchKey(match);
+    }
+
+    QStringList newKeys;
+    newKeys.reserve(matches.count());
+    QHash<QString, int> newKeyCounts;
+    foreach (const Plasma::QueryMatch &match, matches) {
+        const QString key = matchKey(match);
+        newKeys << key;
+        ++newKeyCounts[key];
+    }
 
-    int ceiling = qMin(oldCount, newCount);
-    bool emitDataChange = false;
+    // Remove the matches which are gone, in ranges of adjacent rows.
+    QVector<bool> keep(keys.count());
+    for (int row = 0; row < keys.count(); ++row) {
+        int &count = newKeyCounts[keys.at(row)];
+        keep[row] = (count > 0);
 
-    for (int row = 0; row < ceiling; ++row) {
-        if (!(m_matches.at(row) == matches.at(row))) {
-            emitDataChange = true;
-            m_matches[row] = matches.at(row);
+        if (count > 0) {
+            --count;
         }
     }
 
-    if (emitDataChange) {
-        emit dataChanged(index(0, 0), index(ceiling - 1, 0));
+    for (int last = keys.count() - 1; last >= 0; --last) {
+        if (keep.at(last)) {
+            continue;
+        }
+
+        int first = last;
+        while (first > 0 && !keep.at(first - 1)) {
+            --first;
+        }
+
+        beginRemoveRows(QModelIndex(), first, last);
+        m_matches.erase(m_matches.begin() + first, m_matches.begin() + last + 1);
+        keys.erase(keys.begin() + first, keys.begin() + last + 1);
+        endRemoveRows();
+
+        last = first;
     }
 
-    if (newCount > oldCount) {
-        beginInsertRows(QModelIndex(), oldCount, newCount - 1);
+    // Everything left is also in the new list, so going through it in order
+    // only moves up matches which stay and inserts new ones.
+    for (int row = 0; row < matches.count(); ++row) {
+        const Plasma::QueryMatch &match = matches.at(row);
+        const QString &key = newKeys.at(row);
 
-        m_matches = matches;
+        const int from = (row < keys.count() && keys.at(row) == key) ? row : keys.indexOf(key, row);
 
-        endInsertRows();
-    } else if (newCount < oldCount) {
-        beginRemoveRows(QModelIndex(), newCount, oldCount - 1);
+        if (from == -1) {
+            beginInsertRows(QModelIndex(), row, row);
+            m_matches.insert(row, match);
+            keys.insert(row, key);
+            endInsertRows();
 
-        m_matches = matches;
+            continue;
+        }
 
-        endRemoveRows();
+        if (from != row) {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+            m_matches.move(from, row);
+            keys.move(from, row);
+            endMoveRows();
+        }
+
+        const bool changed = !showsSameData(m_matches.at(row), match);
+
+        // the new match is kept either way, it is the one the runner can run
+        m_matches[row] = match;
+
+        if (changed) {
+            const QModelIndex idx = index(row, 0);
+            emit dataChanged(idx, idx);
+        }
     }
 
-    if (emitCountChange) {
+    Q_ASSERT(m_matches.count() == matches.count());
+
+    if (m_matches.count() != oldCount) {
         emit countChanged();
     }
 }
@@ -26,17 +26,32 @@
 #include <KLocalizedString>
 #include <KRunner/AbstractRunner>
 #include <KRunner/RunnerManager>
+#include <KSycoca>
+
+// Runners declare in their metadata that the same query always gives the same
+// matches during a session, or that they narrow down the matches of a query
+// quickly when it is extended.
+static const QString s_cacheableProperty = QStringLiteral("X-Plasma-Runner-Cacheable");
+static const QString s_refinableProperty = QStringLiteral("X-Plasma-Runner-Refinable");
 
 RunnerModel::RunnerModel(QObject *parent) : QAbstractListModel(parent)
 , m_favoritesModel(nullptr)
 , m_appletInterface(nullptr)
 , m_runnerManager(nullptr)
+, m_showingInterimMatches(false)
 , m_mergeResults(false)
 , m_deleteWhenEmpty(false)
 {
     m_queryTimer.setSingleShot(true);
     m_queryTimer.setInterval(10);
     connect(&m_queryTimer, &QTimer::timeout, this, &RunnerModel::startQuery);
+
+    // The services runner matches what sycoca knows about. Other runners
+    // have no change signal, the cache notices when their results change.
+    connect(KSycoca::self(), static_cast<void (KSycoca::*)(const QStringList &)>(&KSycoca::databaseChanged),
+            this, [this] () {
+                m_matchCache.invalidate(QStringLiteral("services"));
+            });
 }
 
 RunnerModel::~RunnerModel()
@@ -174,6 +189,8 @@ void RunnerModel::setRunners(const QStringList &runners)
             m_runnerManager->setAllowedRunners(runners);
         }
 
+        m_matchCache.clear();
+
         emit runnersChanged();
     }
 }
@@ -206,10 +223,74 @@ void RunnerModel::startQuery()
 
     createManager();
 
+    // The order of a runner's matches is only kept while the results of
+    // one query come in. Every new query sorts them by relevance again,
+    // also one refining the last query by typing on, as the relevance of
+    // the matches changes with the query.
+    m_managerMatches.clear();
+    m_matchOrder.clear();
     m_runnerManager->launchQuery(m_query);
+
+    // Show right away what is known about the query already, e.g. after
+    // backspacing, instead of waiting for the runners to report.
+    const QList<Plasma::QueryMatch> interim = interimMatches(QSet<QString>());
+    if (!interim.isEmpty()) {
+        m_showingInterimMatches = true;
+        showMatches(interim);
+    }
 }
 
 void RunnerModel::matchesChanged(const QList<Plasma::QueryMatch> &matches)
+{
+    m_managerMatches = matches;
+
+    QSet<QString> reportedRunners;
+    foreach (const Plasma::QueryMatch &match, matches) {
+        reportedRunners.insert(match.runner()->id());
+    }
+
+    const QList<Plasma::QueryMatch> interim = interimMatches(reportedRunners);
+    m_showingInterimMatches = !interim.isEmpty();
+    showMatches(interim.isEmpty() ? matches : matches + interim);
+}
+
+void RunnerModel::queryFinished()
+{
+    const QString term = m_query.trimmed();
+    if (!m_runnerManager || term.isEmpty() || m_runnerManager->query() != term) {
+        return;
+    }
+
+    m_matchCache.setCacheableRunners(runnersWithProperty(s_cacheableProperty));
+    m_matchCache.setRefinableRunners(runnersWithProperty(s_refinableProperty));
+    m_matchCache.insert(term, m_managerMatches);
+
+    // Runners which did not report anymore have no matches now.
+    if (m_showingInterimMatches) {
+        m_showingInterimMatches = false;
+        showMatches(m_managerMatches);
+    }
+}
+
+QList<Plasma::QueryMatch> RunnerModel::interimMatches(const QSet<QString> &reportedRunners) const
+{
+    return m_matchCache.interimMatches(m_query.trimmed(), reportedRunners);
+}
+
+QSet<QString> RunnerModel::runnersWithProperty(const QString &property) const
+{
+    QSet<QString> runnerIds;
+
+    foreach (Plasma::AbstractRunner *runner, m_runnerManager->runners()) {
+        if (runner->metadata().property(property).toBool()) {
+            runnerIds.insert(runner->id());
+        }
+    }
+
+    return runnerIds;
+}
+
+void RunnerModel::showMatches(const QList<Plasma::QueryMatch> &matches)
 {
     // Group matches by runner.
     // We do not use a QMultiHash here because it keeps values in LIFO order, while we want FIFO.
@@ -226,11 +307,52 @@ void RunnerModel::matchesChanged(const QList<Plasma::QueryMatch> &matches)
     }
 
     // Sort matches for all runners in descending order. This allows the best
-    // match to win whilest preserving order between runners.
-    for (auto &list : matchesForRunner) {
-        std::sort(list.begin(), list.end(), qGreater<Plasma::QueryMatch>());
+    // match to win whilest preserving order between runners. Runners which
+    // still report the same matches keep their order, so they do not jump
+    // around while more results come in.
+    QHash<QString, QStringList> matchOrder;
+
+    for (auto it = matchesForRunner.begin(); it != matchesForRunner.end(); ++it) {
+        QList<Plasma::QueryMatch> &list = it.value();
+
+        QStringList ids;
+        ids.reserve(list.count());
+        foreach (const Plasma::QueryMatch &match, list) {
+            ids << match.id();
+        }
+
+        QStringList previousOrder = m_matchOrder.value(it.key());
+        QStringList sortedIds = ids;
+        std::sort(previousOrder.begin(), previousOrder.end());
+        std::sort(sortedIds.begin(), sortedIds.end());
+
+        if (!previousOrder.isEmpty() && previousOrder == sortedIds) {
+            QHash<QString, int> positions;
+            const QStringList &order = m_matchOrder.value(it.key());
+            for (int i = order.count() - 1; i >= 0; --i) {
+                positions.insert(order.at(i), i);
+            }
+
+            std::stable_sort(list.begin(), list.end(),
+                [&positions](const Plasma::QueryMatch &a, const Plasma::QueryMatch &b) {
+                    return positions.value(a.id()) < positions.value(b.id());
+                });
+
+            matchOrder.insert(it.key(), order);
+        } else {
+            std::sort(list.begin(), list.end(), qGreater<Plasma::QueryMatch>());
+
+            ids.clear();
+            foreach (const Plasma::QueryMatch &match, list) {
+                ids << match.id();
+            }
+
+            matchOrder.insert(it.key(), ids);
+        }
     }
 
+    m_matchOrder = matchOrder;
+
     if (m_mergeResults) {
         RunnerMatchesModel *matchesModel = nullptr;
 
@@ -313,6 +435,8 @@ void RunnerModel::createManager()
         m_runnerManager->setAllowedRunners(m_runners);
         connect(m_runnerManager, &Plasma::RunnerManager::matchesChanged,
                 this, &RunnerModel::matchesChanged);
+        connect(m_runnerManager, &Plasma::RunnerManager::queryFinished,
+                this, &RunnerModel::queryFinished);
     }
 }
 
@@ -322,6 +446,12 @@ void RunnerModel::clear()
         m_runnerManager->reset();
     }
 
+    // the session ends, the runners may have changed by the next one
+    m_managerMatches.clear();
+    m_showingInterimMatches = false;
+    m_matchCache.clear();
+    m_matchOrder.clear();
+
     if (m_models.isEmpty()) {
         return;
     }
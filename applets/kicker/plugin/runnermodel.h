@@ -22,6 +22,7 @@
 #define RUNNERMODEL_H
 
 #include "abstractmodel.h"
+#include "runnermatchcache.h"
 
 #include <QAbstractListModel>
 #include <QTimer>
@@ -89,10 +90,14 @@ class RunnerModel : public QAbstractListModel
     private Q_SLOTS:
         void startQuery();
         void matchesChanged(const QList<Plasma::QueryMatch> &matches);
+        void queryFinished();
 
     private:
         void createManager();
         void clear();
+        void showMatches(const QList<Plasma::QueryMatch> &matches);
+        QList<Plasma::QueryMatch> interimMatches(const QSet<QString> &reportedRunners) const;
+        QSet<QString> runnersWithProperty(const QString &property) const;
 
         AbstractModel *m_favoritesModel;
         QObject *m_appletInterface;
@@ -101,6 +106,16 @@ class RunnerModel : public QAbstractListModel
         QList<RunnerMatchesModel *> m_models;
         QString m_query;
         QTimer m_queryTimer;
+
+        // what the runner manager reported for m_query so far
+        QList<Plasma::QueryMatch> m_managerMatches;
+        bool m_showingInterimMatches;
+        // complete results of the queries of the current session
+        RunnerMatchCache m_matchCache;
+        // ids of the matches shown for each runner, in the order they are shown;
+        // only kept for the results of one query, cleared by startQuery()
+        QHash<QString, QStringList> m_matchOrder;
+
         bool m_mergeResults;
         bool m_deleteWhenEmpty;
 };
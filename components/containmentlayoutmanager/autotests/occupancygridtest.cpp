@@ -0,0 +1,274 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Library General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <QObject>
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "../occupancygrid.h"
+
+typedef QPair<int, int> Cell;
+
+class OccupancyGridTest : public QObject
+{
+Q_OBJECT
+
+private Q_SLOTS:
+    void testReset();
+    void testSetTaken();
+    void testResize();
+    void testNextCellInState();
+    void testNextCellInStateMatchesWalk();
+
+    void benchmarkPlacement();
+
+private:
+    // What nextCellInState() finds, going cell by cell
+    static Cell walk(const OccupancyGrid &grid, Cell cell, AppletsLayout::PreferredLayoutDirection direction, bool taken);
+    // Takes the first space of the size found going from left to right, as the GridLayoutManager does
+    static bool place(OccupancyGrid &grid, const QSize &size);
+};
+
+Cell OccupancyGridTest::walk(const OccupancyGrid &grid, Cell cell, AppletsLayout::PreferredLayoutDirection direction, bool taken)
+{
+    const bool horizontal = direction != AppletsLayout::TopToBottom && direction != AppletsLayout::BottomToTop;
+    const int step = (direction == AppletsLayout::RightToLeft || direction == AppletsLayout::BottomToTop) ? -1 : 1;
+
+    while (true) {
+        int &position = horizontal ? cell.second : cell.first;
+        int &line = horizontal ? cell.first : cell.second;
+        const int lineLength = horizontal ? grid.columns() : grid.rows();
+        const int lineCount = horizontal ? grid.rows() : grid.columns();
+
+        position += step;
+        if (position < 0 || position >= lineLength) {
+            line += step;
+            position = step > 0 ? 0 : lineLength - 1;
+        }
+        if (line < 0 || line >= lineCount) {
+            return Cell(-1, -1);
+        }
+        if (grid.isTaken(cell.first, cell.second) == taken) {
+            return cell;
+        }
+    }
+}
+
+bool OccupancyGridTest::place(OccupancyGrid &grid, const QSize &size)
+{
+    Cell cell(0, 0);
+    if (grid.isTaken(0, 0)) {
+        cell = grid.nextCellInState(cell, AppletsLayout::LeftToRight, false);
+    }
+
+    while (cell.first != -1) {
+        const QRect cells(cell.second, cell.first, size.width(), size.height());
+        if (grid.isFree(cells)) {
+            grid.setTaken(cells, true);
+            return true;
+        }
+
+        cell = grid.nextCellInState(grid.nextCellInState(cell, AppletsLayout::LeftToRight, true),
+                                    AppletsLayout::LeftToRight, false);
+    }
+
+    return false;
+}
+
+void OccupancyGridTest::testReset()
+{
+    OccupancyGrid grid;
+    QCOMPARE(grid.rows(), 0);
+    QCOMPARE(grid.columns(), 0);
+    QVERIFY(!grid.isTaken(0, 0));
+    QVERIFY(!grid.isFree(QRect(0, 0, 1, 1)));
+
+    // 3 rows of 4 columns, the middle two cells of the second row taken
+    grid.reset(3, 4, {QRect(1, 1, 2, 1)});
+    QCOMPARE(grid.rows(), 3);
+    QCOMPARE(grid.columns(), 4);
+
+    QVERIFY(!grid.isTaken(1, 0));
+    QVERIFY(grid.isTaken(1, 1));
+    QVERIFY(grid.isTaken(1, 2));
+    QVERIFY(!grid.isTaken(1, 3));
+
+    QVERIFY(grid.isFree(QRect(0, 0, 4, 1)));
+    QVERIFY(grid.isFree(QRect(3, 0, 1, 3)));
+    QVERIFY(!grid.isFree(QRect(0, 0, 2, 2)));
+    QVERIFY(!grid.isFree(QRect(2, 1, 1, 1)));
+    // partly outside of the grid
+    QVERIFY(!grid.isFree(QRect(3, 0, 2, 1)));
+    QVERIFY(grid.isFree(QRect()));
+
+    QCOMPARE(grid.run(0, 0, AppletsLayout::LeftToRight), 4);
+    QCOMPARE(grid.run(1, 0, AppletsLayout::LeftToRight), 1);
+    QCOMPARE(grid.run(1, 1, AppletsLayout::LeftToRight), 2);
+    QCOMPARE(grid.run(1, 3, AppletsLayout::RightToLeft), 1);
+    QCOMPARE(grid.run(1, 2, AppletsLayout::RightToLeft), 2);
+    QCOMPARE(grid.run(0, 0, AppletsLayout::TopToBottom), 3);
+    QCOMPARE(grid.run(0, 1, AppletsLayout::TopToBottom), 1);
+    QCOMPARE(grid.run(2, 1, AppletsLayout::BottomToTop), 1);
+    QCOMPARE(grid.run(1, 1, AppletsLayout::BottomToTop), 1);
+    QCOMPARE(grid.run(3, 0, AppletsLayout::LeftToRight), 0);
+}
+
+void OccupancyGridTest::testSetTaken()
+{
+    OccupancyGrid grid;
+    grid.reset(5, 5);
+
+    // a ring around the center cell
+    grid.setTaken(QRect(1, 1, 3, 3), true);
+    grid.setTaken(QRect(2, 2, 1, 1), false);
+
+    QVERIFY(grid.isTaken(1, 1));
+    QVERIFY(!grid.isTaken(2, 2));
+    QVERIFY(grid.isFree(QRect(2, 2, 1, 1)));
+    QVERIFY(!grid.isFree(QRect(2, 2, 2, 1)));
+
+    QCOMPARE(grid.run(1, 1, AppletsLayout::LeftToRight), 3);
+    QCOMPARE(grid.run(1, 3, AppletsLayout::RightToLeft), 3);
+    QCOMPARE(grid.run(2, 1, AppletsLayout::LeftToRight), 1);
+    QCOMPARE(grid.run(2, 0, AppletsLayout::LeftToRight), 1);
+    for (AppletsLayout::PreferredLayoutDirection direction : {AppletsLayout::LeftToRight, AppletsLayout::RightToLeft,
+                                                              AppletsLayout::TopToBottom, AppletsLayout::BottomToTop}) {
+        QCOMPARE(grid.run(2, 2, direction), 1);
+    }
+    QCOMPARE(grid.run(0, 2, AppletsLayout::TopToBottom), 1);
+    QCOMPARE(grid.run(4, 2, AppletsLayout::BottomToTop), 1);
+    QCOMPARE(grid.run(0, 0, AppletsLayout::TopToBottom), 5);
+
+    // the cells outside of the grid are ignored
+    grid.setTaken(QRect(3, 3, 10, 10), true);
+    QVERIFY(grid.isTaken(4, 4));
+    QVERIFY(!grid.isTaken(5, 5));
+    QCOMPARE(grid.run(4, 4, AppletsLayout::RightToLeft), 2);
+    QCOMPARE(grid.run(3, 4, AppletsLayout::TopToBottom), 2);
+
+    // freeing everything again
+    grid.setTaken(QRect(0, 0, 5, 5), false);
+    QVERIFY(grid.isFree(QRect(0, 0, 5, 5)));
+    QCOMPARE(grid.run(2, 2, AppletsLayout::LeftToRight), 3);
+    QCOMPARE(grid.run(2, 2, AppletsLayout::BottomToTop), 3);
+}
+
+void OccupancyGridTest::testResize()
+{
+    // what the layout does when it changes size: the items keep their cells
+    const QVector<QRect> items({QRect(0, 0, 1, 1), QRect(1, 1, 5, 5)});
+
+    OccupancyGrid grid;
+    grid.reset(2, 2, items);
+    QVERIFY(grid.isTaken(0, 0));
+    QVERIFY(grid.isTaken(1, 1));
+    QVERIFY(!grid.isTaken(0, 1));
+    QCOMPARE(grid.run(1, 1, AppletsLayout::LeftToRight), 1);
+
+    grid.reset(6, 8, items);
+    QCOMPARE(grid.rows(), 6);
+    QCOMPARE(grid.columns(), 8);
+    QVERIFY(grid.isTaken(5, 5));
+    QVERIFY(!grid.isTaken(5, 6));
+    QCOMPARE(grid.run(1, 1, AppletsLayout::LeftToRight), 5);
+    QCOMPARE(grid.run(1, 6, AppletsLayout::LeftToRight), 2);
+    QCOMPARE(grid.run(1, 1, AppletsLayout::TopToBottom), 5);
+    QVERIFY(grid.isFree(QRect(6, 0, 2, 6)));
+
+    // nothing to lay out on
+    grid.reset(0, 8, items);
+    QCOMPARE(grid.rows(), 0);
+    QCOMPARE(grid.columns(), 0);
+    QVERIFY(!grid.isTaken(0, 0));
+}
+
+void OccupancyGridTest::testNextCellInState()
+{
+    OccupancyGrid grid;
+    // the middle two cells of the first row taken
+    grid.reset(3, 4, {QRect(1, 0, 2, 1)});
+
+    QCOMPARE(grid.nextCellInState(Cell(0, 0), AppletsLayout::LeftToRight, false), Cell(0, 3));
+    QCOMPARE(grid.nextCellInState(Cell(0, 0), AppletsLayout::LeftToRight, true), Cell(0, 1));
+    // wrapping to the next row
+    QCOMPARE(grid.nextCellInState(Cell(0, 3), AppletsLayout::LeftToRight, false), Cell(1, 0));
+    QCOMPARE(grid.nextCellInState(Cell(0, 3), AppletsLayout::RightToLeft, false), Cell(0, 0));
+    QCOMPARE(grid.nextCellInState(Cell(1, 0), AppletsLayout::RightToLeft, true), Cell(0, 2));
+    QCOMPARE(grid.nextCellInState(Cell(0, 1), AppletsLayout::TopToBottom, false), Cell(1, 1));
+    QCOMPARE(grid.nextCellInState(Cell(2, 1), AppletsLayout::BottomToTop, true), Cell(0, 1));
+    // wrapping to the next column
+    QCOMPARE(grid.nextCellInState(Cell(2, 0), AppletsLayout::TopToBottom, true), Cell(0, 1));
+
+    // nothing left in that direction
+    QCOMPARE(grid.nextCellInState(Cell(2, 3), AppletsLayout::LeftToRight, false), Cell(-1, -1));
+    QCOMPARE(grid.nextCellInState(Cell(1, 0), AppletsLayout::LeftToRight, true), Cell(-1, -1));
+    QCOMPARE(grid.nextCellInState(Cell(3, 0), AppletsLayout::LeftToRight, false), Cell(-1, -1));
+    QCOMPARE(grid.nextCellInState(Cell(-1, -1), AppletsLayout::LeftToRight, false), Cell(-1, -1));
+}
+
+void OccupancyGridTest::testNextCellInStateMatchesWalk()
+{
+    QRandomGenerator random(42);
+
+    OccupancyGrid grid;
+    grid.reset(20, 30);
+
+    for (int i = 0; i < 40; ++i) {
+        grid.setTaken(QRect(random.bounded(30), random.bounded(20), random.bounded(1, 8), random.bounded(1, 6)), true);
+
+        for (int j = 0; j < 10; ++j) {
+            const Cell cell(random.bounded(20), random.bounded(30));
+
+            for (AppletsLayout::PreferredLayoutDirection direction : {AppletsLayout::LeftToRight, AppletsLayout::RightToLeft,
+                                                                      AppletsLayout::TopToBottom, AppletsLayout::BottomToTop}) {
+                QCOMPARE(grid.nextCellInState(cell, direction, false), walk(grid, cell, direction, false));
+                QCOMPARE(grid.nextCellInState(cell, direction, true), walk(grid, cell, direction, true));
+            }
+        }
+    }
+}
+
+void OccupancyGridTest::benchmarkPlacement()
+{
+    // a 3840x2160 screen in cells of 8 pixels
+    const int rows = 2160 / 8;
+    const int columns = 3840 / 8;
+    const QVector<QSize> sizes({QSize(24, 16), QSize(40, 30), QSize(12, 12), QSize(30, 50), QSize(16, 8)});
+
+    OccupancyGrid grid;
+    int placed = 0;
+
+    // filling the screen with widgets, each one placed at the first space large enough
+    QBENCHMARK {
+        grid.reset(rows, columns);
+        placed = 0;
+
+        for (int i = 0; i < 500; ++i) {
+            if (place(grid, sizes.at(i % sizes.count()))) {
+                ++placed;
+            }
+        }
+    }
+
+    QVERIFY(placed > 0);
+    QVERIFY(!grid.isFree(QRect(0, 0, columns, rows)));
+}
+
+QTEST_MAIN(OccupancyGridTest)
+
+#include "occupancygridtest.moc"
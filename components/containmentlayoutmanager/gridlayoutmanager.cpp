@@ -73,7 +73,7 @@ void GridLayoutManager::parseLayout(const QString &savedLayout)
 
 bool GridLayoutManager::itemIsManaged(ItemContainer *item)
 {
-    return m_pointsForItem.contains(item);
+    return m_cellsForItem.contains(item);
 }
 
 inline void maintainItemEdgeAlignment(ItemContainer *item, const QRectF &newRect, const QRectF &oldRect)
@@ -108,8 +108,8 @@ inline void maintainItemEdgeAlignment(ItemContainer *item, const QRectF &newRect
 
 void GridLayoutManager::layoutGeometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
 {
-    m_grid.clear();
-    m_pointsForItem.clear();
+    m_cellsForItem.clear();
+    m_grid.reset(rows(), columns());
     for (auto *item : layout()->childItems()) {
         // Stash the old config
         //m_parsedConfig[item->key()] = {item->x(), item->y(), item->width(), item->height(), item->rotation()};
@@ -126,8 +126,8 @@ void GridLayoutManager::layoutGeometryChanged(const QRectF &newGeometry, const Q
 
 void GridLayoutManager::resetLayout()
 {
-    m_grid.clear();
-    m_pointsForItem.clear();
+    m_cellsForItem.clear();
+    m_grid.reset(rows(), columns());
     for (auto *item : layout()->childItems()) {
         ItemContainer *itemCont = qobject_cast<ItemContainer*>(item);
         if (itemCont && itemCont != layout()->placeHolder()) {
@@ -140,8 +140,8 @@ void GridLayoutManager::resetLayout()
 
 void GridLayoutManager::resetLayoutFromConfig()
 {
-    m_grid.clear();
-    m_pointsForItem.clear();
+    m_cellsForItem.clear();
+    m_grid.reset(rows(), columns());
     QList<ItemContainer *> missingItems;
 
     for (auto *item : layout()->childItems()) {
@@ -191,16 +191,9 @@ bool GridLayoutManager::isRectAvailable(const QRectF &rect)
         return false;
     }
     
-    const QRect cellItemGeom = cellBasedGeometry(rect);
+    updateGrid();
 
-    for (int row = cellItemGeom.top(); row <= cellItemGeom.bottom(); ++row) {
-        for (int column = cellItemGeom.left(); column <= cellItemGeom.right(); ++column) {
-            if (!isCellAvailable(QPair<int, int>(row, column))) {
-                return false;
-            }
-        }
-    }
-    return true;
+    return m_grid.isFree(cellBasedGeometry(rect));
 }
 
 bool GridLayoutManager::assignSpaceImpl(ItemContainer *item)
@@ -214,13 +207,8 @@ bool GridLayoutManager::assignSpaceImpl(ItemContainer *item)
 
     const QRect cellItemGeom = cellBasedGeometry(itemGeometry(item));
 
-    for (int row = cellItemGeom.top(); row <= cellItemGeom.bottom(); ++row) {
-        for (int column = cellItemGeom.left(); column <= cellItemGeom.right(); ++column) {
-            QPair<int, int> cell(row, column);
-            m_grid.insert(cell, item);
-            m_pointsForItem[item].insert(cell);
-        }
-    }
+    m_grid.setTaken(cellItemGeom, true);
+    m_cellsForItem.insert(item, cellItemGeom);
 
     // Reorder items tab order
     for (auto *i2 : layout()->childItems()) {
@@ -245,17 +233,16 @@ bool GridLayoutManager::assignSpaceImpl(ItemContainer *item)
 
 void GridLayoutManager::releaseSpaceImpl(ItemContainer *item)
 {
-    auto it = m_pointsForItem.find(item);
+    auto it = m_cellsForItem.find(item);
 
-    if (it == m_pointsForItem.end()) {
+    if (it == m_cellsForItem.end()) {
         return;
     }
 
-    for (const auto &point : it.value()) {
-        m_grid.remove(point);
-    }
+    updateGrid();
+    m_grid.setTaken(it.value(), false);
 
-    m_pointsForItem.erase(it);
+    m_cellsForItem.erase(it);
 
     disconnect(item, &ItemContainer::sizeHintsChanged, this, nullptr);
 }
@@ -270,6 +257,16 @@ int GridLayoutManager::columns() const
     return layout()->width() / cellSize().width();
 }
 
+void GridLayoutManager::updateGrid() const
+{
+    if (m_grid.rows() == rows() && m_grid.columns() == columns()) {
+        return;
+    }
+
+    // The cells outside of the new size are not taken anymore, but come back if it grows again
+    m_grid.reset(rows(), columns(), m_cellsForItem.values().toVector());
+}
+
 void GridLayoutManager::adjustToItemSizeHints(ItemContainer *item)
 {
     if (!item->layoutAttached() || item->editMode()) {
@@ -354,7 +351,7 @@ bool GridLayoutManager::isOutOfBounds(const QPair<int, int> &cell) const
 
 bool GridLayoutManager::isCellAvailable(const QPair<int, int> &cell) const
 {
-    return !isOutOfBounds(cell) && !m_grid.contains(cell);
+    return !isOutOfBounds(cell) && !m_grid.isTaken(cell.first, cell.second);
 }
 
 QRectF GridLayoutManager::itemGeometry(QQuickItem *item) const
@@ -362,117 +359,29 @@ QRectF GridLayoutManager::itemGeometry(QQuickItem *item) const
     return QRectF(item->x(), item->y(), item->width(), item->height());
 }
 
-QPair<int, int> GridLayoutManager::nextCell(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const
-{
-    QPair<int, int> nCell = cell;
-
-    switch (direction) {
-    case AppletsLayout::AppletsLayout::BottomToTop:
-        --nCell.first;
-        break;
-    case AppletsLayout::AppletsLayout::TopToBottom:
-        ++nCell.first;
-        break;
-    case AppletsLayout::AppletsLayout::RightToLeft:
-        --nCell.second;
-        break;
-    case AppletsLayout::AppletsLayout::LeftToRight:
-    default:
-        ++nCell.second;
-        break;
-    }
-
-    return nCell;
-}
-
 QPair<int, int> GridLayoutManager::nextAvailableCell(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const
 {
-    QPair<int, int> nCell = cell;
-    while (!isOutOfBounds(nCell)) {
-        nCell = nextCell(nCell, direction);
-
-        if (isOutOfBounds(nCell)) {
-            switch (direction) {
-            case AppletsLayout::AppletsLayout::BottomToTop:
-                nCell.first = rows() - 1;
-                --nCell.second;
-                break;
-            case AppletsLayout::AppletsLayout::TopToBottom:
-                nCell.first = 0;
-                ++nCell.second;
-                break;
-            case AppletsLayout::AppletsLayout::RightToLeft:
-                --nCell.first;
-                nCell.second = columns() - 1;
-                break;
-            case AppletsLayout::AppletsLayout::LeftToRight:
-            default:
-                ++nCell.first;
-                nCell.second = 0;
-                break;
-            }
-        }
-
-        if (isCellAvailable(nCell)) {
-            return nCell;
-        }
-    }
-
-    return QPair<int, int>(-1, -1);
+    return m_grid.nextCellInState(cell, direction, false);
 }
 
 QPair<int, int> GridLayoutManager::nextTakenCell(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const
 {
-    QPair<int, int> nCell = cell;
-    while (!isOutOfBounds(nCell)) {
-        nCell = nextCell(nCell, direction);
-
-        if (isOutOfBounds(nCell)) {
-            switch (direction) {
-            case AppletsLayout::AppletsLayout::BottomToTop:
-                nCell.first = rows() - 1;
-                --nCell.second;
-                break;
-            case AppletsLayout::AppletsLayout::TopToBottom:
-                nCell.first = 0;
-                ++nCell.second;
-                break;
-            case AppletsLayout::AppletsLayout::RightToLeft:
-                --nCell.first;
-                nCell.second = columns() - 1;
-                break;
-            case AppletsLayout::AppletsLayout::LeftToRight:
-            default:
-                ++nCell.first;
-                nCell.second = 0;
-                break;
-            }
-        }
-
-        if (!isCellAvailable(nCell)) {
-            return nCell;
-        }
-    }
-
-    return QPair<int, int>(-1, -1);
+    return m_grid.nextCellInState(cell, direction, true);
 }
 
 int GridLayoutManager::freeSpaceInDirection(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const
 {
-    QPair<int, int> nCell = cell;
-
-    int avail = 0;
-
-    while (isCellAvailable(nCell)) {
-        ++avail;
-        nCell = nextCell(nCell, direction);
+    if (!isCellAvailable(cell)) {
+        return 0;
     }
 
-    return avail;
+    return m_grid.run(cell.first, cell.second, direction);
 }
 
 QRectF GridLayoutManager::nextAvailableSpace(ItemContainer *item, const QSizeF &minimumSize, AppletsLayout::PreferredLayoutDirection direction) const
-{  
+{
+    updateGrid();
+
     // The mionimum size in grid units
     const QSize minimumGridSize(
         ceil((qreal)minimumSize.width() / cellSize().width()),
@@ -22,6 +22,7 @@
 
 #include "abstractlayoutmanager.h"
 #include "appletcontainer.h"
+#include "occupancygrid.h"
 
 class AppletsLayout;
 class ItemContainer;
@@ -88,9 +89,6 @@ private:
     // Returns the qrect geometry for an item
     inline QRectF itemGeometry(QQuickItem *item) const;
 
-    // The next cell given the direction
-    QPair<int, int> nextCell(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const;
-
     // The next cell that is available given the direction
     QPair<int, int> nextAvailableCell(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const;
 
@@ -105,9 +103,13 @@ private:
      */
     void adjustToItemSizeHints(ItemContainer *item);
 
-    // What is the item that occupies the point. The point is expressed in cells rather than pixels. a qpair rather a QPointF as QHash doesn't support identification by QPointF
-    QHash <QPair<int, int>, ItemContainer *> m_grid;
-    QHash <ItemContainer *, QSet<QPair<int, int> > > m_pointsForItem;
+    // Makes the occupancy grid as large as the layout, if it changed size
+    void updateGrid() const;
+
+    // Which cells are taken, as large as the layout in cells
+    mutable OccupancyGrid m_grid;
+    // The cells each item occupies
+    QHash <ItemContainer *, QRect> m_cellsForItem;
 
     QHash <QString, Geom> m_parsedConfig;
 };
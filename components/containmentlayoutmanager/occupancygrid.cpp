@@ -0,0 +1,207 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Library General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include "occupancygrid.h"
+
+int OccupancyGrid::rows() const
+{
+    return m_rows;
+}
+
+int OccupancyGrid::columns() const
+{
+    return m_columns;
+}
+
+int OccupancyGrid::index(int row, int column) const
+{
+    return row * m_columns + column;
+}
+
+void OccupancyGrid::reset(int rows, int columns, const QVector<QRect> &taken)
+{
+    m_rows = qMax(0, rows);
+    m_columns = qMax(0, columns);
+    if (m_rows == 0 || m_columns == 0) {
+        m_rows = 0;
+        m_columns = 0;
+    }
+
+    const int size = m_rows * m_columns;
+    m_taken = QBitArray(size);
+    m_rightRuns.resize(size);
+    m_leftRuns.resize(size);
+    m_downRuns.resize(size);
+    m_upRuns.resize(size);
+
+    const QRect bounds(0, 0, m_columns, m_rows);
+    for (const QRect &cells : taken) {
+        const QRect clipped = cells & bounds;
+        for (int row = clipped.top(); row <= clipped.bottom(); ++row) {
+            m_taken.fill(true, index(row, clipped.left()), index(row, clipped.right()) + 1);
+        }
+    }
+
+    for (int row = 0; row < m_rows; ++row) {
+        updateRow(row);
+    }
+    for (int column = 0; column < m_columns; ++column) {
+        updateColumn(column);
+    }
+}
+
+void OccupancyGrid::setTaken(const QRect &cells, bool taken)
+{
+    const QRect clipped = cells & QRect(0, 0, m_columns, m_rows);
+    if (clipped.isEmpty()) {
+        return;
+    }
+
+    for (int row = clipped.top(); row <= clipped.bottom(); ++row) {
+        m_taken.fill(taken, index(row, clipped.left()), index(row, clipped.right()) + 1);
+    }
+
+    // Only the runs crossing the changed cells can be different now
+    for (int row = clipped.top(); row <= clipped.bottom(); ++row) {
+        updateRow(row);
+    }
+    for (int column = clipped.left(); column <= clipped.right(); ++column) {
+        updateColumn(column);
+    }
+}
+
+bool OccupancyGrid::isTaken(int row, int column) const
+{
+    if (row < 0 || column < 0 || row >= m_rows || column >= m_columns) {
+        return false;
+    }
+
+    return m_taken.testBit(index(row, column));
+}
+
+bool OccupancyGrid::isFree(const QRect &cells) const
+{
+    if (cells.isEmpty()) {
+        return true;
+    }
+
+    if (!QRect(0, 0, m_columns, m_rows).contains(cells)) {
+        return false;
+    }
+
+    for (int row = cells.top(); row <= cells.bottom(); ++row) {
+        const int i = index(row, cells.left());
+        if (m_taken.testBit(i) || m_rightRuns[i] < cells.width()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int OccupancyGrid::run(int row, int column, AppletsLayout::PreferredLayoutDirection direction) const
+{
+    if (row < 0 || column < 0 || row >= m_rows || column >= m_columns) {
+        return 0;
+    }
+
+    const int i = index(row, column);
+
+    switch (direction) {
+    case AppletsLayout::BottomToTop:
+        return m_upRuns[i];
+    case AppletsLayout::TopToBottom:
+        return m_downRuns[i];
+    case AppletsLayout::RightToLeft:
+        return m_leftRuns[i];
+    case AppletsLayout::LeftToRight:
+    default:
+        return m_rightRuns[i];
+    }
+}
+
+QPair<int, int> OccupancyGrid::nextCellInState(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction, bool taken) const
+{
+    if (cell.first < 0 || cell.second < 0 || cell.first >= m_rows || cell.second >= m_columns) {
+        return QPair<int, int>(-1, -1);
+    }
+
+    // Walk along lines, which are rows when going horizontally and columns when going vertically,
+    // wrapping to the start of the next line at the end of one
+    const bool horizontal = direction != AppletsLayout::TopToBottom && direction != AppletsLayout::BottomToTop;
+    const int step = (direction == AppletsLayout::RightToLeft || direction == AppletsLayout::BottomToTop) ? -1 : 1;
+    const int lineCount = horizontal ? m_rows : m_columns;
+    const int lineLength = horizontal ? m_columns : m_rows;
+
+    auto cellAt = [horizontal](int line, int position) {
+        return horizontal ? QPair<int, int>(line, position) : QPair<int, int>(position, line);
+    };
+
+    int line = horizontal ? cell.first : cell.second;
+    int position = (horizontal ? cell.second : cell.first) + step;
+
+    while (line >= 0 && line < lineCount) {
+        if (position >= 0 && position < lineLength) {
+            const QPair<int, int> nCell = cellAt(line, position);
+            if (isTaken(nCell.first, nCell.second) != taken) {
+                position += step * run(nCell.first, nCell.second, direction);
+            }
+            // Either it was already in the wanted state, or the run of the other state ended before the end of the line
+            if (position >= 0 && position < lineLength) {
+                return cellAt(line, position);
+            }
+        }
+
+        line += step;
+        position = step > 0 ? 0 : lineLength - 1;
+    }
+
+    return QPair<int, int>(-1, -1);
+}
+
+void OccupancyGrid::updateRow(int row)
+{
+    const int first = index(row, 0);
+    const int last = index(row, m_columns - 1);
+
+    m_leftRuns[first] = 1;
+    for (int i = first + 1; i <= last; ++i) {
+        m_leftRuns[i] = m_taken.testBit(i) == m_taken.testBit(i - 1) ? m_leftRuns[i - 1] + 1 : 1;
+    }
+
+    m_rightRuns[last] = 1;
+    for (int i = last - 1; i >= first; --i) {
+        m_rightRuns[i] = m_taken.testBit(i) == m_taken.testBit(i + 1) ? m_rightRuns[i + 1] + 1 : 1;
+    }
+}
+
+void OccupancyGrid::updateColumn(int column)
+{
+    const int first = index(0, column);
+    const int last = index(m_rows - 1, column);
+
+    m_upRuns[first] = 1;
+    for (int i = first + m_columns; i <= last; i += m_columns) {
+        m_upRuns[i] = m_taken.testBit(i) == m_taken.testBit(i - m_columns) ? m_upRuns[i - m_columns] + 1 : 1;
+    }
+
+    m_downRuns[last] = 1;
+    for (int i = last - m_columns; i >= first; i -= m_columns) {
+        m_downRuns[i] = m_taken.testBit(i) == m_taken.testBit(i + m_columns) ? m_downRuns[i + m_columns] + 1 : 1;
+    }
+}
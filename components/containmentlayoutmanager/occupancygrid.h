@@ -0,0 +1,73 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Library General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#pragma once
+
+#include <QBitArray>
+#include <QPair>
+#include <QRect>
+#include <QVector>
+
+#include "appletslayout.h"
+
+/**
+ * Which cells of a grid are taken, stored row by row.
+ *
+ * Besides the state of each cell, it keeps for every cell how many cells
+ * in each direction share its state, so how far a free or taken stretch
+ * goes is known without walking it cell by cell.
+ * Cells are addressed as in a QRect, x being the column and y the row.
+ */
+class OccupancyGrid
+{
+public:
+    int rows() const;
+    int columns() const;
+
+    // Makes the grid rows x columns cells large, with only the given cells taken
+    void reset(int rows, int columns, const QVector<QRect> &taken = QVector<QRect>());
+
+    // Takes or frees the cells, the ones outside of the grid are ignored
+    void setTaken(const QRect &cells, bool taken);
+
+    // Cells outside of the grid are never taken
+    bool isTaken(int row, int column) const;
+
+    // True if all the cells are inside the grid and free
+    bool isFree(const QRect &cells) const;
+
+    // How many cells, starting from the given one and going in the direction, have the same state as it, up to the border of the grid
+    int run(int row, int column, AppletsLayout::PreferredLayoutDirection direction) const;
+
+    // The next cell as (row, column) that is taken or not given the direction, jumping over the runs of cells in the other state.
+    // Lines wrap at the border of the grid, (-1, -1) if there is none
+    QPair<int, int> nextCellInState(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction, bool taken) const;
+
+private:
+    inline int index(int row, int column) const;
+    void updateRow(int row);
+    void updateColumn(int column);
+
+    int m_rows = 0;
+    int m_columns = 0;
+    QBitArray m_taken;
+    QVector<int> m_rightRuns;
+    QVector<int> m_leftRuns;
+    QVector<int> m_downRuns;
+    QVector<int> m_upRuns;
+};
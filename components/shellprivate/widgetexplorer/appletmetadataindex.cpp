@@ -0,0 +1,129 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library/Lesser General Public License
+ *   version 2, or (at your option) any later version, as published by the
+ *   Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library/Lesser General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "appletmetadataindex_p.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+#include <QStandardPaths>
+
+#include <KPackage/PackageLoader>
+#include <KDeclarative/KDeclarative>
+#include "config-workspace.h"
+
+Q_GLOBAL_STATIC(AppletMetaDataIndex, s_index)
+
+AppletMetaDataIndex *AppletMetaDataIndex::self()
+{
+    return s_index();
+}
+
+const QVector<AppletMetaData> &AppletMetaDataIndex::applets()
+{
+    if (!m_valid || m_directories != packageDirectories()) {
+        scan();
+    }
+
+    return m_applets;
+}
+
+void AppletMetaDataIndex::invalidate()
+{
+    m_valid = false;
+}
+
+QHash<QString, qint64> AppletMetaDataIndex::packageDirectories()
+{
+    QHash<QString, qint64> directories;
+
+    //the roots change when a package is added or removed, the packages
+    //themselves when their metadata gets replaced on update
+    const QStringList roots = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation,
+                                                        QStringLiteral(PLASMA_RELATIVE_DATA_INSTALL_DIR "/plasmoids"),
+                                                        QStandardPaths::LocateDirectory);
+    for (const QString &root : roots) {
+        directories.insert(root, QFileInfo(root).lastModified().toMSecsSinceEpoch());
+
+        const QFileInfoList packages = QDir(root).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+        for (const QFileInfo &package : packages) {
+            directories.insert(package.absoluteFilePath(), package.lastModified().toMSecsSinceEpoch());
+        }
+    }
+
+    return directories;
+}
+
+void AppletMetaDataIndex::scan()
+{
+    m_applets.clear();
+    m_directories = packageDirectories();
+    m_valid = true;
+
+    const QStringList platform = KDeclarative::KDeclarative::runtimePlatform();
+    const QVector<KPluginMetaData> packages = KPackage::PackageLoader::self()->listPackages(QStringLiteral("Plasma/Applet"), QStringLiteral("plasma/plasmoids")).toVector();
+
+    QSet<QString> pluginNames;
+
+    for (const KPluginMetaData &metaData : packages) {
+        const KPluginInfo info = KPluginInfo::fromMetaData(metaData);
+        if (!info.isValid() || info.property(QStringLiteral("NoDisplay")).toBool() || info.category() == QLatin1String("Containments")) {
+            // we don't want to show the hidden category
+            continue;
+        }
+
+        bool inFormFactor = true;
+        for (const QString &formFactor : platform) {
+            if (!info.formFactors().isEmpty() &&
+                !info.formFactors().contains(formFactor)) {
+                inFormFactor = false;
+            }
+        }
+        if (!inFormFactor) {
+            continue;
+        }
+
+        if (pluginNames.contains(info.pluginName())) {
+            continue;
+        }
+        pluginNames.insert(info.pluginName());
+
+        AppletMetaData applet;
+        applet.info = info;
+        applet.provides = info.property(QStringLiteral("X-Plasma-Provides")).toStringList();
+        applet.name = info.name().toLower();
+        applet.description = info.comment().toLower();
+        applet.category = info.category().toLower();
+
+        const QStringList keywords = info.property(QStringLiteral("Keywords")).toStringList();
+        for (const QString &keyword : keywords) {
+            applet.keywords << keyword.toLower();
+        }
+
+        const QString api(info.property(QStringLiteral("X-Plasma-API")).toString());
+        if (!api.isEmpty()) {
+            const QString _f = PLASMA_RELATIVE_DATA_INSTALL_DIR "/plasmoids/" + info.pluginName() + '/';
+            QFileInfo dir(QStandardPaths::locate(QStandardPaths::GenericDataLocation,
+                                                 _f,
+                                                 QStandardPaths::LocateDirectory));
+            applet.local = dir.exists() && dir.isWritable();
+        }
+
+        m_applets << applet;
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library/Lesser General Public License
+ *   version 2, or (at your option) any later version, as published by the
+ *   Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library/Lesser General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PLASMA_APPLETMETADATAINDEX_P_H
+#define PLASMA_APPLETMETADATAINDEX_P_H
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+#include <kplugininfo.h>
+
+/**
+ * What the widget explorer needs to know about an applet package,
+ * read once when the packages are scanned
+ */
+struct AppletMetaData
+{
+    KPluginInfo info;
+    QStringList provides;
+    //lowercase, to match a search pattern against
+    QString name;
+    QString description;
+    QStringList keywords;
+    QString category;
+    bool local = false;
+};
+
+/**
+ * The applets which can be shown in the widget explorer: not hidden, no
+ * containments and meant for the platform we run on.
+ *
+ * The list is shared by all widget explorers of the process and only
+ * built again when a package directory was modified, which is the case
+ * when a package gets installed, updated or removed.
+ */
+class AppletMetaDataIndex
+{
+public:
+    static AppletMetaDataIndex *self();
+
+    const QVector<AppletMetaData> &applets();
+
+    /**
+     * Scans the packages again the next time the applets are asked for,
+     * whether or not the package directories look modified
+     */
+    void invalidate();
+
+private:
+    static QHash<QString, qint64> packageDirectories();
+    void scan();
+
+    QVector<AppletMetaData> m_applets;
+    //package directory => modification time, when the applets were scanned
+    QHash<QString, qint64> m_directories;
+    bool m_valid = false;
+};
+
+#endif
@@ -184,7 +184,7 @@ bool DefaultItemFilterProxyModel::filterAcceptsRow(int sourceRow,
 
     return item &&
         (m_filter.first.isEmpty() || item->passesFiltering(m_filter)) &&
-        (m_searchPattern.isEmpty() || item->matches(m_searchPattern));
+        (m_lowerSearchPattern.isEmpty() || item->matches(m_lowerSearchPattern));
 }
 
 QVariantHash DefaultItemFilterProxyModel::get(int row) const
@@ -211,6 +211,7 @@ bool DefaultItemFilterProxyModel::lessThan(const QModelIndex &left,
 void DefaultItemFilterProxyModel::setSearchTerm(const QString &pattern)
 {
     m_searchPattern = pattern;
+    m_lowerSearchPattern = pattern.toLower();
     invalidateFilter();
     emit searchTermChanged(pattern);
 }
@@ -63,7 +63,8 @@ public:
     virtual int running() const;
 
     /**
-     * Returns if the item contains string specified by pattern.
+     * Returns if the item contains string specified by pattern, which is
+     * in lowercase.
      * Default implementation checks whether name or description contain the
      * string (not needed to be exactly that string)
      */
@@ -168,6 +169,8 @@ Q_SIGNALS:
 private:
     Filter m_filter;
     QString m_searchPattern;
+    // m_searchPattern in lowercase, what the items are matched against
+    QString m_lowerSearchPattern;
 };
 
 } //end of namespace
@@ -19,102 +19,87 @@
 
 #include "plasmaappletitemmodel_p.h"
 
-#include <QStandardPaths>
-#include <QFileInfo>
 #include <QMimeData>
 
 #include <klocalizedstring.h>
 #include <kservicetypetrader.h>
 #include <ksycoca.h>
 #include <kconfig.h>
-#include "config-workspace.h"
-#include <KPluginTrader>
 #include <KPackage/PackageLoader>
-#include <KDeclarative/KDeclarative>
 
-PlasmaAppletItem::PlasmaAppletItem(const KPluginInfo& info):
+PlasmaAppletItem::PlasmaAppletItem(const AppletMetaData &applet):
       AbstractItem(),
-      m_info(info),
-      m_runningCount(0),
-      m_local(false)
-{
-    const QString api(m_info.property(QStringLiteral("X-Plasma-API")).toString());
-    if (!api.isEmpty()) {
-        const QString _f = PLASMA_RELATIVE_DATA_INSTALL_DIR "/plasmoids/" + info.pluginName() + '/';
-        QFileInfo dir(QStandardPaths::locate(QStandardPaths::QStandardPaths::GenericDataLocation,
-                                                  _f,
-                                                  QStandardPaths::LocateDirectory));
-        m_local = dir.exists() && dir.isWritable();
-    }
-
+      m_applet(applet),
+      m_runningCount(0)
+{
     //attrs.insert("recommended", flags & Recommended ? true : false);
-    setText(m_info.name() + " - "+ m_info.category().toLower());
+    setText(m_applet.info.name() + " - "+ m_applet.category);
 
-    if (QIcon::hasThemeIcon(info.pluginName())) {
-        setIcon(QIcon::fromTheme(info.pluginName()));
-    } else if (!m_info.icon().isEmpty()) {
-        setIcon(QIcon::fromTheme(info.icon()));
+    if (QIcon::hasThemeIcon(m_applet.info.pluginName())) {
+        setIcon(QIcon::fromTheme(m_applet.info.pluginName()));
+    } else if (!m_applet.info.icon().isEmpty()) {
+        setIcon(QIcon::fromTheme(m_applet.info.icon()));
     } else {
         setIcon(QIcon::fromTheme(QStringLiteral("application-x-plasma")));
     }
 
     //set plugininfo parts as roles in the model, only way qml can understand it
-    setData(info.name(), PlasmaAppletItemModel::NameRole);
-    setData(info.pluginName(), PlasmaAppletItemModel::PluginNameRole);
-    setData(info.comment(), PlasmaAppletItemModel::DescriptionRole);
-    setData(info.category().toLower(), PlasmaAppletItemModel::CategoryRole);
-    setData(info.license(), PlasmaAppletItemModel::LicenseRole);
-    setData(info.website(), PlasmaAppletItemModel::WebsiteRole);
-    setData(info.version(), PlasmaAppletItemModel::VersionRole);
-    setData(info.author(), PlasmaAppletItemModel::AuthorRole);
-    setData(info.email(), PlasmaAppletItemModel::EmailRole);
+    setData(m_applet.info.name(), PlasmaAppletItemModel::NameRole);
+    setData(m_applet.info.pluginName(), PlasmaAppletItemModel::PluginNameRole);
+    setData(m_applet.info.comment(), PlasmaAppletItemModel::DescriptionRole);
+    setData(m_applet.category, PlasmaAppletItemModel::CategoryRole);
+    setData(m_applet.info.license(), PlasmaAppletItemModel::LicenseRole);
+    setData(m_applet.info.website(), PlasmaAppletItemModel::WebsiteRole);
+    setData(m_applet.info.version(), PlasmaAppletItemModel::VersionRole);
+    setData(m_applet.info.author(), PlasmaAppletItemModel::AuthorRole);
+    setData(m_applet.info.email(), PlasmaAppletItemModel::EmailRole);
     setData(0, PlasmaAppletItemModel::RunningRole);
-    setData(m_local, PlasmaAppletItemModel::LocalRole);
+    setData(m_applet.local, PlasmaAppletItemModel::LocalRole);
 }
 
 QString PlasmaAppletItem::pluginName() const
 {
-    return m_info.pluginName();
+    return m_applet.info.pluginName();
 }
 
 QString PlasmaAppletItem::name() const
 {
-    return m_info.name();
+    return m_applet.info.name();
 }
 
 QString PlasmaAppletItem::description() const
 {
-    return m_info.comment();
+    return m_applet.info.comment();
 }
 
 QString PlasmaAppletItem::license() const
 {
-    return m_info.license();
+    return m_applet.info.license();
 }
 
 QString PlasmaAppletItem::category() const
 {
-    return m_info.category();
+    return m_applet.info.category();
 }
 
 QString PlasmaAppletItem::website() const
 {
-    return m_info.website();
+    return m_applet.info.website();
 }
 
 QString PlasmaAppletItem::version() const
 {
-    return m_info.version();
+    return m_applet.info.version();
 }
 
 QString PlasmaAppletItem::author() const
 {
-    return m_info.author();
+    return m_applet.info.author();
 }
 
 QString PlasmaAppletItem::email() const
 {
-    return m_info.email();
+    return m_applet.info.email();
 }
 
 int PlasmaAppletItem::running() const
@@ -124,6 +109,10 @@ int PlasmaAppletItem::running() const
 
 void PlasmaAppletItem::setRunning(int count)
 {
+    if (m_runningCount == count) {
+        return;
+    }
+
     m_runningCount = count;
     setData(count, PlasmaAppletItemModel::RunningRole);
     emitDataChanged();
@@ -131,22 +120,21 @@ void PlasmaAppletItem::setRunning(int count)
 
 bool PlasmaAppletItem::matches(const QString &pattern) const
 {
-    if (m_info.service()) {
-        const QStringList keywords = m_info.property(QStringLiteral("Keywords")).toStringList();
-        foreach (const QString &keyword, keywords) {
-            if (keyword.startsWith(pattern, Qt::CaseInsensitive)) {
-                return true;
-            }
+    // both the pattern and what is indexed of the applet are lowercase already
+    for (const QString &keyword : m_applet.keywords) {
+        if (keyword.startsWith(pattern)) {
+            return true;
         }
     }
 
-    return AbstractItem::matches(pattern);
+    return m_applet.name.contains(pattern) ||
+           m_applet.description.contains(pattern);
 }
 
 
 bool PlasmaAppletItem::isLocal() const
 {
-    return m_local;
+    return m_applet.local;
 }
 
 bool PlasmaAppletItem::passesFiltering(const KCategorizedItemsViewModels::Filter &filter) const
@@ -156,7 +144,7 @@ bool PlasmaAppletItem::passesFiltering(const KCategorizedItemsViewModels::Filter
     } else if (filter.first == QLatin1String("local")) {
         return isLocal();
     } else if (filter.first == QLatin1String("category")) {
-        return m_info.category().toLower() == filter.second;
+        return m_applet.category == filter.second;
     } else {
         return false;
     }
@@ -186,7 +174,7 @@ QVariant PlasmaAppletItem::data(int role) const
         if (m_screenshot.isNull()) {
             KPackage::Package pkg = KPackage::PackageLoader::self()->loadPackage(QStringLiteral("Plasma/Applet"));
             pkg.setDefaultPackageRoot(QStringLiteral("plasma/plasmoids"));
-            pkg.setPath(m_info.pluginName());
+            pkg.setPath(m_applet.info.pluginName());
             if (pkg.isValid()) {
                 const_cast<PlasmaAppletItem *>(this)->m_screenshot = pkg.filePath("screenshot");
             } else {
@@ -202,7 +190,7 @@ QVariant PlasmaAppletItem::data(int role) const
         if (m_icon.isNull()) {
             KPackage::Package pkg = KPackage::PackageLoader::self()->loadPackage(QStringLiteral("Plasma/Applet"));
             pkg.setDefaultPackageRoot(QStringLiteral("plasma/plasmoids"));
-            pkg.setPath(m_info.pluginName());
+            pkg.setPath(m_applet.info.pluginName());
             if (pkg.isValid() && pkg.metadata().iconName().startsWith(QLatin1String("/"))) {
                 const_cast<PlasmaAppletItem *>(this)->m_icon = pkg.filePath("", pkg.metadata().iconName().toUtf8());
             } else {
@@ -256,50 +244,31 @@ void PlasmaAppletItemModel::populateModel(const QStringList &whatChanged)
         return;
     }
 
-    clear();
-    //qDebug() << "populating model, our application is" << m_application;
-
-    //qDebug() << "number of applets is"
-    //         <<  Plasma::Applet::listAppletInfo(QString(), m_application).count();
-
-    QString constraint;
-    bool first = true;
-    foreach (const QString prov, m_provides) {
-        if (!first) {
-            constraint += QLatin1String(" or ");
-        }
-
-        first = false;
-        constraint += "'" + prov + "' in [X-Plasma-Provides]";
+    if (!whatChanged.isEmpty()) {
+        AppletMetaDataIndex::self()->invalidate();
     }
 
-    KPluginInfo::List list = KPluginInfo::fromMetaData(KPackage::PackageLoader::self()->listPackages(QStringLiteral("Plasma/Applet"), QStringLiteral("plasma/plasmoids")).toVector());
-
-    KPluginTrader::applyConstraints(list, constraint);
-
-    for (auto info : list) {
-        //qDebug() << info.pluginName() << "NoDisplay" << info.property("NoDisplay").toBool();
-        if (!info.isValid() || info.property(QStringLiteral("NoDisplay")).toBool() || info.category() == QLatin1String("Containments")) {
-            // we don't want to show the hidden category
-            continue;
-        }
-
-        bool inFormFactor = true;
-
-        foreach (const QString &formFactor, KDeclarative::KDeclarative::runtimePlatform()) {
-            if (!info.formFactors().isEmpty() &&
-                !info.formFactors().contains(formFactor)) {
-                inFormFactor = false;
+    clear();
+    m_items.clear();
+
+    const QVector<AppletMetaData> &applets = AppletMetaDataIndex::self()->applets();
+    for (const AppletMetaData &applet : applets) {
+        if (!m_provides.isEmpty()) {
+            bool provided = false;
+            for (const QString &prov : qAsConst(m_provides)) {
+                if (applet.provides.contains(prov)) {
+                    provided = true;
+                    break;
+                }
+            }
+            if (!provided) {
+                continue;
             }
-        }
-        if (!inFormFactor) {
-            continue;
         }
 
-        //qDebug() << info.pluginName() << " is the name of the plugin at" << info.entryPath();
-        //qDebug() << info.name() << info.property("X-Plasma-Thumbnail");
-
-        appendRow(new PlasmaAppletItem(info));
+        PlasmaAppletItem *item = new PlasmaAppletItem(applet);
+        m_items.insert(applet.info.pluginName(), item);
+        appendRow(item);
     }
 
     emit modelPopulated();
@@ -307,26 +276,24 @@ void PlasmaAppletItemModel::populateModel(const QStringList &whatChanged)
 
 void PlasmaAppletItemModel::setRunningApplets(const QHash<QString, int> &apps)
 {
-    //foreach item, find that string and set the count
-    for (int r = 0; r < rowCount(); ++r) {
-        QStandardItem *i = item(r);
-        PlasmaAppletItem *p = dynamic_cast<PlasmaAppletItem *>(i);
-
-        if (p) {
-            const int running = apps.value(p->pluginName());
-            p->setRunning(running);
-        }
+    for (auto it = m_items.constBegin(); it != m_items.constEnd(); ++it) {
+        it.value()->setRunning(apps.value(it.key()));
     }
 }
 
 void PlasmaAppletItemModel::setRunningApplets(const QString &name, int count)
 {
-    for (int r=0; r<rowCount(); ++r) {
-        QStandardItem *i = item(r);
-        PlasmaAppletItem *p = dynamic_cast<PlasmaAppletItem *>(i);
-        if (p && p->pluginName() == name) {
-            p->setRunning(count);
-        }
+    PlasmaAppletItem *p = m_items.value(name);
+    if (p) {
+        p->setRunning(count);
+    }
+}
+
+void PlasmaAppletItemModel::removeApplet(const QString &pluginName)
+{
+    PlasmaAppletItem *p = m_items.take(pluginName);
+    if (p) {
+        removeRow(p->row());
     }
 }
 
@@ -340,12 +307,8 @@ QStringList PlasmaAppletItemModel::mimeTypes() const
 QSet<QString> PlasmaAppletItemModel::categories() const
 {
     QSet<QString> cats;
-    for (int r = 0; r < rowCount(); ++r) {
-        QStandardItem *i = item(r);
-        PlasmaAppletItem *p = dynamic_cast<PlasmaAppletItem *>(i);
-        if (p) {
-            cats.insert(p->category().toLower());
-        }
+    for (const PlasmaAppletItem *p : m_items) {
+        cats.insert(p->data(CategoryRole).toString());
     }
 
     return cats;
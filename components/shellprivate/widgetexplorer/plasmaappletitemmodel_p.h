@@ -22,6 +22,7 @@
 
 #include <kplugininfo.h>
 #include <Plasma/Applet>
+#include "appletmetadataindex_p.h"
 #include "kcategorizeditemsviewmodels_p.h"
 
 class PlasmaAppletItemModel;
@@ -32,7 +33,7 @@ class PlasmaAppletItemModel;
 class PlasmaAppletItem : public KCategorizedItemsViewModels::AbstractItem
 {
 public:
-    explicit PlasmaAppletItem(const KPluginInfo& info);
+    explicit PlasmaAppletItem(const AppletMetaData &applet);
 
     QString pluginName() const;
     QString name() const override;
@@ -56,11 +57,10 @@ public:
     QStringList mimeTypes() const;
 
 private:
-    KPluginInfo m_info;
+    AppletMetaData m_applet;
     QString m_screenshot;
     QString m_icon;
     int m_runningCount;
-    bool m_local;
 };
 
 class PlasmaAppletItemModel : public QStandardItemModel
@@ -94,6 +94,8 @@ public:
     void setRunningApplets(const QHash<QString, int> &apps);
     void setRunningApplets(const QString &name, int count);
 
+    void removeApplet(const QString &pluginName);
+
     QString &Application();
 
     QStringList provides() const;
@@ -111,6 +113,7 @@ private:
     QString m_application;
     QStringList m_provides;
     KConfigGroup m_configGroup;
+    QHash<QString, PlasmaAppletItem *> m_items; // plugin name => item
     bool m_startupCompleted : 1;
 
 private Q_SLOTS:
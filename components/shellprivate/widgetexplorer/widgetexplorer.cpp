@@ -34,7 +34,6 @@
 #include <Plasma/Applet>
 #include <Plasma/Corona>
 #include <Plasma/Containment>
-#include <Plasma/PluginLoader>
 #include <qstandardpaths.h>
 
 #include <KActivities/Consumer>
@@ -43,6 +42,7 @@
 #include <KPackage/PackageStructure>
 #include <KPackage/PackageLoader>
 
+#include "appletmetadataindex_p.h"
 #include "kcategorizeditemsviewmodels_p.h"
 #include "plasmaappletitemmodel_p.h"
 #include "openwidgetassistant_p.h"
@@ -138,18 +138,13 @@ void WidgetExplorerPrivate::initFilters()
     QSet<QString> existingCategories = itemModel.categories();
     //foreach (const QString &category, Plasma::Applet::listCategories(application)) {
     QStringList cats;
-    const QList<KPluginInfo> list = PluginLoader::self()->listAppletInfo(QString());
+    const QVector<AppletMetaData> &applets = AppletMetaDataIndex::self()->applets();
 
-    for (auto& info : list) {
-        if (!info.isValid()) {
+    for (const AppletMetaData &applet : applets) {
+        const QString c = applet.info.category();
+        if (c.isEmpty()) {
             continue;
         }
-        if (info.property(QStringLiteral("NoDisplay")).toBool() || info.category() == QLatin1String("Containments") ||
-            info.category().isEmpty()) {
-            // we don't want to show the hidden category
-            continue;
-        }
-        const QString c = info.category();
         if (-1 == cats.indexOf(c)) {
             cats << c;
         }
@@ -479,14 +474,7 @@ void WidgetExplorer::uninstall(const QString &pluginName)
     KPackage::Package pkg(structure);
     pkg.uninstall(pluginName, packageRoot);
 
-    //FIXME: moreefficient way rather a linear scan?
-    for (int i = 0; i < d->itemModel.rowCount(); ++i) {
-        QStandardItem *item = d->itemModel.item(i);
-        if (item->data(PlasmaAppletItemModel::PluginNameRole).toString() == pluginName) {
-            d->itemModel.takeRow(i);
-            break;
-        }
-    }
+    d->itemModel.removeApplet(pluginName);
 
     // now remove all instances of that applet
     if (corona()) {
@@ -0,0 +1,178 @@
+/********************************************************************
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include <QObject>
+
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTest>
+
+#include "../hddtemp.h"
+
+static const int s_interval = 100;
+// HddTemp gives up on a connection without reply after two seconds
+static const int s_timeout = 5000;
+
+/**
+ * Stands in for the hddtemp daemon: sends the reply to every connection
+ * and closes it, or keeps it open without a word if the reply is empty
+ */
+class FakeHddTempServer : public QTcpServer
+{
+public:
+    explicit FakeHddTempServer(QObject *parent = nullptr)
+        : QTcpServer(parent)
+    {
+        connect(this, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket *socket = nextPendingConnection()) {
+                ++connections;
+                if (reply.isEmpty()) {
+                    continue;
+                }
+                socket->write(reply);
+                socket->disconnectFromHost();
+                connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+    }
+
+    QByteArray reply;
+    int connections = 0;
+};
+
+class HddTempTest : public QObject
+{
+Q_OBJECT
+
+private Q_SLOTS:
+    void testParsing();
+    void testUnchangedData();
+    void testTimeout();
+    void testBackOff();
+};
+
+void HddTempTest::testParsing()
+{
+    FakeHddTempServer server;
+    server.reply = QByteArrayLiteral("|/dev/sda|WDC WD10EZEX|38|C||/dev/sdb|Samsung SSD 860|41|C||/dev/sdc|ST2000|SLP|*|");
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    HddTemp hddTemp(QStringLiteral("127.0.0.1"), server.serverPort());
+    QSignalSpy spy(&hddTemp, &HddTemp::dataChanged);
+    QVERIFY(spy.wait(s_timeout));
+
+    QStringList sources = hddTemp.sources();
+    sources.sort();
+    QCOMPARE(sources, QStringList({QStringLiteral("/dev/sda"), QStringLiteral("/dev/sdb"), QStringLiteral("/dev/sdc")}));
+
+    QCOMPARE(hddTemp.data(QStringLiteral("/dev/sda"), HddTemp::Temperature), QVariant(QStringLiteral("38")));
+    QCOMPARE(hddTemp.data(QStringLiteral("/dev/sda"), HddTemp::Unit), QVariant(QStringLiteral("C")));
+    QCOMPARE(hddTemp.data(QStringLiteral("/dev/sdb"), HddTemp::Temperature), QVariant(QStringLiteral("41")));
+    // a sleeping disk has no temperature
+    QCOMPARE(hddTemp.data(QStringLiteral("/dev/sdc"), HddTemp::Temperature), QVariant(QStringLiteral("SLP")));
+
+    QVERIFY(!hddTemp.data(QStringLiteral("/dev/sdd"), HddTemp::Temperature).isValid());
+}
+
+void HddTempTest::testUnchangedData()
+{
+    FakeHddTempServer server;
+    server.reply = QByteArrayLiteral("|/dev/sda|WDC WD10EZEX|38|C|");
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    HddTemp hddTemp(QStringLiteral("127.0.0.1"), server.serverPort());
+    hddTemp.setRefreshInterval(s_interval);
+    QSignalSpy spy(&hddTemp, &HddTemp::dataChanged);
+    QVERIFY(spy.wait(s_timeout));
+
+    // the same report on the following refreshes is no change
+    QTRY_VERIFY_WITH_TIMEOUT(server.connections >= 3, s_timeout);
+    QCOMPARE(spy.count(), 1);
+
+    server.reply = QByteArrayLiteral("|/dev/sda|WDC WD10EZEX|39|C|");
+    QVERIFY(spy.wait(s_timeout));
+    QCOMPARE(hddTemp.data(QStringLiteral("/dev/sda"), HddTemp::Temperature), QVariant(QStringLiteral("39")));
+}
+
+void HddTempTest::testTimeout()
+{
+    FakeHddTempServer server;
+    server.reply = QByteArrayLiteral("|/dev/sda|WDC WD10EZEX|38|C|");
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    HddTemp hddTemp(QStringLiteral("127.0.0.1"), server.serverPort());
+    hddTemp.setRefreshInterval(s_interval);
+    QSignalSpy spy(&hddTemp, &HddTemp::dataChanged);
+    QVERIFY(spy.wait(s_timeout));
+    QCOMPARE(hddTemp.currentInterval(), s_interval);
+
+    // a daemon which accepts but never answers
+    server.reply.clear();
+    const int connections = server.connections;
+    QTRY_VERIFY_WITH_TIMEOUT(server.connections > connections, s_timeout);
+    QTRY_COMPARE_WITH_TIMEOUT(hddTemp.currentInterval(), s_interval * 2, s_timeout);
+
+    // the last report stays available meanwhile
+    QCOMPARE(hddTemp.data(QStringLiteral("/dev/sda"), HddTemp::Temperature), QVariant(QStringLiteral("38")));
+    QCOMPARE(spy.count(), 1);
+}
+
+void HddTempTest::testBackOff()
+{
+    // find a port nobody listens on
+    quint16 port;
+    {
+        QTcpServer server;
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+        port = server.serverPort();
+    }
+
+    HddTemp hddTemp(QStringLiteral("127.0.0.1"), port);
+    hddTemp.setRefreshInterval(s_interval);
+
+    // every failure doubles the wait
+    QTRY_COMPARE_WITH_TIMEOUT(hddTemp.currentInterval(), s_interval * 2, s_timeout);
+    hddTemp.refresh();
+    QTRY_COMPARE_WITH_TIMEOUT(hddTemp.currentInterval(), s_interval * 4, s_timeout);
+    hddTemp.refresh();
+    QTRY_COMPARE_WITH_TIMEOUT(hddTemp.currentInterval(), s_interval * 8, s_timeout);
+
+    // but not beyond five minutes
+    const int maxInterval = 5 * 60 * 1000;
+    for (int i = 0; i < 20 && hddTemp.currentInterval() < maxInterval; ++i) {
+        const int interval = hddTemp.currentInterval();
+        hddTemp.refresh();
+        QTRY_VERIFY_WITH_TIMEOUT(hddTemp.currentInterval() > interval, s_timeout);
+    }
+    QCOMPARE(hddTemp.currentInterval(), maxInterval);
+
+    // once the daemon is back, the normal interval applies again
+    FakeHddTempServer server;
+    server.reply = QByteArrayLiteral("|/dev/sda|WDC WD10EZEX|38|C|");
+    QVERIFY(server.listen(QHostAddress::LocalHost, port));
+
+    QSignalSpy spy(&hddTemp, &HddTemp::dataChanged);
+    hddTemp.refresh();
+    QVERIFY(spy.wait(s_timeout));
+    QTRY_COMPARE_WITH_TIMEOUT(hddTemp.currentInterval(), s_interval, s_timeout);
+}
+
+QTEST_MAIN(HddTempTest)
+
+#include "hddtemptest.moc"
@@ -21,85 +21,175 @@
 
 #include <QTcpSocket>
 
-#include <QTimerEvent>
-
 #include <QDebug>
 
+namespace
+{
+    // hddtemp sends its whole report and closes the connection; anything
+    // beyond this is not a report we know how to read
+    const int s_maxReplySize = 4096;
+    const int s_timeout = 2000;
+    const int s_defaultInterval = 10000;
+    const int s_maxInterval = 5 * 60 * 1000;
+}
+
 HddTemp::HddTemp(QObject* parent)
+    : HddTemp(QStringLiteral("localhost"), 7634, parent)
+{
+}
+
+HddTemp::HddTemp(const QString &host, quint16 port, QObject *parent)
     : QObject(parent),
+      m_host(host),
+      m_port(port),
+      m_socket(new QTcpSocket(this)),
+      m_refreshInterval(s_defaultInterval),
       m_failCount(0),
-      m_cacheValid(false)
+      m_pending(false)
 {
-    updateData();
+    m_refreshTimer.setSingleShot(true);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &HddTemp::refresh);
+
+    m_timeoutTimer.setSingleShot(true);
+    m_timeoutTimer.setInterval(s_timeout);
+    connect(&m_timeoutTimer, &QTimer::timeout, this, &HddTemp::failed);
+
+    connect(m_socket, &QTcpSocket::connected, this, &HddTemp::connected);
+    connect(m_socket, &QTcpSocket::readyRead, this, &HddTemp::readData);
+    connect(m_socket, &QTcpSocket::disconnected, this, &HddTemp::finished);
+    connect(m_socket, static_cast<void (QTcpSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error),
+            this, [this](QAbstractSocket::SocketError error) {
+        // the daemon closing the connection after its report is the normal end of a reply
+        if (error == QAbstractSocket::RemoteHostClosedError && !m_buffer.isEmpty()) {
+            return;
+        }
+        failed();
+    });
+
+    refresh();
 }
 
 HddTemp::~HddTemp()
 {
 }
 
-QStringList HddTemp::sources()
+QStringList HddTemp::sources() const
 {
-    updateData();
     return m_data.keys();
 }
 
-void HddTemp::timerEvent(QTimerEvent *event)
+void HddTemp::setRefreshInterval(int msec)
+{
+    m_refreshInterval = qMax(msec, 0);
+}
+
+int HddTemp::refreshInterval() const
 {
-    killTimer(event->timerId());
-    m_cacheValid = false;
+    return m_refreshInterval;
 }
 
-bool HddTemp::updateData()
+int HddTemp::currentInterval() const
 {
-    if (m_cacheValid) {
-        return true;
+    if (m_failCount == 0) {
+        return m_refreshInterval;
     }
 
-    if (m_failCount > 4) {
-        return false;
+    // exponential back-off, the shift is bounded so it cannot overflow
+    const qint64 interval = qint64(qMax(m_refreshInterval, 1)) << qMin(m_failCount, 16);
+    return int(qMin<qint64>(interval, qMax(s_maxInterval, m_refreshInterval)));
+}
+
+void HddTemp::refresh()
+{
+    if (m_pending) {
+        return;
     }
 
-    QTcpSocket socket;
-    QString data;
-
-    socket.connectToHost(QStringLiteral("localhost"), 7634);
-    if (socket.waitForConnected(500)) {
-        while (data.length() < 1024) {
-            if (!socket.waitForReadyRead(500)) {
-                if (data.length() > 0) {
-                    break;
-                } else {
-                    //qDebug() << socket.errorString();
-                    return false;
-                }
-            }
-            data += QString(socket.readAll());
-        }
-        socket.disconnectFromHost();
-        //on success retry fail count
+    m_pending = true;
+    m_refreshTimer.stop();
+    m_buffer.clear();
+    m_timeoutTimer.start();
+    m_socket->connectToHost(m_host, m_port);
+}
+
+void HddTemp::connected()
+{
+    // restart the timeout so that the daemon gets the full time to reply
+    m_timeoutTimer.start();
+}
+
+void HddTemp::readData()
+{
+    m_buffer += m_socket->readAll();
+    if (m_buffer.size() >= s_maxReplySize) {
+        m_socket->disconnectFromHost();
+    }
+}
+
+void HddTemp::finished()
+{
+    if (!m_pending) {
+        // already handled as a failure
+        return;
+    }
+    m_pending = false;
+    m_timeoutTimer.stop();
+
+    m_buffer += m_socket->readAll();
+    if (m_buffer.isEmpty()) {
+        scheduleNext(false);
+        return;
+    }
+
+    parse(m_buffer);
+    m_buffer.clear();
+    scheduleNext(true);
+}
+
+void HddTemp::failed()
+{
+    if (!m_pending) {
+        return;
+    }
+    m_pending = false;
+    m_timeoutTimer.stop();
+
+    m_buffer.clear();
+    m_socket->abort();
+    scheduleNext(false);
+}
+
+void HddTemp::scheduleNext(bool success)
+{
+    if (success) {
         m_failCount = 0;
     } else {
-        m_failCount++;
-        //qDebug() << socket.errorString();
-        return false;
+        ++m_failCount;
     }
-    const QStringList list = data.split('|');
+
+    m_refreshTimer.start(currentInterval());
+}
+
+void HddTemp::parse(const QByteArray &data)
+{
+    const QStringList list = QString::fromLocal8Bit(data).split(QLatin1Char('|'));
+    QMap<QString, QList<QVariant> > newData;
     int i = 1;
-    m_data.clear();
     while (i + 4 < list.size()) {
-        m_data[list[i]].append(list[i + 2]);
-        m_data[list[i]].append(list[i + 3]);
+        QList<QVariant> &values = newData[list[i]];
+        values.clear();
+        values.append(list[i + 2]);
+        values.append(list[i + 3]);
         i += 5;
     }
-    m_cacheValid = true;
-    startTimer(0);
 
-    return true;
+    if (newData != m_data) {
+        m_data = newData;
+        emit dataChanged();
+    }
 }
 
-QVariant HddTemp::data(const QString source, const DataType type) const
+QVariant HddTemp::data(const QString &source, const DataType type) const
 {
-    return m_data[source][type];
+    return m_data.value(source).value(type);
 }
-
-
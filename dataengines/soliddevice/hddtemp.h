@@ -27,27 +27,72 @@
 #include <QVariant>
 #include <QTimer>
 
+class QTcpSocket;
 
+/**
+ * Asynchronous client for the hddtemp daemon.
+ *
+ * The daemon is queried in the background on a fixed interval; sources() and
+ * data() only ever look at the last snapshot that was received, so they never
+ * block the caller. When the daemon is unreachable the refresh interval is
+ * doubled on every failure, up to a maximum.
+ */
 class HddTemp : public QObject
 {
     Q_OBJECT
 
     public:
         enum DataType {Temperature=0, Unit};
-        
+
         explicit HddTemp(QObject *parent = nullptr);
+        HddTemp(const QString &host, quint16 port, QObject *parent = nullptr);
         ~HddTemp() override;
-        QStringList sources();
-        QVariant data(const QString source, const DataType type) const;
+        QStringList sources() const;
+        QVariant data(const QString &source, const DataType type) const;
+
+        /**
+         * Sets the interval between two successful refreshes, in milliseconds.
+         */
+        void setRefreshInterval(int msec);
+        int refreshInterval() const;
 
-    protected:
-        void timerEvent(QTimerEvent *event) override;
+        /**
+         * The delay before the next connection attempt, in milliseconds.
+         */
+        int currentInterval() const;
+
+    public Q_SLOTS:
+        /**
+         * Starts a refresh now unless one is already in progress.
+         */
+        void refresh();
+
+    Q_SIGNALS:
+        /**
+         * Emitted when a refresh produced a snapshot that differs from the previous one.
+         */
+        void dataChanged();
+
+    private Q_SLOTS:
+        void connected();
+        void readData();
+        void finished();
+        void failed();
 
     private:
+        void scheduleNext(bool success);
+        void parse(const QByteArray &data);
+
+        QString m_host;
+        quint16 m_port;
+        QTcpSocket *m_socket;
+        QTimer m_refreshTimer;
+        QTimer m_timeoutTimer;
+        QByteArray m_buffer;
+        int m_refreshInterval;
         int m_failCount;
-        bool m_cacheValid;
+        bool m_pending;
         QMap<QString, QList<QVariant> > m_data;
-        bool updateData();
 };
 
 
@@ -18,8 +18,10 @@
 
 #include "soliddeviceengine.h"
 #include "soliddeviceservice.h"
+#include "freespacepoller.h"
 
 #include <QMetaEnum>
+#include <algorithm>
 #include <QDateTime>
 #include <Solid/GenericInterface>
 #include <klocalizedstring.h>
@@ -27,7 +29,6 @@
 #include <QApplication>
 #include <QDebug>
 #include <KFormat>
-#include <KIO/FileSystemFreeSpaceJob>
 #include <KNotification>
 
 #include <Plasma/DataContainer>
@@ -60,10 +61,18 @@ SolidDeviceEngine::SolidDeviceEngine(QObject* parent, const QVariantList& args)
     setMinimumPollingInterval(1000);
     connect(this, &Plasma::DataEngine::sourceRemoved,
             this, &SolidDeviceEngine::sourceWasRemoved);
+
+    connect(FreeSpacePoller::self(), &FreeSpacePoller::spaceChanged,
+            this, &SolidDeviceEngine::storageSpaceChanged);
+    connect(FreeSpacePoller::self(), &FreeSpacePoller::notResponding,
+            this, &SolidDeviceEngine::storageNotResponding);
 }
 
 SolidDeviceEngine::~SolidDeviceEngine()
 {
+    for (const QString &path : qAsConst(m_storagePaths)) {
+        FreeSpacePoller::self()->unwatch(path);
+    }
 }
 
 Plasma::Service* SolidDeviceEngine::serviceForSource(const QString& source)
@@ -115,6 +124,7 @@ bool SolidDeviceEngine::sourceRequestEvent(const QString &name)
 
 void SolidDeviceEngine::sourceWasRemoved(const QString &source)
 {
+    unwatchStorageSpace(source);
     m_devicemap.remove(source);
     m_predicatemap.remove(source);
 }
@@ -546,45 +556,65 @@ bool SolidDeviceEngine::updateStorageSpace(const QString &udi)
 
     Solid::StorageAccess *storageaccess = device.as<Solid::StorageAccess>();
     if (!storageaccess || !storageaccess->isAccessible()) {
+        unwatchStorageSpace(udi);
         return false;
     }
 
-    QString path = storageaccess->filePath();
-    if (!m_paths.contains(path)) {
-        QTimer *timer = new QTimer(this);
-        timer->setSingleShot(true);
-        connect(timer, &QTimer::timeout, [path]() {
-            KNotification::event(KNotification::Error, i18n("Filesystem is not responding"),
-                                 i18n("Filesystem mounted at '%1' is not responding", path));
-        });
+    const QString path = storageaccess->filePath();
+    const QString oldPath = m_storagePaths.value(udi);
+    if (path == oldPath) {
+        // the poller coalesces this with the requests of all other sources
+        FreeSpacePoller::self()->refresh();
+        return false;
+    }
 
-        m_paths.insert(path);
+    unwatchStorageSpace(udi);
+    m_storagePaths.insert(udi, path);
+    FreeSpacePoller::self()->watch(path);
 
-        // create job
-        KIO::FileSystemFreeSpaceJob *job = KIO::fileSystemFreeSpace(QUrl::fromLocalFile(path));
+    // another user of the poller may already know the values
+    quint64 size = 0;
+    quint64 available = 0;
+    if (FreeSpacePoller::self()->spaceInfo(path, &size, &available)) {
+        setStorageSpace(udi, size, available);
+        return true;
+    }
 
-        // delete later timer
-        connect(job, &KIO::FileSystemFreeSpaceJob::result, timer, &QTimer::deleteLater);
+    return false;
+}
 
-        // collect and process info
-        connect(job, &KIO::FileSystemFreeSpaceJob::result, this,
-                [this, timer, path, udi](KIO::Job *job, KIO::filesize_t size, KIO::filesize_t available) {
-            timer->stop();
+void SolidDeviceEngine::unwatchStorageSpace(const QString &udi)
+{
+    const QString path = m_storagePaths.take(udi);
+    if (!path.isEmpty()) {
+        FreeSpacePoller::self()->unwatch(path);
+    }
+}
 
-            if (!job->error()) {
-                setData(udi, I18N_NOOP("Free Space"), QVariant(available));
-                setData(udi, I18N_NOOP("Free Space Text"), KFormat().formatByteSize(available));
-                setData(udi, I18N_NOOP("Size"), QVariant(size));
-            }
+void SolidDeviceEngine::setStorageSpace(const QString &udi, quint64 size, quint64 available)
+{
+    setData(udi, I18N_NOOP("Free Space"), QVariant(available));
+    setData(udi, I18N_NOOP("Free Space Text"), KFormat().formatByteSize(available));
+    setData(udi, I18N_NOOP("Size"), QVariant(size));
+}
 
-            m_paths.remove(path);
-        });
+void SolidDeviceEngine::storageSpaceChanged(const QString &path, quint64 size, quint64 available)
+{
+    for (auto it = m_storagePaths.constBegin(); it != m_storagePaths.constEnd(); ++it) {
+        if (it.value() == path) {
+            setStorageSpace(it.key(), size, available);
+        }
+    }
+}
 
-        // start timer: after 15 seconds we will get an error
-        timer->start(15000);
+void SolidDeviceEngine::storageNotResponding(const QString &path)
+{
+    if (std::find(m_storagePaths.constBegin(), m_storagePaths.constEnd(), path) == m_storagePaths.constEnd()) {
+        return;
     }
 
-    return false;
+    KNotification::event(KNotification::Error, i18n("Filesystem is not responding"),
+                         i18n("Filesystem mounted at '%1' is not responding", path));
 }
 
 bool SolidDeviceEngine::updateHardDiskTemperature(const QString &udi)
@@ -597,6 +627,14 @@ bool SolidDeviceEngine::updateHardDiskTemperature(const QString &udi)
 
     if (!m_temperature) {
         m_temperature = new HddTemp(this);
+        // the daemon is queried asynchronously, publish the values once they arrive
+        connect(m_temperature, &HddTemp::dataChanged, this, [this]() {
+            foreach (const QString &driveUdi, m_devicemap.keys()) {
+                if (m_devicemap.value(driveUdi).is<Solid::StorageDrive>()) {
+                    updateHardDiskTemperature(driveUdi);
+                }
+            }
+        });
     }
 
     if (m_temperature->sources().contains(block->device())) {
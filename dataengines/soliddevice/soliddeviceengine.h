@@ -23,6 +23,7 @@
 #include <QString>
 #include <QList>
 #include <QMap>
+#include <QHash>
 #include <QPair>
 
 #include <solid/devicenotifier.h>
@@ -35,7 +36,6 @@
 #include "devicesignalmapmanager.h"
 #include "devicesignalmapper.h"
 #include "hddtemp.h"
-#include <KIO/FileSystemFreeSpaceJob>
 
 enum State {
     Idle = 0,
@@ -69,6 +69,8 @@ protected:
 private:
     bool populateDeviceData(const QString &name);
     bool updateStorageSpace(const QString &udi);
+    void unwatchStorageSpace(const QString &udi);
+    void setStorageSpace(const QString &udi, quint64 size, quint64 available);
     bool updateHardDiskTemperature(const QString &udi);
     bool updateEmblems(const QString &udi);
     bool updateInUse(const QString &udi);
@@ -81,8 +83,8 @@ private:
     QMap<QString, Solid::Device> m_devicemap;
     //udi, corresponding encrypted container udi;
     QMap<QString, QString> m_encryptedContainerMap;
-    //path, for pending file system free space jobs
-    QSet<QString> m_paths;
+    //udi, mount point watched with the free space poller
+    QHash<QString, QString> m_storagePaths;
     DeviceSignalMapManager *m_signalmanager;
 
     HddTemp *m_temperature;
@@ -97,6 +99,8 @@ private Q_SLOTS:
     void setUnmountingState(const QString &udi);
     void setIdleState(Solid::ErrorType error, QVariant errorData, const QString &udi);
     void deviceChanged(const QMap<QString,int> & props);
+    void storageSpaceChanged(const QString &path, quint64 size, quint64 available);
+    void storageNotResponding(const QString &path);
 };
 
 #endif
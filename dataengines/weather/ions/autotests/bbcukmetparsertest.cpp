@@ -0,0 +1,161 @@
+/********************************************************************
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+
+#include <QObject>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "../bbcukmet/ion_bbcukmetparsers.h"
+#include "chunkedfeed.h"
+
+/**
+ * The expected values are what the QXmlStreamReader based parsers of the
+ * ion read from the recorded feeds, before parsing became incremental.
+ */
+class BBCUKMETParserTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testObservation_data();
+    void testObservation();
+    void testForecast_data();
+    void testForecast();
+    void testNoFeed();
+
+    void benchmarkObservation();
+    void benchmarkForecast();
+};
+
+void BBCUKMETParserTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void BBCUKMETParserTest::testObservation_data()
+{
+    ChunkedFeed::addRows();
+}
+
+void BBCUKMETParserTest::testObservation()
+{
+    QFETCH(int, chunkSize);
+
+    UKMETIon::ObservationParser parser;
+    ChunkedFeed::feed(parser, ChunkedFeed::readFixture(QStringLiteral("bbcukmet-observation.xml")), chunkSize);
+    QVERIFY(parser.finish());
+    QVERIFY(parser.haveObservation);
+
+    const WeatherData &data = parser.data;
+    QCOMPARE(data.stationName, QStringLiteral("London, UK"));
+    QCOMPARE(data.obsTime, QStringLiteral("Sunday - 14:00 BST"));
+    // BST is no time zone id
+    QVERIFY(!data.observationDateTime.isValid());
+    QCOMPARE(data.condition, QStringLiteral("Light Cloud"));
+    QCOMPARE(data.temperature_C, 13.0f);
+    QCOMPARE(data.windDirection, QStringLiteral("South Westerly"));
+    QCOMPARE(data.windSpeed_miles, 9.0f);
+    QCOMPARE(data.humidity, 72.0f);
+    QCOMPARE(data.pressure, 1015.0f);
+    QCOMPARE(data.pressureTendency, QStringLiteral("rising"));
+    QCOMPARE(data.visibilityStr, QStringLiteral("Very Good"));
+    QCOMPARE(data.stationLatitude, 51.5081);
+    QCOMPARE(data.stationLongitude, -0.0761);
+    QVERIFY(data.isForecastsDataPending);
+}
+
+void BBCUKMETParserTest::testForecast_data()
+{
+    ChunkedFeed::addRows();
+}
+
+void BBCUKMETParserTest::testForecast()
+{
+    QFETCH(int, chunkSize);
+
+    // only its icon mappings are used by the parser
+    UKMETIon ion(nullptr, QVariantList());
+    UKMETIon::ForecastParser parser(&ion);
+    ChunkedFeed::feed(parser, ChunkedFeed::readFixture(QStringLiteral("bbcukmet-forecast.xml")), chunkSize);
+    QVERIFY(parser.finish());
+    QVERIFY(parser.haveFiveDay);
+
+    // not the <atom:link> next to it
+    QCOMPARE(parser.forecastHTMLUrl, QStringLiteral("https://www.bbc.co.uk/weather/2643743"));
+    QCOMPARE(parser.forecasts.size(), 3);
+
+    const WeatherData::ForecastInfo &tonight = parser.forecasts.at(0);
+    QCOMPARE(tonight.period, QStringLiteral("Tonight"));
+    QCOMPARE(tonight.summary, QStringLiteral("Clear Sky"));
+    QCOMPARE(tonight.iconName, QStringLiteral("weather-clear-night"));
+    QCOMPARE(tonight.tempLow, 6.0f);
+    QVERIFY(qIsNaN(tonight.tempHigh));
+
+    const WeatherData::ForecastInfo &monday = parser.forecasts.at(1);
+    QCOMPARE(monday.period, QStringLiteral("Monday"));
+    QCOMPARE(monday.summary, QStringLiteral("Light Rain Showers"));
+    QCOMPARE(monday.iconName, QStringLiteral("weather-showers-scattered"));
+    QCOMPARE(monday.tempLow, 7.0f);
+    QCOMPARE(monday.tempHigh, 14.0f);
+
+    const WeatherData::ForecastInfo &tuesday = parser.forecasts.at(2);
+    QCOMPARE(tuesday.period, QStringLiteral("Tuesday"));
+    QCOMPARE(tuesday.summary, QStringLiteral("Sunny Intervals"));
+    QCOMPARE(tuesday.iconName, QStringLiteral("weather-clouds"));
+    QCOMPARE(tuesday.tempLow, -1.0f);
+    QCOMPARE(tuesday.tempHigh, 12.0f);
+}
+
+void BBCUKMETParserTest::testNoFeed()
+{
+    // an error page instead of the feed
+    UKMETIon::ObservationParser parser;
+    parser.addData(QByteArrayLiteral("<html><body>Not found</body></html>"));
+    QVERIFY(parser.finish());
+    QVERIFY(!parser.haveObservation);
+}
+
+void BBCUKMETParserTest::benchmarkObservation()
+{
+    const QByteArray data = ChunkedFeed::readFixture(QStringLiteral("bbcukmet-observation.xml"));
+
+    QBENCHMARK {
+        UKMETIon::ObservationParser parser;
+        ChunkedFeed::feed(parser, data, 1460);
+        QVERIFY(parser.finish());
+    }
+}
+
+void BBCUKMETParserTest::benchmarkForecast()
+{
+    const QByteArray data = ChunkedFeed::readFixture(QStringLiteral("bbcukmet-forecast.xml"));
+    UKMETIon ion(nullptr, QVariantList());
+
+    QBENCHMARK {
+        UKMETIon::ForecastParser parser(&ion);
+        ChunkedFeed::feed(parser, data, 1460);
+        QVERIFY(parser.finish());
+    }
+}
+
+QTEST_MAIN(BBCUKMETParserTest)
+
+#include "bbcukmetparsertest.moc"
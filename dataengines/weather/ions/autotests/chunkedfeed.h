@@ -0,0 +1,81 @@
+/********************************************************************
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef CHUNKEDFEED_H
+#define CHUNKEDFEED_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QTest>
+
+#include <random>
+
+#include "../incrementalxmlparser.h"
+
+/**
+ * Helpers to hand a recorded document to a parser the way a download
+ * would, in chunks that split tags, entities and multi-byte characters.
+ */
+namespace ChunkedFeed
+{
+    // a chunk size of 0 passes the whole document at once, -1 random sizes
+    enum {
+        Whole = 0,
+        Random = -1
+    };
+
+    inline void addRows()
+    {
+        QTest::addColumn<int>("chunkSize");
+
+        QTest::newRow("whole") << int(Whole);
+        QTest::newRow("bytes") << 1;
+        QTest::newRow("odd") << 7;
+        QTest::newRow("packets") << 1460;
+        QTest::newRow("random") << int(Random);
+    }
+
+    inline void feed(IncrementalXmlParser &parser, const QByteArray &data, int chunkSize)
+    {
+        if (chunkSize == Whole) {
+            parser.addData(data);
+            return;
+        }
+
+        // fixed seed, so failures can be reproduced
+        std::minstd_rand random(42);
+        std::uniform_int_distribution<int> randomSize(1, 256);
+
+        for (int pos = 0; pos < data.size();) {
+            const int size = chunkSize == Random ? randomSize(random) : chunkSize;
+            parser.addData(data.mid(pos, size));
+            pos += size;
+        }
+    }
+
+    inline QByteArray readFixture(const QString &fileName)
+    {
+        QFile file(QFINDTESTDATA(QStringLiteral("data/") + fileName));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qFatal("Missing fixture %s", qPrintable(fileName));
+        }
+        return file.readAll();
+    }
+}
+
+#endif
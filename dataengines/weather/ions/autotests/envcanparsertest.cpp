@@ -0,0 +1,168 @@
+/********************************************************************
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+
+#include <QObject>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "../envcan/ion_envcanparsers.h"
+#include "chunkedfeed.h"
+
+/**
+ * The expected values are what the QXmlStreamReader based parser of the
+ * ion read from the recorded city page, before parsing became incremental.
+ */
+class EnvCanParserTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testCityPage_data();
+    void testCityPage();
+
+    void benchmarkCityPage();
+};
+
+void EnvCanParserTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void EnvCanParserTest::testCityPage_data()
+{
+    ChunkedFeed::addRows();
+}
+
+void EnvCanParserTest::testCityPage()
+{
+    QFETCH(int, chunkSize);
+
+    // only its icon mappings are used by the parser
+    EnvCanadaIon ion(nullptr, QVariantList());
+    EnvCanadaIon::WeatherParser parser(&ion);
+    ChunkedFeed::feed(parser, ChunkedFeed::readFixture(QStringLiteral("envcan-citypage.xml")), chunkSize);
+    QVERIFY(parser.finish());
+
+    const WeatherData &data = parser.data;
+    QCOMPARE(data.creditUrl, QStringLiteral("https://dd.weather.gc.ca/doc/LICENCE_GENERAL.txt"));
+    QCOMPARE(data.countryName, QStringLiteral("Canada"));
+    QCOMPARE(data.longTerritoryName, QStringLiteral("Quebec"));
+    QCOMPARE(data.cityName, QStringLiteral("Montréal"));
+    QCOMPARE(data.regionName, QStringLiteral("Montréal"));
+
+    // warnings and watches, statements are left out
+    QCOMPARE(data.warnings.size(), 1);
+    QCOMPARE(data.warnings.at(0).url, QStringLiteral("https://weather.gc.ca/warnings/report_e.html?qc147"));
+    QCOMPARE(data.warnings.at(0).type, QStringLiteral("warning"));
+    QCOMPARE(data.warnings.at(0).priority, QStringLiteral("high"));
+    QCOMPARE(data.warnings.at(0).description, QStringLiteral("RAINFALL WARNING  IN EFFECT"));
+    QCOMPARE(data.warnings.at(0).timestamp, QStringLiteral("Sunday October 18, 2026 at 08:30 EDT"));
+    QCOMPARE(data.watches.size(), 1);
+    QCOMPARE(data.watches.at(0).url, QStringLiteral("https://weather.gc.ca/warnings/report_e.html?qc147"));
+    QCOMPARE(data.watches.at(0).type, QStringLiteral("watch"));
+    QCOMPARE(data.watches.at(0).priority, QStringLiteral("medium"));
+    QCOMPARE(data.watches.at(0).description, QStringLiteral("SEVERE THUNDERSTORM WATCH  IN EFFECT"));
+    QCOMPARE(data.watches.at(0).timestamp, QStringLiteral("Sunday October 18, 2026 at 09:15 EDT"));
+
+    // current conditions
+    QCOMPARE(data.stationID, QStringLiteral("yul"));
+    QCOMPARE(data.stationLatitude, 45.47);
+    QCOMPARE(data.stationLongitude, 73.74);
+    // EDT is no time zone id, so the offset is used
+    QCOMPARE(data.observationDateTime,
+             QDateTime(QDate(2026, 10, 18), QTime(10, 0), Qt::OffsetFromUTC, -4 * 3600));
+    QCOMPARE(data.obsTimestamp, QStringLiteral("18.10.2026 @ 10:00"));
+    QCOMPARE(data.condition, QStringLiteral("Mostly Cloudy"));
+    QCOMPARE(data.temperature, 12.4f);
+    QCOMPARE(data.dewpoint, 8.1f);
+    QCOMPARE(data.pressure, 101.2f);
+    QCOMPARE(data.pressureTendency, QStringLiteral("falling"));
+    QCOMPARE(data.visibility, 24.1f);
+    QCOMPARE(data.humidity, 75.0f);
+    QCOMPARE(data.windSpeed, 19.0f);
+    QCOMPARE(data.windGust, 33.0f);
+    QCOMPARE(data.windDirection, QStringLiteral("SW"));
+
+    // forecasts
+    QCOMPARE(data.forecastTimestamp, QStringLiteral("Sunday October 18, 2026 at 05:30 EDT"));
+    QCOMPARE(data.normalHigh, 13.0f);
+    QCOMPARE(data.normalLow, 4.0f);
+    QCOMPARE(data.UVRating, QStringLiteral("low"));
+    QCOMPARE(data.UVIndex, QStringLiteral("2"));
+    QCOMPARE(data.forecasts.size(), 3);
+
+    const WeatherData::ForecastInfo &today = data.forecasts.at(0);
+    QCOMPARE(today.forecastPeriod, QStringLiteral("Today"));
+    QCOMPARE(today.shortForecast, QStringLiteral("Chance of showers"));
+    QCOMPARE(today.iconName, QStringLiteral("weather-showers-scattered-day"));
+    QCOMPARE(today.popPrecent, 60.0f);
+    QCOMPARE(today.tempHigh, 14.0f);
+    QVERIFY(qIsNaN(today.tempLow));
+    QCOMPARE(today.windForecast, QStringLiteral("Wind southwest 20 km/h gusting to 40."));
+    QCOMPARE(today.precipType, QStringLiteral("rain"));
+    QVERIFY(today.forecastSummary.startsWith(QLatin1String("Cloudy. 60 percent chance of showers")));
+
+    const WeatherData::ForecastInfo &tonight = data.forecasts.at(1);
+    QCOMPARE(tonight.forecastPeriod, QStringLiteral("Tonight"));
+    QCOMPARE(tonight.shortForecast, QStringLiteral("Clearing"));
+    QCOMPARE(tonight.iconName, QStringLiteral("weather-clear-night"));
+    QCOMPARE(tonight.popPrecent, 40.0f);
+    QVERIFY(qIsNaN(tonight.tempHigh));
+    QCOMPARE(tonight.tempLow, 5.0f);
+    QCOMPARE(tonight.precipForecast, QStringLiteral("Showers ending this evening."));
+    QCOMPARE(tonight.precipType, QStringLiteral("rain"));
+    QCOMPARE(tonight.precipTotalExpected, QStringLiteral("5"));
+
+    const WeatherData::ForecastInfo &monday = data.forecasts.at(2);
+    QCOMPARE(monday.forecastPeriod, QStringLiteral("Monday"));
+    QCOMPARE(monday.shortForecast, QStringLiteral("A mix of sun and cloud"));
+    QCOMPARE(monday.iconName, QStringLiteral("weather-clouds"));
+    QVERIFY(qIsNaN(monday.popPrecent));
+    QCOMPARE(monday.tempHigh, 11.0f);
+
+    // yesterday, sun and records
+    QCOMPARE(data.prevHigh, 15.3f);
+    QCOMPARE(data.prevLow, 7.9f);
+    QCOMPARE(data.prevPrecipType, QStringLiteral("mm"));
+    QCOMPARE(data.prevPrecipTotal, QStringLiteral("2.4"));
+    QCOMPARE(data.sunriseTimestamp, QStringLiteral("Sunday October 18, 2026 at 07:14 EDT"));
+    QCOMPARE(data.sunsetTimestamp, QStringLiteral("Sunday October 18, 2026 at 18:09 EDT"));
+    QCOMPARE(data.recordHigh, 26.1f);
+    QCOMPARE(data.recordLow, -3.9f);
+    QCOMPARE(data.recordRain, 40.6f);
+    QCOMPARE(data.recordSnow, 2.0f);
+}
+
+void EnvCanParserTest::benchmarkCityPage()
+{
+    const QByteArray data = ChunkedFeed::readFixture(QStringLiteral("envcan-citypage.xml"));
+    EnvCanadaIon ion(nullptr, QVariantList());
+
+    QBENCHMARK {
+        EnvCanadaIon::WeatherParser parser(&ion);
+        ChunkedFeed::feed(parser, data, 1460);
+        QVERIFY(parser.finish());
+    }
+}
+
+QTEST_MAIN(EnvCanParserTest)
+
+#include "envcanparsertest.moc"
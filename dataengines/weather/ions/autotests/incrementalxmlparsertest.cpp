@@ -0,0 +1,228 @@
+/********************************************************************
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+
+#include <QObject>
+#include <QStringList>
+#include <QTest>
+#include <QtConcurrent>
+
+#include <numeric>
+
+#include "../incrementalxmlparser.h"
+#include "chunkedfeed.h"
+
+namespace
+{
+    /**
+     * Writes down every event, with the depth and parent it was reported at
+     */
+    class RecordingParser : public IncrementalXmlParser
+    {
+    public:
+        QStringList events;
+
+    protected:
+        void startElement(const QStringRef &name, const QXmlStreamAttributes &attributes) override
+        {
+            events << QStringLiteral("start %1 depth=%2 parent=%3 id=%4")
+                          .arg(name.toString())
+                          .arg(depth())
+                          .arg(parentName())
+                          .arg(attributes.value(QStringLiteral("id")).toString());
+        }
+
+        void endElement(const QStringRef &name, const QString &text) override
+        {
+            events << QStringLiteral("end %1 depth=%2 grandparent=%3 id=%4 text=%5")
+                          .arg(name.toString())
+                          .arg(depth())
+                          .arg(parentName(2))
+                          .arg(attributes().value(QStringLiteral("id")).toString())
+                          .arg(text.trimmed());
+        }
+    };
+}
+
+class IncrementalXmlParserTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testEvents_data();
+    void testEvents();
+    void testIncomplete();
+    void testMalformed();
+    void testNamespace();
+    void testIntern();
+    void testInternThreads();
+
+    void benchmarkParse_data();
+    void benchmarkParse();
+
+private:
+    static QByteArray document();
+};
+
+QByteArray IncrementalXmlParserTest::document()
+{
+    return QByteArrayLiteral("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                             "<root>\n"
+                             "  <place id=\"1\">Z\xc3\xbcrich &amp; <![CDATA[<Bern>]]></place>\n"
+                             "  <place id=\"2\"><name>Montr\xc3\xa9" "al</name>-5\xc2\xb0" "C</place>\n"
+                             "  <!-- a comment -->\n"
+                             "  <empty/>\n"
+                             "</root>\n");
+}
+
+void IncrementalXmlParserTest::testEvents_data()
+{
+    ChunkedFeed::addRows();
+}
+
+void IncrementalXmlParserTest::testEvents()
+{
+    QFETCH(int, chunkSize);
+
+    RecordingParser parser;
+    ChunkedFeed::feed(parser, document(), chunkSize);
+    QVERIFY(!parser.hasError());
+    QVERIFY(parser.finish());
+
+    // the text of an element is only its own, not that of its children
+    const QStringList expected{
+        QStringLiteral("start root depth=1 parent= id="),
+        QStringLiteral("start place depth=2 parent=root id=1"),
+        QStringLiteral("end place depth=2 grandparent= id=1 text=Zürich & <Bern>"),
+        QStringLiteral("start place depth=2 parent=root id=2"),
+        QStringLiteral("start name depth=3 parent=place id="),
+        QStringLiteral("end name depth=3 grandparent=root id= text=Montréal"),
+        QStringLiteral("end place depth=2 grandparent= id=2 text=-5°C"),
+        QStringLiteral("start empty depth=2 parent=root id="),
+        QStringLiteral("end empty depth=2 grandparent= id= text="),
+        QStringLiteral("end root depth=1 grandparent= id= text="),
+    };
+    QCOMPARE(parser.events, expected);
+}
+
+void IncrementalXmlParserTest::testIncomplete()
+{
+    const QByteArray data = document();
+
+    RecordingParser parser;
+    parser.addData(data.left(data.indexOf("<empty/>")));
+
+    // running out of data is no error while downloading, but a truncated document is
+    QVERIFY(!parser.hasError());
+    QCOMPARE(parser.events.size(), 7);
+    QVERIFY(!parser.finish());
+}
+
+void IncrementalXmlParserTest::testMalformed()
+{
+    RecordingParser parser;
+    parser.addData(QByteArrayLiteral("<root><a>text</b></root>"));
+    QVERIFY(parser.hasError());
+    QVERIFY(!parser.errorString().isEmpty());
+    QVERIFY(!parser.finish());
+
+    // the events before the error were reported
+    QCOMPARE(parser.events.first(), QStringLiteral("start root depth=1 parent= id="));
+}
+
+void IncrementalXmlParserTest::testNamespace()
+{
+    class NamespaceParser : public IncrementalXmlParser
+    {
+    public:
+        QStringList uris;
+
+    protected:
+        void endElement(const QStringRef &name, const QString &text) override
+        {
+            Q_UNUSED(text)
+            uris << name.toString() + QLatin1Char(' ') + namespaceUri().toString();
+        }
+    };
+
+    NamespaceParser parser;
+    parser.addData(QByteArrayLiteral("<rss xmlns:georss=\"http://www.georss.org/georss\"><link/><georss:point/></rss>"));
+    QVERIFY(parser.finish());
+    QCOMPARE(parser.uris, (QStringList{QStringLiteral("link "),
+                                       QStringLiteral("point http://www.georss.org/georss"),
+                                       QStringLiteral("rss ")}));
+}
+
+void IncrementalXmlParserTest::testIntern()
+{
+    const QString first = QStringLiteral("Partly") + QStringLiteral(" Cloudy");
+    const QString second = QStringLiteral("Partly Cl") + QStringLiteral("oudy");
+    QVERIFY(first.constData() != second.constData());
+
+    const QString internedFirst = IncrementalXmlParser::intern(first);
+    const QString internedSecond = IncrementalXmlParser::intern(second);
+    QCOMPARE(internedFirst, first);
+    QCOMPARE(internedSecond, second);
+    QCOMPARE(internedSecond.constData(), internedFirst.constData());
+}
+
+void IncrementalXmlParserTest::testInternThreads()
+{
+    // the weather engines of several applets may parse at the same time
+    QVector<int> runs(8);
+    std::iota(runs.begin(), runs.end(), 0);
+
+    const QVector<QString> interned = QtConcurrent::blockingMapped<QVector<QString>>(runs, [](int run) {
+        for (int i = 0; i < 2000; ++i) {
+            IncrementalXmlParser::intern(QStringLiteral("condition %1").arg((i + run) % 100));
+        }
+        return IncrementalXmlParser::intern(QStringLiteral("condition 42"));
+    });
+
+    for (const QString &string : interned) {
+        QCOMPARE(string, QStringLiteral("condition 42"));
+        QCOMPARE(string.constData(), interned.first().constData());
+    }
+}
+
+void IncrementalXmlParserTest::benchmarkParse_data()
+{
+    ChunkedFeed::addRows();
+}
+
+void IncrementalXmlParserTest::benchmarkParse()
+{
+    QFETCH(int, chunkSize);
+
+    QByteArray data("<root>");
+    for (int i = 0; i < 2000; ++i) {
+        data += "<forecast id=\"" + QByteArray::number(i) + "\"><period>Tonight</period>"
+                "<summary>Chance of showers</summary><high>14</high><low>5</low></forecast>";
+    }
+    data += "</root>";
+
+    QBENCHMARK {
+        RecordingParser parser;
+        ChunkedFeed::feed(parser, data, chunkSize);
+        QVERIFY(parser.finish());
+    }
+}
+
+QTEST_MAIN(IncrementalXmlParserTest)
+
+#include "incrementalxmlparsertest.moc"
@@ -0,0 +1,260 @@
+/********************************************************************
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include <QObject>
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTest>
+
+#include "../ion.h"
+
+static const int s_timeout = 10000;
+
+/**
+ * A web server with a single page: answers every request with the reply
+ * and closes the connection, keeping the requests it got
+ */
+class FakeHttpServer : public QTcpServer
+{
+public:
+    explicit FakeHttpServer(QObject *parent = nullptr)
+        : QTcpServer(parent)
+    {
+        connect(this, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket *socket = nextPendingConnection()) {
+                connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+                connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+                    QByteArray &request = m_pending[socket];
+                    request += socket->readAll();
+                    if (!request.contains("\r\n\r\n")) {
+                        return;
+                    }
+                    requests << m_pending.take(socket);
+                    socket->write(reply);
+                    socket->disconnectFromHost();
+                });
+            }
+        });
+    }
+
+    QUrl url() const
+    {
+        return QUrl(QStringLiteral("http://127.0.0.1:%1/forecast.xml").arg(serverPort()));
+    }
+
+    static QByteArray ok(const QByteArray &body, const QByteArray &headers)
+    {
+        return QByteArrayLiteral("HTTP/1.1 200 OK\r\n")
+            + "Content-Type: text/xml\r\n"
+            + "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+            + "Connection: close\r\n"
+            + headers
+            + "\r\n"
+            + body;
+    }
+
+    QByteArray reply;
+    QList<QByteArray> requests;
+
+private:
+    QHash<QTcpSocket *, QByteArray> m_pending;
+};
+
+class TestIon : public IonInterface
+{
+public:
+    using IonInterface::fetch;
+
+    void reset() override {}
+
+protected:
+    bool updateIonSource(const QString &source) override
+    {
+        Q_UNUSED(source)
+        return true;
+    }
+};
+
+/**
+ * What a fetch handed to its callback
+ */
+struct FetchResult
+{
+    IonInterface::FetchCallback callback()
+    {
+        return [this](const QByteArray &data, const QStringList &sources) {
+            ++calls;
+            this->data = data;
+            this->sources = sources;
+        };
+    }
+
+    int calls = 0;
+    QByteArray data;
+    QStringList sources;
+};
+
+class IonFetchTest : public QObject
+{
+Q_OBJECT
+
+private Q_SLOTS:
+    void testSharedFetch();
+    void testMaxAge();
+    void testExpiry();
+    void testNoStore();
+    void testNotModified();
+    void testFailure();
+};
+
+void IonFetchTest::testSharedFetch()
+{
+    FakeHttpServer server;
+    server.reply = FakeHttpServer::ok(QByteArrayLiteral("<forecast/>"), QByteArray());
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    TestIon ion;
+    FetchResult result;
+    ion.fetch(server.url(), QStringLiteral("place1"), result.callback());
+    ion.fetch(server.url(), QStringLiteral("place2"), result.callback());
+    ion.fetch(server.url(), QStringLiteral("place1"), result.callback());
+
+    // downloaded once, for all sources which asked meanwhile
+    QTRY_COMPARE_WITH_TIMEOUT(result.calls, 1, s_timeout);
+    QCOMPARE(result.data, QByteArrayLiteral("<forecast/>"));
+    QCOMPARE(result.sources, QStringList({QStringLiteral("place1"), QStringLiteral("place2")}));
+    QCOMPARE(server.requests.count(), 1);
+}
+
+void IonFetchTest::testMaxAge()
+{
+    FakeHttpServer server;
+    server.reply = FakeHttpServer::ok(QByteArrayLiteral("<forecast/>"), QByteArrayLiteral("Cache-Control: public, max-age=600\r\n"));
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    TestIon ion;
+    FetchResult result;
+    ion.fetch(server.url(), QStringLiteral("place1"), result.callback());
+    QTRY_COMPARE_WITH_TIMEOUT(result.calls, 1, s_timeout);
+
+    // a fresh response is used without asking the server
+    ion.fetch(server.url(), QStringLiteral("place2"), result.callback());
+    QCOMPARE(result.calls, 1);
+    QTRY_COMPARE_WITH_TIMEOUT(result.calls, 2, s_timeout);
+    QCOMPARE(result.data, QByteArrayLiteral("<forecast/>"));
+    QCOMPARE(result.sources, QStringList({QStringLiteral("place2")}));
+    QCOMPARE(server.requests.count(), 1);
+}
+
+void IonFetchTest::testExpiry()
+{
+    FakeHttpServer server;
+    server.reply = FakeHttpServer::ok(QByteArrayLiteral("<forecast day=\"1\"/>"), QByteArrayLiteral("Cache-Control: max-age=1\r\n"));
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    TestIon ion;
+    FetchResult result;
+    ion.fetch(server.url(), QStringLiteral("place1"), result.callback());
+    QTRY_COMPARE_WITH_TIMEOUT(result.calls, 1, s_timeout);
+
+    QTest::qWait(1500);
+
+    // without validators an expired response is simply downloaded again
+    server.reply = FakeHttpServer::ok(QByteArrayLiteral("<forecast day=\"2\"/>"), QByteArray());
+    ion.fetch(server.url(), QStringLiteral("place1"), result.callback());
+    QTRY_COMPARE_WITH_TIMEOUT(result.calls, 2, s_timeout);
+    QCOMPARE(result.data, QByteArrayLiteral("<forecast day=\"2\"/>"));
+    QCOMPARE(server.requests.count(), 2);
+    QVERIFY(!server.requests.last().contains("If-None-Match"));
+    QVERIFY(!server.requests.last().contains("If-Modified-Since"));
+}
+
+void IonFetchTest::testNoStore()
+{
+    FakeHttpServer server;
+    server.reply = FakeHttpServer::ok(QByteArrayLiteral("<forecast/>"), QByteArrayLiteral("Cache-Control: max-age=600, no-store\r\nETag: \"v1\"\r\n"));
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    TestIon ion;
+    FetchResult result;
+    ion.fetch(server.url(), QStringLiteral("place1"), result.callback());
+    QTRY_COMPARE_WITH_TIMEOUT(result.calls, 1, s_timeout);
+
+    ion.fetch(server.url(), QStringLiteral("place1"), result.callback());
+    QTRY_COMPARE_WITH_TIMEOUT(result.calls, 2, s_timeout);
+    QCOMPARE(server.requests.count(), 2);
+    QVERIFY(!server.requests.last().contains("If-None-Match"));
+}
+
+void IonFetchTest::testNotModified()
+{
+    FakeHttpServer server;
+    server.reply = FakeHttpServer::ok(QByteArrayLiteral("<forecast/>"),
+                                      QByteArrayLiteral("Cache-Control: no-cache\r\n"
+                                                        "ETag: \"v1\"\r\n"
+                                                        "Last-Modified: Sun, 18 Oct 2026 10:00:00 GMT\r\n"));
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    TestIon ion;
+    FetchResult result;
+    ion.fetch(server.url(), QStringLiteral("place1"), result.callback());
+    QTRY_COMPARE_WITH_TIMEOUT(result.calls, 1, s_timeout);
+
+    // the stale response is revalidated, and kept when the server says so
+    server.reply = QByteArrayLiteral("HTTP/1.1 304 Not Modified\r\n"
+                                     "Cache-Control: max-age=600\r\n"
+                                     "Connection: close\r\n"
+                                     "\r\n");
+    ion.fetch(server.url(), QStringLiteral("place1"), result.callback());
+    QTRY_COMPARE_WITH_TIMEOUT(result.calls, 2, s_timeout);
+    QCOMPARE(result.data, QByteArrayLiteral("<forecast/>"));
+    QCOMPARE(server.requests.count(), 2);
+    QVERIFY(server.requests.last().contains("If-None-Match: \"v1\""));
+    QVERIFY(server.requests.last().contains("If-Modified-Since: Sun, 18 Oct 2026 10:00:00 GMT"));
+
+    // the 304 refreshed how long the response may be used
+    ion.fetch(server.url(), QStringLiteral("place1"), result.callback());
+    QTRY_COMPARE_WITH_TIMEOUT(result.calls, 3, s_timeout);
+    QCOMPARE(result.data, QByteArrayLiteral("<forecast/>"));
+    QCOMPARE(server.requests.count(), 2);
+}
+
+void IonFetchTest::testFailure()
+{
+    // find a port nobody listens on
+    QUrl url;
+    {
+        FakeHttpServer server;
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+        url = server.url();
+    }
+
+    TestIon ion;
+    FetchResult result;
+    ion.fetch(url, QStringLiteral("place1"), result.callback());
+    ion.fetch(url, QStringLiteral("place2"), result.callback());
+
+    QTRY_COMPARE_WITH_TIMEOUT(result.calls, 1, s_timeout);
+    QVERIFY(result.data.isEmpty());
+    QCOMPARE(result.sources, QStringList({QStringLiteral("place1"), QStringLiteral("place2")}));
+}
+
+QTEST_MAIN(IonFetchTest)
+
+#include "ionfetchtest.moc"
@@ -0,0 +1,169 @@
+/********************************************************************
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+
+#include <QLocale>
+#include <QObject>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "../noaa/ion_noaaparsers.h"
+#include "chunkedfeed.h"
+
+/**
+ * The expected values are what the QXmlStreamReader based parsers of the
+ * ion read from the recorded documents, before parsing became incremental.
+ */
+class NOAAParserTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testObservation_data();
+    void testObservation();
+    void testForecast_data();
+    void testForecast();
+    void testTruncated();
+
+    void benchmarkObservation();
+    void benchmarkForecast();
+};
+
+void NOAAParserTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void NOAAParserTest::testObservation_data()
+{
+    ChunkedFeed::addRows();
+}
+
+void NOAAParserTest::testObservation()
+{
+    QFETCH(int, chunkSize);
+
+    NOAAIon::ObservationParser parser;
+    ChunkedFeed::feed(parser, ChunkedFeed::readFixture(QStringLiteral("noaa-observation.xml")), chunkSize);
+    QVERIFY(parser.finish());
+
+    const WeatherData &data = parser.data;
+    QCOMPARE(data.locationName, QStringLiteral("New York City, Central Park, NY"));
+    QCOMPARE(data.stationID, QStringLiteral("KNYC"));
+    QCOMPARE(data.stationLatitude, 40.78333);
+    QCOMPARE(data.stationLongitude, -73.96667);
+    QCOMPARE(data.observationTime, QStringLiteral("9:51 am"));
+    QCOMPARE(data.observationDateTime,
+             QDateTime(QDate(2026, 10, 18), QTime(9, 51), Qt::OffsetFromUTC, -4 * 3600));
+    QCOMPARE(data.weather, QStringLiteral("Partly Cloudy"));
+    QCOMPARE(data.temperature_F, 54.0f);
+    QCOMPARE(data.temperature_C, 12.2f);
+    QCOMPARE(data.humidity, 67.0f);
+    QCOMPARE(data.windDirection, QStringLiteral("Northwest"));
+    QCOMPARE(data.windSpeed, 6.9f);
+    // "NA" when there are no gusts
+    QCOMPARE(data.windGust, 0.0f);
+    QCOMPARE(data.pressure, 30.08f);
+    QCOMPARE(data.dewpoint_F, 43.0f);
+    QCOMPARE(data.dewpoint_C, 6.1f);
+    QCOMPARE(data.windchill_F, 52.0f);
+    QCOMPARE(data.windchill_C, 11.0f);
+    QVERIFY(qIsNaN(data.heatindex_F));
+    QVERIFY(qIsNaN(data.heatindex_C));
+    QCOMPARE(data.visibility, 10.0f);
+    QVERIFY(data.isForecastsDataPending);
+}
+
+void NOAAParserTest::testForecast_data()
+{
+    ChunkedFeed::addRows();
+}
+
+void NOAAParserTest::testForecast()
+{
+    QFETCH(int, chunkSize);
+
+    NOAAIon::ForecastParser parser;
+    ChunkedFeed::feed(parser, ChunkedFeed::readFixture(QStringLiteral("noaa-forecast.xml")), chunkSize);
+    QVERIFY(parser.finish());
+
+    const QStringList summaries{
+        QStringLiteral("Partly Sunny"), QStringLiteral("Chance Showers"), QStringLiteral("Rain Likely"),
+        QStringLiteral("Mostly Sunny"), QStringLiteral("Sunny"), QStringLiteral("Partly Sunny"),
+        QStringLiteral("Slight Chance Rain"),
+    };
+    const QStringList highs{
+        QStringLiteral("61"), QStringLiteral("64"), QStringLiteral("58"), QStringLiteral("55"),
+        QStringLiteral("57"), QStringLiteral("60"), QStringLiteral("62"),
+    };
+    // the night of the last day is not forecast yet
+    const QStringList lows{
+        QStringLiteral("48"), QStringLiteral("50"), QStringLiteral("45"), QStringLiteral("41"),
+        QStringLiteral("44"), QStringLiteral("47"), QString(),
+    };
+
+    QCOMPARE(parser.forecasts.size(), 7);
+    for (int i = 0; i < parser.forecasts.size(); ++i) {
+        const WeatherData::Forecast &forecast = parser.forecasts.at(i);
+        QCOMPARE(forecast.day, QLocale().toString(18 + i));
+        QCOMPARE(forecast.summary, summaries.at(i));
+        QCOMPARE(forecast.high, highs.at(i));
+        QCOMPARE(forecast.low, lows.at(i));
+    }
+
+    // the same summary on two days is interned
+    QCOMPARE(parser.forecasts.at(5).summary.constData(), parser.forecasts.at(0).summary.constData());
+}
+
+void NOAAParserTest::testTruncated()
+{
+    const QByteArray data = ChunkedFeed::readFixture(QStringLiteral("noaa-forecast.xml"));
+
+    NOAAIon::ForecastParser parser;
+    parser.addData(data.left(data.size() / 2));
+    QVERIFY(!parser.hasError());
+    QVERIFY(!parser.finish());
+}
+
+void NOAAParserTest::benchmarkObservation()
+{
+    const QByteArray data = ChunkedFeed::readFixture(QStringLiteral("noaa-observation.xml"));
+
+    QBENCHMARK {
+        NOAAIon::ObservationParser parser;
+        ChunkedFeed::feed(parser, data, 1460);
+        QVERIFY(parser.finish());
+    }
+}
+
+void NOAAParserTest::benchmarkForecast()
+{
+    const QByteArray data = ChunkedFeed::readFixture(QStringLiteral("noaa-forecast.xml"));
+
+    QBENCHMARK {
+        NOAAIon::ForecastParser parser;
+        ChunkedFeed::feed(parser, data, 1460);
+        QVERIFY(parser.finish());
+    }
+}
+
+QTEST_MAIN(NOAAParserTest)
+
+#include "noaaparsertest.moc"
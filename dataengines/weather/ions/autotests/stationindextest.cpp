@@ -0,0 +1,368 @@
+/********************************************************************
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+
+#include <QFile>
+#include <QObject>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "../stationindex.h"
+
+class StationIndexTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+
+    void testEmpty();
+    void testUpdateAndLoad();
+    void testCorruptFile_data();
+    void testCorruptFile();
+    void testConditionalRequestHeaders();
+    void testParseResponseHeaders();
+    void testSearch_data();
+    void testSearch();
+    void testFind();
+    void testFindByField();
+
+    void benchmarkLoad();
+    void benchmarkSearch_data();
+    void benchmarkSearch();
+    void benchmarkFindByField();
+
+private:
+    static QString fileName(const QString &name);
+    static QVector<QStringList> stations();
+    static QVector<QStringList> manyStations();
+    static QStringList places(const StationIndex &index, const QVector<int> &result);
+};
+
+QString StationIndexTest::fileName(const QString &name)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + QLatin1String("/plasma_engine_weather/") + name + QLatin1String(".stations");
+}
+
+QVector<QStringList> StationIndexTest::stations()
+{
+    // place, station id, state
+    return {
+        {QStringLiteral("Zürich"), QStringLiteral("LSZH"), QStringLiteral("ZH")},
+        {QStringLiteral("Zurich Airport"), QStringLiteral("LSZK"), QStringLiteral("ZH")},
+        {QStringLiteral("Bern"), QStringLiteral("LSZB"), QStringLiteral("BE")},
+        {QStringLiteral("Berlin"), QStringLiteral("EDDB"), QStringLiteral("BE")},
+        {QStringLiteral("Oslo"), QStringLiteral("ENGM"), QStringLiteral("OS")},
+        {QStringLiteral("Lo"), QStringLiteral("EBLO"), QStringLiteral("wv")},
+    };
+}
+
+QVector<QStringList> StationIndexTest::manyStations()
+{
+    QVector<QStringList> result;
+    result.reserve(50000);
+    for (int i = 0; i < 50000; ++i) {
+        result.append({QStringLiteral("Station %1 Berg").arg(i),
+                       QStringLiteral("K%1").arg(i, 4, 36, QLatin1Char('0')).toUpper(),
+                       QStringLiteral("S%1").arg(i % 60)});
+    }
+    return result;
+}
+
+QStringList StationIndexTest::places(const StationIndex &index, const QVector<int> &result)
+{
+    QStringList places;
+    for (int station : result) {
+        places << index.place(station);
+    }
+    return places;
+}
+
+void StationIndexTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void StationIndexTest::init()
+{
+    QFile::remove(fileName(QStringLiteral("test")));
+}
+
+void StationIndexTest::testEmpty()
+{
+    StationIndex index(QStringLiteral("test"));
+    QVERIFY(!index.load());
+    QVERIFY(!index.isValid());
+    QVERIFY(!index.update({}));
+    QVERIFY(!index.isValid());
+    QCOMPARE(index.count(), 0);
+    QVERIFY(index.search(QStringLiteral("zur")).isEmpty());
+    QCOMPARE(index.find(QStringLiteral("Bern")), -1);
+    QVERIFY(index.findByField(1, QStringLiteral("LSZB")).isEmpty());
+}
+
+void StationIndexTest::testUpdateAndLoad()
+{
+    {
+        StationIndex index(QStringLiteral("test"));
+        QVERIFY(index.update(stations(), QStringLiteral("\"abc\""), QStringLiteral("Sun, 18 Oct 2026 10:00:00 GMT")));
+        QVERIFY(index.isValid());
+        QCOMPARE(index.count(), 6);
+    }
+
+    QVERIFY(QFile::exists(fileName(QStringLiteral("test"))));
+
+    StationIndex index(QStringLiteral("test"));
+    QVERIFY(index.load());
+    QCOMPARE(index.count(), 6);
+    QCOMPARE(index.etag(), QStringLiteral("\"abc\""));
+    QCOMPARE(index.lastModified(), QStringLiteral("Sun, 18 Oct 2026 10:00:00 GMT"));
+
+    const int zurich = index.find(QStringLiteral("Zürich"));
+    QVERIFY(zurich >= 0);
+    QCOMPARE(index.place(zurich), QStringLiteral("Zürich"));
+    QCOMPARE(index.field(zurich, 1), QStringLiteral("LSZH"));
+    QCOMPARE(index.field(zurich, 2), QStringLiteral("ZH"));
+    QCOMPARE(index.field(zurich, 3), QString());
+    QCOMPARE(index.field(-1, 0), QString());
+}
+
+void StationIndexTest::testCorruptFile_data()
+{
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<QByteArray>("bytes");
+    QTest::addColumn<int>("keep");
+    QTest::addColumn<int>("chop");
+
+    // the header starts with magic, version, station count and field count,
+    // followed by four more counts, a reserved word and the etag reference
+    const auto word = [](quint32 value) {
+        return QByteArray(reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+
+    QTest::newRow("garbage") << 0 << QByteArray(64, 'x') << -1 << 0;
+    QTest::newRow("magic") << 0 << word(0x12345678) << -1 << 0;
+    QTest::newRow("version") << 4 << word(1) << -1 << 0;
+    QTest::newRow("station count") << 8 << word(1000000) << -1 << 0;
+    QTest::newRow("gram count") << 16 << word(1000000) << -1 << 0;
+    QTest::newRow("etag offset") << 32 << word(0xfffffff0) << -1 << 0;
+    QTest::newRow("truncated") << 0 << QByteArray() << -1 << 4;
+    QTest::newRow("header only") << 0 << QByteArray() << 48 << 0;
+    QTest::newRow("empty") << 0 << QByteArray() << 0 << 0;
+}
+
+void StationIndexTest::testCorruptFile()
+{
+    QFETCH(int, offset);
+    QFETCH(QByteArray, bytes);
+    QFETCH(int, keep);
+    QFETCH(int, chop);
+
+    {
+        StationIndex index(QStringLiteral("test"));
+        QVERIFY(index.update(stations(), QStringLiteral("\"abc\"")));
+    }
+
+    QFile file(fileName(QStringLiteral("test")));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QByteArray data = file.readAll();
+    if (keep >= 0) {
+        data.truncate(keep);
+    }
+    data.chop(chop);
+    data.replace(offset, bytes.size(), bytes);
+    QVERIFY(file.resize(0));
+    QCOMPARE(file.write(data), qint64(data.size()));
+    file.close();
+
+    StationIndex index(QStringLiteral("test"));
+    QVERIFY(!index.load());
+    QVERIFY(!index.isValid());
+    QCOMPARE(index.count(), 0);
+    QVERIFY(index.conditionalRequestHeaders().isEmpty());
+    QVERIFY(index.search(QStringLiteral("zur")).isEmpty());
+
+    // a fresh list replaces the broken file
+    QVERIFY(index.update(stations()));
+    QVERIFY(index.load());
+    QCOMPARE(index.count(), 6);
+}
+
+void StationIndexTest::testConditionalRequestHeaders()
+{
+    StationIndex index(QStringLiteral("test"));
+    QVERIFY(index.conditionalRequestHeaders().isEmpty());
+
+    QVERIFY(index.update(stations()));
+    QVERIFY(index.conditionalRequestHeaders().isEmpty());
+
+    QVERIFY(index.update(stations(), QStringLiteral("\"abc\"")));
+    QCOMPARE(index.conditionalRequestHeaders(), QStringLiteral("If-None-Match: \"abc\""));
+
+    QVERIFY(index.update(stations(), QString(), QStringLiteral("Sun, 18 Oct 2026 10:00:00 GMT")));
+    QCOMPARE(index.conditionalRequestHeaders(), QStringLiteral("If-Modified-Since: Sun, 18 Oct 2026 10:00:00 GMT"));
+
+    QVERIFY(index.update(stations(), QStringLiteral("\"abc\""), QStringLiteral("Sun, 18 Oct 2026 10:00:00 GMT")));
+    QCOMPARE(index.conditionalRequestHeaders(),
+             QStringLiteral("If-None-Match: \"abc\"\r\nIf-Modified-Since: Sun, 18 Oct 2026 10:00:00 GMT"));
+}
+
+void StationIndexTest::testParseResponseHeaders()
+{
+    QString etag;
+    QString lastModified;
+    StationIndex::parseResponseHeaders(QStringLiteral("HTTP/1.1 200 OK\n"
+                                                      "Content-Type: text/plain\n"
+                                                      "etag:  \"abc\" \n"
+                                                      "Last-Modified: Sun, 18 Oct 2026 10:00:00 GMT\n"),
+                                       &etag, &lastModified);
+    QCOMPARE(etag, QStringLiteral("\"abc\""));
+    QCOMPARE(lastModified, QStringLiteral("Sun, 18 Oct 2026 10:00:00 GMT"));
+
+    etag.clear();
+    StationIndex::parseResponseHeaders(QStringLiteral("HTTP/1.1 200 OK\nContent-Type: text/plain\n"), &etag, nullptr);
+    QVERIFY(etag.isEmpty());
+}
+
+void StationIndexTest::testSearch_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QStringList>("places");
+
+    // results are ordered by folded place name
+    QTest::newRow("empty") << QString()
+                           << QStringList{QStringLiteral("Berlin"), QStringLiteral("Bern"), QStringLiteral("Lo"),
+                                          QStringLiteral("Oslo"), QStringLiteral("Zürich"), QStringLiteral("Zurich Airport")};
+    QTest::newRow("folded") << QStringLiteral("ZÜR") << QStringList{QStringLiteral("Zürich"), QStringLiteral("Zurich Airport")};
+    QTest::newRow("trigram") << QStringLiteral("ber") << QStringList{QStringLiteral("Berlin"), QStringLiteral("Bern")};
+    QTest::newRow("longer") << QStringLiteral("berl") << QStringList{QStringLiteral("Berlin")};
+    QTest::newRow("spanning words") << QStringLiteral("ch air") << QStringList{QStringLiteral("Zurich Airport")};
+    QTest::newRow("two at the end") << QStringLiteral("rn") << QStringList{QStringLiteral("Bern")};
+    QTest::newRow("two") << QStringLiteral("lo") << QStringList{QStringLiteral("Lo"), QStringLiteral("Oslo")};
+    QTest::newRow("one") << QStringLiteral("o")
+                         << QStringList{QStringLiteral("Lo"), QStringLiteral("Oslo"), QStringLiteral("Zurich Airport")};
+    QTest::newRow("one at the end") << QStringLiteral("n") << QStringList{QStringLiteral("Berlin"), QStringLiteral("Bern")};
+    QTest::newRow("whole name") << QStringLiteral("zurich airport") << QStringList{QStringLiteral("Zurich Airport")};
+    QTest::newRow("none") << QStringLiteral("xyz") << QStringList();
+    QTest::newRow("none short") << QStringLiteral("q") << QStringList();
+}
+
+void StationIndexTest::testSearch()
+{
+    QFETCH(QString, text);
+    QFETCH(QStringList, places);
+
+    StationIndex index(QStringLiteral("test"));
+    QVERIFY(index.update(stations()));
+    QCOMPARE(this->places(index, index.search(text)), places);
+
+    // same results from the file
+    StationIndex loaded(QStringLiteral("test"));
+    QVERIFY(loaded.load());
+    QCOMPARE(this->places(loaded, loaded.search(text)), places);
+}
+
+void StationIndexTest::testFind()
+{
+    StationIndex index(QStringLiteral("test"));
+    QVERIFY(index.update(stations()));
+
+    QCOMPARE(index.place(index.find(QStringLiteral("Zürich"))), QStringLiteral("Zürich"));
+    QCOMPARE(index.place(index.find(QStringLiteral("Zurich Airport"))), QStringLiteral("Zurich Airport"));
+    QCOMPARE(index.place(index.find(QStringLiteral("Lo"))), QStringLiteral("Lo"));
+    QCOMPARE(index.find(QStringLiteral("Zurich")), -1);
+    QCOMPARE(index.find(QStringLiteral("Ber")), -1);
+}
+
+void StationIndexTest::testFindByField()
+{
+    StationIndex index(QStringLiteral("test"));
+    QVERIFY(index.update(stations()));
+
+    QCOMPARE(places(index, index.findByField(1, QStringLiteral("LSZB"))), QStringList{QStringLiteral("Bern")});
+    QCOMPARE(places(index, index.findByField(2, QStringLiteral("ZH"))),
+             (QStringList{QStringLiteral("Zürich"), QStringLiteral("Zurich Airport")}));
+    QVERIFY(index.findByField(1, QStringLiteral("lszb")).isEmpty());
+    QCOMPARE(places(index, index.findByField(1, QStringLiteral("lszb"), Qt::CaseInsensitive)), QStringList{QStringLiteral("Bern")});
+    QVERIFY(index.findByField(2, QStringLiteral("WV")).isEmpty());
+    QCOMPARE(places(index, index.findByField(2, QStringLiteral("WV"), Qt::CaseInsensitive)), QStringList{QStringLiteral("Lo")});
+    QCOMPARE(places(index, index.findByField(0, QStringLiteral("Oslo"))), QStringList{QStringLiteral("Oslo")});
+    QVERIFY(index.findByField(1, QStringLiteral("XXXX")).isEmpty());
+    QVERIFY(index.findByField(3, QStringLiteral("LSZB")).isEmpty());
+    QVERIFY(index.findByField(-1, QStringLiteral("LSZB")).isEmpty());
+
+    // the lookups follow new contents
+    QVERIFY(index.update({{QStringLiteral("Basel"), QStringLiteral("LSZB"), QStringLiteral("BS")}}));
+    QCOMPARE(places(index, index.findByField(1, QStringLiteral("LSZB"))), QStringList{QStringLiteral("Basel")});
+    QVERIFY(index.findByField(2, QStringLiteral("ZH")).isEmpty());
+}
+
+void StationIndexTest::benchmarkLoad()
+{
+    {
+        StationIndex index(QStringLiteral("test"));
+        QVERIFY(index.update(manyStations()));
+    }
+
+    QBENCHMARK {
+        StationIndex index(QStringLiteral("test"));
+        QVERIFY(index.load());
+    }
+}
+
+void StationIndexTest::benchmarkSearch_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("one") << QStringLiteral("7") << 17195;
+    QTest::newRow("two") << QStringLiteral("77") << 1400;
+    QTest::newRow("three") << QStringLiteral("777") << 95;
+    QTest::newRow("long") << QStringLiteral("station 4242 ") << 1;
+}
+
+void StationIndexTest::benchmarkSearch()
+{
+    QFETCH(QString, text);
+    QFETCH(int, count);
+
+    StationIndex index(QStringLiteral("test"));
+    QVERIFY(index.update(manyStations()));
+
+    QBENCHMARK {
+        QCOMPARE(index.search(text).size(), count);
+    }
+}
+
+void StationIndexTest::benchmarkFindByField()
+{
+    StationIndex index(QStringLiteral("test"));
+    QVERIFY(index.update(manyStations()));
+    QCOMPARE(index.findByField(1, QStringLiteral("K01AB")).size(), 1);
+
+    QBENCHMARK {
+        QCOMPARE(index.findByField(1, QStringLiteral("K12AB")).size(), 1);
+        QCOMPARE(index.findByField(2, QStringLiteral("S42")).size(), 833);
+    }
+}
+
+QTEST_MAIN(StationIndexTest)
+
+#include "stationindextest.moc"
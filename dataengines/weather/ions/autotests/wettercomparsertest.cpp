@@ -0,0 +1,147 @@
+/********************************************************************
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+
+#include <QObject>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "../wetter.com/ion_wettercomparsers.h"
+#include "chunkedfeed.h"
+
+namespace
+{
+    struct Interval {
+        uint utcTime;
+        const char *iconName;
+        const char *summary;
+        int tempHigh;
+        int tempLow;
+        int probability;
+    };
+
+    void compareIntervals(const QVector<WeatherData::ForecastInfo> &forecasts, const QVector<Interval> &expected)
+    {
+        QCOMPARE(forecasts.size(), expected.size());
+        for (int i = 0; i < forecasts.size(); ++i) {
+            const WeatherData::ForecastInfo &forecast = forecasts.at(i);
+            QCOMPARE(forecast.period, QDateTime::fromSecsSinceEpoch(expected.at(i).utcTime, Qt::LocalTime));
+            QCOMPARE(forecast.iconName, QString::fromLatin1(expected.at(i).iconName));
+            QCOMPARE(forecast.summary, QString::fromLatin1(expected.at(i).summary));
+            QCOMPARE(forecast.tempHigh, expected.at(i).tempHigh);
+            QCOMPARE(forecast.tempLow, expected.at(i).tempLow);
+            QCOMPARE(forecast.probability, expected.at(i).probability);
+        }
+    }
+}
+
+/**
+ * The expected values are what the QXmlStreamReader based parser of the
+ * ion read from the recorded forecast, before parsing became incremental.
+ */
+class WetterComParserTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testForecast_data();
+    void testForecast();
+
+    void benchmarkForecast();
+};
+
+void WetterComParserTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    // whether an interval is by day or by night depends on the local time zone
+    qputenv("TZ", "UTC");
+}
+
+void WetterComParserTest::testForecast_data()
+{
+    ChunkedFeed::addRows();
+}
+
+void WetterComParserTest::testForecast()
+{
+    QFETCH(int, chunkSize);
+
+    // only its icon and condition mappings are used by the parser
+    WetterComIon ion(nullptr, QVariantList());
+    WetterComIon::ForecastParser parser(&ion);
+    ChunkedFeed::feed(parser, ChunkedFeed::readFixture(QStringLiteral("wettercom-forecast.xml")), chunkSize);
+    QVERIFY(parser.finish());
+
+    const WeatherData &data = parser.data;
+    QCOMPARE(data.stationName, QStringLiteral("Berlin"));
+    QCOMPARE(data.credits, QStringLiteral("Powered by wetter.com"));
+    QCOMPARE(data.creditsUrl, QStringLiteral("http://www.wetter.com"));
+    QCOMPARE(data.timeDifference, 7200);
+    QCOMPARE(data.forecasts.size(), 2);
+
+    const WeatherData::ForecastPeriod &sunday = data.forecasts.at(0);
+    QCOMPARE(sunday.period, QDateTime::fromSecsSinceEpoch(1792274400, Qt::LocalTime));
+    QCOMPARE(sunday.iconName, QStringLiteral("weather-clouds"));
+    QCOMPARE(sunday.summary, QStringLiteral("cloudy"));
+    QCOMPARE(sunday.probability, 20);
+    compareIntervals(sunday.dayForecasts, {
+        {1792314000, "weather-clouds", "cloudy", 13, 11, 10},
+        {1792335600, "weather-clouds", "cloudy", 14, 12, 20},
+    });
+    compareIntervals(sunday.nightForecasts, {
+        {1792296000, "weather-few-clouds-night", "few clouds", 8, 6, 0},
+        {1792357200, "weather-clear-night", "clear sky", 9, 7, 0},
+    });
+
+    const WeatherData::ForecastPeriod &monday = data.forecasts.at(1);
+    QCOMPARE(monday.period, QDateTime::fromSecsSinceEpoch(1792360800, Qt::LocalTime));
+    QCOMPARE(monday.iconName, QStringLiteral("weather-showers-scattered"));
+    QCOMPARE(monday.summary, QStringLiteral("light rain"));
+    QCOMPARE(monday.probability, 80);
+    compareIntervals(monday.dayForecasts, {
+        {1792400400, "weather-showers-scattered", "light rain", 12, 10, 80},
+        {1792422000, "weather-showers-scattered-day", "light showers", 12, 11, 60},
+    });
+    compareIntervals(monday.nightForecasts, {
+        {1792382400, "weather-overcast", "overcast", 8, 7, 30},
+        {1792443600, "weather-few-clouds-night", "few clouds", 8, 7, 20},
+    });
+
+    // the whole day as shown for the following days
+    const WeatherData::ForecastInfo mondayWeather = monday.getWeather();
+    QCOMPARE(mondayWeather.tempHigh, 12);
+    QCOMPARE(mondayWeather.tempLow, 7);
+}
+
+void WetterComParserTest::benchmarkForecast()
+{
+    const QByteArray data = ChunkedFeed::readFixture(QStringLiteral("wettercom-forecast.xml"));
+    WetterComIon ion(nullptr, QVariantList());
+
+    QBENCHMARK {
+        WetterComIon::ForecastParser parser(&ion);
+        ChunkedFeed::feed(parser, data, 1460);
+        QVERIFY(parser.finish());
+    }
+}
+
+QTEST_MAIN(WetterComParserTest)
+
+#include "wettercomparsertest.moc"
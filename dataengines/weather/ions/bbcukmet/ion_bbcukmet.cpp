@@ -20,6 +20,7 @@
 /* Ion for BBC's Weather from the UK Met Office */
 
 #include "ion_bbcukmet.h"
+#include "ion_bbcukmetparsers.h"
 
 #include "ion_bbcukmetdebug.h"
 
@@ -30,7 +31,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
-#include <QXmlStreamReader>
+#include <QSharedPointer>
 #include <QTimeZone>
 
 
@@ -62,30 +63,14 @@ UKMETIon::UKMETIon(QObject *parent, const QVariantList &args)
 
 UKMETIon::~UKMETIon()
 {
-    deleteForecasts();
 }
 
 void UKMETIon::reset()
 {
-    deleteForecasts();
     m_sourcesToReset = sources();
     updateAllSources();
 }
 
-void UKMETIon::deleteForecasts()
-{
-    // Destroy each forecast stored in a QVector
-    QHash<QString, WeatherData>::iterator
-        it = m_weatherData.begin(),
-        end = m_weatherData.end();
-    for (; it != end; ++it) {
-        qDeleteAll(it.value().forecasts);
-        it.value().forecasts.clear();
-    }
-}
-
-
-
 QMap<QString, IonInterface::ConditionIcons> UKMETIon::setupDayIconMappings() const
 {
 //    ClearDay, FewCloudsDay, PartlyCloudyDay, Overcast,
@@ -296,452 +281,294 @@ bool UKMETIon::updateIonSource(const QString& source)
     return true;
 }
 
-// Gets specific city XML data
-void UKMETIon::getXMLData(const QString& source)
+UKMETIon::ObservationParser::ObservationParser()
 {
-    for (const QString& fetching : qAsConst(m_obsJobList)) {
-        if (fetching == source) {
-            // already getting this source and awaiting the data
-            return;
-        }
-    }
-
-    const QUrl url(QStringLiteral("https://weather-broker-cdn.api.bbci.co.uk/en/observation/rss/") + m_place[source].stationId);
-
-    KIO::TransferJob* getJob = KIO::get(url, KIO::Reload, KIO::HideProgressInfo);
-    getJob->addMetaData(QStringLiteral("cookies"), QStringLiteral("none")); // Disable displaying cookies
-    m_obsJobXml.insert(getJob, new QXmlStreamReader);
-    m_obsJobList.insert(getJob, source);
-
-    connect(getJob, &KIO::TransferJob::data,
-            this, &UKMETIon::observation_slotDataArrived);
-    connect(getJob, &KJob::result,
-            this, &UKMETIon::observation_slotJobFinished);
+    data.isForecastsDataPending = true;
 }
 
-// Parses city list and gets the correct city based on ID number
-void UKMETIon::findPlace(const QString& place, const QString& source)
+void UKMETIon::ObservationParser::startElement(const QStringRef& name, const QXmlStreamAttributes& attributes)
 {
-    /* There's a page= parameter, results are limited to 10 by page */
-    const QUrl url(QLatin1String("https://www.bbc.com/locator/default/en-GB/search.json?search=")+place+
-                   QLatin1String("&filter=international&postcode_unit=false&postcode_district=true"));
+    Q_UNUSED(attributes)
 
-    KIO::TransferJob* getJob = KIO::get(url, KIO::Reload, KIO::HideProgressInfo);
-    getJob->addMetaData(QStringLiteral("cookies"), QStringLiteral("none")); // Disable displaying cookies
-    m_jobHtml.insert(getJob, new QByteArray());
-    m_jobList.insert(getJob, source);
-
-    connect(getJob, &KIO::TransferJob::data,
-            this, &UKMETIon::setup_slotDataArrived);
-    connect(getJob, &KJob::result,
-            this, &UKMETIon::setup_slotJobFinished);
-
-/*
-    // Handle redirects for direct hit places.
-    connect(getJob, SIGNAL(redirection(KIO::Job*,KUrl)),
-            this, SLOT(setup_slotRedirected(KIO::Job*,KUrl)));
-*/
+    if (depth() == 1 && name == QLatin1String("rss")) {
+        haveObservation = true;
+    }
 }
 
-void UKMETIon::getFiveDayForecast(const QString& source)
+void UKMETIon::ObservationParser::endElement(const QStringRef& name, const QString& text)
 {
-    XMLMapInfo& place = m_place[source];
-
-    const QUrl url(QStringLiteral("https://weather-broker-cdn.api.bbci.co.uk/en/forecast/rss/3day/") + place.stationId);
+    const QString parent = parentName();
 
-    KIO::TransferJob* getJob = KIO::get(url, KIO::Reload, KIO::HideProgressInfo);
-    getJob->addMetaData(QStringLiteral("cookies"), QStringLiteral("none")); // Disable displaying cookies
-    m_forecastJobXml.insert(getJob, new QXmlStreamReader);
-    m_forecastJobList.insert(getJob, source);
+    if (parent == QLatin1String("channel")) {
+        if (name == QLatin1String("title")) {
+            data.stationName = text.section(QStringLiteral("Observations for"), 1, 1).trimmed();
+            data.stationName.replace(QStringLiteral("United Kingdom"), i18n("UK"));
+            data.stationName.replace(QStringLiteral("United States of America"), i18n("USA"));
+        }
+        return;
+    }
 
-    connect(getJob, &KIO::TransferJob::data,
-            this, &UKMETIon::forecast_slotDataArrived);
-    connect(getJob, &KJob::result,
-            this, &UKMETIon::forecast_slotJobFinished);
-}
+    if (parent != QLatin1String("item")) {
+        return;
+    }
 
-void UKMETIon::readSearchHTMLData(const QString& source, const QByteArray& html)
-{
-    int counter = 2;
+    if (name == QLatin1String("title")) {
+        const QString& conditionString = text;
+
+        // Get the observation time and condition
+        int splitIndex = conditionString.lastIndexOf(QLatin1Char(':'));
+        if (splitIndex >= 0) {
+            QString conditionData = conditionString.mid(splitIndex + 1); // Skip ':'
+            data.obsTime = conditionString.left(splitIndex);
+
+            if (data.obsTime.contains(QLatin1Char('-'))) {
+                // Saturday - 13:00 CET
+                // Saturday - 12:00 GMT
+                // timezone parsing is not yet supported by QDateTime, also is there just a dayname
+                // so try manually
+                // guess date from day
+                const QString dayString = data.obsTime.section(QLatin1Char('-'), 0, 0).trimmed();
+                QDate date = QDate::currentDate();
+                const QString dayFormat = QStringLiteral("dddd");
+                const int testDayJumps[4] = {
+                    -1, // first to weekday yesterday
+                     2, // then to weekday tomorrow
+                    -3, // then to weekday before yesterday, not sure if such day offset can happen?
+                     4, // then to weekday after tomorrow, not sure if such day offset can happen?
+                };
+                const int dayJumps = sizeof(testDayJumps)/sizeof(testDayJumps[0]);
+                QLocale cLocale = QLocale::c();
+                int dayJump = 0;
+                while (true) {
+                    if (cLocale.toString(date, dayFormat) == dayString) {
+                        break;
+                    }
 
-    QJsonObject jsonDocumentObject = QJsonDocument::fromJson(html).object();
+                    if (dayJump >= dayJumps) {
+                        // no weekday found near-by, set date invalid
+                        date = QDate();
+                        break;
+                    }
+                    date = date.addDays(testDayJumps[dayJump]);
+                    ++dayJump;
+                }
 
-    if (!jsonDocumentObject.isEmpty()) {
-        const QJsonArray results = jsonDocumentObject.value(QStringLiteral("results")).toArray();
+                if (date.isValid()) {
+                    const QString timeString = data.obsTime.section(QLatin1Char('-'), 1, 1).trimmed();
+                    const QTime time = QTime::fromString(timeString.section(QLatin1Char(' '), 0, 0), QStringLiteral("hh:mm"));
+                    const QTimeZone timeZone = QTimeZone(timeString.section(QLatin1Char(' '), 1, 1).toUtf8());
+                    // TODO: if non-IANA timezone id is not known, try to guess timezone from other data
 
-        for (const QJsonValue& resultValue : results) {
-            QJsonObject result = resultValue.toObject();
-            const QString id = result.value(QStringLiteral("id")).toString();
-            const QString fullName = result.value(QStringLiteral("fullName")).toString();
+                    if (time.isValid() && timeZone.isValid()) {
+                        data.observationDateTime = QDateTime(date, time, timeZone);
+                    }
+                }
+            }
 
-            if (!id.isEmpty() && !fullName.isEmpty()) {
-                QString tmp = QLatin1String("bbcukmet|") + fullName;
+            if (conditionData.contains(QLatin1Char(','))) {
+                data.condition = intern(conditionData.section(QLatin1Char(','), 0, 0).trimmed());
 
-                // Duplicate places can exist
-                if (m_locations.contains(tmp)) {
-                    tmp += QLatin1String(" (#") + QString::number(counter) + QLatin1Char(')');
-                    counter++;
+                if (data.condition == QLatin1String("null") ||
+                    data.condition == QLatin1String("Not Available")) {
+                    data.condition.clear();
                 }
-                XMLMapInfo& place = m_place[tmp];
-                place.stationId = id;
-                place.place = fullName;
-                m_locations.append(tmp);
             }
-       }
-    }
+        }
 
-    validate(source);
-}
+    } else if (name == QLatin1String("description")) {
+        const QStringList observeData = text.split(QLatin1Char(':'));
 
-// handle when no XML tag is found
-void UKMETIon::parseUnknownElement(QXmlStreamReader& xml) const
-{
-    while (!xml.atEnd()) {
-        xml.readNext();
+        // FIXME: We should make this use a QRegExp but I need some help here :) -spstarr
 
-        if (xml.isEndElement()) {
-            break;
-        }
+        QString temperature_C = observeData.value(1).section(QChar(176), 0, 0).trimmed();
+        parseFloat(data.temperature_C, temperature_C);
 
-        if (xml.isStartElement()) {
-            parseUnknownElement(xml);
+        data.windDirection = intern(observeData.value(2).section(QLatin1Char(','), 0, 0).trimmed());
+        if (data.windDirection.contains(QLatin1String("null"))) {
+            data.windDirection.clear();
         }
-    }
-}
 
-void UKMETIon::setup_slotDataArrived(KIO::Job *job, const QByteArray &data)
-{
-    if (data.isEmpty() || !m_jobHtml.contains(job)) {
-        return;
-    }
+        QString windSpeed_miles = observeData.value(3).section(QLatin1Char(','), 0, 0).section(QLatin1Char(' '),1 ,1).remove(QStringLiteral("mph"));
+        parseFloat(data.windSpeed_miles, windSpeed_miles);
 
-    m_jobHtml[job]->append(data);
-}
+        QString humidity = observeData.value(4).section(QLatin1Char(','), 0, 0).section(QLatin1Char(' '),1 ,1);
+        if (humidity.endsWith(QLatin1Char('%'))) {
+            humidity.chop(1);
+        }
+        parseFloat(data.humidity, humidity);
 
-void UKMETIon::setup_slotJobFinished(KJob *job)
-{
-    if (job->error() == KIO::ERR_SERVER_TIMEOUT) {
-        setData(m_jobList[job], QStringLiteral("validate"), QStringLiteral("bbcukmet|timeout"));
-        disconnectSource(m_jobList[job], this);
-        m_jobList.remove(job);
-        delete m_jobHtml[job];
-        m_jobHtml.remove(job);
-        return;
-    }
+        QString pressure = observeData.value(5).section(QLatin1Char(','), 0, 0).section(QLatin1Char(' '),1 ,1).section(QStringLiteral("mb"), 0, 0);
+        parseFloat(data.pressure, pressure);
 
-    // If Redirected, don't go to this routine
-    if (!m_locations.contains(QLatin1String("bbcukmet|") + m_jobList[job])) {
-        QByteArray *reader = m_jobHtml.value(job);
-        if (reader) {
-            readSearchHTMLData(m_jobList[job], *reader);
+        data.pressureTendency = observeData.value(5).section(QLatin1Char(','), 1, 1).toLower().trimmed();
+        if (data.pressureTendency == QLatin1String("no change")) {
+            data.pressureTendency = QStringLiteral("steady");
         }
+
+        data.visibilityStr = observeData.value(6).trimmed();
+        if (data.visibilityStr == QLatin1String("--")) {
+            data.visibilityStr.clear();
+        }
+
+    } else if (name == QLatin1String("lat")) {
+        data.stationLatitude = text.toDouble();
+    } else if (name == QLatin1String("long")) {
+        data.stationLongitude = text.toDouble();
+    } else if (name == QLatin1String("point") &&
+               namespaceUri() == QLatin1String("http://www.georss.org/georss")) {
+        const QStringList ordinates = text.split(QLatin1Char(' '));
+        data.stationLatitude = ordinates.value(0).toDouble();
+        data.stationLongitude = ordinates.value(1).toDouble();
     }
-    m_jobList.remove(job);
-    delete m_jobHtml[job];
-    m_jobHtml.remove(job);
 }
 
-void UKMETIon::observation_slotDataArrived(KIO::Job *job, const QByteArray &data)
+UKMETIon::ForecastParser::ForecastParser(const UKMETIon* ion)
+    : m_ion(ion)
+    , m_high(QStringLiteral("Maximum Temperature: (-?\\d+).C"), Qt::CaseInsensitive)
+    , m_low(QStringLiteral("Minimum Temperature: (-?\\d+).C"), Qt::CaseInsensitive)
 {
-    QByteArray local = data;
-    if (data.isEmpty() || !m_obsJobXml.contains(job)) {
-        return;
-    }
-
-    // Send to xml.
-    m_obsJobXml[job]->addData(local);
 }
 
-void UKMETIon::observation_slotJobFinished(KJob *job)
+void UKMETIon::ForecastParser::startElement(const QStringRef& name, const QXmlStreamAttributes& attributes)
 {
-    const QString source = m_obsJobList.value(job);
-    setData(source, Data());
+    Q_UNUSED(attributes)
 
-    QXmlStreamReader *reader = m_obsJobXml.value(job);
-    if (reader) {
-        readObservationXMLData(m_obsJobList[job], *reader);
-    }
-
-    m_obsJobList.remove(job);
-    delete m_obsJobXml[job];
-    m_obsJobXml.remove(job);
-
-    if (m_sourcesToReset.contains(source)) {
-        m_sourcesToReset.removeAll(source);
-        emit forceUpdate(this, source);
+    if (depth() == 1 && name == QLatin1String("rss")) {
+        haveFiveDay = true;
     }
 }
 
-void UKMETIon::forecast_slotDataArrived(KIO::Job *job, const QByteArray &data)
+void UKMETIon::ForecastParser::endElement(const QStringRef& name, const QString& text)
 {
-    QByteArray local = data;
-    if (data.isEmpty() || !m_forecastJobXml.contains(job)) {
+    if (name == QLatin1String("link") && parentName() == QLatin1String("channel") && namespaceUri().isEmpty()) {
+        forecastHTMLUrl = text;
         return;
     }
 
-    // Send to xml.
-    m_forecastJobXml[job]->addData(local);
-}
-
-void UKMETIon::forecast_slotJobFinished(KJob *job)
-{
-    setData(m_forecastJobList[job], Data());
-    QXmlStreamReader *reader = m_forecastJobXml.value(job);
-    if (reader) {
-        readFiveDayForecastXMLData(m_forecastJobList[job], *reader);
+    if (name != QLatin1String("title") || parentName() != QLatin1String("item")) {
+        return;
     }
 
-    m_forecastJobList.remove(job);
-    delete m_forecastJobXml[job];
-    m_forecastJobXml.remove(job);
-}
+    // FIXME: We should make this all use QRegExps in UKMETIon::ForecastParser for forecast -spstarr
 
-void UKMETIon::parsePlaceObservation(const QString &source, WeatherData& data, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("rss"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
+    const QString line = text.trimmed();
+    const QString p = line.section(QLatin1Char(','), 0, 0);
+    const QString period = p.section(QLatin1Char(':'), 0, 0);
+    const QString summary = p.section(QLatin1Char(':'), 1, 1).trimmed();
 
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("rss")) {
-            break;
-        }
+    WeatherData::ForecastInfo forecast;
 
-        if (xml.isStartElement() && elementName == QLatin1String("channel")) {
-            parseWeatherChannel(source, data, xml);
-        }
+    const QString temps = line.section(QLatin1Char(','), 1, 1);
+    // Sometimes only one of min or max are reported
+    if (m_high.indexIn(temps) != -1) {
+        parseFloat(forecast.tempHigh, m_high.cap(1));
+    }
+    if (m_low.indexIn(temps) != -1) {
+        parseFloat(forecast.tempLow, m_low.cap(1));
     }
-}
-
-void UKMETIon::parsePlaceForecast(const QString &source, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("rss"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
 
-        if (xml.isStartElement() && xml.name() == QLatin1String("channel")) {
-            parseWeatherForecast(source, xml);
-        }
+    const QString summaryLC = summary.toLower();
+    forecast.period = intern(period);
+    if (forecast.period == QLatin1String("Tonight")) {
+        forecast.iconName = m_ion->getWeatherIcon(m_ion->nightIcons(), summaryLC);
+    } else {
+        forecast.iconName = m_ion->getWeatherIcon(m_ion->dayIcons(), summaryLC);
     }
+    // db uses original strings normalized to lowercase, but we prefer the unnormalized if without translation
+    const QString summaryTranslated = i18nc("weather forecast", summaryLC.toUtf8().data());
+    forecast.summary = intern((summaryTranslated != summaryLC) ? summaryTranslated : summary);
+    qCDebug(IONENGINE_BBCUKMET) << "i18n summary string: " << forecast.summary;
+    forecasts.append(forecast);
 }
 
-void UKMETIon::parseWeatherChannel(const QString& source, WeatherData& data, QXmlStreamReader& xml)
+// Gets specific city XML data
+void UKMETIon::getXMLData(const QString& source)
 {
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("channel"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
+    const QUrl url(QStringLiteral("https://weather-broker-cdn.api.bbci.co.uk/en/observation/rss/") + m_place[source].stationId);
 
-        const QStringRef elementName = xml.name();
+    // places sharing a station share the observation
+    QSharedPointer<ObservationParser> parser(new ObservationParser);
+    fetch(url, source,
+          [parser](const QByteArray& chunk) {
+              parser->addData(chunk);
+          },
+          [this, parser](const QByteArray&, const QStringList& sources) {
+              parser->finish();
 
-        if (xml.isEndElement() && elementName == QLatin1String("channel")) {
-            break;
-        }
+              for (const QString& placeSource : sources) {
+                  setData(placeSource, Data());
 
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("title")) {
-                data.stationName = xml.readElementText().section(QStringLiteral("Observations for"), 1, 1).trimmed();
-                data.stationName.replace(QStringLiteral("United Kingdom"), i18n("UK"));
-                data.stationName.replace(QStringLiteral("United States of America"), i18n("USA"));
+                  if (parser->haveObservation) {
+                      setObservation(placeSource, parser->data);
+                  }
 
-            } else if (elementName == QLatin1String("item")) {
-                parseWeatherObservation(source, data, xml);
-            } else {
-                parseUnknownElement(xml);
-            }
-        }
-    }
+                  if (m_sourcesToReset.contains(placeSource)) {
+                      m_sourcesToReset.removeAll(placeSource);
+                      emit forceUpdate(this, placeSource);
+                  }
+              }
+          });
 }
 
-void UKMETIon::parseWeatherForecast(const QString& source, QXmlStreamReader& xml)
+// Parses city list and gets the correct city based on ID number
+void UKMETIon::findPlace(const QString& place, const QString& source)
 {
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("channel"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
+    /* There's a page= parameter, results are limited to 10 by page */
+    const QUrl url(QLatin1String("https://www.bbc.com/locator/default/en-GB/search.json?search=")+place+
+                   QLatin1String("&filter=international&postcode_unit=false&postcode_district=true"));
 
-        const QStringRef elementName = xml.name();
+    KIO::TransferJob* getJob = KIO::get(url, KIO::Reload, KIO::HideProgressInfo);
+    getJob->addMetaData(QStringLiteral("cookies"), QStringLiteral("none")); // Disable displaying cookies
+    m_jobHtml.insert(getJob, new QByteArray());
+    m_jobList.insert(getJob, source);
 
-        if (xml.isEndElement() && elementName == QLatin1String("channel")) {
-            break;
-        }
+    connect(getJob, &KIO::TransferJob::data,
+            this, &UKMETIon::setup_slotDataArrived);
+    connect(getJob, &KJob::result,
+            this, &UKMETIon::setup_slotJobFinished);
 
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("item")) {
-                parseFiveDayForecast(source, xml);
-            } else if (elementName == QLatin1String("link") &&
-                       xml.namespaceUri().isEmpty()) {
-                m_place[source].forecastHTMLUrl = xml.readElementText();
-            } else {
-                parseUnknownElement(xml);
-            }
-        }
-    }
+/*
+    // Handle redirects for direct hit places.
+    connect(getJob, SIGNAL(redirection(KIO::Job*,KUrl)),
+            this, SLOT(setup_slotRedirected(KIO::Job*,KUrl)));
+*/
 }
 
-void UKMETIon::parseWeatherObservation(const QString& source, WeatherData& data, QXmlStreamReader& xml)
+void UKMETIon::getFiveDayForecast(const QString& source)
 {
-    Q_UNUSED(source);
-
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("item"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("item")) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("title")) {
-                QString conditionString = xml.readElementText();
-
-                // Get the observation time and condition
-                int splitIndex = conditionString.lastIndexOf(QLatin1Char(':'));
-                if (splitIndex >= 0) {
-                    QString conditionData = conditionString.mid(splitIndex + 1); // Skip ':'
-                    data.obsTime = conditionString.left(splitIndex);
-
-                    if (data.obsTime.contains(QLatin1Char('-'))) {
-                        // Saturday - 13:00 CET
-                        // Saturday - 12:00 GMT
-                        // timezone parsing is not yet supported by QDateTime, also is there just a dayname
-                        // so try manually
-                        // guess date from day
-                        const QString dayString = data.obsTime.section(QLatin1Char('-'), 0, 0).trimmed();
-                        QDate date = QDate::currentDate();
-                        const QString dayFormat = QStringLiteral("dddd");
-                        const int testDayJumps[4] = {
-                            -1, // first to weekday yesterday
-                             2, // then to weekday tomorrow
-                            -3, // then to weekday before yesterday, not sure if such day offset can happen?
-                             4, // then to weekday after tomorrow, not sure if such day offset can happen?
-                        };
-                        const int dayJumps = sizeof(testDayJumps)/sizeof(testDayJumps[0]);
-                        QLocale cLocale = QLocale::c();
-                        int dayJump = 0;
-                        while (true) {
-                            if (cLocale.toString(date, dayFormat) == dayString) {
-                                break;
-                            }
-
-                            if (dayJump >= dayJumps) {
-                                // no weekday found near-by, set date invalid
-                                date = QDate();
-                                break;
-                            }
-                            date = date.addDays(testDayJumps[dayJump]);
-                            ++dayJump;
-                        }
-
-                        if (date.isValid()) {
-                            const QString timeString = data.obsTime.section(QLatin1Char('-'), 1, 1).trimmed();
-                            const QTime time = QTime::fromString(timeString.section(QLatin1Char(' '), 0, 0), QStringLiteral("hh:mm"));
-                            const QTimeZone timeZone = QTimeZone(timeString.section(QLatin1Char(' '), 1, 1).toUtf8());
-                            // TODO: if non-IANA timezone id is not known, try to guess timezone from other data
-
-                            if (time.isValid() && timeZone.isValid()) {
-                                data.observationDateTime = QDateTime(date, time, timeZone);
-                            }
-                        }
-                    }
-
-                    if (conditionData.contains(QLatin1Char(','))) {
-                        data.condition = conditionData.section(QLatin1Char(','), 0, 0).trimmed();
-
-                        if (data.condition == QLatin1String("null") ||
-                            data.condition == QLatin1String("Not Available")) {
-                            data.condition.clear();
-                        }
-                    }
-                }
-
-            } else if (elementName == QLatin1String("description")) {
-                QString observeString = xml.readElementText();
-                const QStringList observeData = observeString.split(QLatin1Char(':'));
-
-                // FIXME: We should make this use a QRegExp but I need some help here :) -spstarr
-
-                QString temperature_C = observeData[1].section(QChar(176), 0, 0).trimmed();
-                parseFloat(data.temperature_C, temperature_C);
+    XMLMapInfo& place = m_place[source];
 
-                data.windDirection = observeData[2].section(QLatin1Char(','), 0, 0).trimmed();
-                if (data.windDirection.contains(QLatin1String("null"))) {
-                    data.windDirection.clear();
-                }
+    const QUrl url(QStringLiteral("https://weather-broker-cdn.api.bbci.co.uk/en/forecast/rss/3day/") + place.stationId);
 
-                QString windSpeed_miles = observeData[3].section(QLatin1Char(','), 0, 0).section(QLatin1Char(' '),1 ,1).remove(QStringLiteral("mph"));
-                parseFloat(data.windSpeed_miles, windSpeed_miles);
+    QSharedPointer<ForecastParser> parser(new ForecastParser(this));
+    fetch(url, source,
+          [parser](const QByteArray& chunk) {
+              parser->addData(chunk);
+          },
+          [this, parser](const QByteArray&, const QStringList& sources) {
+              parser->finish();
 
-                QString humidity = observeData[4].section(QLatin1Char(','), 0, 0).section(QLatin1Char(' '),1 ,1);
-                if (humidity.endsWith(QLatin1Char('%'))) {
-                    humidity.chop(1);
-                }
-                parseFloat(data.humidity, humidity);
+              for (const QString& placeSource : sources) {
+                  setData(placeSource, Data());
 
-                QString pressure = observeData[5].section(QLatin1Char(','), 0, 0).section(QLatin1Char(' '),1 ,1).section(QStringLiteral("mb"), 0, 0);
-                parseFloat(data.pressure, pressure);
+                  if (!parser->haveFiveDay) {
+                      continue;
+                  }
 
-                data.pressureTendency = observeData[5].section(QLatin1Char(','), 1, 1).toLower().trimmed();
-                if (data.pressureTendency == QLatin1String("no change")) {
-                    data.pressureTendency = QStringLiteral("steady");
-                }
+                  m_place[placeSource].forecastHTMLUrl = parser->forecastHTMLUrl;
 
-                data.visibilityStr = observeData[6].trimmed();
-                if (data.visibilityStr == QLatin1String("--")) {
-                    data.visibilityStr.clear();
-                }
+                  WeatherData& weatherData = m_weatherData[placeSource];
+                  // implicitly shared between all sources
+                  weatherData.forecasts = parser->forecasts;
+                  weatherData.isForecastsDataPending = false;
 
-            } else if (elementName == QLatin1String("lat")) {
-                const QString ordinate = xml.readElementText();
-                data.stationLatitude = ordinate.toDouble();
-            } else if (elementName == QLatin1String("long")) {
-                const QString ordinate = xml.readElementText();
-                data.stationLongitude = ordinate.toDouble();
-            } else if (elementName == QLatin1String("point") &&
-                       xml.namespaceUri() == QLatin1String("http://www.georss.org/georss")) {
-                const QStringList ordinates = xml.readElementText().split(QLatin1Char(' '));
-                data.stationLatitude = ordinates[0].toDouble();
-                data.stationLongitude = ordinates[1].toDouble();
-            } else {
-                parseUnknownElement(xml);
-            }
-        }
-    }
+                  updateWeather(placeSource);
+              }
+          });
 }
 
-bool UKMETIon::readObservationXMLData(const QString& source, QXmlStreamReader& xml)
+void UKMETIon::setObservation(const QString& source, WeatherData data)
 {
-    WeatherData data;
-    data.isForecastsDataPending = true;
-    bool haveObservation = false;
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        if (xml.isEndElement()) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (xml.name() == QLatin1String("rss")) {
-                parsePlaceObservation(source, data, xml);
-                haveObservation = true;
-            } else {
-                parseUnknownElement(xml);
-            }
-        }
-
-    }
-
-    if (!haveObservation) {
-        return false;
-    }
-
     bool solarDataSourceNeedsConnect = false;
     Plasma::DataEngine* timeEngine = dataEngine(QStringLiteral("time"));
     if (timeEngine) {
@@ -783,91 +610,71 @@ bool UKMETIon::readObservationXMLData(const QString& source, QXmlStreamReader& x
 
     // Get the 5 day forecast info next.
     getFiveDayForecast(source);
-
-    return !xml.error();
 }
 
-bool UKMETIon::readFiveDayForecastXMLData(const QString& source, QXmlStreamReader& xml)
+void UKMETIon::readSearchHTMLData(const QString& source, const QByteArray& html)
 {
-    bool haveFiveDay = false;
-    while (!xml.atEnd()) {
-        xml.readNext();
+    int counter = 2;
 
-        if (xml.isEndElement()) {
-            break;
-        }
+    QJsonObject jsonDocumentObject = QJsonDocument::fromJson(html).object();
 
-        if (xml.isStartElement()) {
-            if (xml.name() == QLatin1String("rss")) {
-                parsePlaceForecast(source, xml);
-                haveFiveDay = true;
-            } else {
-                parseUnknownElement(xml);
+    if (!jsonDocumentObject.isEmpty()) {
+        const QJsonArray results = jsonDocumentObject.value(QStringLiteral("results")).toArray();
+
+        for (const QJsonValue& resultValue : results) {
+            QJsonObject result = resultValue.toObject();
+            const QString id = result.value(QStringLiteral("id")).toString();
+            const QString fullName = result.value(QStringLiteral("fullName")).toString();
+
+            if (!id.isEmpty() && !fullName.isEmpty()) {
+                QString tmp = QLatin1String("bbcukmet|") + fullName;
+
+                // Duplicate places can exist
+                if (m_locations.contains(tmp)) {
+                    tmp += QLatin1String(" (#") + QString::number(counter) + QLatin1Char(')');
+                    counter++;
+                }
+                XMLMapInfo& place = m_place[tmp];
+                place.stationId = id;
+                place.place = fullName;
+                m_locations.append(tmp);
             }
-        }
+       }
     }
-    if (!haveFiveDay) return false;
-    updateWeather(source);
-    return !xml.error();
+
+    validate(source);
 }
 
-void UKMETIon::parseFiveDayForecast(const QString& source, QXmlStreamReader& xml)
+void UKMETIon::setup_slotDataArrived(KIO::Job *job, const QByteArray &data)
 {
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("item"));
-
-    WeatherData& weatherData = m_weatherData[source];
-    QVector<WeatherData::ForecastInfo*>& forecasts = weatherData.forecasts;
-
-    // Flush out the old forecasts when updating.
-    forecasts.clear();
-
-    WeatherData::ForecastInfo *forecast = new WeatherData::ForecastInfo;
-    QString line;
-    QString period;
-    QString summary;
-    QRegExp high(QStringLiteral("Maximum Temperature: (-?\\d+).C"), Qt::CaseInsensitive);
-    QRegExp  low(QStringLiteral("Minimum Temperature: (-?\\d+).C"), Qt::CaseInsensitive);
-    while (!xml.atEnd()) {
-        xml.readNext();
-        if (xml.name() == QLatin1String("title")) {
-            line = xml.readElementText().trimmed();
-
-            // FIXME: We should make this all use QRegExps in UKMETIon::parseFiveDayForecast() for forecast -spstarr
-
-            const QString p = line.section(QLatin1Char(','), 0, 0);
-            period = p.section(QLatin1Char(':'), 0, 0);
-            summary = p.section(QLatin1Char(':'), 1, 1).trimmed();
-
-            const QString temps = line.section(QLatin1Char(','), 1, 1);
-            // Sometimes only one of min or max are reported
-            if (high.indexIn(temps) != -1) {
-                parseFloat(forecast->tempHigh, high.cap(1));
-            }
-            if (low.indexIn(temps) != -1) {
-                parseFloat(forecast->tempLow, low.cap(1));
-            }
-
-            const QString summaryLC = summary.toLower();
-            forecast->period = period;
-            if (forecast->period == QLatin1String("Tonight")) {
-                forecast->iconName = getWeatherIcon(nightIcons(), summaryLC);
-            } else {
-                forecast->iconName = getWeatherIcon(dayIcons(), summaryLC);
-            }
-            // db uses original strings normalized to lowercase, but we prefer the unnormalized if without translation
-            const QString summaryTranslated = i18nc("weather forecast", summaryLC.toUtf8().data());
-            forecast->summary = (summaryTranslated != summaryLC) ? summaryTranslated : summary;
-            qCDebug(IONENGINE_BBCUKMET) << "i18n summary string: " << forecast->summary;
-            forecasts.append(forecast);
-            // prepare next
-            forecast = new WeatherData::ForecastInfo;
-        }
+    if (data.isEmpty() || !m_jobHtml.contains(job)) {
+        return;
     }
 
-    weatherData.isForecastsDataPending = false;
+    m_jobHtml[job]->append(data);
+}
+
+void UKMETIon::setup_slotJobFinished(KJob *job)
+{
+    if (job->error() == KIO::ERR_SERVER_TIMEOUT) {
+        setData(m_jobList[job], QStringLiteral("validate"), QStringLiteral("bbcukmet|timeout"));
+        disconnectSource(m_jobList[job], this);
+        m_jobList.remove(job);
+        delete m_jobHtml[job];
+        m_jobHtml.remove(job);
+        return;
+    }
 
-    // remove unused
-    delete forecast;
+    // If Redirected, don't go to this routine
+    if (!m_locations.contains(QLatin1String("bbcukmet|") + m_jobList[job])) {
+        QByteArray *reader = m_jobHtml.value(job);
+        if (reader) {
+            readSearchHTMLData(m_jobList[job], *reader);
+        }
+    }
+    m_jobList.remove(job);
+    delete m_jobHtml[job];
+    m_jobHtml.remove(job);
 }
 
 void UKMETIon::parseFloat(float& value, const QString& string)
@@ -990,14 +797,14 @@ void UKMETIon::updateWeather(const QString& source)
     }
 
     // 5 Day forecast info
-    const QVector <WeatherData::ForecastInfo *>& forecasts = weatherData.forecasts;
+    const QVector<WeatherData::ForecastInfo>& forecasts = weatherData.forecasts;
 
     // Set number of forecasts per day/night supported
     data.insert(QStringLiteral("Total Weather Days"), forecasts.size());
 
     int i = 0;
-    for (const WeatherData::ForecastInfo* forecastInfo : forecasts) {
-        QString period = forecastInfo->period;
+    for (const WeatherData::ForecastInfo& forecastInfo : forecasts) {
+        QString period = forecastInfo.period;
         // same day
         period.replace(QStringLiteral("Today"), i18nc("Short for Today", "Today"));
         period.replace(QStringLiteral("Tonight"), i18nc("Short for Tonight", "Tonight"));
@@ -1010,19 +817,19 @@ void UKMETIon::updateWeather(const QString& source)
         period.replace(QStringLiteral("Thursday"), i18nc("Short for Thursday", "Thu"));
         period.replace(QStringLiteral("Friday"), i18nc("Short for Friday", "Fri"));
 
-        const QString tempHigh = qIsNaN(forecastInfo->tempHigh) ? QString() : QString::number(forecastInfo->tempHigh);
-        const QString tempLow = qIsNaN(forecastInfo->tempLow) ? QString() : QString::number(forecastInfo->tempLow);
+        const QString tempHigh = qIsNaN(forecastInfo.tempHigh) ? QString() : QString::number(forecastInfo.tempHigh);
+        const QString tempLow = qIsNaN(forecastInfo.tempLow) ? QString() : QString::number(forecastInfo.tempLow);
 
         data.insert(QStringLiteral("Short Forecast Day %1").arg(i),
                     QStringLiteral("%1|%2|%3|%4|%5|%6").arg(
                                    period,
-                                   forecastInfo->iconName,
-                                   forecastInfo->summary,
+                                   forecastInfo.iconName,
+                                   forecastInfo.summary,
                                    tempHigh,
                                    tempLow,
                                    QString()));
-        //.arg(forecastInfo->windSpeed)
-        //arg(forecastInfo->windDirection));
+        //.arg(forecastInfo.windSpeed)
+        //arg(forecastInfo.windDirection));
 
         ++i;
     }
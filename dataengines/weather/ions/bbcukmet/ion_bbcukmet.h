@@ -78,7 +78,7 @@ public:
     };
 
     // 5 day Forecast
-    QVector <WeatherData::ForecastInfo *> forecasts;
+    QVector<WeatherData::ForecastInfo> forecasts;
 
     bool isForecastsDataPending = false;
 };
@@ -110,12 +110,6 @@ private Q_SLOTS:
     void setup_slotJobFinished(KJob *);
     //void setup_slotRedirected(KIO::Job *, const KUrl &url);
 
-    void observation_slotDataArrived(KIO::Job *, const QByteArray &);
-    void observation_slotJobFinished(KJob *);
-
-    void forecast_slotDataArrived(KIO::Job *, const QByteArray &);
-    void forecast_slotJobFinished(KJob *);
-
 private:
     void updateWeather(const QString& source);
 
@@ -136,22 +130,16 @@ private:
     void getFiveDayForecast(const QString& source);
     void getXMLData(const QString& source);
     void readSearchHTMLData(const QString& source, const QByteArray& html);
-    bool readFiveDayForecastXMLData(const QString& source, QXmlStreamReader& xml);
     void parseSearchLocations(const QString& source, QXmlStreamReader& xml);
 
-    // Observation parsing methods
-    bool readObservationXMLData(const QString& source, QXmlStreamReader& xml);
-    void parsePlaceObservation(const QString& source, WeatherData& data, QXmlStreamReader& xml);
-    void parseWeatherChannel(const QString& source, WeatherData& data, QXmlStreamReader& xml);
-    void parseWeatherObservation(const QString& source, WeatherData& data, QXmlStreamReader& xml);
-    void parseFiveDayForecast(const QString& source, QXmlStreamReader& xml);
-    void parsePlaceForecast(const QString& source, QXmlStreamReader& xml);
-    void parseWeatherForecast(const QString& source, QXmlStreamReader& xml);
-    void parseUnknownElement(QXmlStreamReader& xml) const;
+    void setObservation(const QString& source, WeatherData data);
 
-    void parseFloat(float& value, const QString& string);
+    static void parseFloat(float& value, const QString& string);
 
-    void deleteForecasts();
+public:
+    // parsers of the downloaded documents, defined in ion_bbcukmetparsers.h
+    class ObservationParser;
+    class ForecastParser;
 
 private:
     struct XMLMapInfo {
@@ -172,12 +160,6 @@ private:
     QHash<KJob *, QByteArray *> m_jobHtml;
     QHash<KJob *, QString> m_jobList;
 
-    QHash<KJob *, QXmlStreamReader*> m_obsJobXml;
-    QHash<KJob *, QString> m_obsJobList;
-
-    QHash<KJob *, QXmlStreamReader *> m_forecastJobXml;
-    QHash<KJob *, QString> m_forecastJobList;
-
     QStringList m_sourcesToReset;
 };
 
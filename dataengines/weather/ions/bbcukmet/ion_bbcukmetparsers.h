@@ -0,0 +1,65 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA          *
+ ***************************************************************************/
+
+#ifndef ION_BBCUKMETPARSERS_H
+#define ION_BBCUKMETPARSERS_H
+
+#include "ion_bbcukmet.h"
+
+#include "../incrementalxmlparser.h"
+
+#include <QRegExp>
+
+/**
+ * Parses the latest observation of a station.
+ */
+class UKMETIon::ObservationParser : public IncrementalXmlParser
+{
+public:
+    ObservationParser();
+
+    WeatherData data;
+    bool haveObservation = false;
+
+protected:
+    void startElement(const QStringRef& name, const QXmlStreamAttributes& attributes) override;
+    void endElement(const QStringRef& name, const QString& text) override;
+};
+
+/**
+ * Parses the three day forecast of a station.
+ */
+class UKMETIon::ForecastParser : public IncrementalXmlParser
+{
+public:
+    explicit ForecastParser(const UKMETIon* ion);
+
+    QVector<WeatherData::ForecastInfo> forecasts;
+    QString forecastHTMLUrl;
+    bool haveFiveDay = false;
+
+protected:
+    void startElement(const QStringRef& name, const QXmlStreamAttributes& attributes) override;
+    void endElement(const QStringRef& name, const QString& text) override;
+
+private:
+    const UKMETIon* const m_ion;
+    QRegExp m_high;
+    QRegExp m_low;
+};
+
+#endif
@@ -20,6 +20,7 @@
 /* Ion for Environment Canada XML data */
 
 #include "ion_envcan.h"
+#include "ion_envcanparsers.h"
 
 #include "ion_envcandebug.h"
 
@@ -28,6 +29,7 @@
 #include <KLocalizedString>
 
 #include <QRegularExpression>
+#include <QSharedPointer>
 #include <QTimeZone>
 
 WeatherData::WeatherData()
@@ -63,31 +65,19 @@ WeatherData::ForecastInfo::ForecastInfo()
 // ctor, dtor
 EnvCanadaIon::EnvCanadaIon(QObject *parent, const QVariantList &args)
         : IonInterface(parent, args)
+        , m_stations(QStringLiteral("envcan"))
 {
+    // The city list of the last session allows to serve requests right away
+    if (m_stations.load()) {
+        setInitialized(true);
+    }
+
     // Get the real city XML URL so we can parse this
     getXMLSetup();
 }
 
-void EnvCanadaIon::deleteForecasts()
-{
-    QMutableHashIterator<QString, WeatherData> it(m_weatherData);
-    while (it.hasNext()) {
-        it.next();
-        WeatherData &item = it.value();
-        qDeleteAll(item.warnings);
-        item.warnings.clear();
-
-        qDeleteAll(item.watches);
-        item.watches.clear();
-
-        qDeleteAll(item.forecasts);
-        item.forecasts.clear();
-    }
-}
-
 void EnvCanadaIon::reset()
 {
-    deleteForecasts();
     emitWhenSetup = true;
     m_sourcesToReset = sources();
     getXMLSetup();
@@ -95,8 +85,6 @@ void EnvCanadaIon::reset()
 
 EnvCanadaIon::~EnvCanadaIon()
 {
-    // Destroy each watch/warning stored in a QVector
-    deleteForecasts();
 }
 
 QMap<QString, IonInterface::ConditionIcons> EnvCanadaIon::setupConditionIconMappings() const
@@ -458,13 +446,9 @@ QStringList EnvCanadaIon::validate(const QString& source) const
 {
     QStringList placeList;
 
-    QString sourceNormalized = source.toUpper();
-    QHash<QString, EnvCanadaIon::XMLMapInfo>::const_iterator it = m_places.constBegin();
-    while (it != m_places.constEnd()) {
-        if (it.key().toUpper().contains(sourceNormalized)) {
-            placeList.append(QStringLiteral("place|") + it.key());
-        }
-        ++it;
+    const QVector<int> stations = m_stations.search(source);
+    for (int i : stations) {
+        placeList.append(QStringLiteral("place|") + m_stations.place(i));
     }
 
     placeList.sort();
@@ -517,7 +501,13 @@ void EnvCanadaIon::getXMLSetup()
 
     const QUrl url(QStringLiteral("http://dd.weatheroffice.ec.gc.ca/citypage_weather/xml/siteList.xml"));
 
-    KIO::TransferJob* getJob = KIO::get(url, KIO::NoReload, KIO::HideProgressInfo);
+    // Always ask the server, it answers with "304 Not Modified" if our city index is current
+    KIO::TransferJob* getJob = KIO::get(url, KIO::Reload, KIO::HideProgressInfo);
+    getJob->addMetaData(QStringLiteral("PropagateHttpHeader"), QStringLiteral("true"));
+    const QString conditionalHeaders = m_stations.conditionalRequestHeaders();
+    if (!conditionalHeaders.isEmpty()) {
+        getJob->addMetaData(QStringLiteral("customHTTPHeader"), conditionalHeaders);
+    }
 
     m_xmlSetup.clear();
     connect(getJob, &KIO::TransferJob::data,
@@ -526,41 +516,334 @@ void EnvCanadaIon::getXMLSetup()
             this, &EnvCanadaIon::setup_slotJobFinished);
 }
 
-// Gets specific city XML data
-void EnvCanadaIon::getXMLData(const QString& source)
+EnvCanadaIon::WeatherParser::WeatherParser(const EnvCanadaIon* ion)
+    : m_ion(ion)
+{
+}
+
+void EnvCanadaIon::WeatherParser::startElement(const QStringRef& name, const QXmlStreamAttributes& attributes)
+{
+    const QString parent = parentName();
+
+    if (name == QLatin1String("dateTime")) {
+        // What kind of date info is this?
+        m_dateType = attributes.value(QStringLiteral("name")).toString();
+        m_dateZone = attributes.value(QStringLiteral("zone")).toString();
+        m_dateUtcOffset = attributes.value(QStringLiteral("UTCOffset")).toString();
+        m_timeStamp.clear();
+    } else if (name == QLatin1String("currentConditions")) {
+        data.temperature = qQNaN();
+        data.dewpoint = qQNaN();
+        data.condition = i18n("N/A");
+        data.humidex.clear();
+        data.stationID = i18n("N/A");
+        data.stationLatitude = qQNaN();
+        data.stationLongitude = qQNaN();
+        data.pressure = qQNaN();
+        data.visibility = qQNaN();
+        data.humidity = qQNaN();
+    } else if (parent == QLatin1String("currentConditions")) {
+        if (name == QLatin1String("station")) {
+            data.stationID = attributes.value(QStringLiteral("code")).toString();
+            const QRegularExpression dumpDirection(QStringLiteral("[^0-9.]"));
+            data.stationLatitude = attributes.value(QStringLiteral("lat")).toString().remove(dumpDirection).toDouble();
+            data.stationLongitude = attributes.value(QStringLiteral("lon")).toString().remove(dumpDirection).toDouble();
+        } else if (name == QLatin1String("pressure")) {
+            data.pressureTendency = attributes.value(QStringLiteral("tendency")).toString();
+            if (data.pressureTendency.isEmpty()) {
+                data.pressureTendency = QStringLiteral("steady");
+            }
+        }
+    } else if (name == QLatin1String("bearing") && parent == QLatin1String("wind") &&
+               parentName(2) == QLatin1String("currentConditions")) {
+        data.windDegrees = attributes.value(QStringLiteral("degrees")).toString();
+    } else if (name == QLatin1String("warnings")) {
+        // Cleanup warning list on update
+        data.warnings.clear();
+        data.watches.clear();
+        m_eventUrl = attributes.value(QStringLiteral("url")).toString();
+    } else if (name == QLatin1String("event") && parent == QLatin1String("warnings")) {
+        m_event = WeatherData::WeatherEvent();
+        const QString eventType = attributes.value(QStringLiteral("type")).toString();
+        if (eventType == QLatin1String("watch") || eventType == QLatin1String("warning")) {
+            m_event.url = m_eventUrl;
+            m_event.type = eventType;
+            m_event.priority = attributes.value(QStringLiteral("priority")).toString();
+            m_event.description = attributes.value(QStringLiteral("description")).toString();
+        }
+    } else if (name == QLatin1String("forecastGroup")) {
+        // Clean up forecast list on update
+        data.forecasts.clear();
+    } else if (name == QLatin1String("forecast") && parent == QLatin1String("forecastGroup")) {
+        m_forecast = WeatherData::ForecastInfo();
+    } else if (parent == QLatin1String("forecast")) {
+        if (name == QLatin1String("period")) {
+            m_forecast.forecastPeriod = intern(attributes.value(QStringLiteral("textForecastName")).toString());
+        } else if (name == QLatin1String("uv")) {
+            data.UVRating = attributes.value(QStringLiteral("category")).toString();
+        }
+    }
+}
+
+void EnvCanadaIon::WeatherParser::endElement(const QStringRef& name, const QString& text)
+{
+    const QString parent = parentName();
+
+    if (parent == QLatin1String("dateTime")) {
+        endDateTimeElement(name, text);
+    } else if (parent == QLatin1String("siteData")) {
+        if (name == QLatin1String("license")) {
+            data.creditUrl = text;
+        }
+    } else if (parent == QLatin1String("location")) {
+        if (name == QLatin1String("country")) {
+            data.countryName = text;
+        } else if (name == QLatin1String("province") || name == QLatin1String("territory")) {
+            data.longTerritoryName = text;
+        } else if (name == QLatin1String("name")) {
+            data.cityName = text;
+        } else if (name == QLatin1String("region")) {
+            data.regionName = text;
+        }
+    } else if (parent == QLatin1String("currentConditions")) {
+        // prevent N/A text to result in 0.0 values
+        if (name == QLatin1String("condition")) {
+            data.condition = intern(text.trimmed());
+        } else if (name == QLatin1String("temperature")) {
+            parseFloat(data.temperature, text);
+        } else if (name == QLatin1String("dewpoint")) {
+            parseFloat(data.dewpoint, text);
+        } else if (name == QLatin1String("humidex")) {
+            data.humidex = text;
+        } else if (name == QLatin1String("windChill")) {
+            parseFloat(data.windchill, text);
+        } else if (name == QLatin1String("pressure")) {
+            parseFloat(data.pressure, text);
+        } else if (name == QLatin1String("visibility")) {
+            parseFloat(data.visibility, text);
+        } else if (name == QLatin1String("relativeHumidity")) {
+            parseFloat(data.humidity, text);
+        }
+    } else if (parent == QLatin1String("wind") && parentName(2) == QLatin1String("currentConditions")) {
+        if (name == QLatin1String("speed")) {
+            parseFloat(data.windSpeed, text);
+        } else if (name == QLatin1String("gust")) {
+            parseFloat(data.windGust, text);
+        } else if (name == QLatin1String("direction")) {
+            data.windDirection = intern(text);
+        }
+    } else if (parent == QLatin1String("warnings")) {
+        if (name == QLatin1String("event") && !m_event.timestamp.isEmpty() && !m_event.url.isEmpty()) {
+            if (m_event.type == QLatin1String("warning")) {
+                data.warnings.append(m_event);
+            } else {
+                data.watches.append(m_event);
+            }
+        }
+    } else if (parent == QLatin1String("regionalNormals")) {
+        if (name == QLatin1String("temperature")) {
+            const QStringRef temperatureClass = attributes().value(QStringLiteral("class"));
+            if (temperatureClass == QLatin1String("high")) {
+                parseFloat(data.normalHigh, text);
+            } else if (temperatureClass == QLatin1String("low")) {
+                parseFloat(data.normalLow, text);
+            }
+        }
+    } else if (parent == QLatin1String("forecastGroup")) {
+        if (name == QLatin1String("forecast")) {
+            data.forecasts.append(m_forecast);
+        }
+    } else if (parent == QLatin1String("forecast")) {
+        if (name == QLatin1String("textSummary")) {
+            m_forecast.forecastSummary = text;
+        }
+    } else if (parent == QLatin1String("abbreviatedForecast")) {
+        if (name == QLatin1String("pop")) {
+            parseFloat(m_forecast.popPrecent, text);
+        } else if (name == QLatin1String("textSummary")) {
+            QMap<QString, ConditionIcons> forecastList = m_ion->forecastIcons();
+            if ((m_forecast.forecastPeriod == QLatin1String("tonight")) ||
+                (m_forecast.forecastPeriod.contains(QLatin1String("night")))) {
+                forecastList.insert(QStringLiteral("a few clouds"), FewCloudsNight);
+                forecastList.insert(QStringLiteral("cloudy periods"), PartlyCloudyNight);
+                forecastList.insert(QStringLiteral("chance of drizzle mixed with rain"), ChanceShowersNight);
+                forecastList.insert(QStringLiteral("chance of drizzle"), ChanceShowersNight);
+                forecastList.insert(QStringLiteral("chance of drizzle or rain"), ChanceShowersNight);
+                forecastList.insert(QStringLiteral("chance of flurries"), ChanceSnowNight);
+                forecastList.insert(QStringLiteral("chance of light snow"), ChanceSnowNight);
+                forecastList.insert(QStringLiteral("chance of flurries at times heavy"), ChanceSnowNight);
+                forecastList.insert(QStringLiteral("chance of showers or drizzle"), ChanceShowersNight);
+                forecastList.insert(QStringLiteral("chance of showers"), ChanceShowersNight);
+                forecastList.insert(QStringLiteral("clearing"), ClearNight);
+            } else {
+                forecastList.insert(QStringLiteral("a few clouds"), FewCloudsDay);
+                forecastList.insert(QStringLiteral("cloudy periods"), PartlyCloudyDay);
+                forecastList.insert(QStringLiteral("chance of drizzle mixed with rain"), ChanceShowersDay);
+                forecastList.insert(QStringLiteral("chance of drizzle"), ChanceShowersDay);
+                forecastList.insert(QStringLiteral("chance of drizzle or rain"), ChanceShowersDay);
+                forecastList.insert(QStringLiteral("chance of flurries"), ChanceSnowDay);
+                forecastList.insert(QStringLiteral("chance of light snow"), ChanceSnowDay);
+                forecastList.insert(QStringLiteral("chance of flurries at times heavy"), ChanceSnowDay);
+                forecastList.insert(QStringLiteral("chance of showers or drizzle"), ChanceShowersDay);
+                forecastList.insert(QStringLiteral("chance of showers"), ChanceShowersDay);
+                forecastList.insert(QStringLiteral("clearing"), ClearDay);
+            }
+            m_forecast.shortForecast = intern(text);
+            m_forecast.iconName = m_ion->getWeatherIcon(forecastList, text.toLower());
+        }
+    } else if (parent == QLatin1String("temperatures")) {
+        if (name == QLatin1String("temperature")) {
+            const QStringRef temperatureClass = attributes().value(QStringLiteral("class"));
+            if (temperatureClass == QLatin1String("low")) {
+                parseFloat(m_forecast.tempLow, text);
+            } else if (temperatureClass == QLatin1String("high")) {
+                parseFloat(m_forecast.tempHigh, text);
+            }
+        }
+    } else if (parent == QLatin1String("winds")) {
+        if (name == QLatin1String("textSummary")) {
+            m_forecast.windForecast = intern(text);
+        }
+    } else if (parent == QLatin1String("precipitation") && parentName(2) == QLatin1String("forecast")) {
+        if (name == QLatin1String("textSummary")) {
+            m_forecast.precipForecast = intern(text);
+        } else if (name == QLatin1String("precipType")) {
+            m_forecast.precipType = intern(text);
+        }
+    } else if (parent == QLatin1String("accumulation")) {
+        if (name == QLatin1String("amount")) {
+            m_forecast.precipTotalExpected = text;
+        }
+    } else if (parent == QLatin1String("uv")) {
+        if (name == QLatin1String("index")) {
+            data.UVIndex = text;
+        }
+    } else if (parent == QLatin1String("yesterdayConditions")) {
+        if (name == QLatin1String("temperature")) {
+            const QStringRef temperatureClass = attributes().value(QStringLiteral("class"));
+            if (temperatureClass == QLatin1String("high")) {
+                parseFloat(data.prevHigh, text);
+            } else if (temperatureClass == QLatin1String("low")) {
+                parseFloat(data.prevLow, text);
+            }
+        } else if (name == QLatin1String("precip")) {
+            data.prevPrecipType = attributes().value(QStringLiteral("units")).toString();
+            if (data.prevPrecipType.isEmpty()) {
+                data.prevPrecipType = QString::number(KUnitConversion::NoUnit);
+            }
+            data.prevPrecipTotal = text;
+        }
+    } else if (parent == QLatin1String("almanac")) {
+        const QStringRef recordClass = attributes().value(QStringLiteral("class"));
+        if (name == QLatin1String("temperature")) {
+            if (recordClass == QLatin1String("extremeMax")) {
+                parseFloat(data.recordHigh, text);
+            } else if (recordClass == QLatin1String("extremeMin")) {
+                parseFloat(data.recordLow, text);
+            }
+        } else if (name == QLatin1String("precipitation")) {
+            if (recordClass == QLatin1String("extremeRainfall")) {
+                parseFloat(data.recordRain, text);
+            } else if (recordClass == QLatin1String("extremeSnowfall")) {
+                parseFloat(data.recordSnow, text);
+            }
+        }
+    }
+}
+
+void EnvCanadaIon::WeatherParser::endDateTimeElement(const QStringRef& name, const QString& text)
 {
-    for (const QString& fetching : qAsConst(m_jobList)) {
-        if (fetching == source) {
-            // already getting this source and awaiting the data
-            return;
+    if (m_dateType == QLatin1String("xmlCreation") || m_dateZone == QLatin1String("UTC")) {
+        return;
+    }
+
+    if (name == QLatin1String("timeStamp")) {
+        m_timeStamp = text;
+        return;
+    }
+
+    if (name != QLatin1String("textSummary")) {
+        return;
+    }
+
+    if (m_dateType == QLatin1String("eventIssue")) {
+        if (parentName(2) == QLatin1String("event")) {
+            m_event.timestamp = text;
+        }
+    } else if (m_dateType == QLatin1String("observation")) {
+        QDateTime observationDateTime = QDateTime::fromString(m_timeStamp, QStringLiteral("yyyyMMddHHmmss"));
+        QTimeZone timeZone = QTimeZone(m_dateZone.toUtf8());
+        // if timezone id not recognized, fallback to utcoffset
+        if (!timeZone.isValid()) {
+            timeZone = QTimeZone(m_dateUtcOffset.toInt() * 3600);
+        }
+        if (observationDateTime.isValid() && timeZone.isValid()) {
+            data.observationDateTime = observationDateTime;
+            data.observationDateTime.setTimeZone(timeZone);
         }
+        data.obsTimestamp = observationDateTime.toString(QStringLiteral("dd.MM.yyyy @ hh:mm"));
+    } else if (m_dateType == QLatin1String("forecastIssue")) {
+        data.forecastTimestamp = text;
+    } else if (m_dateType == QLatin1String("sunrise")) {
+        data.sunriseTimestamp = text;
+    } else if (m_dateType == QLatin1String("sunset")) {
+        data.sunsetTimestamp = text;
+    } else if (m_dateType == QLatin1String("moonrise")) {
+        data.moonriseTimestamp = text;
+    } else if (m_dateType == QLatin1String("moonset")) {
+        data.moonsetTimestamp = text;
     }
+}
 
+// Gets specific city XML data
+void EnvCanadaIon::getXMLData(const QString& source)
+{
     //qCDebug(IONENGINE_ENVCAN) << source;
 
     // Demunge source name for key only.
     QString dataKey = source;
     dataKey.remove(QStringLiteral("envcan|weather|"));
-    const XMLMapInfo& place = m_places[dataKey];
+    const int place = m_stations.find(dataKey);
+    const QString territoryName = m_stations.field(place, TerritoryNameField);
+    const QString cityCode = m_stations.field(place, CityCodeField);
 
-    const QUrl url(QLatin1String("http://dd.weatheroffice.ec.gc.ca/citypage_weather/xml/") + place.territoryName + QLatin1Char('/') + place.cityCode + QStringLiteral("_e.xml"));
+    const QUrl url(QLatin1String("http://dd.weatheroffice.ec.gc.ca/citypage_weather/xml/") + territoryName + QLatin1Char('/') + cityCode + QStringLiteral("_e.xml"));
     //url="file:///home/spstarr/Desktop/s0000649_e.xml";
     //qCDebug(IONENGINE_ENVCAN) << "Will Try URL: " << url;
 
-    if (place.territoryName.isEmpty() && place.cityCode.isEmpty()) {
+    if (territoryName.isEmpty() && cityCode.isEmpty()) {
         setData(source, QStringLiteral("validate"), QStringLiteral("envcan|malformed"));
         return;
     }
 
-    KIO::TransferJob* getJob  = KIO::get(url, KIO::Reload, KIO::HideProgressInfo);
-
-    m_jobXml.insert(getJob, new QXmlStreamReader);
-    m_jobList.insert(getJob, source);
-
-    connect(getJob, &KIO::TransferJob::data,
-            this, &EnvCanadaIon::slotDataArrived);
-    connect(getJob, &KJob::result,
-            this, &EnvCanadaIon::slotJobFinished);
+    // all sources of the city share the fetch and its result
+    QSharedPointer<WeatherParser> parser(new WeatherParser(this));
+    parser->data.shortTerritoryName = territoryName;
+    fetch(url, source,
+          [parser](const QByteArray& chunk) {
+              parser->addData(chunk);
+          },
+          [this, parser](const QByteArray&, const QStringList& sources) {
+              if (!parser->finish()) {
+                  qCDebug(IONENGINE_ENVCAN) << "Incomplete city page for" << sources << parser->errorString();
+              }
+
+              for (const QString& citySource : sources) {
+                  setData(citySource, Data());
+                  // warnings, watches and forecasts are implicitly shared between all sources
+                  setWeatherData(citySource, parser->data);
+
+                  if (m_sourcesToReset.contains(citySource)) {
+                      m_sourcesToReset.removeAll(citySource);
+
+                      // so the weather engine updates it's data
+                      forceImmediateUpdateOfAllVisualizations();
+
+                      // update the clients of our engine
+                      emit forceUpdate(this, citySource);
+                  }
+              }
+          });
 }
 
 void EnvCanadaIon::setup_slotDataArrived(KIO::Job *job, const QByteArray &data)
@@ -577,59 +860,38 @@ void EnvCanadaIon::setup_slotDataArrived(KIO::Job *job, const QByteArray &data)
     m_xmlSetup.addData(data);
 }
 
-void EnvCanadaIon::slotDataArrived(KIO::Job *job, const QByteArray &data)
-{
-
-    if (data.isEmpty() || !m_jobXml.contains(job)) {
-        return;
-    }
-
-    // Send to xml.
-    m_jobXml[job]->addData(data);
-}
-
-void EnvCanadaIon::slotJobFinished(KJob *job)
+void EnvCanadaIon::setup_slotJobFinished(KJob *job)
 {
-    // Dual use method, if we're fetching location data to parse we need to do this first
-    const QString source = m_jobList.value(job);
-    //qCDebug(IONENGINE_ENVCAN) << source << m_sourcesToReset.contains(source);
-    setData(source, Data());
-    QXmlStreamReader *reader = m_jobXml.value(job);
-    if (reader) {
-        readXMLData(m_jobList[job], *reader);
-    }
-
-    m_jobList.remove(job);
-    delete m_jobXml[job];
-    m_jobXml.remove(job);
-
-    if (m_sourcesToReset.contains(source)) {
-        m_sourcesToReset.removeAll(source);
+    KIO::TransferJob *transferJob = static_cast<KIO::TransferJob *>(job);
 
-        // so the weather engine updates it's data
-        forceImmediateUpdateOfAllVisualizations();
-
-        // update the clients of our engine
-        emit forceUpdate(this, source);
+    bool success = false;
+    if (job->error()) {
+        qCWarning(IONENGINE_ENVCAN) << "Could not fetch the city list:" << job->errorString();
+    } else if (transferJob->queryMetaData(QStringLiteral("responsecode")) == QLatin1String("304")) {
+        // our city index is still current
+        success = m_stations.isValid();
+    } else {
+        success = readXMLSetup(transferJob->queryMetaData(QStringLiteral("HTTP-Headers")));
     }
-}
-
-void EnvCanadaIon::setup_slotJobFinished(KJob *job)
-{
-    Q_UNUSED(job)
-    const bool success = readXMLSetup();
     m_xmlSetup.clear();
     //qCDebug(IONENGINE_ENVCAN) << success << m_sourcesToReset;
-    setInitialized(success);
+
+    // keep using the city index of the last session when the list could not be fetched
+    success = success || m_stations.isValid();
+    if (success != isInitialized()) {
+        setInitialized(success);
+    }
 }
 
-// Parse the city list and store into a QMap
-bool EnvCanadaIon::readXMLSetup()
+// Parse the city list and store it in the station index
+bool EnvCanadaIon::readXMLSetup(const QString& httpHeaders)
 {
     bool success = false;
     QString territory;
     QString code;
     QString cityName;
+    QVector<QStringList> stations;
+    QHash<QString, int> stationForPlace;
 
     //qCDebug(IONENGINE_ENVCAN) << "readXMLSetup()";
 
@@ -655,86 +917,34 @@ bool EnvCanadaIon::readXMLSetup()
         }
 
         if (m_xmlSetup.isEndElement() && elementName == QLatin1String("site")) {
-            EnvCanadaIon::XMLMapInfo info;
-            QString tmp = cityName + QStringLiteral(", ") + territory; // Build the key name.
-
-            // Set the mappings
-            info.cityCode = code;
-            info.territoryName = territory;
-            info.cityName = cityName;
+            const QString place = cityName + QStringLiteral(", ") + territory; // Build the key name.
+            const QStringList station { place, cityName, territory, code };
 
             // Set the string list, we will use for the applet to display the available cities.
-            m_places[tmp] = info;
+            const auto it = stationForPlace.constFind(place);
+            if (it != stationForPlace.constEnd()) {
+                stations[it.value()] = station;
+            } else {
+                stationForPlace.insert(place, stations.size());
+                stations.append(station);
+            }
             success = true;
         }
 
     }
 
-    return (success && !m_xmlSetup.error());
-}
-
-void EnvCanadaIon::parseWeatherSite(WeatherData& data, QXmlStreamReader& xml)
-{
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("license")) {
-                data.creditUrl = xml.readElementText();
-            } else if (elementName == QLatin1String("location")) {
-                parseLocations(data, xml);
-            } else if (elementName == QLatin1String("warnings")) {
-                // Cleanup warning list on update
-                data.warnings.clear();
-                data.watches.clear();
-                parseWarnings(data, xml);
-            } else if (elementName == QLatin1String("currentConditions")) {
-                parseConditions(data, xml);
-            } else if (elementName == QLatin1String("forecastGroup")) {
-                // Clean up forecast list on update
-                data.forecasts.clear();
-                parseWeatherForecast(data, xml);
-            } else if (elementName == QLatin1String("yesterdayConditions")) {
-                parseYesterdayWeather(data, xml);
-            } else if (elementName == QLatin1String("riseSet")) {
-                parseAstronomicals(data, xml);
-            } else if (elementName == QLatin1String("almanac")) {
-                parseWeatherRecords(data, xml);
-            } else {
-                parseUnknownElement(xml);
-            }
-        }
+    if (!success || m_xmlSetup.error()) {
+        return false;
     }
+
+    QString etag;
+    QString lastModified;
+    StationIndex::parseResponseHeaders(httpHeaders, &etag, &lastModified);
+    return m_stations.update(stations, etag, lastModified);
 }
 
-// Parse Weather data main loop, from here we have to decend into each tag pair
-bool EnvCanadaIon::readXMLData(const QString& source, QXmlStreamReader& xml)
+void EnvCanadaIon::setWeatherData(const QString& source, WeatherData data)
 {
-    WeatherData data;
-
-    //qCDebug(IONENGINE_ENVCAN) << "readXMLData()";
-
-    QString dataKey = source;
-    dataKey.remove(QStringLiteral("envcan|weather|"));
-    data.shortTerritoryName = m_places[dataKey].territoryName;
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        if (xml.isEndElement()) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (xml.name() == QLatin1String("siteData")) {
-                parseWeatherSite(data, xml);
-            } else {
-                parseUnknownElement(xml);
-            }
-        }
-    }
-
     bool solarDataSourceNeedsConnect = false;
     Plasma::DataEngine* timeEngine = dataEngine(QStringLiteral("time"));
     if (timeEngine) {
@@ -774,651 +984,17 @@ bool EnvCanadaIon::readXMLData(const QString& source, QXmlStreamReader& xml)
     } else {
         updateWeather(source);
     }
-
-    return !xml.error();
 }
 
-void EnvCanadaIon::parseFloat(float& value, QXmlStreamReader& xml)
+void EnvCanadaIon::parseFloat(float& value, const QString& string)
 {
     bool ok = false;
-    const float result = xml.readElementText().toFloat(&ok);
+    const float result = string.toFloat(&ok);
     if (ok) {
         value = result;
     }
 }
 
-void EnvCanadaIon::parseDateTime(WeatherData& data, QXmlStreamReader& xml, WeatherData::WeatherEvent *event)
-{
-
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("dateTime"));
-
-    // What kind of date info is this?
-    const QString dateType = xml.attributes().value(QStringLiteral("name")).toString();
-    const QString dateZone = xml.attributes().value(QStringLiteral("zone")).toString();
-    const QString dateUtcOffset = xml.attributes().value(QStringLiteral("UTCOffset")).toString();
-
-    QString selectTimeStamp;
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        if (xml.isEndElement()) {
-            break;
-        }
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isStartElement()) {
-            if (dateType == QLatin1String("xmlCreation")) {
-                return;
-            }
-            if (dateZone == QLatin1String("UTC")) {
-                return;
-            }
-            if (elementName == QLatin1String("year")) {
-                xml.readElementText();
-            } else if (elementName == QLatin1String("month")) {
-                xml.readElementText();
-            } else if (elementName == QLatin1String("day")) {
-                xml.readElementText();
-            } else if (elementName == QLatin1String("hour"))
-                xml.readElementText();
-            else if (elementName == QLatin1String("minute"))
-                xml.readElementText();
-            else if (elementName == QLatin1String("timeStamp"))
-                selectTimeStamp = xml.readElementText();
-            else if (elementName == QLatin1String("textSummary")) {
-                if (dateType == QLatin1String("eventIssue")) {
-                    if (event) {
-                        event->timestamp = xml.readElementText();
-                    }
-                } else if (dateType == QLatin1String("observation")) {
-                    xml.readElementText();
-                    QDateTime observationDateTime = QDateTime::fromString(selectTimeStamp, QStringLiteral("yyyyMMddHHmmss"));
-                    QTimeZone timeZone = QTimeZone(dateZone.toUtf8());
-                    // if timezone id not recognized, fallback to utcoffset
-                    if (!timeZone.isValid()) {
-                        timeZone = QTimeZone(dateUtcOffset.toInt() * 3600);
-                    }
-                    if (observationDateTime.isValid() && timeZone.isValid()) {
-                        data.observationDateTime = observationDateTime;
-                        data.observationDateTime.setTimeZone(timeZone);
-                    }
-                    data.obsTimestamp = observationDateTime.toString(QStringLiteral("dd.MM.yyyy @ hh:mm"));
-                } else if (dateType == QLatin1String("forecastIssue")) {
-                    data.forecastTimestamp = xml.readElementText();
-                } else if (dateType == QLatin1String("sunrise")) {
-                    data.sunriseTimestamp = xml.readElementText();
-                } else if (dateType == QLatin1String("sunset")) {
-                    data.sunsetTimestamp = xml.readElementText();
-                } else if (dateType == QLatin1String("moonrise")) {
-                    data.moonriseTimestamp = xml.readElementText();
-                } else if (dateType == QLatin1String("moonset")) {
-                    data.moonsetTimestamp = xml.readElementText();
-                }
-            }
-        }
-    }
-}
-
-void EnvCanadaIon::parseLocations(WeatherData& data, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("location"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        if (xml.isEndElement()) {
-            break;
-        }
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("country")) {
-                data.countryName = xml.readElementText();
-            } else if (elementName == QLatin1String("province") || elementName == QLatin1String("territory")) {
-                data.longTerritoryName = xml.readElementText();
-            } else if (elementName == QLatin1String("name")) {
-                data.cityName = xml.readElementText();
-            } else if (elementName == QLatin1String("region")) {
-                data.regionName = xml.readElementText();
-            } else {
-                parseUnknownElement(xml);
-            }
-        }
-    }
-}
-
-void EnvCanadaIon::parseWindInfo(WeatherData& data, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("wind"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        if (xml.isEndElement()) {
-            break;
-        }
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("speed")) {
-                parseFloat(data.windSpeed, xml);
-            } else if (elementName == QLatin1String("gust")) {
-                parseFloat(data.windGust, xml);
-            } else if (elementName == QLatin1String("direction")) {
-                data.windDirection = xml.readElementText();
-            } else if (elementName == QLatin1String("bearing")) {
-                data.windDegrees = xml.attributes().value(QStringLiteral("degrees")).toString();
-            } else {
-                parseUnknownElement(xml);
-            }
-        }
-    }
-}
-
-void EnvCanadaIon::parseConditions(WeatherData& data, QXmlStreamReader& xml)
-{
-
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("currentConditions"));
-    data.temperature = qQNaN();
-    data.dewpoint = qQNaN();
-    data.condition = i18n("N/A");
-    data.humidex.clear();
-    data.stationID = i18n("N/A");
-    data.stationLatitude = qQNaN();
-    data.stationLongitude = qQNaN();
-    data.pressure = qQNaN();
-    data.visibility = qQNaN();
-    data.humidity = qQNaN();
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("currentConditions"))
-            break;
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("station")) {
-                data.stationID = xml.attributes().value(QStringLiteral("code")).toString();
-                QRegularExpression dumpDirection(QStringLiteral("[^0-9.]"));
-                data.stationLatitude = xml.attributes().value(QStringLiteral("lat")).toString().remove(dumpDirection).toDouble();
-                data.stationLongitude = xml.attributes().value(QStringLiteral("lon")).toString().remove(dumpDirection).toDouble();
-            } else if (elementName == QLatin1String("dateTime")) {
-                parseDateTime(data, xml);
-            } else if (elementName == QLatin1String("condition")) {
-                data.condition = xml.readElementText().trimmed();
-            } else if (elementName == QLatin1String("temperature")) {
-                // prevent N/A text to result in 0.0 value
-                parseFloat(data.temperature, xml);
-            } else if (elementName == QLatin1String("dewpoint")) {
-                // prevent N/A text to result in 0.0 value
-                parseFloat(data.dewpoint, xml);
-            } else if (elementName == QLatin1String("humidex")) {
-                data.humidex = xml.readElementText();
-            } else if (elementName == QLatin1String("windChill")) {
-                // prevent N/A text to result in 0.0 value
-                parseFloat(data.windchill, xml);
-            } else if (elementName == QLatin1String("pressure")) {
-                data.pressureTendency = xml.attributes().value(QStringLiteral("tendency")).toString();
-                if (data.pressureTendency.isEmpty()) {
-                    data.pressureTendency = QStringLiteral("steady");
-                }
-                parseFloat(data.pressure, xml);
-            } else if (elementName == QLatin1String("visibility")) {
-                parseFloat(data.visibility, xml);
-            } else if (elementName == QLatin1String("relativeHumidity")) {
-                parseFloat(data.humidity, xml);
-            } else if (elementName == QLatin1String("wind")) {
-                parseWindInfo(data, xml);
-            }
-            //} else {
-            //    parseUnknownElement(xml);
-            //}
-        }
-    }
-}
-
-void EnvCanadaIon::parseWarnings(WeatherData &data, QXmlStreamReader& xml)
-{
-    WeatherData::WeatherEvent *watch = new WeatherData::WeatherEvent;
-    WeatherData::WeatherEvent *warning = new WeatherData::WeatherEvent;
-
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("warnings"));
-    QString eventURL = xml.attributes().value(QStringLiteral("url")).toString();
-    int flag = 0;
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("warnings")) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("dateTime")) {
-                if (flag == 1) {
-                    parseDateTime(data, xml, watch);
-                }
-                if (flag == 2) {
-                    parseDateTime(data, xml, warning);
-                }
-
-                if (!warning->timestamp.isEmpty() && !warning->url.isEmpty())  {
-                    data.warnings.append(warning);
-                    warning = new WeatherData::WeatherEvent;
-                }
-                if (!watch->timestamp.isEmpty() && !watch->url.isEmpty()) {
-                    data.watches.append(watch);
-                    watch = new WeatherData::WeatherEvent;
-                }
-
-            } else if (elementName == QLatin1String("event")) {
-                // Append new event to list.
-                QString eventType = xml.attributes().value(QStringLiteral("type")).toString();
-                if (eventType == QLatin1String("watch")) {
-                    watch->url = eventURL;
-                    watch->type = eventType;
-                    watch->priority = xml.attributes().value(QStringLiteral("priority")).toString();
-                    watch->description = xml.attributes().value(QStringLiteral("description")).toString();
-                    flag = 1;
-                }
-
-                if (eventType == QLatin1String("warning")) {
-                    warning->url = eventURL;
-                    warning->type = eventType;
-                    warning->priority = xml.attributes().value(QStringLiteral("priority")).toString();
-                    warning->description = xml.attributes().value(QStringLiteral("description")).toString();
-                    flag = 2;
-                }
-            } else {
-                if (xml.name() != QLatin1String("dateTime")) {
-                    parseUnknownElement(xml);
-                }
-            }
-        }
-    }
-    delete watch;
-    delete warning;
-}
-
-
-void EnvCanadaIon::parseWeatherForecast(WeatherData& data, QXmlStreamReader& xml)
-{
-    WeatherData::ForecastInfo* forecast = new WeatherData::ForecastInfo;
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("forecastGroup"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("forecastGroup")) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("dateTime")) {
-                parseDateTime(data, xml);
-            } else if (elementName == QLatin1String("regionalNormals")) {
-                parseRegionalNormals(data, xml);
-            } else if (elementName == QLatin1String("forecast")) {
-                parseForecast(data, xml, forecast);
-                forecast = new WeatherData::ForecastInfo;
-            } else {
-                parseUnknownElement(xml);
-            }
-        }
-    }
-    delete forecast;
-}
-
-void EnvCanadaIon::parseRegionalNormals(WeatherData& data, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("regionalNormals"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        if (xml.isEndElement()) {
-            break;
-        }
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("textSummary")) {
-                xml.readElementText();
-            } else if (elementName == QLatin1String("temperature") && xml.attributes().value(QStringLiteral("class")) == QLatin1String("high")) {
-                // prevent N/A text to result in 0.0 value
-                parseFloat(data.normalHigh, xml);
-            } else if (elementName == QLatin1String("temperature") && xml.attributes().value(QStringLiteral("class")) == QLatin1String("low")) {
-                // prevent N/A text to result in 0.0 value
-                parseFloat(data.normalLow, xml);
-            }
-        }
-    }
-}
-
-void EnvCanadaIon::parseForecast(WeatherData& data, QXmlStreamReader& xml, WeatherData::ForecastInfo *forecast)
-{
-
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("forecast"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("forecast")) {
-            data.forecasts.append(forecast);
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("period")) {
-                forecast->forecastPeriod = xml.attributes().value(QStringLiteral("textForecastName")).toString();
-            } else if (elementName == QLatin1String("textSummary")) {
-                forecast->forecastSummary = xml.readElementText();
-            } else if (elementName == QLatin1String("abbreviatedForecast")) {
-                parseShortForecast(forecast, xml);
-            } else if (elementName == QLatin1String("temperatures")) {
-                parseForecastTemperatures(forecast, xml);
-            } else if (elementName == QLatin1String("winds")) {
-                parseWindForecast(forecast, xml);
-            } else if (elementName == QLatin1String("precipitation")) {
-                parsePrecipitationForecast(forecast, xml);
-            } else if (elementName == QLatin1String("uv")) {
-                data.UVRating = xml.attributes().value(QStringLiteral("category")).toString();
-                parseUVIndex(data, xml);
-                // else if (elementName == QLatin1String("frost")) { FIXME: Wait until winter to see what this looks like.
-                //  parseFrost(xml, forecast);
-            } else {
-                if (elementName != QLatin1String("forecast")) {
-                    parseUnknownElement(xml);
-                }
-            }
-        }
-    }
-}
-
-void EnvCanadaIon::parseShortForecast(WeatherData::ForecastInfo *forecast, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("abbreviatedForecast"));
-
-    QString shortText;
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("abbreviatedForecast")) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("pop")) {
-                parseFloat(forecast->popPrecent, xml);
-            }
-            if (elementName == QLatin1String("textSummary")) {
-                shortText = xml.readElementText();
-                QMap<QString, ConditionIcons> forecastList = forecastIcons();
-                if ((forecast->forecastPeriod == QLatin1String("tonight")) ||
-                    (forecast->forecastPeriod.contains(QLatin1String("night")))) {
-                    forecastList.insert(QStringLiteral("a few clouds"), FewCloudsNight);
-                    forecastList.insert(QStringLiteral("cloudy periods"), PartlyCloudyNight);
-                    forecastList.insert(QStringLiteral("chance of drizzle mixed with rain"), ChanceShowersNight);
-                    forecastList.insert(QStringLiteral("chance of drizzle"), ChanceShowersNight);
-                    forecastList.insert(QStringLiteral("chance of drizzle or rain"), ChanceShowersNight);
-                    forecastList.insert(QStringLiteral("chance of flurries"), ChanceSnowNight);
-                    forecastList.insert(QStringLiteral("chance of light snow"), ChanceSnowNight);
-                    forecastList.insert(QStringLiteral("chance of flurries at times heavy"), ChanceSnowNight);
-                    forecastList.insert(QStringLiteral("chance of showers or drizzle"), ChanceShowersNight);
-                    forecastList.insert(QStringLiteral("chance of showers"), ChanceShowersNight);
-                    forecastList.insert(QStringLiteral("clearing"), ClearNight);
-                } else {
-                    forecastList.insert(QStringLiteral("a few clouds"), FewCloudsDay);
-                    forecastList.insert(QStringLiteral("cloudy periods"), PartlyCloudyDay);
-                    forecastList.insert(QStringLiteral("chance of drizzle mixed with rain"), ChanceShowersDay);
-                    forecastList.insert(QStringLiteral("chance of drizzle"), ChanceShowersDay);
-                    forecastList.insert(QStringLiteral("chance of drizzle or rain"), ChanceShowersDay);
-                    forecastList.insert(QStringLiteral("chance of flurries"), ChanceSnowDay);
-                    forecastList.insert(QStringLiteral("chance of light snow"), ChanceSnowDay);
-                    forecastList.insert(QStringLiteral("chance of flurries at times heavy"), ChanceSnowDay);
-                    forecastList.insert(QStringLiteral("chance of showers or drizzle"), ChanceShowersDay);
-                    forecastList.insert(QStringLiteral("chance of showers"), ChanceShowersDay);
-                    forecastList.insert(QStringLiteral("clearing"), ClearDay);
-                }
-                forecast->shortForecast = shortText;
-                forecast->iconName = getWeatherIcon(forecastList, shortText.toLower());
-            }
-        }
-    }
-}
-
-void EnvCanadaIon::parseUVIndex(WeatherData& data, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("uv"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("uv")) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("index")) {
-                data.UVIndex = xml.readElementText();
-            }
-            if (elementName == QLatin1String("textSummary")) {
-                xml.readElementText();
-            }
-        }
-    }
-}
-
-void EnvCanadaIon::parseForecastTemperatures(WeatherData::ForecastInfo *forecast, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("temperatures"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("temperatures")) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("temperature") && xml.attributes().value(QStringLiteral("class")) == QLatin1String("low")) {
-                parseFloat(forecast->tempLow, xml);
-            } else if (elementName == QLatin1String("temperature") && xml.attributes().value(QStringLiteral("class")) == QLatin1String("high")) {
-                parseFloat(forecast->tempHigh, xml);
-            } else if (elementName == QLatin1String("textSummary")) {
-                xml.readElementText();
-            }
-        }
-    }
-}
-
-void EnvCanadaIon::parsePrecipitationForecast(WeatherData::ForecastInfo *forecast, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("precipitation"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("precipitation")) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("textSummary")) {
-                forecast->precipForecast = xml.readElementText();
-            } else if (elementName == QLatin1String("precipType")) {
-                forecast->precipType = xml.readElementText();
-            } else if (elementName == QLatin1String("accumulation")) {
-                parsePrecipTotals(forecast, xml);
-            }
-        }
-    }
-}
-
-void EnvCanadaIon::parsePrecipTotals(WeatherData::ForecastInfo *forecast, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("accumulation"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("accumulation")) {
-            break;
-        }
-
-        if (elementName == QLatin1String("name")) {
-            xml.readElementText();
-        } else if (elementName == QLatin1String("amount")) {
-            forecast->precipTotalExpected = xml.readElementText();
-        }
-    }
-}
-
-void EnvCanadaIon::parseWindForecast(WeatherData::ForecastInfo *forecast, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("winds"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("winds")) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("textSummary")) {
-                forecast->windForecast = xml.readElementText();
-            } else {
-                if (xml.name() != QLatin1String("winds")) {
-                    parseUnknownElement(xml);
-                }
-            }
-        }
-    }
-}
-
-void EnvCanadaIon::parseYesterdayWeather(WeatherData& data, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("yesterdayConditions"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        if (xml.isEndElement()) {
-            break;
-        }
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("temperature") && xml.attributes().value(QStringLiteral("class")) == QLatin1String("high")) {
-                parseFloat(data.prevHigh, xml);
-            } else if (elementName == QLatin1String("temperature") && xml.attributes().value(QStringLiteral("class")) == QLatin1String("low")) {
-                parseFloat(data.prevLow, xml);
-            } else if (elementName == QLatin1String("precip")) {
-                data.prevPrecipType = xml.attributes().value(QStringLiteral("units")).toString();
-                if (data.prevPrecipType.isEmpty()) {
-                    data.prevPrecipType = QString::number(KUnitConversion::NoUnit);
-                }
-                data.prevPrecipTotal = xml.readElementText();
-            }
-        }
-    }
-}
-
-void EnvCanadaIon::parseWeatherRecords(WeatherData& data, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("almanac"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("almanac")) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("temperature") && xml.attributes().value(QStringLiteral("class")) == QLatin1String("extremeMax")) {
-                parseFloat(data.recordHigh, xml);
-            } else if (elementName == QLatin1String("temperature") && xml.attributes().value(QStringLiteral("class")) == QLatin1String("extremeMin")) {
-                parseFloat(data.recordLow, xml);
-            } else if (elementName == QLatin1String("precipitation") && xml.attributes().value(QStringLiteral("class")) == QLatin1String("extremeRainfall")) {
-                parseFloat(data.recordRain, xml);
-            } else if (elementName == QLatin1String("precipitation") && xml.attributes().value(QStringLiteral("class")) == QLatin1String("extremeSnowfall")) {
-                parseFloat(data.recordSnow, xml);
-            }
-        }
-    }
-}
-
-void EnvCanadaIon::parseAstronomicals(WeatherData& data, QXmlStreamReader& xml)
-{
-    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("riseSet"));
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement() && elementName == QLatin1String("riseSet")) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("disclaimer")) {
-                xml.readElementText();
-            } else if (elementName == QLatin1String("dateTime")) {
-                parseDateTime(data, xml);
-            }
-        }
-    }
-}
-
-// handle when no XML tag is found
-void EnvCanadaIon::parseUnknownElement(QXmlStreamReader& xml) const
-{
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        if (xml.isEndElement()) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            parseUnknownElement(xml);
-        }
-    }
-}
-
 void EnvCanadaIon::updateWeather(const QString& source)
 {
     //qCDebug(IONENGINE_ENVCAN) << "updateWeather()";
@@ -1533,45 +1109,45 @@ void EnvCanadaIon::updateWeather(const QString& source)
         data.insert(QStringLiteral("UV Rating"), weatherData.UVRating);
     }
 
-    const QVector<WeatherData::WeatherEvent*>& watches = weatherData.watches;
+    const QVector<WeatherData::WeatherEvent>& watches = weatherData.watches;
 
     // Set number of forecasts per day/night supported
     data.insert(QStringLiteral("Total Watches Issued"), watches.size());
 
     // Check if we have warnings or watches
     for (int i = 0; i < watches.size(); ++i) {
-        const WeatherData::WeatherEvent* watch = watches.at(i);
+        const WeatherData::WeatherEvent& watch = watches.at(i);
         const QString number = QString::number(i);
 
-        data.insert(QStringLiteral("Watch Priority ") + number, watch->priority);
-        data.insert(QStringLiteral("Watch Description ") + number, watch->description);
-        data.insert(QStringLiteral("Watch Info ") + number, watch->url);
-        data.insert(QStringLiteral("Watch Timestamp ") + number, watch->timestamp);
+        data.insert(QStringLiteral("Watch Priority ") + number, watch.priority);
+        data.insert(QStringLiteral("Watch Description ") + number, watch.description);
+        data.insert(QStringLiteral("Watch Info ") + number, watch.url);
+        data.insert(QStringLiteral("Watch Timestamp ") + number, watch.timestamp);
     }
 
-    const QVector<WeatherData::WeatherEvent*>& warnings = weatherData.warnings;
+    const QVector<WeatherData::WeatherEvent>& warnings = weatherData.warnings;
 
     data.insert(QStringLiteral("Total Warnings Issued"), warnings.size());
 
     for (int k = 0; k < warnings.size(); ++k) {
-        const WeatherData::WeatherEvent* warning = warnings.at(k);
+        const WeatherData::WeatherEvent& warning = warnings.at(k);
         const QString number = QString::number(k);
 
-        data.insert(QStringLiteral("Warning Priority ") + number, warning->priority);
-        data.insert(QStringLiteral("Warning Description ") + number, warning->description);
-        data.insert(QStringLiteral("Warning Info ") + number, warning->url);
-        data.insert(QStringLiteral("Warning Timestamp ") + number, warning->timestamp);
+        data.insert(QStringLiteral("Warning Priority ") + number, warning.priority);
+        data.insert(QStringLiteral("Warning Description ") + number, warning.description);
+        data.insert(QStringLiteral("Warning Info ") + number, warning.url);
+        data.insert(QStringLiteral("Warning Timestamp ") + number, warning.timestamp);
     }
 
-    const QVector <WeatherData::ForecastInfo *>& forecasts = weatherData.forecasts;
+    const QVector<WeatherData::ForecastInfo>& forecasts = weatherData.forecasts;
 
     // Set number of forecasts per day/night supported
     data.insert(QStringLiteral("Total Weather Days"), forecasts.size());
 
     int i = 0;
-    for (const WeatherData::ForecastInfo* forecastInfo : forecasts) {
+    for (const WeatherData::ForecastInfo& forecastInfo : forecasts) {
 
-        QString forecastPeriod = forecastInfo->forecastPeriod;
+        QString forecastPeriod = forecastInfo.forecastPeriod;
         if (forecastPeriod.isEmpty()) {
             forecastPeriod = i18n("N/A");
         } else {
@@ -1588,22 +1164,22 @@ void EnvCanadaIon::updateWeather(const QString& source)
             forecastPeriod.replace(QStringLiteral("Thursday"), i18nc("Short for Thursday", "Thu"));
             forecastPeriod.replace(QStringLiteral("Friday"), i18nc("Short for Friday", "Fri"));
         }
-        const QString shortForecast = forecastInfo->shortForecast.isEmpty() ? i18n("N/A") :
-            i18nc("weather forecast", forecastInfo->shortForecast.toUtf8().data());
+        const QString shortForecast = forecastInfo.shortForecast.isEmpty() ? i18n("N/A") :
+            i18nc("weather forecast", forecastInfo.shortForecast.toUtf8().data());
 
-        const QString tempHigh = qIsNaN(forecastInfo->tempHigh) ? QString() : QString::number(forecastInfo->tempHigh);
-        const QString tempLow = qIsNaN(forecastInfo->tempLow) ? QString() : QString::number(forecastInfo->tempLow);
-        const QString popPrecent = qIsNaN(forecastInfo->popPrecent) ? QString() : QString::number(forecastInfo->popPrecent);
+        const QString tempHigh = qIsNaN(forecastInfo.tempHigh) ? QString() : QString::number(forecastInfo.tempHigh);
+        const QString tempLow = qIsNaN(forecastInfo.tempLow) ? QString() : QString::number(forecastInfo.tempLow);
+        const QString popPrecent = qIsNaN(forecastInfo.popPrecent) ? QString() : QString::number(forecastInfo.popPrecent);
 
         data.insert(QStringLiteral("Short Forecast Day %1").arg(i),
                     QStringLiteral("%1|%2|%3|%4|%5|%6").arg(
                                    forecastPeriod,
-                                   forecastInfo->iconName,
+                                   forecastInfo.iconName,
                                    shortForecast,
                                    tempHigh,
                                    tempLow,
                                    popPrecent));
-        //qCDebug(IONENGINE_ENVCAN) << "i18n summary string: " << qPrintable(i18n(forecastInfo->shortForecast.toUtf8()));
+        //qCDebug(IONENGINE_ENVCAN) << "i18n summary string: " << qPrintable(i18n(forecastInfo.shortForecast.toUtf8()));
 
         /*
                 data.insert(QString("Long Forecast Day %1").arg(i), QString("%1|%2|%3|%4|%5|%6|%7|%8") \
@@ -23,6 +23,7 @@
 #define ION_ENVCAN_H
 
 #include "../ion.h"
+#include "../stationindex.h"
 
 #include <Plasma/DataEngineConsumer>
 
@@ -103,8 +104,8 @@ public:
     QString windDirection;
     QString windDegrees;
 
-    QVector <WeatherData::WeatherEvent *> watches;
-    QVector <WeatherData::WeatherEvent *> warnings;
+    QVector<WeatherData::WeatherEvent> watches;
+    QVector<WeatherData::WeatherEvent> warnings;
 
     float normalHigh;
     float normalLow;
@@ -115,7 +116,7 @@ public:
     QString UVRating;
 
     // 5 day Forecast
-    QVector <WeatherData::ForecastInfo *> forecasts;
+    QVector<WeatherData::ForecastInfo> forecasts;
 
     // Historical data from previous day.
     float prevHigh;
@@ -168,15 +169,10 @@ private Q_SLOTS:
     void setup_slotDataArrived(KIO::Job *, const QByteArray &);
     void setup_slotJobFinished(KJob *);
 
-    void slotDataArrived(KIO::Job *, const QByteArray &);
-    void slotJobFinished(KJob *);
-
 private:
     void updateWeather(const QString& source);
 
     /* Environment Canada Methods - Internal for Ion */
-    void deleteForecasts();
-
     QMap<QString, ConditionIcons> setupConditionIconMappings() const;
     QMap<QString, ConditionIcons> setupForecastIconMappings() const;
 
@@ -185,56 +181,36 @@ private:
 
     // Load and Parse the place XML listing
     void getXMLSetup();
-    bool readXMLSetup();
+    bool readXMLSetup(const QString& httpHeaders);
 
     // Load and parse the specific place(s)
     void getXMLData(const QString& source);
-    bool readXMLData(const QString& source, QXmlStreamReader& xml);
+    void setWeatherData(const QString& source, WeatherData data);
 
     // Check if place specified is valid or not
     QStringList validate(const QString& source) const;
 
-    // Catchall for unknown XML tags
-    void parseUnknownElement(QXmlStreamReader& xml) const;
-
-    // Parse weather XML data
-    void parseWeatherSite(WeatherData& data, QXmlStreamReader& xml);
-    void parseDateTime(WeatherData& data, QXmlStreamReader& xml, WeatherData::WeatherEvent* event = nullptr);
-    void parseLocations(WeatherData& data, QXmlStreamReader& xml);
-    void parseConditions(WeatherData& data, QXmlStreamReader& xml);
-    void parseWarnings(WeatherData& data, QXmlStreamReader& xml);
-    void parseWindInfo(WeatherData& data, QXmlStreamReader& xml);
-    void parseWeatherForecast(WeatherData& data, QXmlStreamReader& xml);
-    void parseRegionalNormals(WeatherData& data, QXmlStreamReader& xml);
-    void parseForecast(WeatherData& data, QXmlStreamReader& xml, WeatherData::ForecastInfo* forecast);
-    void parseShortForecast(WeatherData::ForecastInfo* forecast, QXmlStreamReader& xml);
-    void parseForecastTemperatures(WeatherData::ForecastInfo* forecast, QXmlStreamReader& xml);
-    void parseWindForecast(WeatherData::ForecastInfo* forecast, QXmlStreamReader& xml);
-    void parsePrecipitationForecast(WeatherData::ForecastInfo* forecast, QXmlStreamReader& xml);
-    void parsePrecipTotals(WeatherData::ForecastInfo* forecast, QXmlStreamReader& xml);
-    void parseUVIndex(WeatherData& data, QXmlStreamReader& xml);
-    void parseYesterdayWeather(WeatherData& data, QXmlStreamReader& xml);
-    void parseAstronomicals(WeatherData& data, QXmlStreamReader& xml);
-    void parseWeatherRecords(WeatherData& data, QXmlStreamReader& xml);
-
-    void parseFloat(float& value, QXmlStreamReader& xml);
+    static void parseFloat(float& value, const QString& string);
+
+public:
+    // parser of the downloaded city pages, defined in ion_envcanparsers.h
+    class WeatherParser;
 
 private:
-    struct XMLMapInfo {
-        QString cityName;
-        QString territoryName;
-        QString cityCode;
+    // Fields of the stations in m_stations
+    enum StationField {
+        PlaceField = 0,
+        CityNameField,
+        TerritoryNameField,
+        CityCodeField
     };
 
     // Key dicts
-    QHash<QString, EnvCanadaIon::XMLMapInfo> m_places;
+    StationIndex m_stations;
 
     // Weather information
     QHash<QString, WeatherData> m_weatherData;
 
-    // Store KIO jobs
-    QHash<KJob *, QXmlStreamReader*> m_jobXml;
-    QHash<KJob *, QString> m_jobList;
     QStringList m_sourcesToReset;
     QXmlStreamReader m_xmlSetup;
 
@@ -0,0 +1,55 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA          *
+ ***************************************************************************/
+
+#ifndef ION_ENVCANPARSERS_H
+#define ION_ENVCANPARSERS_H
+
+#include "ion_envcan.h"
+
+#include "../incrementalxmlparser.h"
+
+/**
+ * Parses the city page of a city.
+ */
+class EnvCanadaIon::WeatherParser : public IncrementalXmlParser
+{
+public:
+    explicit WeatherParser(const EnvCanadaIon* ion);
+
+    WeatherData data;
+
+protected:
+    void startElement(const QStringRef& name, const QXmlStreamAttributes& attributes) override;
+    void endElement(const QStringRef& name, const QString& text) override;
+
+private:
+    void endDateTimeElement(const QStringRef& name, const QString& text);
+
+    const EnvCanadaIon* const m_ion;
+
+    // attributes of the current <dateTime> and its time stamp
+    QString m_dateType;
+    QString m_dateZone;
+    QString m_dateUtcOffset;
+    QString m_timeStamp;
+
+    QString m_eventUrl;
+    WeatherData::WeatherEvent m_event;
+    WeatherData::ForecastInfo m_forecast;
+};
+
+#endif
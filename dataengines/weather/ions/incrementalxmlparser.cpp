@@ -0,0 +1,186 @@
+/*****************************************************************************
+ * This library is free software; you can redistribute it and/or             *
+ * modify it under the terms of the GNU Library General Public               *
+ * License as published by the Free Software Foundation; either              *
+ * version 2 of the License, or (at your option) any later version.          *
+ *                                                                           *
+ * This library is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU         *
+ * Library General Public License for more details.                          *
+ *                                                                           *
+ * You should have received a copy of the GNU Library General Public License *
+ * along with this library; see the file COPYING.LIB.  If not, write to      *
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,      *
+ * Boston, MA 02110-1301, USA.                                               *
+ *****************************************************************************/
+
+#include "incrementalxmlparser.h"
+
+#include <QMutex>
+#include <QSet>
+#include <QVector>
+#include <QXmlStreamReader>
+
+namespace
+{
+    // condition, wind and period strings of all ions are well below that
+    const int s_maxInternedStrings = 4096;
+
+    // shared by the ions of all weather engines in the process, which may
+    // be driven from different threads
+    struct InternedStrings {
+        QMutex mutex;
+        QSet<QString> strings;
+    };
+}
+
+Q_GLOBAL_STATIC(InternedStrings, s_internedStrings)
+
+class Q_DECL_HIDDEN IncrementalXmlParser::Private
+{
+public:
+    struct Element {
+        QString name;
+        QXmlStreamAttributes attributes;
+        QString text;
+    };
+
+    QString elementName(const QStringRef &name);
+
+    QXmlStreamReader xml;
+    QVector<Element> elements;
+    // a document only has a few distinct element names, so they are kept
+    // here instead of allocating a new string for every element
+    QVector<QString> names;
+};
+
+QString IncrementalXmlParser::Private::elementName(const QStringRef &name)
+{
+    for (const QString &known : qAsConst(names)) {
+        if (name == known) {
+            return known;
+        }
+    }
+
+    names.append(name.toString());
+    return names.last();
+}
+
+IncrementalXmlParser::IncrementalXmlParser()
+    : d(new Private)
+{
+}
+
+IncrementalXmlParser::~IncrementalXmlParser()
+{
+    delete d;
+}
+
+void IncrementalXmlParser::addData(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+
+    d->xml.addData(data);
+    parse();
+}
+
+bool IncrementalXmlParser::finish()
+{
+    // a document that ends early is as useless as a malformed one
+    d->elements.clear();
+    return !d->xml.hasError() && d->xml.atEnd();
+}
+
+bool IncrementalXmlParser::hasError() const
+{
+    return d->xml.hasError() && d->xml.error() != QXmlStreamReader::PrematureEndOfDocumentError;
+}
+
+QString IncrementalXmlParser::errorString() const
+{
+    return d->xml.errorString();
+}
+
+QString IncrementalXmlParser::intern(const QString &string)
+{
+    InternedStrings *interned = s_internedStrings();
+    QMutexLocker locker(&interned->mutex);
+
+    const auto it = interned->strings.constFind(string);
+    if (it != interned->strings.constEnd()) {
+        return *it;
+    }
+
+    if (interned->strings.size() < s_maxInternedStrings) {
+        interned->strings.insert(string);
+    }
+    return string;
+}
+
+void IncrementalXmlParser::startElement(const QStringRef &name, const QXmlStreamAttributes &attributes)
+{
+    Q_UNUSED(name)
+    Q_UNUSED(attributes)
+}
+
+void IncrementalXmlParser::endElement(const QStringRef &name, const QString &text)
+{
+    Q_UNUSED(name)
+    Q_UNUSED(text)
+}
+
+int IncrementalXmlParser::depth() const
+{
+    return d->elements.size();
+}
+
+QString IncrementalXmlParser::parentName(int level) const
+{
+    const int index = d->elements.size() - 1 - level;
+    return index >= 0 ? d->elements.at(index).name : QString();
+}
+
+QXmlStreamAttributes IncrementalXmlParser::attributes() const
+{
+    return d->elements.isEmpty() ? QXmlStreamAttributes() : d->elements.last().attributes;
+}
+
+QStringRef IncrementalXmlParser::namespaceUri() const
+{
+    return d->xml.namespaceUri();
+}
+
+void IncrementalXmlParser::parse()
+{
+    // stops with a PrematureEndOfDocumentError when running out of data,
+    // the next addData() resumes from there
+    while (!d->xml.atEnd()) {
+        switch (d->xml.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            Private::Element element;
+            element.name = d->elementName(d->xml.name());
+            element.attributes = d->xml.attributes();
+            d->elements.append(element);
+
+            startElement(d->xml.name(), d->elements.last().attributes);
+            break;
+        }
+        case QXmlStreamReader::Characters:
+            if (!d->elements.isEmpty()) {
+                d->elements.last().text.append(d->xml.text());
+            }
+            break;
+        case QXmlStreamReader::EndElement:
+            if (!d->elements.isEmpty()) {
+                endElement(d->xml.name(), d->elements.last().text);
+                d->elements.removeLast();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
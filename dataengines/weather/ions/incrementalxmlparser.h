@@ -0,0 +1,110 @@
+/*****************************************************************************
+ * This library is free software; you can redistribute it and/or             *
+ * modify it under the terms of the GNU Library General Public               *
+ * License as published by the Free Software Foundation; either              *
+ * version 2 of the License, or (at your option) any later version.          *
+ *                                                                           *
+ * This library is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU         *
+ * Library General Public License for more details.                          *
+ *                                                                           *
+ * You should have received a copy of the GNU Library General Public License *
+ * along with this library; see the file COPYING.LIB.  If not, write to      *
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,      *
+ * Boston, MA 02110-1301, USA.                                               *
+ *****************************************************************************/
+
+#ifndef INCREMENTALXMLPARSER_H
+#define INCREMENTALXMLPARSER_H
+
+#include <QString>
+#include <QXmlStreamAttributes>
+
+#include "ion_export.h"
+
+/**
+* Base class for parsers of the weather data documents of an ion.
+*
+* The document is parsed while it is downloaded: every chunk handed to
+* addData() is parsed right away and reported through startElement() and
+* endElement(), so subclasses can fill their structs as the data arrives
+* instead of keeping the whole response around until the download is done.
+*
+* The text of an element is collected for it and passed to endElement(),
+* which covers what the ions used QXmlStreamReader::readElementText() for.
+* The names of the current element and its ancestors can be queried to
+* tell apart elements of the same name in different places of the document.
+*/
+class ION_EXPORT IncrementalXmlParser
+{
+public:
+    IncrementalXmlParser();
+    virtual ~IncrementalXmlParser();
+
+    /**
+     * Parses @p data as far as possible. An incomplete token at the end is
+     * kept until the next call.
+     */
+    void addData(const QByteArray &data);
+
+    /**
+     * To be called once all data was added.
+     * @return whether a complete and well-formed document was parsed
+     */
+    bool finish();
+
+    bool hasError() const;
+    QString errorString() const;
+
+    /**
+     * @return a string equal to @p string, which shares its data with all
+     * other interned copies. Meant for the small set of condition and wind
+     * strings which are repeated in every observation and forecast.
+     * Thread-safe.
+     */
+    static QString intern(const QString &string);
+
+protected:
+    /**
+     * Called when the start tag of an element was parsed.
+     */
+    virtual void startElement(const QStringRef &name, const QXmlStreamAttributes &attributes);
+
+    /**
+     * Called when the end tag of an element was parsed.
+     * @param text the text directly contained in the element
+     */
+    virtual void endElement(const QStringRef &name, const QString &text);
+
+    /**
+     * @return the nesting level of the current element, 1 for the root element
+     */
+    int depth() const;
+
+    /**
+     * @return the name of the ancestor @p level levels above the current
+     * element, the parent for 1, or an empty string if there is none
+     */
+    QString parentName(int level = 1) const;
+
+    /**
+     * @return the attributes of the current element, also in endElement()
+     */
+    QXmlStreamAttributes attributes() const;
+
+    /**
+     * @return the namespace uri of the current element
+     */
+    QStringRef namespaceUri() const;
+
+private:
+    void parse();
+
+    class Private;
+    Private* const d;
+
+    Q_DISABLE_COPY(IncrementalXmlParser)
+};
+
+#endif
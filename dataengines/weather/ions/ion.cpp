@@ -20,9 +20,21 @@
 #include "ion.h"
 
 #include "iondebug.h"
+#include "stationindex.h"
 
+#include <KIO/TransferJob>
 #include <KLocalizedString>
 
+#include <QDateTime>
+#include <QLocale>
+#include <QTimer>
+
+namespace
+{
+    // responses of all sources of an ion, usually one or two per place
+    const int s_maxCachedResponses = 64;
+}
+
 class Q_DECL_HIDDEN IonInterface::Private
 {
 public:
@@ -30,10 +42,154 @@ public:
             : ion(i),
             initialized(false) {}
 
+    struct CachedResponse {
+        QByteArray data;
+        QString etag;
+        QString lastModified;
+        QDateTime expires;
+    };
+
+    struct PendingFetch {
+        QStringList sources;
+        DataCallback dataArrived;
+        FetchCallback finished;
+        QByteArray data;
+    };
+
+    void fetchResult(const QUrl &url, KIO::TransferJob *job);
+    void finishFetch(const QUrl &url, const QByteArray &data, bool fromCache = false);
+    void cacheResponse(const QUrl &url, const CachedResponse &response);
+    static bool parseExpiry(const QString &headers, QDateTime *expires);
+
     IonInterface *ion;
     bool initialized;
+
+    QHash<QUrl, CachedResponse> responses;
+    QHash<QUrl, PendingFetch> fetches;
 };
 
+void IonInterface::Private::fetchResult(const QUrl &url, KIO::TransferJob *job)
+{
+    const auto it = fetches.constFind(url);
+    if (it == fetches.constEnd()) {
+        return;
+    }
+
+    if (job->error()) {
+        qCWarning(IONENGINE) << "Failed to fetch" << url << job->errorString();
+        finishFetch(url, QByteArray());
+        return;
+    }
+
+    const QString headers = job->queryMetaData(QStringLiteral("HTTP-Headers"));
+    auto cached = responses.find(url);
+    if (cached != responses.end() && job->queryMetaData(QStringLiteral("responsecode")) == QLatin1String("304")) {
+        qCDebug(IONENGINE) << "Cached response still valid for" << url;
+        parseExpiry(headers, &cached->expires);
+        finishFetch(url, cached->data, true);
+        return;
+    }
+
+    const QByteArray data = it->data;
+
+    CachedResponse response;
+    response.data = data;
+    StationIndex::parseResponseHeaders(headers, &response.etag, &response.lastModified);
+    if (parseExpiry(headers, &response.expires)) {
+        cacheResponse(url, response);
+    } else {
+        responses.remove(url);
+    }
+
+    finishFetch(url, data);
+}
+
+void IonInterface::Private::finishFetch(const QUrl &url, const QByteArray &data, bool fromCache)
+{
+    // take it out first, the callback may well fetch the url again
+    const PendingFetch pending = fetches.take(url);
+    if (fromCache && pending.dataArrived && !data.isEmpty()) {
+        pending.dataArrived(data);
+    }
+    if (pending.finished) {
+        pending.finished(data, pending.sources);
+    }
+}
+
+void IonInterface::Private::cacheResponse(const QUrl &url, const CachedResponse &response)
+{
+    if (response.etag.isEmpty() && response.lastModified.isEmpty() && response.expires <= QDateTime::currentDateTimeUtc()) {
+        // could neither be reused nor revalidated
+        responses.remove(url);
+        return;
+    }
+
+    responses.insert(url, response);
+
+    while (responses.size() > s_maxCachedResponses) {
+        auto oldest = responses.begin();
+        for (auto it = responses.begin(); it != responses.end(); ++it) {
+            if (it->expires < oldest->expires) {
+                oldest = it;
+            }
+        }
+        responses.erase(oldest);
+    }
+}
+
+/**
+ * Reads how long a response may be used from its Cache-Control and Expires headers.
+ * Returns false if the response must not be stored at all.
+ */
+bool IonInterface::Private::parseExpiry(const QString &headers, QDateTime *expires)
+{
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    // without any hint the response has to be revalidated before it is used again
+    *expires = now;
+
+    bool hasMaxAge = false;
+    const QVector<QStringRef> lines = headers.splitRef(QLatin1Char('\n'));
+    for (const QStringRef &line : lines) {
+        const int colon = line.indexOf(QLatin1Char(':'));
+        if (colon < 0) {
+            continue;
+        }
+
+        const QStringRef name = line.left(colon).trimmed();
+        const QStringRef value = line.mid(colon + 1).trimmed();
+
+        if (name.compare(QLatin1String("Cache-Control"), Qt::CaseInsensitive) == 0) {
+            const QVector<QStringRef> directives = value.split(QLatin1Char(','));
+            for (const QStringRef &directive : directives) {
+                const QStringRef trimmed = directive.trimmed();
+                if (trimmed.compare(QLatin1String("no-store"), Qt::CaseInsensitive) == 0) {
+                    return false;
+                }
+                if (trimmed.compare(QLatin1String("no-cache"), Qt::CaseInsensitive) == 0) {
+                    *expires = now;
+                    hasMaxAge = true;
+                } else if (trimmed.startsWith(QLatin1String("max-age="), Qt::CaseInsensitive) && !hasMaxAge) {
+                    bool ok = false;
+                    const int maxAge = trimmed.mid(8).toInt(&ok);
+                    if (ok) {
+                        *expires = now.addSecs(maxAge);
+                        hasMaxAge = true;
+                    }
+                }
+            }
+        } else if (name.compare(QLatin1String("Expires"), Qt::CaseInsensitive) == 0 && !hasMaxAge) {
+            // max-age takes precedence, no matter in which order the headers come
+            QDateTime date = QLocale::c().toDateTime(value.toString(), QStringLiteral("ddd, dd MMM yyyy HH:mm:ss 'GMT'"));
+            if (date.isValid()) {
+                date.setTimeSpec(Qt::UTC);
+                *expires = date;
+            }
+        }
+    }
+
+    return true;
+}
+
 IonInterface::IonInterface(QObject *parent, const QVariantList &args)
         : Plasma::DataEngine(parent, args),
         d(new Private(this))
@@ -92,6 +248,74 @@ void IonInterface::setInitialized(bool initialized)
     }
 }
 
+bool IonInterface::isInitialized() const
+{
+    return d->initialized;
+}
+
+void IonInterface::fetch(const QUrl &url, const QString &source, const FetchCallback &finished)
+{
+    fetch(url, source, DataCallback(), finished);
+}
+
+void IonInterface::fetch(const QUrl &url, const QString &source, const DataCallback &dataArrived, const FetchCallback &finished)
+{
+    auto it = d->fetches.find(url);
+    if (it != d->fetches.end()) {
+        qCDebug(IONENGINE) << "Joining running fetch of" << url << "for" << source;
+        if (!it->sources.contains(source)) {
+            it->sources.append(source);
+        }
+        return;
+    }
+
+    Private::PendingFetch &pending = d->fetches[url];
+    pending.sources.append(source);
+    pending.dataArrived = dataArrived;
+    pending.finished = finished;
+
+    const auto cached = d->responses.constFind(url);
+    if (cached != d->responses.constEnd() && QDateTime::currentDateTimeUtc() < cached->expires) {
+        qCDebug(IONENGINE) << "Using cached response for" << url;
+        const QByteArray data = cached->data;
+        // deliver like a network reply, sources requested meanwhile join in
+        QTimer::singleShot(0, this, [this, url, data]() {
+            d->finishFetch(url, data, true);
+        });
+        return;
+    }
+
+    KIO::TransferJob *job = KIO::get(url, KIO::Reload, KIO::HideProgressInfo);
+    job->addMetaData(QStringLiteral("cookies"), QStringLiteral("none")); // Disable displaying cookies
+    job->addMetaData(QStringLiteral("PropagateHttpHeader"), QStringLiteral("true"));
+
+    if (cached != d->responses.constEnd()) {
+        QStringList headers;
+        if (!cached->etag.isEmpty()) {
+            headers << QLatin1String("If-None-Match: ") + cached->etag;
+        }
+        if (!cached->lastModified.isEmpty()) {
+            headers << QLatin1String("If-Modified-Since: ") + cached->lastModified;
+        }
+        if (!headers.isEmpty()) {
+            job->addMetaData(QStringLiteral("customHTTPHeader"), headers.join(QLatin1String("\r\n")));
+        }
+    }
+
+    connect(job, &KIO::TransferJob::data, this, [this, url](KIO::Job *, const QByteArray &data) {
+        auto it = d->fetches.find(url);
+        if (it != d->fetches.end() && !data.isEmpty()) {
+            it->data += data;
+            if (it->dataArrived) {
+                it->dataArrived(data);
+            }
+        }
+    });
+    connect(job, &KJob::result, this, [this, url](KJob *job) {
+        d->fetchResult(url, static_cast<KIO::TransferJob *>(job));
+    });
+}
+
 /**
  * Return wind direction svg element to display in applet when given a wind direction.
  */
@@ -22,6 +22,10 @@
 
 #include <Plasma/DataEngine>
 
+#include <QUrl>
+
+#include <functional>
+
 #include "ion_export.h"
 
 /**
@@ -119,6 +123,17 @@ class ION_EXPORT IonInterface : public Plasma::DataEngine
 
 public:
 
+    /**
+     * Called with the response body, which is empty if the fetch failed, and
+     * all sources that requested the url while it was being fetched.
+     */
+    typedef std::function<void(const QByteArray &data, const QStringList &sources)> FetchCallback;
+
+    /**
+     * Called with each chunk of a response as it arrives.
+     */
+    typedef std::function<void(const QByteArray &chunk)> DataCallback;
+
     enum ConditionIcons { ClearDay = 1, ClearWindyDay, FewCloudsDay, FewCloudsWindyDay, PartlyCloudyDay, PartlyCloudyWindyDay, Overcast, OvercastWindy,
                           Rain, LightRain, Showers, ChanceShowersDay, Thunderstorm, Hail,
                           Snow, LightSnow, Flurries, FewCloudsNight, FewCloudsWindyNight,  ChanceShowersNight,
@@ -189,6 +204,34 @@ protected:
      */
     void setInitialized(bool initialized);
 
+    /**
+     * @return whether the ion is currently ready to fetch data
+     */
+    bool isInitialized() const;
+
+    /**
+     * Fetches @p url on behalf of @p source.
+     *
+     * Fetches are shared between sources: if the url is already being
+     * fetched, @p source is only added to the sources passed to the callback
+     * of the running fetch, so the response is downloaded and parsed once.
+     * Responses are kept as long as their Cache-Control max-age or Expires
+     * header allows and are revalidated using their ETag or Last-Modified
+     * header afterwards.
+     *
+     * @p finished is always called asynchronously.
+     */
+    void fetch(const QUrl &url, const QString &source, const FetchCallback &finished);
+
+    /**
+     * Like fetch() above, but additionally passes the response to
+     * @p dataArrived while it is downloaded, so it can be parsed
+     * incrementally. A cached response is passed as a single chunk.
+     * If the download fails after some data arrived, @p finished is
+     * still called with an empty response.
+     */
+    void fetch(const QUrl &url, const QString &source, const DataCallback &dataArrived, const FetchCallback &finished);
+
     /**
      * Reimplemented from Plasma::DataEngine
      * @param source The datasource being requested
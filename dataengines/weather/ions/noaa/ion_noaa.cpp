@@ -20,6 +20,7 @@
 /* Ion for NOAA's National Weather Service XML data */
 
 #include "ion_noaa.h"
+#include "ion_noaaparsers.h"
 
 #include "ion_noaadebug.h"
 
@@ -28,6 +29,7 @@
 #include <KLocalizedString>
 
 #include <QLocale>
+#include <QSharedPointer>
 #include <QTimeZone>
 
 
@@ -88,7 +90,13 @@ QMap<QString, IonInterface::WindDirections> const& NOAAIon::windIcons() const
 // ctor, dtor
 NOAAIon::NOAAIon(QObject *parent, const QVariantList &args)
         : IonInterface(parent, args)
+        , m_stations(QStringLiteral("noaa"))
 {
+    // The station list of the last session allows to serve requests right away
+    if (m_stations.load()) {
+        setInitialized(true);
+    }
+
     // Get the real city XML URL so we can parse this
     getXMLSetup();
 }
@@ -109,24 +117,23 @@ QStringList NOAAIon::validate(const QString& source) const
 {
     QStringList placeList;
     QString station;
-    QString sourceNormalized = source.toUpper();
 
-    QHash<QString, NOAAIon::XMLMapInfo>::const_iterator it = m_places.constBegin();
     // If the source name might look like a station ID, check these too and return the name
-    bool checkState = source.count() == 2;
-
-    while (it != m_places.constEnd()) {
-        if (checkState) {
-            if (it.value().stateName == source) {
-                placeList.append(QStringLiteral("place|").append(it.key()));
-            }
-        } else if (it.key().toUpper().contains(sourceNormalized)) {
-            placeList.append(QStringLiteral("place|").append(it.key()));
-        } else if (it.value().stationID == sourceNormalized) {
-            station = QStringLiteral("place|").append(it.key());
+    if (source.count() == 2) {
+        const QVector<int> stations = m_stations.findByField(StateField, source);
+        for (int i : stations) {
+            placeList.append(QStringLiteral("place|").append(m_stations.place(i)));
+        }
+    } else {
+        const QVector<int> stations = m_stations.search(source);
+        for (int i : stations) {
+            placeList.append(QStringLiteral("place|").append(m_stations.place(i)));
         }
 
-        ++it;
+        const QVector<int> ids = m_stations.findByField(StationIDField, source.toUpper());
+        if (!ids.isEmpty() && !stations.contains(ids.constFirst())) {
+            station = QStringLiteral("place|").append(m_stations.place(ids.constFirst()));
+        }
     }
 
     placeList.sort();
@@ -177,11 +184,19 @@ bool NOAAIon::updateIonSource(const QString& source)
 }
 
 // Parses city list and gets the correct city based on ID number
-void NOAAIon::getXMLSetup() const
+void NOAAIon::getXMLSetup()
 {
     const QUrl url(QStringLiteral("https://www.weather.gov/data/current_obs/index.xml"));
 
-    KIO::TransferJob* getJob = KIO::get(url, KIO::NoReload, KIO::HideProgressInfo);
+    // Always ask the server, it answers with "304 Not Modified" if our station index is current
+    KIO::TransferJob* getJob = KIO::get(url, KIO::Reload, KIO::HideProgressInfo);
+    getJob->addMetaData(QStringLiteral("PropagateHttpHeader"), QStringLiteral("true"));
+    const QString conditionalHeaders = m_stations.conditionalRequestHeaders();
+    if (!conditionalHeaders.isEmpty()) {
+        getJob->addMetaData(QStringLiteral("customHTTPHeader"), conditionalHeaders);
+    }
+
+    m_xmlSetup.clear();
 
     connect(getJob, &KIO::TransferJob::data,
             this, &NOAAIon::setup_slotDataArrived);
@@ -189,19 +204,151 @@ void NOAAIon::getXMLSetup() const
             this, &NOAAIon::setup_slotJobFinished);
 }
 
-// Gets specific city XML data
-void NOAAIon::getXMLData(const QString& source)
+NOAAIon::ObservationParser::ObservationParser()
 {
-    for (const QString& fetching : qAsConst(m_jobList)) {
-        if (fetching == source) {
-            // already getting this source and awaiting the data
-            return;
+    data.isForecastsDataPending = true;
+}
+
+void NOAAIon::ObservationParser::startElement(const QStringRef& name, const QXmlStreamAttributes& attributes)
+{
+    Q_UNUSED(attributes)
+
+    if (depth() != 1 || name != QLatin1String("current_observation")) {
+        return;
+    }
+
+    data.temperature_C = qQNaN();
+    data.temperature_F = qQNaN();
+    data.dewpoint_C = qQNaN();
+    data.dewpoint_F = qQNaN();
+    data.weather = QStringLiteral("N/A");
+    data.stationID = i18n("N/A");
+    data.pressure = qQNaN();
+    data.visibility = qQNaN();
+    data.humidity = qQNaN();
+    data.windSpeed = qQNaN();
+    data.windGust = qQNaN();
+    data.windchill_F = qQNaN();
+    data.windchill_C = qQNaN();
+    data.heatindex_F = qQNaN();
+    data.heatindex_C = qQNaN();
+}
+
+void NOAAIon::ObservationParser::endElement(const QStringRef& name, const QString& text)
+{
+    if (parentName() != QLatin1String("current_observation")) {
+        return;
+    }
+
+    if (name == QLatin1String("location")) {
+        data.locationName = text;
+    } else if (name == QLatin1String("station_id")) {
+        data.stationID = text;
+    } else if (name == QLatin1String("latitude")) {
+        parseDouble(data.stationLatitude, text);
+    } else if (name == QLatin1String("longitude")) {
+        parseDouble(data.stationLongitude, text);
+    } else if (name == QLatin1String("observation_time_rfc822")) {
+        data.observationDateTime = QDateTime::fromString(text, Qt::RFC2822Date);
+    } else if (name == QLatin1String("observation_time")) {
+        const QStringList tmpDateStr = text.split(QLatin1Char(' '));
+        data.observationTime = QStringLiteral("%1 %2").arg(tmpDateStr.value(6), tmpDateStr.value(7));
+    } else if (name == QLatin1String("weather")) {
+        data.weather = (text.isEmpty() || text == QLatin1String("NA")) ? QStringLiteral("N/A") : intern(text);
+    } else if (name == QLatin1String("temp_f")) {
+        parseFloat(data.temperature_F, text);
+    } else if (name == QLatin1String("temp_c")) {
+        parseFloat(data.temperature_C, text);
+    } else if (name == QLatin1String("relative_humidity")) {
+        parseFloat(data.humidity, text);
+    } else if (name == QLatin1String("wind_dir")) {
+        data.windDirection = intern(text);
+    } else if (name == QLatin1String("wind_mph")) {
+        if (text == QLatin1String("NA")) {
+            data.windSpeed = 0.0;
+        } else {
+            parseFloat(data.windSpeed, text);
         }
+    } else if (name == QLatin1String("wind_gust_mph")) {
+        if (text == QLatin1String("NA") || text == QLatin1String("N/A")) {
+            data.windGust = 0.0;
+        } else {
+            parseFloat(data.windGust, text);
+        }
+    } else if (name == QLatin1String("pressure_in")) {
+        parseFloat(data.pressure, text);
+    } else if (name == QLatin1String("dewpoint_f")) {
+        parseFloat(data.dewpoint_F, text);
+    } else if (name == QLatin1String("dewpoint_c")) {
+        parseFloat(data.dewpoint_C, text);
+    } else if (name == QLatin1String("heat_index_f")) {
+        parseFloat(data.heatindex_F, text);
+    } else if (name == QLatin1String("heat_index_c")) {
+        parseFloat(data.heatindex_C, text);
+    } else if (name == QLatin1String("windchill_f")) {
+        parseFloat(data.windchill_F, text);
+    } else if (name == QLatin1String("windchill_c")) {
+        parseFloat(data.windchill_C, text);
+    } else if (name == QLatin1String("visibility_mi")) {
+        parseFloat(data.visibility, text);
+    }
+}
+
+void NOAAIon::ForecastParser::startElement(const QStringRef& name, const QXmlStreamAttributes& attributes)
+{
+    if (name == QLatin1String("temperature")) {
+        const QStringRef type = attributes.value(QStringLiteral("type"));
+        m_values = (type == QLatin1String("maximum")) ? HighValues :
+                   (type == QLatin1String("minimum")) ? LowValues :
+                   /*else*/                             NoValues;
+        m_day = 0;
+    } else if (name == QLatin1String("weather")) {
+        m_day = 0;
+    } else if (name == QLatin1String("weather-conditions") && parentName() == QLatin1String("weather") &&
+               m_day < forecasts.count()) {
+        WeatherData::Forecast& forecast = forecasts[m_day];
+        forecast.summary = intern(attributes.value(QStringLiteral("weather-summary")).toString());
+        qCDebug(IONENGINE_NOAA) << "i18n summary string: "
+                                << i18nc("weather forecast", forecast.summary.toUtf8().data());
+        ++m_day;
+    }
+}
+
+void NOAAIon::ForecastParser::endElement(const QStringRef& name, const QString& text)
+{
+    /* Read all reported days from <time-layout>. We check for existence of a specific
+     * <layout-key> which indicates the separate day listings.  The schema defines it to be
+     * the first item before the day listings.
+     */
+    if (name == QLatin1String("layout-key")) {
+        m_inDayLayout = (text == QLatin1String("k-p24h-n7-1"));
+    } else if (name == QLatin1String("time-layout")) {
+        m_inDayLayout = false;
+    } else if (name == QLatin1String("start-valid-time") && m_inDayLayout) {
+        const QDateTime date = QDateTime::fromString(text, Qt::ISODate);
+
+        WeatherData::Forecast forecast;
+        forecast.day = QLocale().toString(date.date().day());
+        forecasts.append(forecast);
+    } else if (name == QLatin1String("value") && parentName() == QLatin1String("temperature") &&
+               m_values != NoValues && m_day < forecasts.count()) {
+        if (m_values == HighValues) {
+            forecasts[m_day].high = text;
+        } else {
+            forecasts[m_day].low = text;
+        }
+        ++m_day;
+    } else if (name == QLatin1String("temperature")) {
+        m_values = NoValues;
     }
+}
 
+// Gets specific city XML data
+void NOAAIon::getXMLData(const QString& source)
+{
     QString dataKey = source;
     dataKey.remove(QStringLiteral("noaa|weather|"));
-    const QUrl url(m_places[dataKey].XMLurl);
+    const QUrl url(m_stations.field(m_stations.find(dataKey), XMLUrlField));
 
     // If this is empty we have no valid data, send out an error and abort.
     if (url.url().isEmpty()) {
@@ -209,14 +356,27 @@ void NOAAIon::getXMLData(const QString& source)
         return;
     }
 
-    KIO::TransferJob* getJob = KIO::get(url, KIO::Reload, KIO::HideProgressInfo);
-    m_jobXml.insert(getJob, new QXmlStreamReader);
-    m_jobList.insert(getJob, source);
+    // all sources of the place share the fetch and its result
+    QSharedPointer<ObservationParser> parser(new ObservationParser);
+    fetch(url, source,
+          [parser](const QByteArray& chunk) {
+              parser->addData(chunk);
+          },
+          [this, parser](const QByteArray&, const QStringList& sources) {
+              if (!parser->finish()) {
+                  qCDebug(IONENGINE_NOAA) << "Incomplete observation for" << sources << parser->errorString();
+              }
 
-    connect(getJob, &KIO::TransferJob::data,
-            this, &NOAAIon::slotDataArrived);
-    connect(getJob, &KJob::result,
-            this, &NOAAIon::slotJobFinished);
+              for (const QString& placeSource : sources) {
+                  removeAllData(placeSource);
+                  setWeatherData(placeSource, parser->data);
+              }
+
+              // Now that we have the longitude and latitude, fetch the seven day forecast.
+              for (const QString& placeSource : sources) {
+                  getForecast(placeSource);
+              }
+          });
 }
 
 void NOAAIon::setup_slotDataArrived(KIO::Job *job, const QByteArray &data)
@@ -231,39 +391,26 @@ void NOAAIon::setup_slotDataArrived(KIO::Job *job, const QByteArray &data)
     m_xmlSetup.addData(data);
 }
 
-void NOAAIon::slotDataArrived(KIO::Job *job, const QByteArray &data)
+void NOAAIon::setup_slotJobFinished(KJob *job)
 {
-    if (data.isEmpty() || !m_jobXml.contains(job)) {
-        return;
-    }
-
-    // Send to xml.
-    m_jobXml[job]->addData(data);
-}
+    KIO::TransferJob *transferJob = static_cast<KIO::TransferJob *>(job);
 
-void NOAAIon::slotJobFinished(KJob *job)
-{
-    // Dual use method, if we're fetching location data to parse we need to do this first
-    const QString source(m_jobList.value(job));
-    removeAllData(source);
-    QXmlStreamReader *reader = m_jobXml.value(job);
-    if (reader) {
-        readXMLData(m_jobList[job], *reader);
+    bool success = false;
+    if (job->error()) {
+        qCWarning(IONENGINE_NOAA) << "Could not fetch the station list:" << job->errorString();
+    } else if (transferJob->queryMetaData(QStringLiteral("responsecode")) == QLatin1String("304")) {
+        // our station index is still current
+        success = m_stations.isValid();
+    } else {
+        success = readXMLSetup(transferJob->queryMetaData(QStringLiteral("HTTP-Headers")));
     }
+    m_xmlSetup.clear();
 
-    // Now that we have the longitude and latitude, fetch the seven day forecast.
-    getForecast(m_jobList[job]);
-
-    m_jobList.remove(job);
-    m_jobXml.remove(job);
-    delete reader;
-}
-
-void NOAAIon::setup_slotJobFinished(KJob *job)
-{
-    Q_UNUSED(job)
-    const bool success = readXMLSetup();
-    setInitialized(success);
+    // keep using the station index of the last session when the list could not be fetched
+    success = success || m_stations.isValid();
+    if (success != isInitialized()) {
+        setInitialized(success);
+    }
 
     for (const QString& source : qAsConst(m_sourcesToReset)) {
         updateSourceEvent(source);
@@ -279,25 +426,16 @@ void NOAAIon::parseFloat(float& value, const QString& string)
     }
 }
 
-void NOAAIon::parseFloat(float& value, QXmlStreamReader& xml)
-{
-    bool ok = false;
-    const float result = xml.readElementText().toFloat(&ok);
-    if (ok) {
-        value = result;
-    }
-}
-
-void NOAAIon::parseDouble(double& value, QXmlStreamReader& xml)
+void NOAAIon::parseDouble(double& value, const QString& string)
 {
     bool ok = false;
-    const double result = xml.readElementText().toDouble(&ok);
+    const double result = string.toDouble(&ok);
     if (ok) {
         value = result;
     }
 }
 
-void NOAAIon::parseStationID()
+void NOAAIon::parseStationID(QVector<QStringList>& stations, QHash<QString, int>& stationForPlace)
 {
     QString state;
     QString stationName;
@@ -311,14 +449,17 @@ void NOAAIon::parseStationID()
 
         if (m_xmlSetup.isEndElement() && elementName == QLatin1String("station")) {
             if (!xmlurl.isEmpty()) {
-                NOAAIon::XMLMapInfo info;
-                info.stateName = state;
-                info.stationName = stationName;
-                info.stationID = stationID;
-                info.XMLurl = xmlurl;
-
-                QString tmp = stationName + QLatin1String(", ") + state; // Build the key name.
-                m_places[tmp] = info;
+                const QString place = stationName + QLatin1String(", ") + state; // Build the key name.
+                const QStringList station { place, state, stationName, stationID, xmlurl };
+
+                // a later entry for the same place replaces the earlier one
+                const auto it = stationForPlace.constFind(place);
+                if (it != stationForPlace.constEnd()) {
+                    stations[it.value()] = station;
+                } else {
+                    stationForPlace.insert(place, stations.size());
+                    stations.append(station);
+                }
             }
             break;
         }
@@ -339,7 +480,7 @@ void NOAAIon::parseStationID()
     }
 }
 
-void NOAAIon::parseStationList()
+void NOAAIon::parseStationList(QVector<QStringList>& stations, QHash<QString, int>& stationForPlace)
 {
     while (!m_xmlSetup.atEnd()) {
         m_xmlSetup.readNext();
@@ -350,7 +491,7 @@ void NOAAIon::parseStationList()
 
         if (m_xmlSetup.isStartElement()) {
             if (m_xmlSetup.name() == QLatin1String("station")) {
-                parseStationID();
+                parseStationID(stations, stationForPlace);
             } else {
                 parseUnknownElement(m_xmlSetup);
             }
@@ -358,132 +499,35 @@ void NOAAIon::parseStationList()
     }
 }
 
-// Parse the city list and store into a QMap
-bool NOAAIon::readXMLSetup()
+// Parse the city list and store it in the station index
+bool NOAAIon::readXMLSetup(const QString& httpHeaders)
 {
+    QVector<QStringList> stations;
+    QHash<QString, int> stationForPlace;
     bool success = false;
     while (!m_xmlSetup.atEnd()) {
         m_xmlSetup.readNext();
 
         if (m_xmlSetup.isStartElement()) {
             if (m_xmlSetup.name() == QLatin1String("wx_station_index")) {
-                parseStationList();
+                parseStationList(stations, stationForPlace);
                 success = true;
             }
         }
     }
-    return (!m_xmlSetup.error() && success);
-}
-
-void NOAAIon::parseWeatherSite(WeatherData& data, QXmlStreamReader& xml)
-{
-    data.temperature_C = qQNaN();
-    data.temperature_F = qQNaN();
-    data.dewpoint_C = qQNaN();
-    data.dewpoint_F = qQNaN();
-    data.weather = QStringLiteral("N/A");
-    data.stationID = i18n("N/A");
-    data.pressure = qQNaN();
-    data.visibility = qQNaN();
-    data.humidity = qQNaN();
-    data.windSpeed = qQNaN();
-    data.windGust = qQNaN();
-    data.windchill_F = qQNaN();
-    data.windchill_C = qQNaN();
-    data.heatindex_F = qQNaN();
-    data.heatindex_C = qQNaN();
 
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("location")) {
-                data.locationName = xml.readElementText();
-            } else if (elementName == QLatin1String("station_id")) {
-                data.stationID = xml.readElementText();
-            } else if (elementName == QLatin1String("latitude")) {
-                parseDouble(data.stationLatitude, xml);
-            } else if (elementName == QLatin1String("longitude")) {
-                parseDouble(data.stationLongitude, xml);
-            } else if (elementName == QLatin1String("observation_time_rfc822")) {
-                data.observationDateTime = QDateTime::fromString(xml.readElementText(), Qt::RFC2822Date);
-            } else if (elementName == QLatin1String("observation_time")) {
-                data.observationTime = xml.readElementText();
-                QStringList tmpDateStr = data.observationTime.split(QLatin1Char(' '));
-                data.observationTime = QStringLiteral("%1 %2").arg(tmpDateStr[6], tmpDateStr[7]);
-            } else if (elementName == QLatin1String("weather")) {
-                const QString weather = xml.readElementText();
-                data.weather = (weather.isEmpty() || weather == QLatin1String("NA")) ? QStringLiteral("N/A") : weather;
-                // Pick which icon set depending on period of day
-            } else if (elementName == QLatin1String("temp_f")) {
-                parseFloat(data.temperature_F, xml);
-            } else if (elementName == QLatin1String("temp_c")) {
-                parseFloat(data.temperature_C, xml);
-            } else if (elementName == QLatin1String("relative_humidity")) {
-                parseFloat(data.humidity, xml);
-            } else if (elementName == QLatin1String("wind_dir")) {
-                data.windDirection = xml.readElementText();
-            } else if (elementName == QLatin1String("wind_mph")) {
-                const QString windSpeed = xml.readElementText();
-                if (windSpeed == QLatin1String("NA")) {
-                    data.windSpeed = 0.0;
-                } else {
-                    parseFloat(data.windSpeed, windSpeed);
-                }
-            } else if (elementName == QLatin1String("wind_gust_mph")) {
-                const QString windGust = xml.readElementText();
-                if (windGust == QLatin1String("NA") || windGust == QLatin1String("N/A")) {
-                    data.windGust = 0.0;
-                } else {
-                    parseFloat(data.windGust, windGust);
-                }
-            } else if (elementName == QLatin1String("pressure_in")) {
-                parseFloat(data.pressure, xml);
-            } else if (elementName == QLatin1String("dewpoint_f")) {
-                parseFloat(data.dewpoint_F, xml);
-            } else if (elementName == QLatin1String("dewpoint_c")) {
-                parseFloat(data.dewpoint_C, xml);
-            } else if (elementName == QLatin1String("heat_index_f")) {
-                parseFloat(data.heatindex_F, xml);
-            } else if (elementName == QLatin1String("heat_index_c")) {
-                parseFloat(data.heatindex_C, xml);
-            } else if (elementName == QLatin1String("windchill_f")) {
-                parseFloat(data.windchill_F, xml);
-            } else if (elementName == QLatin1String("windchill_c")) {
-                parseFloat(data.windchill_C, xml);
-            } else if (elementName == QLatin1String("visibility_mi")) {
-                parseFloat(data.visibility, xml);
-            } else {
-                parseUnknownElement(xml);
-            }
-        }
+    if (m_xmlSetup.error() || !success) {
+        return false;
     }
+
+    QString etag;
+    QString lastModified;
+    StationIndex::parseResponseHeaders(httpHeaders, &etag, &lastModified);
+    return m_stations.update(stations, etag, lastModified);
 }
 
-// Parse Weather data main loop, from here we have to decend into each tag pair
-bool NOAAIon::readXMLData(const QString& source, QXmlStreamReader& xml)
+void NOAAIon::setWeatherData(const QString& source, WeatherData data)
 {
-    WeatherData data;
-    data.isForecastsDataPending = true;
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        if (xml.isEndElement()) {
-            break;
-        }
-
-        if (xml.isStartElement()) {
-            if (xml.name() == QLatin1String("current_observation")) {
-                parseWeatherSite(data, xml);
-            } else {
-                parseUnknownElement(xml);
-            }
-        }
-    }
-
     bool solarDataSourceNeedsConnect = false;
     Plasma::DataEngine* timeEngine = dataEngine(QStringLiteral("time"));
     if (timeEngine) {
@@ -522,8 +566,6 @@ bool NOAAIon::readXMLData(const QString& source, QXmlStreamReader& xml)
         data.isSolarDataPending = true;
         timeEngine->connectSource(data.solarDataTimeEngineSourceName, this);
     }
-
-    return !xml.error();
 }
 
 // handle when no XML tag is found
@@ -815,139 +857,34 @@ void NOAAIon::getForecast(const QString& source)
                                  QLatin1String("&lon=") + QString::number(lon) +
                                  QLatin1String("&format=24+hourly&numDays=7"));
 
-    KIO::TransferJob* getJob = KIO::get(url, KIO::Reload, KIO::HideProgressInfo);
-    m_jobXml.insert(getJob, new QXmlStreamReader);
-    m_jobList.insert(getJob, source);
-
-    connect(getJob, &KIO::TransferJob::data,
-            this, &NOAAIon::forecast_slotDataArrived);
-    connect(getJob, &KJob::result,
-            this, &NOAAIon::forecast_slotJobFinished);
-}
-
-void NOAAIon::forecast_slotDataArrived(KIO::Job *job, const QByteArray &data)
-{
-    if (data.isEmpty() || !m_jobXml.contains(job)) {
-        return;
-    }
-
-    // Send to xml.
-    m_jobXml[job]->addData(data);
-}
-
-void NOAAIon::forecast_slotJobFinished(KJob *job)
-{
-    QXmlStreamReader *reader = m_jobXml.value(job);
-    const QString source = m_jobList.value(job);
-
-    if (reader) {
-        readForecast(source, *reader);
-        updateWeather(source);
-    }
-
-    m_jobList.remove(job);
-    delete m_jobXml[job];
-    m_jobXml.remove(job);
-
-    if (m_sourcesToReset.contains(source)) {
-        m_sourcesToReset.removeAll(source);
-
-        // so the weather engine updates it's data
-        forceImmediateUpdateOfAllVisualizations();
-
-        // update the clients of our engine
-        emit forceUpdate(this, source);
-    }
-}
-
-void NOAAIon::readForecast(const QString& source, QXmlStreamReader& xml)
-{
-    WeatherData& weatherData = m_weatherData[source];
-    QVector<WeatherData::Forecast>& forecasts = weatherData.forecasts;
-
-    // Clear the current forecasts
-    forecasts.clear();
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        if (xml.isStartElement()) {
-
-            /* Read all reported days from <time-layout>. We check for existence of a specific
-             * <layout-key> which indicates the separate day listings.  The schema defines it to be
-             * the first item before the day listings.
-             */
-            if (xml.name() == QLatin1String("layout-key") && xml.readElementText() == QLatin1String("k-p24h-n7-1")) {
-
-                // Read days until we get to end of parent (<time-layout>)tag
-                while (! (xml.isEndElement() && xml.name() == QLatin1String("time-layout"))) {
-
-                    xml.readNext();
-
-                    if (xml.name() == QLatin1String("start-valid-time")) {
-                        QString data = xml.readElementText();
-                        QDateTime date = QDateTime::fromString(data, Qt::ISODate);
-
-                        WeatherData::Forecast forecast;
-                        forecast.day = QLocale().toString(date.date().day());
-                        forecasts.append(forecast);
-                        //qCDebug(IONENGINE_NOAA) << forecast.day;
-                    }
-                }
-
-            } else if (xml.name() == QLatin1String("temperature") && xml.attributes().value(QStringLiteral("type")) == QLatin1String("maximum")) {
-
-                // Read max temps until we get to end tag
-                int i = 0;
-                while (! (xml.isEndElement() && xml.name() == QLatin1String("temperature")) &&
-                       i < forecasts.count()) {
-
-                    xml.readNext();
-
-                    if (xml.name() == QLatin1String("value")) {
-                        forecasts[i].high = xml.readElementText();
-                        //qCDebug(IONENGINE_NOAA) << forecasts[i].high;
-                        i++;
-                    }
-                }
-            } else if (xml.name() == QLatin1String("temperature") && xml.attributes().value(QStringLiteral("type")) == QLatin1String("minimum")) {
-
-                // Read min temps until we get to end tag
-                int i = 0;
-                while (! (xml.isEndElement() && xml.name() == QLatin1String("temperature")) &&
-                       i < forecasts.count()) {
-
-                    xml.readNext();
-
-                    if (xml.name() == QLatin1String("value")) {
-                        forecasts[i].low = xml.readElementText();
-                        //qCDebug(IONENGINE_NOAA) << forecasts[i].low;
-                        i++;
-                    }
-                }
-            } else if (xml.name() == QLatin1String("weather")) {
-
-                // Read weather conditions until we get to end tag
-                int i = 0;
-                while (! (xml.isEndElement() && xml.name() == QLatin1String("weather")) &&
-                       i < forecasts.count()) {
-
-                    xml.readNext();
-
-                    if (xml.name() == QLatin1String("weather-conditions") && xml.isStartElement()) {
-                        QString summary = xml.attributes().value(QStringLiteral("weather-summary")).toString();
-                        forecasts[i].summary = summary;
-                        //qCDebug(IONENGINE_NOAA) << forecasts[i].summary;
-			qCDebug(IONENGINE_NOAA) << "i18n summary string: "
-                                 << i18nc("weather forecast", forecasts[i].summary.toUtf8().data());
-                        i++;
-                    }
-                }
-            }
-        }
-    }
-
-    weatherData.isForecastsDataPending = false;
+    // stations at the same coordinates share the forecast
+    QSharedPointer<ForecastParser> parser(new ForecastParser);
+    fetch(url, source,
+          [parser](const QByteArray& chunk) {
+              parser->addData(chunk);
+          },
+          [this, parser](const QByteArray&, const QStringList& sources) {
+              parser->finish();
+
+              for (const QString& placeSource : sources) {
+                  WeatherData& weatherData = m_weatherData[placeSource];
+                  // implicitly shared between all sources
+                  weatherData.forecasts = parser->forecasts;
+                  weatherData.isForecastsDataPending = false;
+
+                  updateWeather(placeSource);
+
+                  if (m_sourcesToReset.contains(placeSource)) {
+                      m_sourcesToReset.removeAll(placeSource);
+
+                      // so the weather engine updates it's data
+                      forceImmediateUpdateOfAllVisualizations();
+
+                      // update the clients of our engine
+                      emit forceUpdate(this, placeSource);
+                  }
+              }
+          });
 }
 
 void NOAAIon::dataUpdated(const QString& sourceName, const Plasma::DataEngine::Data& data)
@@ -23,6 +23,7 @@
 #define ION_NOAA_H
 
 #include "../ion.h"
+#include "../stationindex.h"
 
 #include <Plasma/DataEngineConsumer>
 
@@ -111,12 +112,6 @@ private Q_SLOTS:
     void setup_slotDataArrived(KIO::Job *, const QByteArray &);
     void setup_slotJobFinished(KJob *);
 
-    void slotDataArrived(KIO::Job *, const QByteArray &);
-    void slotJobFinished(KJob *);
-
-    void forecast_slotDataArrived(KIO::Job *, const QByteArray &);
-    void forecast_slotJobFinished(KJob *);
-
 private:
     void updateWeather(const QString& source);
 
@@ -131,16 +126,15 @@ private:
     IonInterface::ConditionIcons getConditionIcon(const QString& weather, bool isDayTime) const;
 
     // Load and Parse the place XML listing
-    void getXMLSetup() const;
-    bool readXMLSetup();
+    void getXMLSetup();
+    bool readXMLSetup(const QString& httpHeaders);
 
     // Load and parse the specific place(s)
     void getXMLData(const QString& source);
-    bool readXMLData(const QString& source, QXmlStreamReader& xml);
+    void setWeatherData(const QString& source, WeatherData data);
 
     // Load and parse upcoming forecast for the next N days
     void getForecast(const QString& source);
-    void readForecast(const QString& source, QXmlStreamReader& xml);
 
     // Check if place specified is valid or not
     QStringList validate(const QString& source) const;
@@ -148,32 +142,34 @@ private:
     // Catchall for unknown XML tags
     void parseUnknownElement(QXmlStreamReader& xml) const;
 
-    // Parse weather XML data
-    void parseWeatherSite(WeatherData& data, QXmlStreamReader& xml);
-    void parseStationID();
-    void parseStationList();
+    // Parse the station list
+    void parseStationID(QVector<QStringList>& stations, QHash<QString, int>& stationForPlace);
+    void parseStationList(QVector<QStringList>& stations, QHash<QString, int>& stationForPlace);
 
-    void parseFloat(float& value, const QString& string);
-    void parseFloat(float& value, QXmlStreamReader& xml);
-    void parseDouble(double& value, QXmlStreamReader& xml);
+    static void parseFloat(float& value, const QString& string);
+    static void parseDouble(double& value, const QString& string);
+
+public:
+    // parsers of the downloaded documents, defined in ion_noaaparsers.h
+    class ObservationParser;
+    class ForecastParser;
 
 private:
-    struct XMLMapInfo {
-        QString stateName;
-        QString stationName;
-        QString stationID;
-        QString XMLurl;
+    // Fields of the stations in m_stations
+    enum StationField {
+        PlaceField = 0,
+        StateField,
+        StationNameField,
+        StationIDField,
+        XMLUrlField
     };
 
     // Key dicts
-    QHash<QString, NOAAIon::XMLMapInfo> m_places;
+    StationIndex m_stations;
 
     // Weather information
     QHash<QString, WeatherData> m_weatherData;
 
-    // Store KIO jobs
-    QHash<KJob *, QXmlStreamReader*> m_jobXml;
-    QHash<KJob *, QString> m_jobList;
     QXmlStreamReader m_xmlSetup;
 
     // bool emitWhenSetup;
@@ -0,0 +1,66 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA          *
+ ***************************************************************************/
+
+#ifndef ION_NOAAPARSERS_H
+#define ION_NOAAPARSERS_H
+
+#include "ion_noaa.h"
+
+#include "../incrementalxmlparser.h"
+
+/**
+ * Parses the current observation of a station.
+ */
+class NOAAIon::ObservationParser : public IncrementalXmlParser
+{
+public:
+    ObservationParser();
+
+    WeatherData data;
+
+protected:
+    void startElement(const QStringRef& name, const QXmlStreamAttributes& attributes) override;
+    void endElement(const QStringRef& name, const QString& text) override;
+};
+
+/**
+ * Parses the daily forecasts from a NDFD DWML document.
+ */
+class NOAAIon::ForecastParser : public IncrementalXmlParser
+{
+public:
+    QVector<WeatherData::Forecast> forecasts;
+
+protected:
+    void startElement(const QStringRef& name, const QXmlStreamAttributes& attributes) override;
+    void endElement(const QStringRef& name, const QString& text) override;
+
+private:
+    enum ValueKind {
+        NoValues,
+        HighValues,
+        LowValues
+    };
+
+    // whether the current <time-layout> lists the forecast days
+    bool m_inDayLayout = false;
+    ValueKind m_values = NoValues;
+    // the forecast day the next value, temperature or condition, is for
+    int m_day = 0;
+};
+
+#endif
@@ -0,0 +1,581 @@
+/*****************************************************************************
+ * This library is free software; you can redistribute it and/or             *
+ * modify it under the terms of the GNU Library General Public               *
+ * License as published by the Free Software Foundation; either              *
+ * version 2 of the License, or (at your option) any later version.          *
+ *                                                                           *
+ * This library is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU         *
+ * Library General Public License for more details.                          *
+ *                                                                           *
+ * You should have received a copy of the GNU Library General Public License *
+ * along with this library; see the file COPYING.LIB.  If not, write to      *
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,      *
+ * Boston, MA 02110-1301, USA.                                               *
+ *****************************************************************************/
+
+#include "stationindex.h"
+
+#include "iondebug.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+
+/*
+ * File layout, all numbers in host byte order:
+ *
+ *   Header
+ *   Gram[gramCount]            sorted by gram, every position of a folded place
+ *                              name starts one, padded with two null characters
+ *   StringRef[stationCount * (fieldCount + 1)]
+ *                              per station the folded place name, then the fields;
+ *                              stations are sorted by folded place name
+ *   quint32[postingCount]      station numbers, ascending per gram
+ *   QChar[stringsSize]         all strings, UTF-16
+ */
+namespace
+{
+    const quint32 s_magic = 0x57535849; // "WSXI"
+    const quint32 s_version = 2;
+
+    struct StringRef {
+        quint32 offset;
+        quint32 length;
+    };
+
+    struct Gram {
+        quint64 gram;
+        quint32 first;
+        quint32 count;
+    };
+
+    struct Header {
+        quint32 magic;
+        quint32 version;
+        quint32 stationCount;
+        quint32 fieldCount;
+        quint32 gramCount;
+        quint32 postingCount;
+        quint32 stringsSize;
+        quint32 reserved;
+        StringRef etag;
+        StringRef lastModified;
+    };
+
+    static_assert(sizeof(Header) % 8 == 0, "Gram table must stay aligned");
+    static_assert(sizeof(Gram) == 16, "Unexpected padding in Gram");
+
+    inline quint64 gramAt(const QChar *s)
+    {
+        return (quint64(s[0].unicode()) << 32) | (quint64(s[1].unicode()) << 16) | quint64(s[2].unicode());
+    }
+
+    class StringTable
+    {
+    public:
+        StringRef add(const QString &s)
+        {
+            StringRef ref;
+            ref.offset = quint32(m_data.size());
+            ref.length = quint32(s.size());
+            m_data.append(s);
+            return ref;
+        }
+
+        const QString &data() const
+        {
+            return m_data;
+        }
+
+    private:
+        QString m_data;
+    };
+}
+
+class Q_DECL_HIDDEN StationIndex::Private
+{
+public:
+    Private(const QString &name)
+        : fileName(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                   + QLatin1String("/plasma_engine_weather/") + name + QLatin1String(".stations"))
+    {
+    }
+
+    bool attach(const uchar *base, qint64 size);
+    void detach();
+
+    QString string(const StringRef &ref) const
+    {
+        return QString(strings + ref.offset, ref.length);
+    }
+
+    // Does not copy, only valid as long as the index is not changed
+    QString rawString(const StringRef &ref) const
+    {
+        return QString::fromRawData(strings + ref.offset, ref.length);
+    }
+
+    const StringRef *station(int i) const
+    {
+        return stations + size_t(i) * (header->fieldCount + 1);
+    }
+
+    // stations of which field @p field equals @p value, built on first use
+    QVector<int> lookup(int field, const QString &value, Qt::CaseSensitivity cs) const;
+
+    const Gram *findGram(quint64 gram) const
+    {
+        const Gram *end = grams + header->gramCount;
+        const Gram *it = std::lower_bound(grams, end, gram, [](const Gram &g, quint64 value) {
+            return g.gram < value;
+        });
+        return (it != end && it->gram == gram) ? it : nullptr;
+    }
+
+    QString fileName;
+    QFile file;
+    // backs the index when it could not be written to disk
+    QByteArray buffer;
+
+    const Header *header = nullptr;
+    const Gram *grams = nullptr;
+    const StringRef *stations = nullptr;
+    const quint32 *postings = nullptr;
+    const QChar *strings = nullptr;
+
+    // field values to stations, by field number times two, plus one when case insensitive
+    mutable QMutex lookupMutex;
+    mutable QHash<int, QHash<QString, QVector<int>>> lookups;
+};
+
+QVector<int> StationIndex::Private::lookup(int field, const QString &value, Qt::CaseSensitivity cs) const
+{
+    QMutexLocker locker(&lookupMutex);
+
+    const bool folded = cs == Qt::CaseInsensitive;
+    auto it = lookups.find(field * 2 + (folded ? 1 : 0));
+    if (it == lookups.end()) {
+        QHash<QString, QVector<int>> values;
+        for (int i = 0; i < int(header->stationCount); ++i) {
+            const QString fieldValue = rawString(station(i)[field + 1]);
+            values[folded ? fieldValue.toCaseFolded() : fieldValue].append(i);
+        }
+        it = lookups.insert(field * 2 + (folded ? 1 : 0), values);
+    }
+
+    return it->value(folded ? value.toCaseFolded() : value);
+}
+
+bool StationIndex::Private::attach(const uchar *base, qint64 size)
+{
+    if (size < qint64(sizeof(Header))) {
+        return false;
+    }
+
+    const Header *h = reinterpret_cast<const Header *>(base);
+    if (h->magic != s_magic || h->version != s_version || h->fieldCount == 0) {
+        return false;
+    }
+
+    const quint64 gramsSize = quint64(h->gramCount) * sizeof(Gram);
+    const quint64 refCount = quint64(h->stationCount) * (h->fieldCount + 1);
+    const quint64 stationsSize = refCount * sizeof(StringRef);
+    const quint64 postingsSize = quint64(h->postingCount) * sizeof(quint32);
+    const quint64 stringsSize = quint64(h->stringsSize) * sizeof(QChar);
+    if (sizeof(Header) + gramsSize + stationsSize + postingsSize + stringsSize != quint64(size)) {
+        return false;
+    }
+
+    const Gram *g = reinterpret_cast<const Gram *>(base + sizeof(Header));
+    const StringRef *s = reinterpret_cast<const StringRef *>(base + sizeof(Header) + gramsSize);
+    const quint32 *p = reinterpret_cast<const quint32 *>(base + sizeof(Header) + gramsSize + stationsSize);
+
+    // a damaged cache file must not make us read out of bounds later on
+    auto validRef = [h](const StringRef &ref) {
+        return quint64(ref.offset) + ref.length <= h->stringsSize;
+    };
+    if (!validRef(h->etag) || !validRef(h->lastModified)) {
+        return false;
+    }
+    for (quint64 i = 0; i < refCount; ++i) {
+        if (!validRef(s[i])) {
+            return false;
+        }
+    }
+    for (quint32 i = 0; i < h->gramCount; ++i) {
+        if (quint64(g[i].first) + g[i].count > h->postingCount) {
+            return false;
+        }
+    }
+    for (quint32 i = 0; i < h->postingCount; ++i) {
+        if (p[i] >= h->stationCount) {
+            return false;
+        }
+    }
+
+    header = h;
+    grams = g;
+    stations = s;
+    postings = p;
+    strings = reinterpret_cast<const QChar *>(base + sizeof(Header) + gramsSize + stationsSize + postingsSize);
+    return true;
+}
+
+void StationIndex::Private::detach()
+{
+    header = nullptr;
+    grams = nullptr;
+    stations = nullptr;
+    postings = nullptr;
+    strings = nullptr;
+
+    {
+        // the keys of the lookups point into the file
+        QMutexLocker locker(&lookupMutex);
+        lookups.clear();
+    }
+
+    file.close();
+    buffer.clear();
+}
+
+StationIndex::StationIndex(const QString &name)
+    : d(new Private(name))
+{
+}
+
+StationIndex::~StationIndex()
+{
+    delete d;
+}
+
+bool StationIndex::load()
+{
+    d->detach();
+
+    d->file.setFileName(d->fileName);
+    if (!d->file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size = d->file.size();
+    const uchar *base = size > 0 ? d->file.map(0, size) : nullptr;
+    if (!base || !d->attach(base, size)) {
+        qCDebug(IONENGINE) << "Ignoring invalid station index" << d->fileName;
+        d->detach();
+        return false;
+    }
+
+    return true;
+}
+
+bool StationIndex::update(const QVector<QStringList> &stations, const QString &etag, const QString &lastModified)
+{
+    if (stations.isEmpty()) {
+        return false;
+    }
+
+    int fieldCount = 1;
+    for (const QStringList &station : stations) {
+        fieldCount = qMax(fieldCount, station.size());
+    }
+
+    QVector<QString> keys;
+    keys.reserve(stations.size());
+    for (const QStringList &station : stations) {
+        keys.append(normalize(station.value(0)));
+    }
+
+    QVector<int> order(stations.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&keys](int a, int b) {
+        return keys[a] < keys[b];
+    });
+
+    StringTable strings;
+    QVector<StringRef> refs;
+    refs.reserve(stations.size() * (fieldCount + 1));
+    QMap<quint64, QVector<quint32>> gramPostings;
+
+    for (int i = 0; i < order.size(); ++i) {
+        const QString &key = keys[order[i]];
+        const QStringList &station = stations[order[i]];
+
+        refs.append(strings.add(key));
+        for (int field = 0; field < fieldCount; ++field) {
+            refs.append(strings.add(station.value(field)));
+        }
+
+        // padded, so also the last two characters and names shorter than a trigram are indexed
+        const QString paddedKey = key + QString(2, QChar(0));
+        for (int pos = 0; pos < key.size(); ++pos) {
+            QVector<quint32> &list = gramPostings[gramAt(paddedKey.constData() + pos)];
+            // stations are added in order, so a duplicate can only be the last entry
+            if (list.isEmpty() || list.constLast() != quint32(i)) {
+                list.append(quint32(i));
+            }
+        }
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = s_magic;
+    header.version = s_version;
+    header.stationCount = quint32(stations.size());
+    header.fieldCount = quint32(fieldCount);
+    header.gramCount = quint32(gramPostings.size());
+    header.etag = strings.add(etag);
+    header.lastModified = strings.add(lastModified);
+
+    QVector<Gram> grams;
+    grams.reserve(gramPostings.size());
+    QVector<quint32> postings;
+    for (auto it = gramPostings.constBegin(); it != gramPostings.constEnd(); ++it) {
+        Gram gram;
+        gram.gram = it.key();
+        gram.first = quint32(postings.size());
+        gram.count = quint32(it.value().size());
+        grams.append(gram);
+        postings += it.value();
+    }
+    header.postingCount = quint32(postings.size());
+    header.stringsSize = quint32(strings.data().size());
+
+    QByteArray data;
+    data.reserve(int(sizeof(Header) + grams.size() * sizeof(Gram) + refs.size() * sizeof(StringRef)
+                     + postings.size() * sizeof(quint32) + strings.data().size() * sizeof(QChar)));
+    data.append(reinterpret_cast<const char *>(&header), sizeof(Header));
+    data.append(reinterpret_cast<const char *>(grams.constData()), grams.size() * int(sizeof(Gram)));
+    data.append(reinterpret_cast<const char *>(refs.constData()), refs.size() * int(sizeof(StringRef)));
+    data.append(reinterpret_cast<const char *>(postings.constData()), postings.size() * int(sizeof(quint32)));
+    data.append(reinterpret_cast<const char *>(strings.data().constData()), strings.data().size() * int(sizeof(QChar)));
+
+    d->detach();
+
+    QDir().mkpath(QFileInfo(d->fileName).absolutePath());
+    QSaveFile file(d->fileName);
+    if (file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit() && load()) {
+        return true;
+    }
+
+    qCWarning(IONENGINE) << "Could not write station index" << d->fileName;
+
+    // keep working from memory
+    d->buffer = data;
+    return d->attach(reinterpret_cast<const uchar *>(d->buffer.constData()), d->buffer.size());
+}
+
+bool StationIndex::isValid() const
+{
+    return d->header;
+}
+
+int StationIndex::count() const
+{
+    return d->header ? int(d->header->stationCount) : 0;
+}
+
+QString StationIndex::etag() const
+{
+    return d->header ? d->string(d->header->etag) : QString();
+}
+
+QString StationIndex::lastModified() const
+{
+    return d->header ? d->string(d->header->lastModified) : QString();
+}
+
+QString StationIndex::conditionalRequestHeaders() const
+{
+    QStringList headers;
+
+    const QString tag = etag();
+    if (!tag.isEmpty()) {
+        headers << QLatin1String("If-None-Match: ") + tag;
+    }
+
+    const QString modified = lastModified();
+    if (!modified.isEmpty()) {
+        headers << QLatin1String("If-Modified-Since: ") + modified;
+    }
+
+    return headers.join(QLatin1String("\r\n"));
+}
+
+void StationIndex::parseResponseHeaders(const QString &headers, QString *etag, QString *lastModified)
+{
+    const QVector<QStringRef> lines = headers.splitRef(QLatin1Char('\n'));
+    for (const QStringRef &line : lines) {
+        const int colon = line.indexOf(QLatin1Char(':'));
+        if (colon < 0) {
+            continue;
+        }
+
+        const QStringRef name = line.left(colon).trimmed();
+        const QString value = line.mid(colon + 1).trimmed().toString();
+        if (etag && name.compare(QLatin1String("ETag"), Qt::CaseInsensitive) == 0) {
+            *etag = value;
+        } else if (lastModified && name.compare(QLatin1String("Last-Modified"), Qt::CaseInsensitive) == 0) {
+            *lastModified = value;
+        }
+    }
+}
+
+QVector<int> StationIndex::search(const QString &text) const
+{
+    QVector<int> result;
+    if (!d->header) {
+        return result;
+    }
+
+    const QString needle = normalize(text);
+    const int stationCount = int(d->header->stationCount);
+
+    if (needle.isEmpty()) {
+        result.resize(stationCount);
+        std::iota(result.begin(), result.end(), 0);
+        return result;
+    }
+
+    if (needle.size() < 3) {
+        // every position of a name starts a trigram, the ones starting with
+        // the needle are next to each other in the table
+        const int shift = needle.size() == 1 ? 32 : 16;
+        const quint64 low = needle.size() == 1 ? quint64(needle[0].unicode()) << 32
+                                               : (quint64(needle[0].unicode()) << 32) | (quint64(needle[1].unicode()) << 16);
+        const quint64 high = low + (quint64(1) << shift);
+
+        const Gram *end = d->grams + d->header->gramCount;
+        const Gram *it = std::lower_bound(d->grams, end, low, [](const Gram &g, quint64 value) {
+            return g.gram < value;
+        });
+
+        QVector<quint32> candidates;
+        for (; it != end && it->gram < high; ++it) {
+            std::copy(d->postings + it->first, d->postings + it->first + it->count, std::back_inserter(candidates));
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        result.reserve(candidates.size());
+        for (quint32 candidate : qAsConst(candidates)) {
+            result.append(int(candidate));
+        }
+        return result;
+    }
+
+    QVector<const Gram *> grams;
+    for (int pos = 0; pos + 3 <= needle.size(); ++pos) {
+        const Gram *gram = d->findGram(gramAt(needle.constData() + pos));
+        if (!gram) {
+            return result;
+        }
+        if (!grams.contains(gram)) {
+            grams.append(gram);
+        }
+    }
+
+    // intersect starting with the rarest trigram
+    std::sort(grams.begin(), grams.end(), [](const Gram *a, const Gram *b) {
+        return a->count < b->count;
+    });
+
+    const quint32 *first = d->postings + grams[0]->first;
+    QVector<quint32> candidates(first, first + grams[0]->count);
+    QVector<quint32> remaining;
+    for (int i = 1; i < grams.size() && !candidates.isEmpty(); ++i) {
+        const quint32 *begin = d->postings + grams[i]->first;
+        const quint32 *end = begin + grams[i]->count;
+        remaining.clear();
+        std::set_intersection(candidates.constBegin(), candidates.constEnd(), begin, end, std::back_inserter(remaining));
+        candidates.swap(remaining);
+    }
+
+    // all trigrams being present does not mean they are adjacent
+    for (quint32 candidate : qAsConst(candidates)) {
+        if (needle.size() == 3 || d->rawString(d->station(int(candidate))[0]).contains(needle)) {
+            result.append(int(candidate));
+        }
+    }
+
+    return result;
+}
+
+int StationIndex::find(const QString &place) const
+{
+    if (!d->header) {
+        return -1;
+    }
+
+    const QString key = normalize(place);
+    int low = 0;
+    int high = int(d->header->stationCount);
+    while (low < high) {
+        const int mid = (low + high) / 2;
+        if (d->rawString(d->station(mid)[0]) < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    // different places can fold to the same key
+    for (int i = low; i < int(d->header->stationCount) && d->rawString(d->station(i)[0]) == key; ++i) {
+        if (d->rawString(d->station(i)[1]) == place) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+QVector<int> StationIndex::findByField(int field, const QString &value, Qt::CaseSensitivity cs) const
+{
+    if (!d->header || field < 0 || field >= int(d->header->fieldCount)) {
+        return QVector<int>();
+    }
+
+    return d->lookup(field, value, cs);
+}
+
+QString StationIndex::field(int station, int field) const
+{
+    if (!d->header || station < 0 || station >= int(d->header->stationCount)
+            || field < 0 || field >= int(d->header->fieldCount)) {
+        return QString();
+    }
+
+    return d->string(d->station(station)[field + 1]);
+}
+
+QString StationIndex::place(int station) const
+{
+    return field(station, 0);
+}
+
+QString StationIndex::normalize(const QString &text)
+{
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+
+    QString result;
+    result.reserve(decomposed.size());
+    for (const QChar c : decomposed) {
+        if (c.category() != QChar::Mark_NonSpacing) {
+            result.append(c);
+        }
+    }
+
+    return result.toCaseFolded();
+}
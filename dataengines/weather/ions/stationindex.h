@@ -0,0 +1,122 @@
+/*****************************************************************************
+ * This library is free software; you can redistribute it and/or             *
+ * modify it under the terms of the GNU Library General Public               *
+ * License as published by the Free Software Foundation; either              *
+ * version 2 of the License, or (at your option) any later version.          *
+ *                                                                           *
+ * This library is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU         *
+ * Library General Public License for more details.                          *
+ *                                                                           *
+ * You should have received a copy of the GNU Library General Public License *
+ * along with this library; see the file COPYING.LIB.  If not, write to      *
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,      *
+ * Boston, MA 02110-1301, USA.                                               *
+ *****************************************************************************/
+
+#ifndef STATIONINDEX_H
+#define STATIONINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "ion_export.h"
+
+/**
+* A searchable list of the weather stations or places known to an ion.
+*
+* Every station is a fixed number of string fields, the first of which is the
+* place name that is handed out to applets in validate replies and used in
+* "ion|weather|place" sources. The remaining fields are up to the ion.
+*
+* The index is kept in a binary file in the cache directory which is memory
+* mapped when loading, so an ion can answer location searches right after
+* startup without downloading and parsing its station list again. Place names
+* are case and diacritics folded and indexed by trigrams, which makes
+* substring searches, also of one or two characters, independent of the
+* number of stations apart from the number of results.
+*
+* The entity tag and modification date of the downloaded list are stored
+* along with it, so the list can be refreshed with a conditional request.
+*/
+class ION_EXPORT StationIndex
+{
+public:
+    /**
+     * @param name the name of the cache file, usually the name of the ion
+     */
+    explicit StationIndex(const QString &name);
+    ~StationIndex();
+
+    /**
+     * Loads the index from the cache directory.
+     * @return whether a valid index was found
+     */
+    bool load();
+
+    /**
+     * Replaces the contents of the index and writes it to the cache directory.
+     * @param stations the fields of each station, the first one being the place name
+     * @param etag the entity tag of the station list the stations were read from
+     * @param lastModified the modification date of that station list
+     * @return false if there are no stations
+     */
+    bool update(const QVector<QStringList> &stations, const QString &etag = QString(), const QString &lastModified = QString());
+
+    bool isValid() const;
+    int count() const;
+
+    QString etag() const;
+    QString lastModified() const;
+
+    /**
+     * Returns the headers to send along with the request for the station list,
+     * so the server can answer with "304 Not Modified" if the index is current.
+     * The headers are separated by "\r\n", as expected by the "customHTTPHeader"
+     * meta data of KIO jobs.
+     */
+    QString conditionalRequestHeaders() const;
+
+    /**
+     * Extracts the entity tag and modification date from the raw HTTP response
+     * headers, as found in the "HTTP-Headers" meta data of KIO jobs.
+     */
+    static void parseResponseHeaders(const QString &headers, QString *etag, QString *lastModified);
+
+    /**
+     * @return the stations whose place name contains @p text, ignoring case and
+     * diacritics, ordered by their folded place name.
+     */
+    QVector<int> search(const QString &text) const;
+
+    /**
+     * @return the station with the place name @p place, or -1
+     */
+    int find(const QString &place) const;
+
+    /**
+     * @return the stations of which field @p field equals @p value
+     *
+     * The first lookup of a field and case sensitivity goes through all
+     * stations to build a hash of its values, later ones only look it up.
+     */
+    QVector<int> findByField(int field, const QString &value, Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
+
+    QString field(int station, int field) const;
+    QString place(int station) const;
+
+    /**
+     * @return @p text case folded and with diacritics removed
+     */
+    static QString normalize(const QString &text);
+
+private:
+    class Private;
+    Private* const d;
+
+    Q_DISABLE_COPY(StationIndex)
+};
+
+#endif
@@ -27,6 +27,7 @@
 // https://api.wetter.com/forecast/weather/city/DE0004329/project/weatherion/cs/89f1264869cce5c6fd5a2db80051f3d8
 
 #include "ion_wettercom.h"
+#include "ion_wettercomparsers.h"
 
 #include "ion_wettercomdebug.h"
 
@@ -37,6 +38,7 @@
 #include <QCryptographicHash>
 #include <QXmlStreamReader>
 #include <QLocale>
+#include <QSharedPointer>
 
 /*
  * Initialization
@@ -54,24 +56,10 @@ WetterComIon::WetterComIon(QObject *parent, const QVariantList &args)
 
 WetterComIon::~WetterComIon()
 {
-    cleanup();
-}
-
-void WetterComIon::cleanup()
-{
-    // Clean up dynamically allocated forecasts
-    QMutableHashIterator<QString, WeatherData> it(m_weatherData);
-    while (it.hasNext()) {
-        it.next();
-        WeatherData &item = it.value();
-        qDeleteAll(item.forecasts);
-        item.forecasts.clear();
-    }
 }
 
 void WetterComIon::reset()
 {
-    cleanup();
     m_sourcesToReset = sources();
     updateAllSources();
 }
@@ -456,226 +444,166 @@ void WetterComIon::validate(const QString& source, bool parseError)
  * Handling of forecasts
  */
 
-void WetterComIon::fetchForecast(const QString& source)
-{
-    for (const QString& fetching : qAsConst(m_forecastJobList)) {
-        if (fetching == source) {
-            // already fetching!
-            return;
-        }
-    }
-
-    QCryptographicHash md5(QCryptographicHash::Md5);
-    md5.addData(QByteArray(PROJECTNAME));
-    md5.addData(QByteArray(APIKEY));
-    md5.addData(m_place[source].placeCode.toUtf8());
-    const QString encodedKey = QString::fromLatin1(md5.result().toHex());
-
-    const QUrl url(QStringLiteral(FORECAST_URL).arg(m_place[source].placeCode, encodedKey));
-
-    KIO::TransferJob* getJob = KIO::get(url, KIO::Reload, KIO::HideProgressInfo);
-    getJob->addMetaData(QStringLiteral("cookies"), QStringLiteral("none"));
-    m_forecastJobXml.insert(getJob, new QXmlStreamReader);
-    m_forecastJobList.insert(getJob, source);
-
-    connect(getJob, &KIO::TransferJob::data,
-            this, &WetterComIon::forecast_slotDataArrived);
-    connect(getJob, &KJob::result,
-            this, &WetterComIon::forecast_slotJobFinished);
-}
-
-void WetterComIon::forecast_slotDataArrived(KIO::Job *job, const QByteArray &data)
+void WetterComIon::ForecastParser::startElement(const QStringRef& name, const QXmlStreamAttributes& attributes)
 {
-    QByteArray local = data;
-
-    if (data.isEmpty() || !m_forecastJobXml.contains(job)) {
+    if (m_done) {
         return;
     }
 
-    m_forecastJobXml[job]->addData(local);
+    if (name == QLatin1String("date")) {
+        m_date = attributes.value(QStringLiteral("value")).toString();
+    } else if (name == QLatin1String("time")) {
+        m_time = attributes.value(QStringLiteral("value")).toString();
+    }
 }
 
-void WetterComIon::forecast_slotJobFinished(KJob *job)
+void WetterComIon::ForecastParser::endElement(const QStringRef& name, const QString& text)
 {
-    const QString source(m_forecastJobList.value(job));
-    setData(source, Data());
-    QXmlStreamReader *reader = m_forecastJobXml.value(job);
-
-    if (reader) {
-        parseWeatherForecast(source, *reader);
+    if (m_done) {
+        return;
     }
 
-    m_forecastJobList.remove(job);
-
-    delete m_forecastJobXml[job];
-    m_forecastJobXml.remove(job);
-
-    if (m_sourcesToReset.contains(source)) {
-        m_sourcesToReset.removeAll(source);
-        const QString weatherSource = QStringLiteral("wettercom|weather|%1|%2;%3")
-            .arg(source,
-                 m_place[source].placeCode,
-                 m_place[source].displayName);
-
-        // so the weather engine updates it's data
-        forceImmediateUpdateOfAllVisualizations();
+    if (name == QLatin1String("city")) {
+        m_done = true;
+    } else if (name == QLatin1String("date")) {
+        // we have parsed a complete day
+
+        m_forecastPeriod.period = QDateTime::fromSecsSinceEpoch(m_summaryUtcTime, Qt::LocalTime);
+        const QString weatherString = QString::number(m_summaryWeather);
+        m_forecastPeriod.iconName = m_ion->getWeatherIcon(m_ion->dayIcons(), weatherString);
+        m_forecastPeriod.summary = intern(m_ion->getWeatherCondition(m_ion->dayConditions(), weatherString));
+        m_forecastPeriod.probability = m_summaryProbability;
+
+        data.forecasts.append(m_forecastPeriod);
+        m_forecastPeriod = WeatherData::ForecastPeriod();
+
+        m_date.clear();
+        m_summaryWeather = -1;
+        m_summaryProbability = 0;
+        m_summaryUtcTime = 0;
+    } else if (name == QLatin1String("time")) {
+        // we have parsed one forecast
+
+        qCDebug(IONENGINE_WETTERCOM) << "Parsed a forecast interval:" << m_date << m_time;
+
+        // yep, that field is written to more often than needed...
+        data.timeDifference = m_localTime - m_utcTime;
+
+        WeatherData::ForecastInfo forecast;
+        forecast.period = QDateTime::fromSecsSinceEpoch(m_utcTime, Qt::LocalTime);
+        const QString weatherString = QString::number(m_weather);
+        forecast.tempHigh = m_tempMax;
+        forecast.tempLow = m_tempMin;
+        forecast.probability = m_probability;
+
+        QTime localWeatherTime = QDateTime::fromSecsSinceEpoch(m_utcTime, Qt::LocalTime).time();
+        localWeatherTime = localWeatherTime.addSecs(data.timeDifference);
+
+        qCDebug(IONENGINE_WETTERCOM) << "localWeatherTime =" << localWeatherTime;
+
+        // TODO use local sunset/sunrise time
+
+        if (localWeatherTime.hour() < 20 && localWeatherTime.hour() > 6) {
+            forecast.iconName = m_ion->getWeatherIcon(m_ion->dayIcons(), weatherString);
+            forecast.summary = intern(m_ion->getWeatherCondition(m_ion->dayConditions(), weatherString));
+            m_forecastPeriod.dayForecasts.append(forecast);
+        } else {
+            forecast.iconName = m_ion->getWeatherIcon(m_ion->nightIcons(), weatherString);
+            forecast.summary = intern(m_ion->getWeatherCondition(m_ion->nightConditions(), weatherString));
+            m_forecastPeriod.nightForecasts.append(forecast);
+        }
 
-        // update the clients of our engine
-        emit forceUpdate(this, weatherSource);
+        resetForecast();
+    } else if (name == QLatin1String("tx")) {
+        m_tempMax = qRound(text.toDouble());
+    } else if (name == QLatin1String("tn")) {
+        m_tempMin = qRound(text.toDouble());
+    } else if (name == QLatin1Char('w')) {
+        if (!m_time.isEmpty()) {
+            m_weather = text.toInt();
+        } else {
+            m_summaryWeather = text.toInt();
+        }
+    } else if (name == QLatin1String("name")) {
+        data.stationName = text;
+    } else if (name == QLatin1String("pc")) {
+        if (!m_time.isEmpty()) {
+            m_probability = text.toInt();
+        } else {
+            m_summaryProbability = text.toInt();
+        }
+    } else if (name == QLatin1String("text")) {
+        data.credits = text;
+    } else if (name == QLatin1String("link")) {
+        data.creditsUrl = text;
+    } else if (name == QLatin1Char('d')) {
+        m_localTime = text.toInt();
+    } else if (name == QLatin1String("du")) {
+        if (!m_time.isEmpty()) {
+            m_utcTime = text.toInt();
+        } else {
+            m_summaryUtcTime = text.toInt();
+        }
     }
 }
 
-void WetterComIon::parseWeatherForecast(const QString& source, QXmlStreamReader& xml)
+void WetterComIon::ForecastParser::resetForecast()
 {
-    qCDebug(IONENGINE_WETTERCOM) << "About to parse forecast for source:" << source;
-
-    WeatherData& weatherData = m_weatherData[source];
-
-    // Clear old forecasts when updating
-    weatherData.forecasts.clear();
-
-    WeatherData::ForecastPeriod *forecastPeriod = new WeatherData::ForecastPeriod;
-    WeatherData::ForecastInfo *forecast = new WeatherData::ForecastInfo;
-    int summaryWeather = -1, summaryProbability = 0;
-    int tempMax = -273, tempMin = 100, weather = -1, probability = 0;
-    uint summaryUtcTime = 0, utcTime = 0, localTime = 0;
-    QString date, time;
-
-    weatherData.place = source;
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-
-        qCDebug(IONENGINE_WETTERCOM) << "parsing xml elem: " << xml.name();
-
-        const QStringRef elementName = xml.name();
-
-        if (xml.isEndElement()) {
-            if (elementName == QLatin1String("city")) {
-                break;
-            }
-            if (elementName == QLatin1String("date")) {
-                // we have parsed a complete day
-
-                forecastPeriod->period = QDateTime::fromSecsSinceEpoch(summaryUtcTime, Qt::LocalTime);
-                QString weatherString = QString::number(summaryWeather);
-                forecastPeriod->iconName = getWeatherIcon(dayIcons(),
-                                           weatherString);
-                forecastPeriod->summary = getWeatherCondition(dayConditions(),
-                                          weatherString);
-                forecastPeriod->probability = summaryProbability;
-
-                weatherData.forecasts.append(forecastPeriod);
-                forecastPeriod = new WeatherData::ForecastPeriod;
-
-                date.clear();
-                summaryWeather = -1;
-                summaryProbability = 0;
-                summaryUtcTime = 0;
-            } else if (elementName == QLatin1String("time")) {
-                // we have parsed one forecast
-
-                qCDebug(IONENGINE_WETTERCOM) << "Parsed a forecast interval:" << date << time;
-
-                // yep, that field is written to more often than needed...
-                weatherData.timeDifference = localTime - utcTime;
-
-                forecast->period = QDateTime::fromSecsSinceEpoch(utcTime, Qt::LocalTime);
-                QString weatherString = QString::number(weather);
-                forecast->tempHigh = tempMax;
-                forecast->tempLow = tempMin;
-                forecast->probability = probability;
-
-                QTime localWeatherTime = QDateTime::fromSecsSinceEpoch(utcTime, Qt::LocalTime).time();
-                localWeatherTime = localWeatherTime.addSecs(weatherData.timeDifference);
-
-                qCDebug(IONENGINE_WETTERCOM) << "localWeatherTime =" << localWeatherTime;
-
-                // TODO use local sunset/sunrise time
-
-                if (localWeatherTime.hour() < 20 && localWeatherTime.hour() > 6) {
-                    forecast->iconName = getWeatherIcon(dayIcons(),
-                                                        weatherString);
-                    forecast->summary = getWeatherCondition(dayConditions(),
-                                                            weatherString);
-                    forecastPeriod->dayForecasts.append(forecast);
-                } else {
-                    forecast->iconName = getWeatherIcon(nightIcons(),
-                                                        weatherString);
-                    forecast->summary = getWeatherCondition(nightConditions(),
-                                                            weatherString);
-                    forecastPeriod->nightForecasts.append(forecast);
-                }
-
-                forecast = new WeatherData::ForecastInfo;
-
-                tempMax = -273;
-                tempMin = 100;
-                weather = -1;
-                probability = 0;
-                utcTime = localTime = 0;
-                time.clear();
-            }
-        }
+    m_tempMax = -273;
+    m_tempMin = 100;
+    m_weather = -1;
+    m_probability = 0;
+    m_utcTime = m_localTime = 0;
+    m_time.clear();
+}
 
-        if (xml.isStartElement()) {
-            if (elementName == QLatin1String("date")) {
-                date = xml.attributes().value(QStringLiteral("value")).toString();
-            } else if (elementName == QLatin1String("time")) {
-                time = xml.attributes().value(QStringLiteral("value")).toString();
-            } else if (elementName == QLatin1String("tx")) {
-                tempMax = qRound(xml.readElementText().toDouble());
-                qCDebug(IONENGINE_WETTERCOM) << "parsed t_max:" << tempMax;
-            } else if (elementName == QLatin1String("tn")) {
-                tempMin = qRound(xml.readElementText().toDouble());
-                qCDebug(IONENGINE_WETTERCOM) << "parsed t_min:" << tempMin;
-            } else if (elementName == QLatin1Char('w')) {
-                int tmp = xml.readElementText().toInt();
-
-                if (!time.isEmpty())
-                    weather = tmp;
-                else
-                    summaryWeather = tmp;
-
-                qCDebug(IONENGINE_WETTERCOM) << "parsed weather condition:" << tmp;
-            } else if (elementName == QLatin1String("name")) {
-                weatherData.stationName = xml.readElementText();
-                qCDebug(IONENGINE_WETTERCOM) << "parsed station name:" << weatherData.stationName;
-            } else if (elementName == QLatin1String("pc")) {
-                int tmp = xml.readElementText().toInt();
-
-                if (!time.isEmpty())
-                    probability = tmp;
-                else
-                    summaryProbability = tmp;
-
-                qCDebug(IONENGINE_WETTERCOM) << "parsed probability:" << probability;
-            } else if (elementName == QLatin1String("text")) {
-                weatherData.credits = xml.readElementText();
-                qCDebug(IONENGINE_WETTERCOM) << "parsed credits:" << weatherData.credits;
-            } else if (elementName == QLatin1String("link")) {
-                weatherData.creditsUrl = xml.readElementText();
-                qCDebug(IONENGINE_WETTERCOM) << "parsed credits url:" << weatherData.creditsUrl;
-            } else if (elementName == QLatin1Char('d')) {
-                localTime = xml.readElementText().toInt();
-                qCDebug(IONENGINE_WETTERCOM) << "parsed local time:" << localTime;
-            } else if (elementName == QLatin1String("du")) {
-                int tmp = xml.readElementText().toInt();
-
-                if (!time.isEmpty())
-                    utcTime = tmp;
-                else
-                    summaryUtcTime = tmp;
-
-                qCDebug(IONENGINE_WETTERCOM) << "parsed UTC time:" << tmp;
-            }
-        }
-    }
+void WetterComIon::fetchForecast(const QString& source)
+{
+    QCryptographicHash md5(QCryptographicHash::Md5);
+    md5.addData(QByteArray(PROJECTNAME));
+    md5.addData(QByteArray(APIKEY));
+    md5.addData(m_place[source].placeCode.toUtf8());
+    const QString encodedKey = QString::fromLatin1(md5.result().toHex());
 
-    delete forecast;
-    delete forecastPeriod;
+    const QUrl url(QStringLiteral(FORECAST_URL).arg(m_place[source].placeCode, encodedKey));
 
-    updateWeather(source, xml.error() != QXmlStreamReader::NoError);
+    // parsed while downloading, once for all sources of the same city
+    QSharedPointer<ForecastParser> parser(new ForecastParser(this));
+    fetch(url, source,
+          [parser](const QByteArray& chunk) {
+              parser->addData(chunk);
+          },
+          [this, parser](const QByteArray&, const QStringList& sources) {
+              const bool parseError = !parser->finish();
+              if (parseError) {
+                  qCDebug(IONENGINE_WETTERCOM) << "Failed to parse forecast:" << parser->errorString();
+              }
+
+              for (const QString& placeSource : sources) {
+                  setData(placeSource, Data());
+
+                  WeatherData& weatherData = m_weatherData[placeSource];
+                  // implicitly shared between all sources
+                  weatherData = parser->data;
+                  weatherData.place = placeSource;
+
+                  updateWeather(placeSource, parseError);
+
+                  if (m_sourcesToReset.contains(placeSource)) {
+                      m_sourcesToReset.removeAll(placeSource);
+                      const QString weatherSource = QStringLiteral("wettercom|weather|%1|%2;%3")
+                          .arg(placeSource,
+                               m_place[placeSource].placeCode,
+                               m_place[placeSource].displayName);
+
+                      // so the weather engine updates it's data
+                      forceImmediateUpdateOfAllVisualizations();
+
+                      // update the clients of our engine
+                      emit forceUpdate(this, weatherSource);
+                  }
+              }
+          });
 }
 
 void WetterComIon::updateWeather(const QString& source, bool parseError)
@@ -701,9 +629,9 @@ void WetterComIon::updateWeather(const QString& source, bool parseError)
         data.insert(QStringLiteral("Temperature Unit"), KUnitConversion::Celsius);
 
         int i = 0;
-        for (const WeatherData::ForecastPeriod* forecastPeriod : weatherData.forecasts) {
+        for (const WeatherData::ForecastPeriod& forecastPeriod : weatherData.forecasts) {
             if (i > 0) {
-                WeatherData::ForecastInfo weather = forecastPeriod->getWeather();
+                WeatherData::ForecastInfo weather = forecastPeriod.getWeather();
 
                 data.insert(QStringLiteral("Short Forecast Day %1").arg(i),
                             QStringLiteral("%1|%2|%3|%4|%5|%6")
@@ -715,7 +643,7 @@ void WetterComIon::updateWeather(const QString& source, bool parseError)
                             .arg(weather.probability));
                 i++;
             } else {
-                WeatherData::ForecastInfo dayWeather = forecastPeriod->getDayWeather();
+                WeatherData::ForecastInfo dayWeather = forecastPeriod.getDayWeather();
 
                 data.insert(QStringLiteral("Short Forecast Day %1").arg(i),
                             QStringLiteral("%1|%2|%3|%4|%5|%6")
@@ -727,8 +655,8 @@ void WetterComIon::updateWeather(const QString& source, bool parseError)
                             .arg(dayWeather.probability));
                 i++;
 
-                if (forecastPeriod->hasNightWeather()) {
-                    WeatherData::ForecastInfo nightWeather = forecastPeriod->getNightWeather();
+                if (forecastPeriod.hasNightWeather()) {
+                    WeatherData::ForecastInfo nightWeather = forecastPeriod.getNightWeather();
                     data.insert(QStringLiteral("Short Forecast Day %1").arg(i),
                                 QStringLiteral("%1 nt|%2|%3|%4|%5|%6")
                                 .arg(i18n("Night"),
@@ -761,12 +689,6 @@ void WetterComIon::updateWeather(const QString& source, bool parseError)
  * WeatherData::ForecastPeriod convenience methods
  */
 
-WeatherData::ForecastPeriod::~ForecastPeriod()
-{
-    qDeleteAll(dayForecasts);
-    qDeleteAll(nightForecasts);
-}
-
 WeatherData::ForecastInfo WeatherData::ForecastPeriod::getDayWeather() const
 {
     WeatherData::ForecastInfo result;
@@ -784,7 +706,7 @@ WeatherData::ForecastInfo WeatherData::ForecastPeriod::getNightWeather() const
     qCDebug(IONENGINE_WETTERCOM) << "nightForecasts.size() =" << nightForecasts.size();
 
     // TODO do not just pick the first night forecast
-    return *(nightForecasts.at(0));
+    return nightForecasts.at(0);
 }
 
 bool WeatherData::ForecastPeriod::hasNightWeather() const
@@ -800,21 +722,21 @@ WeatherData::ForecastInfo WeatherData::ForecastPeriod::getWeather() const
     return result;
 }
 
-int WeatherData::ForecastPeriod::getMaxTemp(const QVector<WeatherData::ForecastInfo*>& forecastInfos) const
+int WeatherData::ForecastPeriod::getMaxTemp(const QVector<WeatherData::ForecastInfo>& forecastInfos) const
 {
     int result = -273;
-    for (const WeatherData::ForecastInfo* forecast : forecastInfos) {
-        result = std::max(result, forecast->tempHigh);
+    for (const WeatherData::ForecastInfo& forecast : forecastInfos) {
+        result = std::max(result, forecast.tempHigh);
     }
 
     return result;
 }
 
-int WeatherData::ForecastPeriod::getMinTemp(const QVector<WeatherData::ForecastInfo*>& forecastInfos) const
+int WeatherData::ForecastPeriod::getMinTemp(const QVector<WeatherData::ForecastInfo>& forecastInfos) const
 {
     int result = 100;
-    for (const WeatherData::ForecastInfo* forecast : forecastInfos) {
-        result = std::min(result, forecast->tempLow);
+    for (const WeatherData::ForecastInfo& forecast : forecastInfos) {
+        result = std::min(result, forecast.tempLow);
     }
 
     return result;
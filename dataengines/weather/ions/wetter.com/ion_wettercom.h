@@ -76,22 +76,20 @@ public:
     class ForecastPeriod : public ForecastInfo
     {
     public:
-        ~ForecastPeriod();
-
         WeatherData::ForecastInfo getDayWeather() const;
         WeatherData::ForecastInfo getNightWeather() const;
         WeatherData::ForecastInfo getWeather() const;
 
         bool hasNightWeather() const;
 
-        QVector<WeatherData::ForecastInfo *> dayForecasts;
-        QVector<WeatherData::ForecastInfo *> nightForecasts;
+        QVector<WeatherData::ForecastInfo> dayForecasts;
+        QVector<WeatherData::ForecastInfo> nightForecasts;
     private:
-        int getMaxTemp(const QVector<WeatherData::ForecastInfo*>& forecastInfos) const;
-        int getMinTemp(const QVector<WeatherData::ForecastInfo*>& forecastInfos) const;
+        int getMaxTemp(const QVector<WeatherData::ForecastInfo>& forecastInfos) const;
+        int getMinTemp(const QVector<WeatherData::ForecastInfo>& forecastInfos) const;
     };
 
-    QVector<WeatherData::ForecastPeriod *> forecasts;
+    QVector<WeatherData::ForecastPeriod> forecasts;
 };
 
 Q_DECLARE_TYPEINFO(WeatherData::ForecastInfo, Q_MOVABLE_TYPE);
@@ -117,12 +115,11 @@ private Q_SLOTS:
     void setup_slotDataArrived(KIO::Job *, const QByteArray &);
     void setup_slotJobFinished(KJob *);
 
-    void forecast_slotDataArrived(KIO::Job *, const QByteArray &);
-    void forecast_slotJobFinished(KJob *);
+public:
+    // parser of the downloaded forecasts, defined in ion_wettercomparsers.h
+    class ForecastParser;
 
 private:
-    void cleanup();
-
     // Set up the mapping from the wetter.com condition code to the respective icon / condition name
     QMap<QString, ConditionIcons> setupCommonIconMappings() const;
     QMap<QString, ConditionIcons> setupDayIconMappings() const;
@@ -146,7 +143,6 @@ private:
 
     // Retrieve and parse forecast
     void fetchForecast(const QString& source);
-    void parseWeatherForecast(const QString& source, QXmlStreamReader& xml);
     void updateWeather(const QString& source, bool parseError);
 
 private:
@@ -167,10 +163,6 @@ private:
     QHash<KJob *, QXmlStreamReader *> m_searchJobXml;
     QHash<KJob *, QString> m_searchJobList;
 
-    // Store KIO jobs - Forecast retrieval
-    QHash<KJob *, QXmlStreamReader *> m_forecastJobXml;
-    QHash<KJob *, QString> m_forecastJobList;
-
     QStringList m_sourcesToReset;
 };
 
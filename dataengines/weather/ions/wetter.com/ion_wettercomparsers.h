@@ -0,0 +1,62 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA          *
+ ***************************************************************************/
+
+#ifndef ION_WETTERCOMPARSERS_H
+#define ION_WETTERCOMPARSERS_H
+
+#include "ion_wettercom.h"
+
+#include "../incrementalxmlparser.h"
+
+/**
+ * Parses the forecast document of a city, which lists the days, each with
+ * a summary and the forecasts for several intervals of the day.
+ */
+class WetterComIon::ForecastParser : public IncrementalXmlParser
+{
+public:
+    explicit ForecastParser(const WetterComIon* ion) : m_ion(ion) {}
+
+    WeatherData data;
+
+protected:
+    void startElement(const QStringRef& name, const QXmlStreamAttributes& attributes) override;
+    void endElement(const QStringRef& name, const QString& text) override;
+
+private:
+    void resetForecast();
+
+    const WetterComIon* const m_ion;
+
+    // set once the end of the city was seen, anything after it is ignored
+    bool m_done = false;
+
+    WeatherData::ForecastPeriod m_forecastPeriod;
+    int m_summaryWeather = -1;
+    int m_summaryProbability = 0;
+    uint m_summaryUtcTime = 0;
+    int m_tempMax = -273;
+    int m_tempMin = 100;
+    int m_weather = -1;
+    int m_probability = 0;
+    uint m_utcTime = 0;
+    uint m_localTime = 0;
+    QString m_date;
+    QString m_time;
+};
+
+#endif
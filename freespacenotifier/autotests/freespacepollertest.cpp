@@ -0,0 +1,226 @@
+/* This file is part of the KDE Project
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QObject>
+
+#include <QAtomicInt>
+#include <QDir>
+#include <QSemaphore>
+#include <QSignalSpy>
+#include <QStorageInfo>
+#include <QTest>
+
+#include "freespacepoller.h"
+
+static const int s_interval = 100;
+static const int s_timeout = 5000;
+
+/**
+ * A poller whose queries answer what the test tells them, or hang on the
+ * path "hung" until released
+ */
+class TestPoller : public FreeSpacePoller
+{
+public:
+    explicit TestPoller(int interval = s_interval, int timeout = s_timeout)
+        : FreeSpacePoller(interval, timeout)
+    {
+    }
+
+    ~TestPoller() override
+    {
+        // no worker may be left in querySpace() once the poller is gone
+        release();
+    }
+
+    void release()
+    {
+        if (!m_released.fetchAndStoreOrdered(1)) {
+            m_hung.release(1000);
+        }
+    }
+
+    QAtomicInt available = 1000;
+    mutable QAtomicInt queries = 0;
+    mutable QAtomicInt hungQueries = 0;
+
+protected:
+    SpaceResult querySpace(const QString &path) const override
+    {
+        SpaceResult result;
+
+        if (path == QLatin1String("hung")) {
+            ++hungQueries;
+            m_hung.acquire();
+        } else {
+            ++queries;
+        }
+
+        result.ok = (path != QLatin1String("failing"));
+        result.size = 4000;
+        result.available = available.load();
+        return result;
+    }
+
+private:
+    mutable QSemaphore m_hung;
+    QAtomicInt m_released = 0;
+};
+
+class FreeSpacePollerTest : public QObject
+{
+Q_OBJECT
+
+private Q_SLOTS:
+    void testStatvfs();
+    void testResultDelivery();
+    void testInterval();
+    void testTimeout();
+    void testUnwatch();
+};
+
+void FreeSpacePollerTest::testStatvfs()
+{
+    const QString path = QDir::tempPath();
+
+    FreeSpacePoller *poller = FreeSpacePoller::self();
+    QSignalSpy spy(poller, &FreeSpacePoller::spaceChanged);
+    poller->watch(path);
+
+    QVERIFY(spy.wait(s_timeout));
+    QCOMPARE(spy.first().at(0).toString(), path);
+
+    const QStorageInfo storage(path);
+    QCOMPARE(spy.first().at(1).value<quint64>(), quint64(storage.bytesTotal()));
+
+    quint64 size = 0;
+    QVERIFY(poller->spaceInfo(path, &size, nullptr));
+    QCOMPARE(size, quint64(storage.bytesTotal()));
+
+    poller->unwatch(path);
+    QVERIFY(!poller->spaceInfo(path, nullptr, nullptr));
+}
+
+void FreeSpacePollerTest::testResultDelivery()
+{
+    TestPoller poller;
+    QSignalSpy spy(&poller, &FreeSpacePoller::spaceChanged);
+
+    poller.watch(QStringLiteral("a"));
+    poller.watch(QStringLiteral("failing"));
+
+    QVERIFY(spy.wait(s_timeout));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().at(0).toString(), QStringLiteral("a"));
+    QCOMPARE(spy.first().at(1).value<quint64>(), quint64(4000));
+    QCOMPARE(spy.first().at(2).value<quint64>(), quint64(1000));
+
+    quint64 size = 0;
+    quint64 available = 0;
+    QVERIFY(poller.spaceInfo(QStringLiteral("a"), &size, &available));
+    QCOMPARE(size, quint64(4000));
+    QCOMPARE(available, quint64(1000));
+
+    // a path whose query fails has no values
+    QVERIFY(!poller.spaceInfo(QStringLiteral("failing"), &size, &available));
+    QVERIFY(!poller.spaceInfo(QStringLiteral("unknown"), &size, &available));
+}
+
+void FreeSpacePollerTest::testInterval()
+{
+    TestPoller poller;
+    QSignalSpy spy(&poller, &FreeSpacePoller::spaceChanged);
+
+    poller.watch(QStringLiteral("a"));
+    QVERIFY(spy.wait(s_timeout));
+
+    // polled again and again, but unchanged values are not reported
+    QTRY_VERIFY_WITH_TIMEOUT(poller.queries.load() >= 4, s_timeout);
+    QCOMPARE(spy.count(), 1);
+
+    poller.available = 500;
+    QVERIFY(spy.wait(s_timeout));
+    QCOMPARE(spy.last().at(2).value<quint64>(), quint64(500));
+
+    // refreshing right away does not wait for the interval, requests are merged
+    TestPoller slowPoller(60 * 1000);
+    QSignalSpy slowSpy(&slowPoller, &FreeSpacePoller::spaceChanged);
+    slowPoller.watch(QStringLiteral("a"));
+    QVERIFY(slowSpy.wait(s_timeout));
+    QCOMPARE(slowPoller.queries.load(), 1);
+    slowPoller.refresh();
+    slowPoller.refresh();
+    slowPoller.refresh();
+    QTRY_COMPARE_WITH_TIMEOUT(slowPoller.queries.load(), 2, s_timeout);
+    QTest::qWait(s_interval);
+    QCOMPARE(slowPoller.queries.load(), 2);
+}
+
+void FreeSpacePollerTest::testTimeout()
+{
+    const int timeout = 200;
+    TestPoller poller(s_interval, timeout);
+    QSignalSpy notResponding(&poller, &FreeSpacePoller::notResponding);
+    QSignalSpy changed(&poller, &FreeSpacePoller::spaceChanged);
+
+    poller.watch(QStringLiteral("hung"));
+    poller.watch(QStringLiteral("a"));
+
+    QVERIFY(notResponding.wait(s_timeout));
+    QCOMPARE(notResponding.count(), 1);
+    QCOMPARE(notResponding.first().at(0).toString(), QStringLiteral("hung"));
+
+    // the others are still polled, the hung one is not asked again meanwhile
+    const int queries = poller.queries.load();
+    QTRY_VERIFY_WITH_TIMEOUT(poller.queries.load() >= queries + 3, s_timeout);
+    QCOMPARE(poller.hungQueries.load(), 1);
+    QCOMPARE(notResponding.count(), 1);
+
+    // once it answers, its values are delivered and it is polled again
+    poller.release();
+    QTRY_VERIFY_WITH_TIMEOUT(poller.spaceInfo(QStringLiteral("hung"), nullptr, nullptr), s_timeout);
+    QTRY_VERIFY_WITH_TIMEOUT(poller.hungQueries.load() >= 2, s_timeout);
+}
+
+void FreeSpacePollerTest::testUnwatch()
+{
+    TestPoller poller;
+    QSignalSpy spy(&poller, &FreeSpacePoller::spaceChanged);
+
+    // watching is reference counted
+    poller.watch(QStringLiteral("a"));
+    poller.watch(QStringLiteral("a"));
+    QVERIFY(spy.wait(s_timeout));
+
+    poller.unwatch(QStringLiteral("a"));
+    poller.available = 500;
+    QVERIFY(spy.wait(s_timeout));
+
+    poller.unwatch(QStringLiteral("a"));
+    QVERIFY(!poller.spaceInfo(QStringLiteral("a"), nullptr, nullptr));
+
+    // no more polling
+    QTest::qWait(s_interval * 2);
+    const int queries = poller.queries.load();
+    poller.available = 200;
+    QTest::qWait(s_interval * 3);
+    QCOMPARE(poller.queries.load(), queries);
+    QCOMPARE(spy.count(), 2);
+}
+
+QTEST_MAIN(FreeSpacePollerTest)
+
+#include "freespacepollertest.moc"
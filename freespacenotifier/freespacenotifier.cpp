@@ -30,8 +30,7 @@
 #include <KStatusNotifierItem>
 #include <KNotification>
 
-#include <KIO/FileSystemFreeSpaceJob>
-
+#include "freespacepoller.h"
 #include "settings.h"
 #include "ui_freespacenotifier_prefs_base.h"
 
@@ -45,12 +44,17 @@ FreeSpaceNotifier::FreeSpaceNotifier(QObject *parent)
     // If we are running, notifications are enabled
     FreeSpaceNotifierSettings::setEnableNotification(true);
 
-    connect(&timer, &QTimer::timeout, this, &FreeSpaceNotifier::checkFreeDiskSpace);
-    timer.start(1000 * 60 /* 1 minute */);
+    m_path = QDir::homePath();
+    connect(FreeSpacePoller::self(), &FreeSpacePoller::spaceChanged, this, &FreeSpaceNotifier::checkFreeDiskSpace);
+    FreeSpacePoller::self()->watch(m_path);
 }
 
 FreeSpaceNotifier::~FreeSpaceNotifier()
 {
+    if (!m_path.isEmpty()) {
+        FreeSpacePoller::self()->unwatch(m_path);
+    }
+
     // The notification is automatically destroyed when it goes away, so we only need to do this if
     // it is still being shown
     if (m_notification) {
@@ -62,88 +66,86 @@ FreeSpaceNotifier::~FreeSpaceNotifier()
     }
 }
 
-void FreeSpaceNotifier::checkFreeDiskSpace()
+void FreeSpaceNotifier::checkFreeDiskSpace(const QString &path, quint64 size, quint64 available)
 {
+    if (path != m_path) {
+        return;
+    }
+
     if (!FreeSpaceNotifierSettings::enableNotification()) {
         // do nothing if notifying is disabled;
-        // also stop the timer that probably got us here in the first place
-        timer.stop();
+        // also stop polling the home directory
+        FreeSpacePoller::self()->unwatch(m_path);
+        m_path.clear();
 
         return;
     }
 
-    auto *job = KIO::fileSystemFreeSpace(QUrl::fromLocalFile(QDir::homePath()));
-    connect(job, &KIO::FileSystemFreeSpaceJob::result, this, [this](KIO::Job* job, KIO::filesize_t size, KIO::filesize_t available) {
-        if (job->error()) {
-            return;
+    int limit = FreeSpaceNotifierSettings::minimumSpace(); // MiB
+    qint64 avail = available / (1024 * 1024); // to MiB
+    bool warn = false;
+
+    if (avail < limit) {
+        // avail disk space dropped under a limit
+        if (m_lastAvail < 0 || avail < m_lastAvail / 2) { // always warn the first time or when available dropped to a half of previous one, warn again
+            m_lastAvail = avail;
+            warn = true;
+        } else if (avail > m_lastAvail) {     // the user freed some space
+            m_lastAvail = avail;              // so warn if it goes low again
+            if (m_sni) {
+                // keep the SNI active, but don't blink
+                m_sni->setStatus(KStatusNotifierItem::Active);
+                m_sni->setToolTip(QStringLiteral("drive-harddisk"), i18n("Low Disk Space"), i18n("Remaining space in your Home folder: %1 MiB", QLocale::system().toString(avail)));
+            }
         }
-
-        int limit = FreeSpaceNotifierSettings::minimumSpace(); // MiB
-        qint64 avail = available / (1024 * 1024); // to MiB
-        bool warn = false;
-
-        if (avail < limit) {
-            // avail disk space dropped under a limit
-            if (m_lastAvail < 0 || avail < m_lastAvail / 2) { // always warn the first time or when available dropped to a half of previous one, warn again
-                m_lastAvail = avail;
-                warn = true;
-            } else if (avail > m_lastAvail) {     // the user freed some space
-                m_lastAvail = avail;              // so warn if it goes low again
-                if (m_sni) {
-                    // keep the SNI active, but don't blink
-                    m_sni->setStatus(KStatusNotifierItem::Active);
-                    m_sni->setToolTip(QStringLiteral("drive-harddisk"), i18n("Low Disk Space"), i18n("Remaining space in your Home folder: %1 MiB", QLocale::system().toString(avail)));
-                }
+        // do not change lastAvail otherwise, to handle free space slowly going down
+
+        if (warn) {
+            int availpct = int(100 * available / size);
+            if (!m_sni) {
+                m_sni = new KStatusNotifierItem(QStringLiteral("freespacenotifier"));
+                m_sni->setIconByName(QStringLiteral("drive-harddisk"));
+                m_sni->setOverlayIconByName(QStringLiteral("dialog-warning"));
+                m_sni->setTitle(i18n("Low Disk Space"));
+                m_sni->setCategory(KStatusNotifierItem::Hardware);
+
+                QMenu *sniMenu = new QMenu();
+                QAction *action = new QAction(i18nc("Opens a file manager like dolphin", "Open File Manager..."), nullptr);
+                connect(action, &QAction::triggered, this, &FreeSpaceNotifier::openFileManager);
+                sniMenu->addAction(action);
+
+                action = new QAction(i18nc("Allows the user to configure the warning notification being shown", "Configure Warning..."), nullptr);
+                connect(action, &QAction::triggered, this, &FreeSpaceNotifier::showConfiguration);
+                sniMenu->addAction(action);
+
+                action = new QAction(i18nc("Allows the user to hide this notifier item", "Hide"), nullptr);
+                connect(action, &QAction::triggered, this, &FreeSpaceNotifier::hideSni);
+                sniMenu->addAction(action);
+
+                m_sni->setContextMenu(sniMenu);
+                m_sni->setStandardActionsEnabled(false);
             }
-            // do not change lastAvail otherwise, to handle free space slowly going down
-
-            if (warn) {
-                int availpct = int(100 * available / size);
-                if (!m_sni) {
-                    m_sni = new KStatusNotifierItem(QStringLiteral("freespacenotifier"));
-                    m_sni->setIconByName(QStringLiteral("drive-harddisk"));
-                    m_sni->setOverlayIconByName(QStringLiteral("dialog-warning"));
-                    m_sni->setTitle(i18n("Low Disk Space"));
-                    m_sni->setCategory(KStatusNotifierItem::Hardware);
-
-                    QMenu *sniMenu = new QMenu();
-                    QAction *action = new QAction(i18nc("Opens a file manager like dolphin", "Open File Manager..."), nullptr);
-                    connect(action, &QAction::triggered, this, &FreeSpaceNotifier::openFileManager);
-                    sniMenu->addAction(action);
-
-                    action = new QAction(i18nc("Allows the user to configure the warning notification being shown", "Configure Warning..."), nullptr);
-                    connect(action, &QAction::triggered, this, &FreeSpaceNotifier::showConfiguration);
-                    sniMenu->addAction(action);
-
-                    action = new QAction(i18nc("Allows the user to hide this notifier item", "Hide"), nullptr);
-                    connect(action, &QAction::triggered, this, &FreeSpaceNotifier::hideSni);
-                    sniMenu->addAction(action);
-
-                    m_sni->setContextMenu(sniMenu);
-                    m_sni->setStandardActionsEnabled(false);
-                }
-
-                m_sni->setStatus(KStatusNotifierItem::NeedsAttention);
-                m_sni->setToolTip(QStringLiteral("drive-harddisk"), i18n("Low Disk Space"), i18n("Remaining space in your Home folder: %1 MiB", QLocale::system().toString(avail)));
 
-                m_notification = new KNotification(QStringLiteral("freespacenotif"));
+            m_sni->setStatus(KStatusNotifierItem::NeedsAttention);
+            m_sni->setToolTip(QStringLiteral("drive-harddisk"), i18n("Low Disk Space"), i18n("Remaining space in your Home folder: %1 MiB", QLocale::system().toString(avail)));
 
-                m_notification->setText(i18nc("Warns the user that the system is running low on space on his home folder, indicating the percentage and absolute MiB size remaining",
-                                            "Your Home folder is running out of disk space, you have %1 MiB remaining (%2%)", QLocale::system().toString(avail), availpct));
+            m_notification = new KNotification(QStringLiteral("freespacenotif"));
 
-                connect(m_notification, &KNotification::closed, this, &FreeSpaceNotifier::cleanupNotification);
+            m_notification->setText(i18nc("Warns the user that the system is running low on space on his home folder, indicating the percentage and absolute MiB size remaining",
+                                        "Your Home folder is running out of disk space, you have %1 MiB remaining (%2%)", QLocale::system().toString(avail), availpct));
 
-                m_notification->setComponentName(QStringLiteral("freespacenotifier"));
-                m_notification->sendEvent();
-            }
-        } else {
-            // free space is above limit again, remove the SNI
-            if (m_sni) {
-                m_sni->deleteLater();
-                m_sni = nullptr;
-            }
+            connect(m_notification, &KNotification::closed, this, &FreeSpaceNotifier::cleanupNotification);
+
+            m_notification->setComponentName(QStringLiteral("freespacenotifier"));
+            m_notification->sendEvent();
         }
-    });
+    } else {
+        // free space is above limit again, remove the SNI
+        if (m_sni) {
+            m_sni->deleteLater();
+            m_sni = nullptr;
+        }
+    }
 }
 
 void FreeSpaceNotifier::hideSni()
@@ -214,6 +216,13 @@ void FreeSpaceNotifier::resetLastAvailable()
     m_lastAvail = -1;
     m_lastAvailTimer->deleteLater();
     m_lastAvailTimer = nullptr;
+
+    // the poller only reports changes, so look at the current value again
+    quint64 size = 0;
+    quint64 available = 0;
+    if (!m_path.isEmpty() && FreeSpacePoller::self()->spaceInfo(m_path, &size, &available)) {
+        checkFreeDiskSpace(m_path, size, available);
+    }
 }
 
 void FreeSpaceNotifier::configDialogClosed()
@@ -35,7 +35,7 @@ public:
     ~FreeSpaceNotifier() override;
 
 private Q_SLOTS:
-    void checkFreeDiskSpace();
+    void checkFreeDiskSpace(const QString &path, quint64 size, quint64 available);
     void resetLastAvailable();
     void openFileManager();
     void showConfiguration();
@@ -44,7 +44,7 @@ private Q_SLOTS:
     void hideSni();
 
 private:
-    QTimer timer;
+    QString m_path;
     QTimer *m_lastAvailTimer;
     KNotification *m_notification;
     KStatusNotifierItem *m_sni;
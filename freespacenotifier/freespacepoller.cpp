@@ -0,0 +1,300 @@
+/* This file is part of the KDE Project
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "freespacepoller.h"
+
+#include <QFile>
+#include <QFutureWatcher>
+#include <QLibrary>
+#include <QSocketNotifier>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+namespace
+{
+    // the workers are mostly waiting on the kernel, a handful is plenty
+    const int s_maxThreadCount = 4;
+
+    const int s_interval = 60 * 1000;
+    const int s_timeout = 15000;
+
+    // A query may be stuck in a worker for as long as the process lives, even
+    // after the poller is gone, so the plugin which runs them must not be
+    // unloaded anymore once it started one
+    void keepLoaded()
+    {
+        static bool kept = false;
+        if (kept) {
+            return;
+        }
+        kept = true;
+
+        Dl_info info;
+        if (::dladdr(reinterpret_cast<void *>(&keepLoaded), &info) && info.dli_fname) {
+            QLibrary library(QFile::decodeName(info.dli_fname));
+            library.setLoadHints(QLibrary::PreventUnloadHint);
+            library.load();
+        }
+    }
+}
+
+class FreeSpacePollerSingleton
+{
+public:
+    FreeSpacePollerSingleton()
+        : self(s_interval, s_timeout)
+    {
+    }
+
+    FreeSpacePoller self;
+};
+
+Q_GLOBAL_STATIC(FreeSpacePollerSingleton, privateFreeSpacePollerSelf)
+
+FreeSpacePoller *FreeSpacePoller::self()
+{
+    return &privateFreeSpacePollerSelf->self;
+}
+
+FreeSpacePoller::FreeSpacePoller(int interval, int timeout, QObject *parent)
+    : QObject(parent)
+    , m_stuckQueries(0)
+    , m_pool(new QThreadPool)
+    , m_timeout(timeout)
+    , m_mountsNotifier(nullptr)
+    , m_mountsFd(-1)
+{
+    updateMaxThreadCount();
+
+    m_intervalTimer.setInterval(interval);
+    connect(&m_intervalTimer, &QTimer::timeout, this, &FreeSpacePoller::refresh);
+
+    m_coalesceTimer.setSingleShot(true);
+    m_coalesceTimer.setInterval(0);
+    connect(&m_coalesceTimer, &QTimer::timeout, this, &FreeSpacePoller::startQueries);
+
+    m_timeoutTimer.setInterval(1000);
+    connect(&m_timeoutTimer, &QTimer::timeout, this, &FreeSpacePoller::checkTimeouts);
+
+#ifdef Q_OS_LINUX
+    // the kernel flags /proc/self/mounts with POLLPRI whenever the mount table changes
+    m_mountsFd = ::open("/proc/self/mounts", O_RDONLY | O_CLOEXEC);
+    if (m_mountsFd >= 0) {
+        m_mountsNotifier = new QSocketNotifier(m_mountsFd, QSocketNotifier::Exception, this);
+        m_mountsNotifier->setEnabled(false);
+        connect(m_mountsNotifier, &QSocketNotifier::activated, this, [this]() {
+            // reading the file acknowledges the change
+            char buf[4096];
+            ::lseek(m_mountsFd, 0, SEEK_SET);
+            while (::read(m_mountsFd, buf, sizeof(buf)) > 0) {
+            }
+            refresh();
+        });
+    }
+#endif
+}
+
+FreeSpacePoller::~FreeSpacePoller()
+{
+    m_pool->clear();
+
+    // ~QThreadPool waits for its workers, never do that for a query that may
+    // be stuck on an unresponsive mount. Its code stays loaded, see keepLoaded()
+    if (m_pool->activeThreadCount() == 0) {
+        delete m_pool;
+    }
+
+    if (m_mountsFd >= 0) {
+        delete m_mountsNotifier;
+        ::close(m_mountsFd);
+    }
+}
+
+void FreeSpacePoller::watch(const QString &path)
+{
+    Entry &entry = m_entries[path];
+    ++entry.refCount;
+
+    if (entry.refCount == 1) {
+        if (!m_intervalTimer.isActive()) {
+            m_intervalTimer.start();
+        }
+        if (m_mountsNotifier) {
+            m_mountsNotifier->setEnabled(true);
+        }
+        refresh();
+    }
+}
+
+void FreeSpacePoller::unwatch(const QString &path)
+{
+    auto it = m_entries.find(path);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    if (--it->refCount <= 0) {
+        m_entries.erase(it);
+    }
+
+    if (m_entries.isEmpty()) {
+        m_intervalTimer.stop();
+        if (m_mountsNotifier) {
+            m_mountsNotifier->setEnabled(false);
+        }
+    }
+}
+
+FreeSpacePoller::SpaceResult FreeSpacePoller::querySpace(const QString &path) const
+{
+    SpaceResult result;
+    struct statvfs buf;
+    if (::statvfs(QFile::encodeName(path).constData(), &buf) == 0) {
+        result.ok = true;
+        result.size = quint64(buf.f_blocks) * buf.f_frsize;
+        result.available = quint64(buf.f_bavail) * buf.f_frsize;
+    }
+    return result;
+}
+
+bool FreeSpacePoller::spaceInfo(const QString &path, quint64 *size, quint64 *available) const
+{
+    const auto it = m_entries.constFind(path);
+    if (it == m_entries.constEnd() || !it->valid) {
+        return false;
+    }
+
+    if (size) {
+        *size = it->size;
+    }
+    if (available) {
+        *available = it->available;
+    }
+    return true;
+}
+
+void FreeSpacePoller::refresh()
+{
+    if (!m_entries.isEmpty()) {
+        m_coalesceTimer.start();
+    }
+}
+
+void FreeSpacePoller::startQueries()
+{
+    keepLoaded();
+
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        const QString path = it.key();
+        if (m_queries.contains(path)) {
+            // may well be a hung mount, another query would only hang as well
+            continue;
+        }
+
+        m_queries[path].started.start();
+
+        auto *watcher = new QFutureWatcher<SpaceResult>(this);
+        connect(watcher, &QFutureWatcher<SpaceResult>::finished, this, [this, watcher, path]() {
+            const SpaceResult result = watcher->result();
+            watcher->deleteLater();
+            queryFinished(path, result.ok, result.size, result.available);
+        });
+        watcher->setFuture(QtConcurrent::run(m_pool, [this, path]() {
+            return querySpace(path);
+        }));
+    }
+
+    if (!m_queries.isEmpty() && !m_timeoutTimer.isActive()) {
+        m_timeoutTimer.start();
+    }
+}
+
+void FreeSpacePoller::checkTimeouts()
+{
+    bool stuckChanged = false;
+    bool pending = false;
+
+    for (auto it = m_queries.begin(); it != m_queries.end(); ++it) {
+        Query &query = it.value();
+        if (query.stuck) {
+            continue;
+        }
+        if (!query.started.hasExpired(m_timeout)) {
+            pending = true;
+            continue;
+        }
+
+        query.stuck = true;
+        ++m_stuckQueries;
+        stuckChanged = true;
+
+        if (m_entries.contains(it.key())) {
+            emit notResponding(it.key());
+        }
+    }
+
+    if (stuckChanged) {
+        updateMaxThreadCount();
+    }
+
+    // nothing left to time out, the stuck ones are only waited for
+    if (!pending) {
+        m_timeoutTimer.stop();
+    }
+}
+
+void FreeSpacePoller::updateMaxThreadCount()
+{
+    // A stuck query keeps its worker for as long as the mount hangs, which
+    // may be forever, so it gets one more worker in addition to the usual ones.
+    // There is at most one query per path, which bounds the number of threads.
+    m_pool->setMaxThreadCount(s_maxThreadCount + m_stuckQueries);
+}
+
+void FreeSpacePoller::queryFinished(const QString &path, bool ok, quint64 size, quint64 available)
+{
+    const Query query = m_queries.take(path);
+    if (query.stuck) {
+        --m_stuckQueries;
+        updateMaxThreadCount();
+    }
+
+    auto it = m_entries.find(path);
+    if (it == m_entries.end()) {
+        // unwatched in the meantime
+        return;
+    }
+
+    Entry &entry = it.value();
+
+    if (!ok) {
+        return;
+    }
+
+    if (entry.valid && entry.size == size && entry.available == available) {
+        return;
+    }
+
+    entry.valid = true;
+    entry.size = size;
+    entry.available = available;
+    emit spaceChanged(path, size, available);
+}
@@ -0,0 +1,131 @@
+/* This file is part of the KDE Project
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _FREESPACEPOLLER_H_
+#define _FREESPACEPOLLER_H_
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+
+class QSocketNotifier;
+class QThreadPool;
+
+/**
+ * Polls the free space of a set of mount points.
+ *
+ * All watched paths are queried together with statvfs() on a private thread
+ * pool, never on the calling thread. A path gets no new query while its last
+ * one is still outstanding, and a query which did not return within the
+ * timeout no longer counts against the pool, so hung network mounts cannot
+ * keep the others from being polled. spaceChanged() is only emitted when the
+ * values of a path actually changed. On Linux the mount table is watched as well, so mounts
+ * and unmounts trigger a refresh right away.
+ *
+ * The instance returned by self() is shared by all users within the plugin
+ * linking this library. The soliddevice engine and the free space notifier
+ * run in different processes, each of them has its own instance, polling
+ * the paths it watches.
+ */
+class FreeSpacePoller : public QObject
+{
+    Q_OBJECT
+
+public:
+    static FreeSpacePoller *self();
+
+    ~FreeSpacePoller() override;
+
+    /**
+     * Starts polling @p path. Calls are reference counted, each one has to be
+     * balanced with a call to unwatch().
+     */
+    void watch(const QString &path);
+    void unwatch(const QString &path);
+
+    /**
+     * Whether the last query of @p path succeeded, and if so its values.
+     */
+    bool spaceInfo(const QString &path, quint64 *size, quint64 *available) const;
+
+public Q_SLOTS:
+    /**
+     * Requests a refresh of all watched paths. Requests are coalesced until
+     * the next event loop pass; paths with a query still in flight are skipped.
+     */
+    void refresh();
+
+Q_SIGNALS:
+    void spaceChanged(const QString &path, quint64 size, quint64 available);
+    void notResponding(const QString &path);
+
+private Q_SLOTS:
+    void startQueries();
+    void checkTimeouts();
+    void queryFinished(const QString &path, bool ok, quint64 size, quint64 available);
+
+protected:
+    /**
+     * Refreshes every @p interval milliseconds, a query which did not return
+     * after @p timeout milliseconds is reported with notResponding()
+     */
+    explicit FreeSpacePoller(int interval, int timeout, QObject *parent = nullptr);
+
+    struct SpaceResult {
+        bool ok = false;
+        quint64 size = 0;
+        quint64 available = 0;
+    };
+
+    /**
+     * Queries the space of @p path, called on a worker thread.
+     * Default implementation uses statvfs()
+     */
+    virtual SpaceResult querySpace(const QString &path) const;
+
+private:
+    friend class FreeSpacePollerSingleton;
+
+    void updateMaxThreadCount();
+
+    struct Entry {
+        int refCount = 0;
+        bool valid = false;
+        quint64 size = 0;
+        quint64 available = 0;
+    };
+
+    // A statvfs() call which has not returned yet, kept until it does even
+    // if its path got unwatched meanwhile, as it still occupies a worker
+    struct Query {
+        QElapsedTimer started;
+        bool stuck = false;
+    };
+
+    QHash<QString, Entry> m_entries;
+    QHash<QString, Query> m_queries;
+    int m_stuckQueries;
+    QThreadPool *m_pool;
+    QTimer m_intervalTimer;
+    QTimer m_coalesceTimer;
+    QTimer m_timeoutTimer;
+    int m_timeout;
+    QSocketNotifier *m_mountsNotifier;
+    int m_mountsFd;
+};
+
+#endif
@@ -0,0 +1,272 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "appstreamindex.h"
+
+#include <AppStreamQt/icon.h>
+#include <AppStreamQt/pool.h>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QLocale>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+#include "debug.h"
+
+// increase when the contents of the cache file change
+static const quint32 s_cacheVersion = 1;
+
+// where the pool reads its metadata from
+static const char *const s_metadataDirs[] = {
+    "/usr/share/app-info",
+    "/var/lib/app-info",
+    "/var/cache/app-info",
+    "/usr/share/swcatalog",
+    "/var/lib/swcatalog",
+    "/var/cache/swcatalog",
+    "/usr/share/metainfo",
+};
+
+static QDataStream &operator<<(QDataStream &stream, const AppStreamIndex::Icon &icon)
+{
+    return stream << icon.file << icon.size;
+}
+
+static QDataStream &operator>>(QDataStream &stream, AppStreamIndex::Icon &icon)
+{
+    return stream >> icon.file >> icon.size;
+}
+
+static QDataStream &operator<<(QDataStream &stream, const AppStreamIndex::Component &component)
+{
+    return stream << component.id << component.name << component.summary
+                  << component.stockIcon << component.icons << component.lowerKeywords;
+}
+
+static QDataStream &operator>>(QDataStream &stream, AppStreamIndex::Component &component)
+{
+    stream >> component.id >> component.name >> component.summary
+           >> component.stockIcon >> component.icons >> component.lowerKeywords;
+    component.lowerName = component.name.toLower();
+    component.lowerSummary = component.summary.toLower();
+    return stream;
+}
+
+AppStreamIndex::AppStreamIndex(const QString &stamp)
+    : m_stamp(stamp)
+{
+}
+
+QString AppStreamIndex::metadataStamp()
+{
+    // The metadata files are in the directories or one level below, e.g. in
+    // app-info/xmls. The icons are only referenced and do not change the index.
+    // Names and summaries are read in the language of the current locale.
+    QString stamp = QLocale().name() + QLatin1Char(';');
+    for (const char *dir : s_metadataDirs) {
+        const QFileInfo info(QString::fromLatin1(dir));
+        if (!info.isDir()) {
+            continue;
+        }
+
+        qint64 lastModified = info.lastModified().toMSecsSinceEpoch();
+        int count = 0;
+        const QFileInfoList entries = QDir(info.filePath()).entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot);
+        for (const QFileInfo &entry : entries) {
+            if (entry.isDir()) {
+                if (entry.fileName() == QLatin1String("icons")) {
+                    continue;
+                }
+                const QFileInfoList files = QDir(entry.filePath()).entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot);
+                for (const QFileInfo &file : files) {
+                    lastModified = qMax(lastModified, file.lastModified().toMSecsSinceEpoch());
+                    ++count;
+                }
+            }
+            lastModified = qMax(lastModified, entry.lastModified().toMSecsSinceEpoch());
+            ++count;
+        }
+        stamp += QStringLiteral("%1:%2:%3;").arg(info.filePath()).arg(lastModified).arg(count);
+    }
+    return stamp;
+}
+
+std::shared_ptr<const AppStreamIndex> AppStreamIndex::update(const std::shared_ptr<const AppStreamIndex> &current,
+                                                             const QString &stamp,
+                                                             const PoolReader &readPool)
+{
+    if (current && current->stamp() == stamp) {
+        return current;
+    }
+
+    std::shared_ptr<AppStreamIndex> index(new AppStreamIndex(stamp));
+    if (index->readCache()) {
+        return index;
+    }
+
+    index->m_components = readPool();
+    if (index->m_components.isEmpty()) {
+        qCDebug(RUNNER_APPSTREAM) << "The AppStream pool has no desktop applications, keeping the current index";
+        return current;
+    }
+
+    index->writeCache();
+    return index;
+}
+
+QString AppStreamIndex::cacheFile()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/appstreamindex");
+}
+
+bool AppStreamIndex::readCache()
+{
+    QFile file(cacheFile());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 version;
+    QString stamp;
+    stream >> version >> stamp;
+    if (version != s_cacheVersion || stamp != m_stamp) {
+        return false;
+    }
+
+    stream >> m_components;
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(RUNNER_APPSTREAM) << "Could not read the cached AppStream index" << file.fileName();
+        m_components.clear();
+        return false;
+    }
+    return true;
+}
+
+void AppStreamIndex::writeCache() const
+{
+    const QString fileName = cacheFile();
+    QDir().mkpath(QFileInfo(fileName).path());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(RUNNER_APPSTREAM) << "Could not write the AppStream index" << fileName;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << s_cacheVersion << m_stamp << m_components;
+    if (!file.commit()) {
+        qCWarning(RUNNER_APPSTREAM) << "Could not write the AppStream index" << fileName;
+    }
+}
+
+QVector<AppStreamIndex::Component> AppStreamIndex::readPool()
+{
+    // the pool is only needed while building, which frees its memory afterwards
+    AppStream::Pool pool;
+    QString error;
+    if (!pool.load(&error)) {
+        qCWarning(RUNNER_APPSTREAM) << "Had errors when loading AppStream metadata pool" << error;
+    }
+
+    QVector<Component> entries;
+    const QList<AppStream::Component> components = pool.componentsByKind(AppStream::Component::KindDesktopApp);
+    entries.reserve(components.count());
+    for (const AppStream::Component &component : components) {
+        Component entry;
+        entry.id = component.id();
+        entry.name = component.name();
+        entry.summary = component.summary();
+        entry.lowerName = entry.name.toLower();
+        entry.lowerSummary = entry.summary.toLower();
+        for (const QString &keyword : component.keywords()) {
+            entry.lowerKeywords << keyword.toLower();
+        }
+
+        const auto icons = component.icons();
+        for (const AppStream::Icon &icon : icons) {
+            switch (icon.kind()) {
+                case AppStream::Icon::KindLocal:
+                case AppStream::Icon::KindCached:
+                    entry.icons.append({icon.url().toLocalFile(), icon.size()});
+                    break;
+                case AppStream::Icon::KindStock:
+                    if (entry.stockIcon.isEmpty()) {
+                        entry.stockIcon = icon.name();
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        entries.append(entry);
+    }
+
+    return entries;
+}
+
+QVector<const AppStreamIndex::Component *> AppStreamIndex::search(const QString &query, int limit) const
+{
+    const QStringList words = query.toLower().split(QLatin1Char(' '), QString::SkipEmptyParts);
+    if (words.isEmpty()) {
+        return {};
+    }
+
+    QVector<QPair<int, const Component *>> results;
+    for (const Component &component : m_components) {
+        int score = 0;
+        for (const QString &word : words) {
+            int wordScore = 0;
+            if (component.lowerName.startsWith(word)) {
+                wordScore = 4;
+            } else if (component.lowerName.contains(word)) {
+                wordScore = 3;
+            } else if (std::any_of(component.lowerKeywords.constBegin(), component.lowerKeywords.constEnd(),
+                                   [&word](const QString &keyword) { return keyword.contains(word); })) {
+                wordScore = 2;
+            } else if (component.lowerSummary.contains(word)) {
+                wordScore = 1;
+            } else {
+                score = 0;
+                break;
+            }
+            score += wordScore;
+        }
+        if (score > 0) {
+            results.append({score, &component});
+        }
+    }
+
+    std::stable_sort(results.begin(), results.end(), [](const QPair<int, const Component *> &a, const QPair<int, const Component *> &b) {
+        return a.first > b.first;
+    });
+
+    QVector<const Component *> components;
+    for (int i = 0; i < results.count() && i < limit; ++i) {
+        components << results.at(i).second;
+    }
+    return components;
+}
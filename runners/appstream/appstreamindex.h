@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef APPSTREAMINDEX_H
+#define APPSTREAMINDEX_H
+
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+#include <memory>
+
+/**
+ * The desktop applications of the AppStream pool, reduced to what the runner
+ * shows and searches.
+ *
+ * Loading the pool takes long and needs a lot of memory, so the index is
+ * written to the cache directory along with a stamp of the AppStream metadata
+ * it was built from, and only built from the pool again when that changed.
+ *
+ * An index is not changed after it was loaded, so it can be searched from
+ * any number of threads.
+ */
+class AppStreamIndex
+{
+public:
+    struct Icon {
+        QString file;
+        QSize size;
+    };
+
+    struct Component {
+        QString id;
+        QString name;
+        QString summary;
+        QString stockIcon;
+        QVector<Icon> icons;
+
+        // in lower case, compared with the lower case query
+        QString lowerName;
+        QString lowerSummary;
+        QStringList lowerKeywords;
+    };
+
+    /**
+     * @return a string identifying the current state of the AppStream metadata
+     * by the modification times of its files, and the locale it is read for
+     */
+    static QString metadataStamp();
+
+    typedef std::function<QVector<Component>()> PoolReader;
+
+    /**
+     * @return the desktop applications of the AppStream pool
+     */
+    static QVector<Component> readPool();
+
+    /**
+     * @return the index for the metadata in the state @p stamp: @p current if
+     * it was built for that state, otherwise one read from the cache if it was
+     * written for that state, or else built with @p readPool.
+     *
+     * When neither has any applications, e.g. because the metadata is being
+     * updated, @p current is returned unchanged, so the next update tries
+     * again instead of keeping an empty index for @p stamp.
+     */
+    static std::shared_ptr<const AppStreamIndex> update(const std::shared_ptr<const AppStreamIndex> &current,
+                                                        const QString &stamp,
+                                                        const PoolReader &readPool = &AppStreamIndex::readPool);
+
+    QString stamp() const { return m_stamp; }
+
+    /**
+     * @return the components of which the name, keywords or summary contain
+     * all words of @p query, ignoring case, the best ones first
+     */
+    QVector<const Component *> search(const QString &query, int limit) const;
+
+private:
+    explicit AppStreamIndex(const QString &stamp);
+
+    static QString cacheFile();
+    bool readCache();
+    void writeCache() const;
+
+    QString m_stamp;
+    QVector<Component> m_components;
+};
+
+#endif
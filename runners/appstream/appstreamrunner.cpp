@@ -20,12 +20,11 @@
 
 #include "appstreamrunner.h"
 
-#include <AppStreamQt/icon.h>
-
 #include <QDir>
 #include <QIcon>
 #include <QDesktopServices>
 #include <QDebug>
+#include <QtConcurrentRun>
 
 #include <KLocalizedString>
 #include <KServiceTypeTrader>
@@ -43,53 +42,66 @@ InstallerRunner::InstallerRunner(QObject *parent, const QVariantList &args)
     setPriority(AbstractRunner::HighestPriority);
 
     addSyntax(Plasma::RunnerSyntax(":q:", i18n("Looks for non-installed components according to :q:")));
+
+    connect(this, &Plasma::AbstractRunner::prepare, this, &InstallerRunner::prepareForMatchSession);
 }
 
 InstallerRunner::~InstallerRunner()
 {
+    m_indexUpdate.waitForFinished();
 }
 
-static QIcon componentIcon(const AppStream::Component &comp)
+static QIcon componentIcon(const AppStreamIndex::Component &comp)
 {
     QIcon ret;
-    const auto icons = comp.icons();
-    if (icons.isEmpty()) {
+    if (comp.icons.isEmpty() && comp.stockIcon.isEmpty()) {
         ret = QIcon::fromTheme(QStringLiteral("package-x-generic"));
-    } else foreach(const AppStream::Icon &icon, icons) {
-        QStringList stock;
-        switch(icon.kind()) {
-            case AppStream::Icon::KindLocal:
-                ret.addFile(icon.url().toLocalFile(), icon.size());
-                break;
-            case AppStream::Icon::KindCached:
-                ret.addFile(icon.url().toLocalFile(), icon.size());
-                break;
-            case AppStream::Icon::KindStock:
-                stock += icon.name();
-                break;
-            default:
-                break;
+    } else {
+        for (const AppStreamIndex::Icon &icon : comp.icons) {
+            ret.addFile(icon.file, icon.size);
         }
-        if (ret.isNull() && !stock.isEmpty()) {
-            ret = QIcon::fromTheme(stock.first());
+        if (ret.isNull() && !comp.stockIcon.isEmpty()) {
+            ret = QIcon::fromTheme(comp.stockIcon);
         }
     }
     return ret;
 }
 
+// Called in the main thread
+void InstallerRunner::prepareForMatchSession()
+{
+    // the index is loaded or checked for changes of the metadata in the
+    // background, matching uses the one there is until it is done
+    if (m_indexUpdate.isFinished()) {
+        m_indexUpdate = QtConcurrent::run(this, &InstallerRunner::updateIndex);
+    }
+}
+
+void InstallerRunner::updateIndex()
+{
+    const std::shared_ptr<const AppStreamIndex> current = std::atomic_load(&m_index);
+    const std::shared_ptr<const AppStreamIndex> index = AppStreamIndex::update(current, AppStreamIndex::metadataStamp());
+    if (index != current) {
+        std::atomic_store(&m_index, index);
+    }
+}
+
 void InstallerRunner::match(Plasma::RunnerContext &context)
 {
     if(context.query().size() <= 2)
         return;
 
-    const auto components = findComponentsByString(context.query()).mid(0, 3);
+    const std::shared_ptr<const AppStreamIndex> index = std::atomic_load(&m_index);
+    if (!index) {
+        // still being loaded for the first time
+        return;
+    }
 
-    for (const AppStream::Component &component : components) {
-        if (component.kind() != AppStream::Component::KindDesktopApp)
-            continue;
+    const auto components = index->search(context.query(), 3);
 
-        const auto idWithoutDesktop = component.id().remove(".desktop");
-        const auto serviceQuery = QStringLiteral("exist Exec and ('%1' =~ DesktopEntryName or (exist [X-Flatpak-RenamedFrom] and ('%1' in [X-Flatpak-RenamedFrom] or '%1;' in [X-Flatpak-RenamedFrom])) or '%2' =~ DesktopEntryName)").arg(component.id(), idWithoutDesktop);
+    for (const AppStreamIndex::Component *component : components) {
+        const auto idWithoutDesktop = QString(component->id).remove(".desktop");
+        const auto serviceQuery = QStringLiteral("exist Exec and ('%1' =~ DesktopEntryName or (exist [X-Flatpak-RenamedFrom] and ('%1' in [X-Flatpak-RenamedFrom] or '%1;' in [X-Flatpak-RenamedFrom])) or '%2' =~ DesktopEntryName)").arg(component->id, idWithoutDesktop);
         const auto servicesFound = KServiceTypeTrader::self()->query(QStringLiteral("Application"), serviceQuery);
 
         if (!servicesFound.isEmpty())
@@ -97,11 +109,11 @@ void InstallerRunner::match(Plasma::RunnerContext &context)
 
         Plasma::QueryMatch match(this);
         match.setType(Plasma::QueryMatch::PossibleMatch);
-        match.setId(component.id());
-        match.setIcon(componentIcon(component));
-        match.setText(i18n("Get %1...", component.name()));
-        match.setSubtext(component.summary());
-        match.setData(QUrl("appstream://" + component.id()));
+        match.setId(component->id);
+        match.setIcon(componentIcon(*component));
+        match.setText(i18n("Get %1...", component->name));
+        match.setSubtext(component->summary);
+        match.setData(QUrl("appstream://" + component->id));
         context.addMatch(match);
     }
 }
@@ -113,22 +125,4 @@ void InstallerRunner::run(const Plasma::RunnerContext &/*context*/, const Plasma
         qCWarning(RUNNER_APPSTREAM) << "couldn't open" << appstreamUrl;
 }
 
-QList<AppStream::Component> InstallerRunner::findComponentsByString(const QString &query)
-{
-    QMutexLocker locker(&m_appstreamMutex);
-    QString error;
-    static bool warnedOnce = false;
-    static bool opened = m_db.load(&error);
-    if(!opened) {
-        if (warnedOnce) {
-            qCDebug(RUNNER_APPSTREAM) << "Had errors when loading AppStream metadata pool" << error;
-        } else {
-            qCWarning(RUNNER_APPSTREAM) << "Had errors when loading AppStream metadata pool" << error;
-            warnedOnce = true;
-        }
-    }
-
-    return m_db.search(query);
-}
-
 #include "appstreamrunner.moc"
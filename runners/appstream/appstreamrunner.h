@@ -22,8 +22,11 @@
 #define APPSTREAMRUNNER_H
 
 #include <KRunner/AbstractRunner>
-#include <AppStreamQt/pool.h>
-#include <QMutex>
+#include <QFuture>
+
+#include <memory>
+
+#include "appstreamindex.h"
 
 class InstallerRunner : public Plasma::AbstractRunner
 {
@@ -36,11 +39,15 @@ public:
     void match(Plasma::RunnerContext &context) override;
     void run(const Plasma::RunnerContext &context, const Plasma::QueryMatch &action) override;
 
+private Q_SLOTS:
+    void prepareForMatchSession();
+
 private:
-    QList<AppStream::Component> findComponentsByString(const QString &query);
+    void updateIndex();
 
-    AppStream::Pool m_db;
-    QMutex m_appstreamMutex;
+    // replaced as a whole, read and written with std::atomic_load/std::atomic_store
+    std::shared_ptr<const AppStreamIndex> m_index;
+    QFuture<void> m_indexUpdate;
 };
 
 #endif
@@ -0,0 +1,211 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include <QDir>
+#include <QObject>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "../appstreamindex.h"
+
+class AppStreamIndexTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+
+    void testBuildFromPool();
+    void testSameStampKeepsIndex();
+    void testChangedStampRebuilds();
+    void testReadFromCache();
+    void testEmptyPoolRetried();
+    void testSearch();
+
+    void benchmarkSearch();
+
+private:
+    AppStreamIndex::PoolReader reader(const QVector<AppStreamIndex::Component> &components);
+    static AppStreamIndex::Component component(const QString &name, const QString &summary,
+                                               const QStringList &keywords = QStringList());
+    static QStringList names(const QVector<const AppStreamIndex::Component *> &components);
+
+    QVector<AppStreamIndex::Component> m_components;
+    int m_poolReads = 0;
+};
+
+AppStreamIndex::PoolReader AppStreamIndexTest::reader(const QVector<AppStreamIndex::Component> &components)
+{
+    return [this, components]() {
+        ++m_poolReads;
+        return components;
+    };
+}
+
+AppStreamIndex::Component AppStreamIndexTest::component(const QString &name, const QString &summary,
+                                                        const QStringList &keywords)
+{
+    AppStreamIndex::Component component;
+    component.id = QStringLiteral("org.example.%1.desktop").arg(name);
+    component.name = name;
+    component.summary = summary;
+    component.lowerName = name.toLower();
+    component.lowerSummary = summary.toLower();
+    for (const QString &keyword : keywords) {
+        component.lowerKeywords << keyword.toLower();
+    }
+    return component;
+}
+
+QStringList AppStreamIndexTest::names(const QVector<const AppStreamIndex::Component *> &components)
+{
+    QStringList names;
+    for (const AppStreamIndex::Component *component : components) {
+        names << component->name;
+    }
+    return names;
+}
+
+void AppStreamIndexTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+
+    m_components = {
+        component(QStringLiteral("Krita"), QStringLiteral("Digital painting"), {QStringLiteral("draw")}),
+        component(QStringLiteral("Kdenlive"), QStringLiteral("Video editor"), {QStringLiteral("film")}),
+        component(QStringLiteral("Inkscape"), QStringLiteral("Vector graphics editor"), {QStringLiteral("draw"), QStringLiteral("svg")}),
+    };
+}
+
+void AppStreamIndexTest::init()
+{
+    QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).removeRecursively();
+    m_poolReads = 0;
+}
+
+void AppStreamIndexTest::testBuildFromPool()
+{
+    const auto index = AppStreamIndex::update(nullptr, QStringLiteral("stamp1"), reader(m_components));
+
+    QVERIFY(index);
+    QCOMPARE(m_poolReads, 1);
+    QCOMPARE(index->stamp(), QStringLiteral("stamp1"));
+    QCOMPARE(names(index->search(QStringLiteral("krita"), 10)), QStringList({QStringLiteral("Krita")}));
+}
+
+void AppStreamIndexTest::testSameStampKeepsIndex()
+{
+    const auto index = AppStreamIndex::update(nullptr, QStringLiteral("stamp1"), reader(m_components));
+    QCOMPARE(m_poolReads, 1);
+
+    QCOMPARE(AppStreamIndex::update(index, QStringLiteral("stamp1"), reader(m_components)), index);
+    QCOMPARE(m_poolReads, 1);
+}
+
+void AppStreamIndexTest::testChangedStampRebuilds()
+{
+    const auto index = AppStreamIndex::update(nullptr, QStringLiteral("stamp1"), reader(m_components));
+
+    const auto updated = AppStreamIndex::update(index, QStringLiteral("stamp2"),
+                                                reader({component(QStringLiteral("Kate"), QStringLiteral("Text editor"))}));
+    QVERIFY(updated != index);
+    QCOMPARE(m_poolReads, 2);
+    QCOMPARE(updated->stamp(), QStringLiteral("stamp2"));
+    QCOMPARE(names(updated->search(QStringLiteral("editor"), 10)), QStringList({QStringLiteral("Kate")}));
+}
+
+void AppStreamIndexTest::testReadFromCache()
+{
+    AppStreamIndex::update(nullptr, QStringLiteral("stamp1"), reader(m_components));
+    QCOMPARE(m_poolReads, 1);
+
+    // e.g. the next time the runner is loaded
+    const auto cached = AppStreamIndex::update(nullptr, QStringLiteral("stamp1"), reader(m_components));
+    QCOMPARE(m_poolReads, 1);
+    QCOMPARE(cached->stamp(), QStringLiteral("stamp1"));
+    QCOMPARE(names(cached->search(QStringLiteral("draw"), 10)),
+             QStringList({QStringLiteral("Krita"), QStringLiteral("Inkscape")}));
+
+    // the cache was written for another state of the metadata
+    AppStreamIndex::update(nullptr, QStringLiteral("stamp2"), reader(m_components));
+    QCOMPARE(m_poolReads, 2);
+}
+
+void AppStreamIndexTest::testEmptyPoolRetried()
+{
+    // nothing is known before the first index
+    QVERIFY(!AppStreamIndex::update(nullptr, QStringLiteral("stamp1"), reader({})));
+    QCOMPARE(m_poolReads, 1);
+
+    // the empty result was neither stamped nor cached, the pool is read again
+    const auto index = AppStreamIndex::update(nullptr, QStringLiteral("stamp1"), reader(m_components));
+    QCOMPARE(m_poolReads, 2);
+    QVERIFY(index);
+    QCOMPARE(index->stamp(), QStringLiteral("stamp1"));
+
+    // an empty pool for a newer state keeps the current index, and tries again
+    QCOMPARE(AppStreamIndex::update(index, QStringLiteral("stamp2"), reader({})), index);
+    QCOMPARE(m_poolReads, 3);
+    QCOMPARE(AppStreamIndex::update(index, QStringLiteral("stamp2"), reader({})), index);
+    QCOMPARE(m_poolReads, 4);
+
+    const auto updated = AppStreamIndex::update(index, QStringLiteral("stamp2"), reader(m_components));
+    QCOMPARE(m_poolReads, 5);
+    QCOMPARE(updated->stamp(), QStringLiteral("stamp2"));
+}
+
+void AppStreamIndexTest::testSearch()
+{
+    const auto index = AppStreamIndex::update(nullptr, QStringLiteral("stamp1"), reader(m_components));
+
+    // name prefixes before names before keywords before summaries
+    QCOMPARE(names(index->search(QStringLiteral("k"), 10)),
+             QStringList({QStringLiteral("Krita"), QStringLiteral("Kdenlive"), QStringLiteral("Inkscape")}));
+    QCOMPARE(names(index->search(QStringLiteral("editor"), 10)),
+             QStringList({QStringLiteral("Kdenlive"), QStringLiteral("Inkscape")}));
+
+    // all words have to match
+    QCOMPARE(names(index->search(QStringLiteral("VECTOR draw"), 10)), QStringList({QStringLiteral("Inkscape")}));
+    QVERIFY(index->search(QStringLiteral("video draw"), 10).isEmpty());
+    QVERIFY(index->search(QStringLiteral("  "), 10).isEmpty());
+
+    QCOMPARE(index->search(QStringLiteral("k"), 2).count(), 2);
+}
+
+void AppStreamIndexTest::benchmarkSearch()
+{
+    QVector<AppStreamIndex::Component> components;
+    components.reserve(5000);
+    for (int i = 0; i < 5000; ++i) {
+        components << component(QStringLiteral("Application %1").arg(i),
+                                QStringLiteral("Summary of application %1").arg(i),
+                                {QStringLiteral("keyword%1").arg(i % 50)});
+    }
+
+    const auto index = AppStreamIndex::update(nullptr, QStringLiteral("stamp1"), reader(components));
+
+    QBENCHMARK {
+        QCOMPARE(index->search(QStringLiteral("application 4999"), 3).count(), 1);
+        QCOMPARE(index->search(QStringLiteral("keyword7"), 3).count(), 3);
+    }
+}
+
+QTEST_MAIN(AppStreamIndexTest)
+
+#include "appstreamindextest.moc"
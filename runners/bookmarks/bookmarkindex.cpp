@@ -0,0 +1,144 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "bookmarkindex.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <iterator>
+
+static quint64 trigram(const QChar *chars)
+{
+    return (quint64(chars[0].unicode()) << 32) | (quint64(chars[1].unicode()) << 16) | chars[2].unicode();
+}
+
+QString BookmarkIndex::stamp(const QStringList &files)
+{
+    QString result;
+    bool anyExists = false;
+    for (const QString &file : files) {
+        const QFileInfo info(file);
+        if (info.exists()) {
+            anyExists = true;
+            result += QStringLiteral("%1:%2;").arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size());
+        } else {
+            result += QLatin1Char(';');
+        }
+    }
+    return anyExists ? result : QString();
+}
+
+bool BookmarkIndex::isCurrent(const QStringList &files) const
+{
+    const QString current = stamp(files);
+
+    QReadLocker locker(&m_lock);
+    return !current.isEmpty() && current == m_sourceStamp;
+}
+
+void BookmarkIndex::replace(const QVector<Bookmark> &bookmarks, const QString &sourceStamp)
+{
+    QWriteLocker locker(&m_lock);
+
+    m_sourceStamp = sourceStamp;
+    m_bookmarks = bookmarks;
+    m_trigrams.clear();
+
+    for (int i = 0; i < m_bookmarks.count(); ++i) {
+        const Bookmark &bookmark = m_bookmarks.at(i);
+        addTrigrams(bookmark.title.toCaseFolded(), i);
+        addTrigrams(bookmark.url.toCaseFolded(), i);
+        addTrigrams(bookmark.description.toCaseFolded(), i);
+    }
+}
+
+void BookmarkIndex::clear()
+{
+    replace(QVector<Bookmark>(), QString());
+}
+
+int BookmarkIndex::count() const
+{
+    QReadLocker locker(&m_lock);
+    return m_bookmarks.count();
+}
+
+void BookmarkIndex::addTrigrams(const QString &folded, int bookmark)
+{
+    const QChar *chars = folded.constData();
+    for (int i = 0; i + 3 <= folded.size(); ++i) {
+        QVector<int> &bookmarks = m_trigrams[trigram(chars + i)];
+        // bookmarks are added in order, so this keeps the lists sorted and unique
+        if (bookmarks.isEmpty() || bookmarks.last() != bookmark) {
+            bookmarks.append(bookmark);
+        }
+    }
+}
+
+QVector<int> BookmarkIndex::candidates(const QString &folded) const
+{
+    QVector<const QVector<int> *> lists;
+    const QChar *chars = folded.constData();
+    for (int i = 0; i + 3 <= folded.size(); ++i) {
+        const auto it = m_trigrams.constFind(trigram(chars + i));
+        if (it == m_trigrams.constEnd()) {
+            return {};
+        }
+        lists << &(*it);
+    }
+
+    std::sort(lists.begin(), lists.end(), [](const QVector<int> *a, const QVector<int> *b) {
+        return a->size() < b->size();
+    });
+
+    QVector<int> result = *lists.first();
+    for (int i = 1; i < lists.size() && !result.isEmpty(); ++i) {
+        QVector<int> intersection;
+        std::set_intersection(result.constBegin(), result.constEnd(),
+                              lists.at(i)->constBegin(), lists.at(i)->constEnd(),
+                              std::back_inserter(intersection));
+        result = intersection;
+    }
+    return result;
+}
+
+QList<BookmarkMatch> BookmarkIndex::match(Favicon *favicon, const QString &term, bool addEverything) const
+{
+    QReadLocker locker(&m_lock);
+
+    QList<BookmarkMatch> results;
+
+    const QString folded = term.toCaseFolded();
+    if (addEverything || folded.size() < 3) {
+        for (const Bookmark &bookmark : m_bookmarks) {
+            BookmarkMatch bookmarkMatch(favicon, term, bookmark.title, bookmark.url, bookmark.description);
+            bookmarkMatch.addTo(results, addEverything);
+        }
+        return results;
+    }
+
+    // the candidates contain the trigrams of the term, but not necessarily in
+    // the right order or all in the same field, BookmarkMatch checks that
+    for (int i : candidates(folded)) {
+        const Bookmark &bookmark = m_bookmarks.at(i);
+        BookmarkMatch bookmarkMatch(favicon, term, bookmark.title, bookmark.url, bookmark.description);
+        bookmarkMatch.addTo(results, false);
+    }
+    return results;
+}
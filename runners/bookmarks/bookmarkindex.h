@@ -0,0 +1,88 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef BOOKMARKINDEX_H
+#define BOOKMARKINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "bookmarkmatch.h"
+
+class Favicon;
+
+/**
+ * The bookmarks of one browser profile, kept in memory between match sessions.
+ *
+ * Titles, URLs and descriptions are case folded and broken up into trigrams
+ * once, so a search only compares the bookmarks containing all trigrams of the
+ * term instead of every bookmark. Along with the bookmarks a stamp of the files
+ * they were read from is stored, which tells whether they need to be read again.
+ *
+ * Matching and replacing the bookmarks can happen in different threads.
+ */
+class BookmarkIndex
+{
+public:
+    struct Bookmark {
+        QString title;
+        QString url;
+        QString description;
+    };
+
+    /**
+     * @return a string identifying the current state of @p files by their
+     * modification time and size, or an empty string if none of them exists
+     */
+    static QString stamp(const QStringList &files);
+
+    /**
+     * @return whether the bookmarks were read from @p files in their current state
+     */
+    bool isCurrent(const QStringList &files) const;
+
+    /**
+     * Replaces all bookmarks.
+     * @param sourceStamp the stamp() of the files the bookmarks were read from
+     */
+    void replace(const QVector<Bookmark> &bookmarks, const QString &sourceStamp);
+    void clear();
+
+    int count() const;
+
+    /**
+     * @return the bookmarks of which the title, URL or description contain
+     * @p term, ignoring case, or all of them if @p addEverything is set;
+     * in the order they were added
+     */
+    QList<BookmarkMatch> match(Favicon *favicon, const QString &term, bool addEverything) const;
+
+private:
+    void addTrigrams(const QString &folded, int bookmark);
+    QVector<int> candidates(const QString &folded) const;
+
+    mutable QReadWriteLock m_lock;
+    QString m_sourceStamp;
+    QVector<Bookmark> m_bookmarks;
+    QHash<quint64, QVector<int>> m_trigrams;
+};
+
+#endif // BOOKMARKINDEX_H
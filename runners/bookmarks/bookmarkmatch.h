@@ -33,6 +33,8 @@ public:
     BookmarkMatch(Favicon *favicon, const QString &searchTerm, const QString &bookmarkTitle, const QString &bookmarkURL, const QString &description = QString());
     void addTo(QList< BookmarkMatch >& listOfResults, bool addEvenOnNoMatch);
     Plasma::QueryMatch asQueryMatch(Plasma::AbstractRunner *runner);
+    inline Favicon *favicon() const { return m_favicon; }
+    inline QString bookmarkUrl() const { return m_bookmarkURL; }
 private:
     bool matches(const QString &search, const QString &matchingField);
 private:
@@ -21,6 +21,7 @@
 #include "bookmarksrunner.h"
 #include "browser.h"
 
+#include <QHash>
 #include <QList>
 #include <QStack>
 #include <QDir>
@@ -35,6 +36,7 @@
 
 #include "bookmarkmatch.h"
 #include "browserfactory.h"
+#include "favicon.h"
 #include "bookmarksrunner_defs.h"
 
 K_EXPORT_PLASMA_RUNNER(bookmarksrunner, BookmarksRunner)
@@ -83,6 +85,18 @@ void BookmarksRunner::match(Plasma::RunnerContext &context)
                                      Qt::CaseInsensitive) == 0;
                                      
     QList<BookmarkMatch> matches = m_browser->match(term, allBookmarks);
+
+    // look up the icons of all matches at once rather than one by one
+    QHash<Favicon *, QStringList> urlsByFavicon;
+    for (const BookmarkMatch &match : qAsConst(matches)) {
+        urlsByFavicon[match.favicon()] << match.bookmarkUrl();
+    }
+    for (auto it = urlsByFavicon.constBegin(); it != urlsByFavicon.constEnd(); ++it) {
+        if (it.key()) {
+            it.key()->prefetch(it.value());
+        }
+    }
+
     foreach(BookmarkMatch match, matches) {
         if(!context.isValid())
             return;
@@ -22,6 +22,7 @@
 #include "chrome.h"
 #include "faviconfromblob.h"
 #include "browsers/findprofile.h"
+#include "bookmarks_debug.h"
 
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -35,26 +36,31 @@
 class ProfileBookmarks {
 public:
     ProfileBookmarks(Profile &profile) : m_profile(profile) {}
-    inline QJsonArray bookmarks() { return m_bookmarks; }
+    inline BookmarkIndex &index() { return m_index; }
     inline Profile profile() { return m_profile; }
-    void tearDown() { m_profile.favicon()->teardown(); clear(); }
-    void add(const QJsonObject &bookmarkEntry) { m_bookmarks << bookmarkEntry; }
-    void clear() { m_bookmarks = QJsonArray(); }
 private:
     Profile m_profile;
-    QJsonArray m_bookmarks;
+    BookmarkIndex m_index;
 };
 
 Chrome::Chrome( FindProfile* findProfile, QObject* parent )
     : QObject(parent),
     m_watcher(new KDirWatch(this)),
-    m_dirty(false)
+    m_active(false)
 {
     foreach(Profile profile, findProfile->find()) {
         m_profileBookmarks << new ProfileBookmarks(profile);
         m_watcher->addFile(profile.path());
     }
-    connect(m_watcher, &KDirWatch::created, [=] { m_dirty = true; });
+    // only re-read while a session is running, otherwise the next prepare() takes care of it
+    auto refreshIfActive = [this] {
+        if (m_active) {
+            refresh();
+        }
+    };
+    connect(m_watcher, &KDirWatch::created, this, refreshIfActive);
+    connect(m_watcher, &KDirWatch::dirty, this, refreshIfActive);
+    connect(m_watcher, &KDirWatch::deleted, this, refreshIfActive);
 }
 
 Chrome::~Chrome()
@@ -66,10 +72,10 @@ Chrome::~Chrome()
 
 QList<BookmarkMatch> Chrome::match(const QString &term, bool addEveryThing)
 {
-    if (m_dirty) {
-        prepare();
-    }
     QList<BookmarkMatch> results;
+    if (!m_active) {
+        return results;
+    }
     foreach(ProfileBookmarks *profileBookmarks, m_profileBookmarks) {
         results << match(term, addEveryThing, profileBookmarks);
     }
@@ -78,62 +84,78 @@ QList<BookmarkMatch> Chrome::match(const QString &term, bool addEveryThing)
 
 QList<BookmarkMatch> Chrome::match(const QString &term, bool addEveryThing, ProfileBookmarks *profileBookmarks)
 {
-    QList<BookmarkMatch> results;
-
-    const auto bookmarks = profileBookmarks->bookmarks();
-    for (const QJsonValue &bookmarkValue : bookmarks) {
-        const QJsonObject bookmark = bookmarkValue.toObject();
-
-        QString url = bookmark.value(QStringLiteral("url")).toString();
+    return profileBookmarks->index().match(profileBookmarks->profile().favicon(), term, addEveryThing);
+}
 
-        BookmarkMatch bookmarkMatch(profileBookmarks->profile().favicon(), term, bookmark.value(QStringLiteral("name")).toString(), url);
-        bookmarkMatch.addTo(results, addEveryThing);
+void Chrome::prepare()
+{
+    m_active = true;
+    refresh();
+    foreach(ProfileBookmarks *profileBookmarks, m_profileBookmarks) {
+        if (profileBookmarks->index().count() > 0) {
+            profileBookmarks->profile().favicon()->prepare();
+        }
     }
-    return results;
 }
 
-void Chrome::prepare()
+void Chrome::refresh()
 {
-    m_dirty = false;
     foreach(ProfileBookmarks *profileBookmarks, m_profileBookmarks) {
         Profile profile = profileBookmarks->profile();
-        profileBookmarks->clear();
+        BookmarkIndex &index = profileBookmarks->index();
+        const QStringList files = {profile.path()};
+        // the bookmarks are kept between sessions, only parse them again when the file changed
+        if (index.isCurrent(files)) {
+            continue;
+        }
+
+        const QString stamp = BookmarkIndex::stamp(files);
+        QVector<BookmarkIndex::Bookmark> bookmarks;
+
         QFile bookmarksFile(profile.path());
         if (!bookmarksFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            index.clear();
             continue;
         }
         QJsonDocument jdoc = QJsonDocument::fromJson(bookmarksFile.readAll());
         if (jdoc.isNull()) {
+            index.clear();
             continue;
         }
         const QJsonObject resultMap = jdoc.object();
-        if (!resultMap.contains(QLatin1String("roots"))) {
-            return;
+        if (resultMap.contains(QLatin1String("roots"))) {
+            const QJsonObject entries = resultMap.value(QStringLiteral("roots")).toObject();
+            for (const QJsonValue &folder : entries) {
+                parseFolder(folder.toObject(), bookmarks);
+            }
         }
-        const QJsonObject entries = resultMap.value(QStringLiteral("roots")).toObject();
-        for (const QJsonValue &folder : entries) {
-            parseFolder(folder.toObject(), profileBookmarks);
-        }
-        profile.favicon()->prepare();
+        qCDebug(RUNNER_BOOKMARKS) << "Read" << bookmarks.count() << "bookmarks from" << profile.path();
+        index.replace(bookmarks, stamp);
     }
 }
 
 void Chrome::teardown()
 {
+    // the bookmarks stay in memory for the next session
+    m_active = false;
     foreach(ProfileBookmarks *profileBookmarks, m_profileBookmarks) {
-        profileBookmarks->tearDown();
+        if (profileBookmarks->profile().favicon()) {
+            profileBookmarks->profile().favicon()->teardown();
+        }
     }
 }
 
-void Chrome::parseFolder(const QJsonObject &entry, ProfileBookmarks *profile)
+void Chrome::parseFolder(const QJsonObject &entry, QVector<BookmarkIndex::Bookmark> &bookmarks)
 {
     const QJsonArray children = entry.value(QStringLiteral("children")).toArray();
     for (const QJsonValue &child : children) {
         const QJsonObject entry = child.toObject();
         if(entry.value(QStringLiteral("type")).toString() == QLatin1String("folder"))
-            parseFolder(entry, profile);
+            parseFolder(entry, bookmarks);
         else {
-            profile->add(entry);
+            bookmarks.append({entry.value(QStringLiteral("name")).toString(),
+                              entry.value(QStringLiteral("url")).toString(),
+                              QString()});
         }
     }
 }
@@ -23,12 +23,15 @@
 #define CHROME_H
 
 #include "browser.h"
+#include "bookmarkindex.h"
 #include "findprofile.h"
 
 #include <QList>
 
 #include <KDirWatch>
 
+#include <atomic>
+
 class QJsonObject;
 
 class ProfileBookmarks;
@@ -43,11 +46,16 @@ public Q_SLOTS:
     void prepare() override;
     void teardown() override;
 private:
-    void parseFolder(const QJsonObject &entry, ProfileBookmarks *profile);
+    /**
+     * Reads the bookmarks of the profiles whose bookmarks file changed since it was last read
+     */
+    void refresh();
+    void parseFolder(const QJsonObject &entry, QVector<BookmarkIndex::Bookmark> &bookmarks);
     virtual QList<BookmarkMatch> match(const QString &term, bool addEveryThing, ProfileBookmarks *profileBookmarks);
     QList<ProfileBookmarks*> m_profileBookmarks;
     KDirWatch* m_watcher = nullptr;
-    bool m_dirty;
+    // whether a match session is running, also read by the match threads
+    std::atomic<bool> m_active;
 
 };
 
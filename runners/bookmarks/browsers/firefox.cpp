@@ -25,20 +25,38 @@
 #include <QFile>
 #include <QDir>
 #include <KConfigGroup>
+#include <KDirWatch>
 #include <KSharedConfig>
 #include "bookmarkmatch.h"
 #include "favicon.h"
 #include "fetchsqlite.h"
 #include "faviconfromblob.h"
+#include "bookmarks_debug.h"
 
 Firefox::Firefox(QObject *parent) :
     QObject(parent),
     m_favicon(new FallbackFavicon(this)),
-    m_fetchsqlite(nullptr),
-    m_fetchsqlite_fav(nullptr)
+    m_fetchsqlite_fav(nullptr),
+    m_watcher(new KDirWatch(this)),
+    m_active(false)
 {
   reloadConfiguration();
   //qDebug() << "Loading Firefox Bookmarks Browser";
+
+  if (!m_dbFile.isEmpty()) {
+      // changes to the bookmarks usually only reach the write-ahead log until Firefox quits
+      m_watcher->addFile(m_dbFile);
+      m_watcher->addFile(m_dbFile + QStringLiteral("-wal"));
+  }
+  // only re-read while a session is running, otherwise the next prepare() takes care of it
+  auto refreshIfActive = [this] {
+      if (m_active) {
+          refresh();
+      }
+  };
+  connect(m_watcher, &KDirWatch::created, this, refreshIfActive);
+  connect(m_watcher, &KDirWatch::dirty, this, refreshIfActive);
+  connect(m_watcher, &KDirWatch::deleted, this, refreshIfActive);
 }
 
 
@@ -62,43 +80,43 @@ void Firefox::prepare()
         m_dbCacheFile_fav = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/bookmarkrunnerfirefoxfavdbfile.sqlite");
     }
     if (!m_dbFile.isEmpty()) {
-        m_fetchsqlite = new FetchSqlite(m_dbFile, m_dbCacheFile);
-        m_fetchsqlite->prepare();
+        m_active = true;
+        refresh();
     }
-    if (!m_dbFile_fav.isEmpty()) {
-        m_fetchsqlite_fav = new FetchSqlite(m_dbFile_fav, m_dbCacheFile_fav);
-        m_fetchsqlite_fav->prepare();
+    // kept between sessions, the favicon database is only copied for icons that are not cached yet
+    if (!m_dbFile_fav.isEmpty() && !m_fetchsqlite_fav) {
+        m_fetchsqlite_fav = new FetchSqlite(m_dbFile_fav, m_dbCacheFile_fav, this);
 
         delete m_favicon;
-        m_favicon = nullptr;
-
         m_favicon = FaviconFromBlob::firefox(m_fetchsqlite_fav, this);
     }
+    m_favicon->prepare();
 }
 
-QList< BookmarkMatch > Firefox::match(const QString& term, bool addEverything)
+void Firefox::refresh()
 {
-    QList< BookmarkMatch > matches;
-    if (!m_fetchsqlite) {
-        return matches;
+    // the bookmarks are kept between sessions, only copy and read the
+    // database again when it changed, which includes its write-ahead log.
+    // Visits change it as well, so this may read unchanged bookmarks again.
+    const QStringList files = {m_dbFile, m_dbFile + QStringLiteral("-wal")};
+    if (!m_index.isCurrent(files)) {
+        readBookmarks(BookmarkIndex::stamp(files));
     }
-    //qDebug() << "Firefox bookmark: match " << term;
+}
+
+void Firefox::readBookmarks(const QString &stamp)
+{
+    // A running Firefox keeps places.sqlite locked, so the bookmarks are
+    // read from a copy, which is removed again when fetchSqlite goes away
+    FetchSqlite fetchSqlite(m_dbFile, m_dbCacheFile);
+    fetchSqlite.prepare();
+
+    const QString query = QStringLiteral("SELECT moz_bookmarks.fk, moz_bookmarks.title, moz_places.url " \
+                                         "FROM moz_bookmarks, moz_places WHERE " \
+                                         "moz_bookmarks.type = 1 AND moz_bookmarks.fk = moz_places.id");
+    QList<QVariantMap> results = fetchSqlite.query(query);
+    fetchSqlite.teardown();
 
-    QString query;
-    if (addEverything) {
-        query = QStringLiteral("SELECT moz_bookmarks.fk, moz_bookmarks.title, moz_places.url " \
-                    "FROM moz_bookmarks, moz_places WHERE " \
-                    "moz_bookmarks.type = 1 AND moz_bookmarks.fk = moz_places.id");
-    } else {
-        query = QString("SELECT moz_bookmarks.fk, moz_bookmarks.title, moz_places.url " \
-                        "FROM moz_bookmarks, moz_places WHERE " \
-                        "moz_bookmarks.type = 1 AND moz_bookmarks.fk = moz_places.id AND " \
-                        "(moz_bookmarks.title LIKE :term OR moz_places.url LIKE :term)");
-    }
-    const QMap<QString, QVariant> bindVariables {
-        {QStringLiteral(":term"), QStringLiteral("%%%1%%").arg(term)},
-    };
-    QList<QVariantMap> results = m_fetchsqlite->query(query, bindVariables);
     QMultiMap<QString, QString> uniqueResults;
     foreach(QVariantMap result, results) {
         const QString title = result.value(QStringLiteral("title")).toString();
@@ -136,29 +154,32 @@ QList< BookmarkMatch > Firefox::match(const QString& term, bool addEverything)
         }
     }
 
+    QVector<BookmarkIndex::Bookmark> bookmarks;
+    bookmarks.reserve(uniqueResults.size());
     for (auto result = uniqueResults.constKeyValueBegin(); result != uniqueResults.constKeyValueEnd(); ++result) {
-        BookmarkMatch bookmarkMatch(m_favicon, term, (*result).second, (*result).first);
-        bookmarkMatch.addTo(matches, addEverything);
+        bookmarks.append({(*result).second, (*result).first, QString()});
     }
 
-    return matches;
+    qCDebug(RUNNER_BOOKMARKS) << "Read" << bookmarks.count() << "bookmarks from" << m_dbFile;
+    m_index.replace(bookmarks, stamp);
+}
+
+QList< BookmarkMatch > Firefox::match(const QString& term, bool addEverything)
+{
+    if (!m_active) {
+        return QList<BookmarkMatch>();
+    }
+    //qDebug() << "Firefox bookmark: match " << term;
+
+    return m_index.match(m_favicon, term, addEverything);
 }
 
 
 void Firefox::teardown()
 {
-    if(m_fetchsqlite) {
-        m_fetchsqlite->teardown();
-        delete m_fetchsqlite;
-        m_fetchsqlite = nullptr;
-    }
-    if(m_fetchsqlite_fav) {
-        m_fetchsqlite_fav->teardown();
-        delete m_fetchsqlite_fav;
-        m_fetchsqlite_fav = nullptr;
-        delete m_favicon;
-        m_favicon = nullptr;
-    }
+    // the bookmarks stay in memory for the next session
+    m_active = false;
+    m_favicon->teardown();
 }
 
 
@@ -23,6 +23,11 @@
 
 #include <QSqlDatabase>
 #include "browser.h"
+#include "bookmarkindex.h"
+
+#include <atomic>
+
+class KDirWatch;
 
 class Favicon;
 class FetchSqlite;
@@ -38,13 +43,21 @@ public Q_SLOTS:
     void prepare() override;
 private:
     virtual void reloadConfiguration();
+    /**
+     * Reads the bookmarks if the database changed since they were last read
+     */
+    void refresh();
+    void readBookmarks(const QString &stamp);
     QString m_dbFile;
     QString m_dbFile_fav;
     QString m_dbCacheFile;
     QString m_dbCacheFile_fav;
     Favicon * m_favicon;
-    FetchSqlite *m_fetchsqlite;
     FetchSqlite *m_fetchsqlite_fav;
+    BookmarkIndex m_index;
+    KDirWatch *m_watcher;
+    // whether a match session is running, also read by the match threads
+    std::atomic<bool> m_active;
 };
 
 #endif // FIREFOX_H
@@ -24,6 +24,7 @@
 
 #include <QObject>
 #include <QIcon>
+#include <QStringList>
 
 class Favicon : public QObject
 {
@@ -31,6 +32,11 @@ class Favicon : public QObject
 public:
     explicit Favicon(QObject *parent = nullptr);
     virtual QIcon iconFor(const QString &url) = 0;
+    /**
+     * Called with the URLs of all matches before iconFor() is called for each,
+     * so the icons can be looked up at once.
+     */
+    virtual void prefetch(const QStringList &urls) { Q_UNUSED(urls) }
 
 protected:
     inline QIcon defaultIcon() const { return m_default_icon; }
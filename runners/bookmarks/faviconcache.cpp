@@ -0,0 +1,146 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "faviconcache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QUrl>
+
+#include "bookmarks_debug.h"
+
+// icons are shown at most at the size of a match icon
+static const int s_iconSize = 64;
+static const int s_maxIconsInMemory = 256;
+static const int s_maxIconFiles = 2000;
+// after that long an icon is looked up in the browser database again
+static const qint64 s_maxIconAge = 7 * 24 * 60 * 60;
+
+static bool isExpired(const QDateTime &written)
+{
+    return written.secsTo(QDateTime::currentDateTime()) > s_maxIconAge;
+}
+
+Q_GLOBAL_STATIC(FaviconCache, s_faviconCache)
+
+FaviconCache::FaviconCache()
+    : m_directory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/favicons"))
+    , m_icons(s_maxIconsInMemory)
+{
+    // remove the per-profile icon directories of earlier versions
+    const QDir cacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    const QStringList oldDirectories = cacheDirectory.entryList({QStringLiteral("KRunner-Favicons-*")},
+                                                                QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &oldDirectory : oldDirectories) {
+        QDir(cacheDirectory.filePath(oldDirectory)).removeRecursively();
+    }
+}
+
+FaviconCache *FaviconCache::self()
+{
+    return s_faviconCache();
+}
+
+QString FaviconCache::key(const QString &url)
+{
+    const QString host = QUrl(url).host();
+    return host.isEmpty() ? url : host;
+}
+
+QString FaviconCache::fileName(const QString &key) const
+{
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_directory + QLatin1Char('/') + QString::fromLatin1(hash) + QStringLiteral(".png");
+}
+
+QIcon FaviconCache::icon(const QString &key)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (CachedIcon *cached = m_icons.object(key)) {
+        if (!isExpired(cached->written)) {
+            return cached->icon;
+        }
+        m_icons.remove(key);
+        return QIcon();
+    }
+
+    const QFileInfo file(fileName(key));
+    if (!file.exists() || isExpired(file.lastModified())) {
+        return QIcon();
+    }
+
+    // loaded lazily by QIcon, in the thread painting it
+    CachedIcon *cached = new CachedIcon{QIcon(file.filePath()), file.lastModified()};
+    m_icons.insert(key, cached);
+    return cached->icon;
+}
+
+QIcon FaviconCache::insert(const QString &key, const QByteArray &imageData)
+{
+    QImage image = QImage::fromData(imageData);
+    if (image.isNull()) {
+        return QIcon();
+    }
+    if (image.width() > s_iconSize || image.height() > s_iconSize) {
+        image = image.scaled(s_iconSize, s_iconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    const QString file = fileName(key);
+    const bool existed = QFile::exists(file);
+    if (!QDir().mkpath(m_directory) || !image.save(file, "PNG")) {
+        qCWarning(RUNNER_BOOKMARKS) << "Could not write favicon" << file;
+        return QIcon();
+    }
+
+    if (!existed) {
+        if (m_fileCount < 0) {
+            m_fileCount = QDir(m_directory).entryList(QDir::Files).count();
+        } else {
+            ++m_fileCount;
+        }
+        if (m_fileCount > s_maxIconFiles) {
+            trimDirectory();
+        }
+    }
+
+    CachedIcon *cached = new CachedIcon{QIcon(file), QDateTime::currentDateTime()};
+    m_icons.insert(key, cached);
+    return cached->icon;
+}
+
+void FaviconCache::trimDirectory()
+{
+    // remove the oldest tenth, so this does not happen for every new icon
+    QDir dir(m_directory);
+    const QFileInfoList files = dir.entryInfoList(QDir::Files, QDir::Time);
+    const int keep = s_maxIconFiles * 9 / 10;
+    for (int i = keep; i < files.count(); ++i) {
+        QFile::remove(files.at(i).absoluteFilePath());
+    }
+    m_fileCount = qMin(files.count(), keep);
+
+    // the memory cache may refer to removed files
+    m_icons.clear();
+}
@@ -0,0 +1,78 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FAVICONCACHE_H
+#define FAVICONCACHE_H
+
+#include <QCache>
+#include <QDateTime>
+#include <QIcon>
+#include <QMutex>
+#include <QString>
+
+/**
+ * Favicons of all browsers, keyed by the host of the pages they belong to.
+ *
+ * Icons are decoded and scaled down once when they are extracted from a
+ * browser database and stored as small PNG files in the cache directory,
+ * which keeps them across sessions and restarts without ever touching the
+ * browser database again. The icons used recently are also kept in memory.
+ * Both caches are bounded, the oldest files are removed when there are too many.
+ * Icons expire after a week, so changed icons are looked up again.
+ *
+ * The cache is shared by all profiles and may be used from any thread.
+ */
+class FaviconCache
+{
+public:
+    FaviconCache();
+
+    static FaviconCache *self();
+
+    /**
+     * @return the key of the icon for the page @p url, its host
+     */
+    static QString key(const QString &url);
+
+    /**
+     * @return the icon for @p key, or a null icon if it is not cached or expired
+     */
+    QIcon icon(const QString &key);
+
+    /**
+     * Decodes @p imageData and stores it as the icon for @p key.
+     * @return the stored icon, or a null icon if the data is not an image
+     */
+    QIcon insert(const QString &key, const QByteArray &imageData);
+
+private:
+    struct CachedIcon {
+        QIcon icon;
+        QDateTime written;
+    };
+
+    QString fileName(const QString &key) const;
+    void trimDirectory();
+
+    QMutex m_mutex;
+    QString const m_directory;
+    QCache<QString, CachedIcon> m_icons;
+    // number of files in the directory, -1 until it was counted
+    int m_fileCount = -1;
+};
+
+#endif // FAVICONCACHE_H
@@ -21,13 +21,13 @@
 #include "faviconfromblob.h"
 
 #include <QDebug>
-#include <QPixmap>
-#include <QFile>
 #include <QFileInfo>
+#include <QMutexLocker>
+#include <QSet>
 #include <QStandardPaths>
-#include <QPainter>
-#include <QDir>
 #include "bookmarksrunner_defs.h"
+#include "bookmarks_debug.h"
+#include "faviconcache.h"
 #include "fetchsqlite.h"
 
 #include <QSqlDatabase>
@@ -42,45 +42,40 @@ FaviconFromBlob *FaviconFromBlob::chrome(const QString &profileDirectory, QObjec
             .arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation), profileName);
     FetchSqlite *fetchSqlite = new FetchSqlite(profileDirectory + QStringLiteral("/Favicons"), faviconCache, parent);
 
+    // %1 is replaced by the list of page URLs to look up
     QString faviconQuery;
     if(fetchSqlite->tables().contains(QLatin1String("favicon_bitmaps"))) {
-        faviconQuery = QLatin1String("SELECT * FROM favicons " \
+        faviconQuery = QLatin1String("SELECT page_url, image_data FROM favicons " \
                                      "inner join icon_mapping on icon_mapping.icon_id = favicons.id " \
                                      "inner join favicon_bitmaps on icon_mapping.icon_id = favicon_bitmaps.icon_id " \
-                                     "WHERE page_url = :url ORDER BY height desc LIMIT 1;");
+                                     "WHERE page_url IN (%1) ORDER BY height desc;");
     } else {
-        faviconQuery = QLatin1String("SELECT * FROM favicons " \
+        faviconQuery = QLatin1String("SELECT page_url, image_data FROM favicons " \
                                      "inner join icon_mapping on icon_mapping.icon_id = favicons.id " \
-                                     "WHERE page_url = :url LIMIT 1;");
+                                     "WHERE page_url IN (%1);");
     }
 
-    return new FaviconFromBlob(profileName, faviconQuery, QStringLiteral("image_data"), fetchSqlite, parent);
+    return new FaviconFromBlob(faviconQuery, QStringLiteral("page_url"), QStringLiteral("image_data"), fetchSqlite, parent);
 }
 
 FaviconFromBlob *FaviconFromBlob::firefox(FetchSqlite *fetchSqlite, QObject *parent)
 {
 
-    QString faviconQuery = QStringLiteral("SELECT moz_icons.data FROM moz_icons" \
+    QString faviconQuery = QStringLiteral("SELECT moz_pages_w_icons.page_url, moz_icons.data FROM moz_icons" \
                                    " INNER JOIN moz_icons_to_pages ON moz_icons.id = moz_icons_to_pages.icon_id" \
                                    " INNER JOIN moz_pages_w_icons ON moz_icons_to_pages.page_id = moz_pages_w_icons.id" \
-                                   " WHERE moz_pages_w_icons.page_url = :url LIMIT 1;");
-    return new FaviconFromBlob(QStringLiteral("firefox-default"), faviconQuery, QStringLiteral("data"), fetchSqlite, parent);
+                                   " WHERE moz_pages_w_icons.page_url IN (%1) ORDER BY moz_icons.width desc;");
+    return new FaviconFromBlob(faviconQuery, QStringLiteral("page_url"), QStringLiteral("data"), fetchSqlite, parent);
 }
 
 
-FaviconFromBlob::FaviconFromBlob(const QString &profileName, const QString &query, const QString &blobColumn, FetchSqlite *fetchSqlite, QObject *parent)
-    : Favicon(parent), m_query(query), m_blobcolumn(blobColumn), m_fetchsqlite(fetchSqlite)
+FaviconFromBlob::FaviconFromBlob(const QString &query, const QString &urlColumn, const QString &blobColumn, FetchSqlite *fetchSqlite, QObject *parent)
+    : Favicon(parent), m_query(query), m_urlcolumn(urlColumn), m_blobcolumn(blobColumn), m_fetchsqlite(fetchSqlite)
 {
-    m_profileCacheDirectory = QStringLiteral("%1/KRunner-Favicons-%2")
-            .arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation), profileName);
-    //qDebug() << "got cache directory: " << m_profileCacheDirectory;
-    cleanCacheDirectory();
-    QDir().mkpath(m_profileCacheDirectory);
 }
 
 FaviconFromBlob::~FaviconFromBlob()
 {
-    cleanCacheDirectory();
 }
 
 void FaviconFromBlob::prepare()
@@ -91,35 +86,87 @@ void FaviconFromBlob::prepare()
 void FaviconFromBlob::teardown()
 {
     m_fetchsqlite->teardown();
-}
 
-void FaviconFromBlob::cleanCacheDirectory()
-{
-    QDir(m_profileCacheDirectory).removeRecursively();
+    // the browser might have got an icon for them in the meantime
+    QMutexLocker locker(&m_mutex);
+    m_missing.clear();
 }
 
 QIcon FaviconFromBlob::iconFor(const QString &url)
 {
-    //qDebug() << "got url: " << url;
-    QString fileChecksum = QString::number(qChecksum(url.toLatin1(), url.toLatin1().size()));
-    QFile iconFile( m_profileCacheDirectory + QDir::separator() + fileChecksum + QStringLiteral("_favicon") );
-    if(iconFile.size() == 0)
-        iconFile.remove();
-    if(!iconFile.exists()) {
-        QMap<QString,QVariant> bindVariables;
-        bindVariables.insert(QStringLiteral(":url"), url);
-        QList<QVariantMap> faviconFound = m_fetchsqlite->query(m_query, bindVariables);
-        if(faviconFound.isEmpty()) return defaultIcon();
-
-        QByteArray iconData = faviconFound.first().value(m_blobcolumn).toByteArray();
-        //qDebug() << "Favicon found: " << iconData.size() << " bytes";
-        if(iconData.size() <=0)
-            return defaultIcon();
-
-        iconFile.open(QFile::WriteOnly);
-        iconFile.write(iconData);
-        iconFile.close();
+    const QString key = FaviconCache::key(url);
+
+    QIcon icon = FaviconCache::self()->icon(key);
+    if (icon.isNull()) {
+        fetch({url});
+        icon = FaviconCache::self()->icon(key);
     }
-    return QIcon(iconFile.fileName());
+
+    return icon.isNull() ? defaultIcon() : icon;
+}
+
+void FaviconFromBlob::prefetch(const QStringList &urls)
+{
+    fetch(urls);
 }
 
+void FaviconFromBlob::fetch(const QStringList &urls)
+{
+    FaviconCache *cache = FaviconCache::self();
+
+    // only ask the database for icons neither cached nor known to be missing
+    QHash<QString, QString> keys;
+    QStringList pending;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const QString &url : urls) {
+            const QString key = FaviconCache::key(url);
+            if (keys.contains(url) || m_missing.contains(key)) {
+                continue;
+            }
+            keys.insert(url, key);
+            if (cache->icon(key).isNull()) {
+                pending << url;
+            }
+        }
+    }
+
+    QSet<QString> found;
+    // stay well below the limit of SQLite for bound parameters
+    const int batchSize = 500;
+    for (int start = 0; start < pending.count(); start += batchSize) {
+        const QStringList batch = pending.mid(start, batchSize);
+
+        QStringList placeholders;
+        QMap<QString, QVariant> bindVariables;
+        for (int i = 0; i < batch.count(); ++i) {
+            const QString placeholder = QStringLiteral(":url%1").arg(i);
+            placeholders << placeholder;
+            bindVariables.insert(placeholder, batch.at(i));
+        }
+
+        const QList<QVariantMap> faviconsFound = m_fetchsqlite->query(m_query.arg(placeholders.join(QLatin1Char(','))), bindVariables);
+        for (const QVariantMap &favicon : faviconsFound) {
+            const QString key = FaviconCache::key(favicon.value(m_urlcolumn).toString());
+            // rows are ordered by size, the first one of a host is the biggest
+            if (found.contains(key)) {
+                continue;
+            }
+
+            const QByteArray iconData = favicon.value(m_blobcolumn).toByteArray();
+            if (!iconData.isEmpty() && !cache->insert(key, iconData).isNull()) {
+                found.insert(key);
+            }
+        }
+    }
+
+    qCDebug(RUNNER_BOOKMARKS) << "Looked up" << pending.count() << "favicons, found" << found.count();
+
+    QMutexLocker locker(&m_mutex);
+    for (const QString &url : qAsConst(pending)) {
+        const QString key = keys.value(url);
+        if (!found.contains(key)) {
+            m_missing.insert(key);
+        }
+    }
+}
@@ -22,6 +22,8 @@
 #define FAVICONFROMBLOB_H
 
 #include <QIcon>
+#include <QMutex>
+#include <QSet>
 #include "favicon.h"
 #include "fetchsqlite.h"
 
@@ -33,18 +35,26 @@ public:
     static FaviconFromBlob *firefox(FetchSqlite *fetchSqlite, QObject *parent = nullptr);
     ~FaviconFromBlob() override;
     QIcon iconFor(const QString &url) override;
+    void prefetch(const QStringList &urls) override;
 
 public Q_SLOTS:
     void prepare() override;
     void teardown() override;
 
 private:
-    FaviconFromBlob(const QString &profileName, const QString &query, const QString &blobColumn, FetchSqlite *fetchSqlite, QObject *parent = nullptr);
-    QString m_profileCacheDirectory;
-    QString m_query;
+    FaviconFromBlob(const QString &query, const QString &urlColumn, const QString &blobColumn, FetchSqlite *fetchSqlite, QObject *parent = nullptr);
+    /**
+     * Moves the icons for @p urls from the database to the FaviconCache,
+     * with one query for all of them
+     */
+    void fetch(const QStringList &urls);
+    QString const m_query;
+    QString const m_urlcolumn;
     QString const m_blobcolumn;
     FetchSqlite *m_fetchsqlite;
-    void cleanCacheDirectory();
+    QMutex m_mutex;
+    // hosts the database has no icon for, not looked up again this session
+    QSet<QString> m_missing;
 };
 
 #endif // FAVICONFROMBLOB_H
@@ -20,6 +20,7 @@
 
 #include "fetchsqlite.h"
 #include <QFile>
+#include <QFileInfo>
 #include <QDebug>
 #include "bookmarks_debug.h"
 #include "bookmarksrunner_defs.h"
@@ -31,15 +32,8 @@
 #include <sstream>
 
 FetchSqlite::FetchSqlite(const QString &originalFilePath, const QString &copyTo, QObject *parent) :
-    QObject(parent), m_databaseFile(copyTo)
+    QObject(parent), m_originalFile(originalFilePath), m_databaseFile(copyTo)
 {
-    QFile originalFile(originalFilePath);
-    QFile(copyTo).remove();
-    bool couldCopy = originalFile.copy(copyTo);
-    if(!couldCopy) {
-        //qDebug() << "error copying favicon database from " << originalFile.fileName() << " to " << copyTo;
-        //qDebug() << originalFile.errorString();
-    }
 }
 
 FetchSqlite::~FetchSqlite()
@@ -52,6 +46,34 @@ void FetchSqlite::prepare()
 }
 
 void FetchSqlite::teardown()
+{
+    closeConnections();
+}
+
+void FetchSqlite::updateCopy()
+{
+    // the database is only copied when it is first used and when it changed since
+    const QFileInfo originalInfo(m_originalFile);
+    if (originalInfo.lastModified() == m_copiedLastModified && originalInfo.size() == m_copiedSize
+            && QFile::exists(m_databaseFile)) {
+        return;
+    }
+
+    closeConnections();
+    QFile(m_databaseFile).remove();
+    QFile originalFile(m_originalFile);
+    bool couldCopy = originalFile.copy(m_databaseFile);
+    if(!couldCopy) {
+        //qDebug() << "error copying favicon database from " << originalFile.fileName() << " to " << copyTo;
+        //qDebug() << originalFile.errorString();
+        return;
+    }
+    qCDebug(RUNNER_BOOKMARKS) << "Copied" << m_originalFile << "to" << m_databaseFile;
+    m_copiedLastModified = originalInfo.lastModified();
+    m_copiedSize = originalInfo.size();
+}
+
+void FetchSqlite::closeConnections()
 {
     QString connectionPrefix = m_databaseFile + "-";
 
@@ -92,6 +114,7 @@ QList<QVariantMap> FetchSqlite::query(const QString &sql, QMap<QString, QVariant
 {
     QMutexLocker lock(&m_mutex);
 
+    updateCopy();
     auto db = openDbConnection(m_databaseFile);
 
     //qDebug() << "query: " << sql;
@@ -122,10 +145,16 @@ QList<QVariantMap> FetchSqlite::query(const QString &sql, QMap<QString, QVariant
     return result;
 }
 
+QList<QVariantMap> FetchSqlite::query(const QString &sql)
+{
+    return query(sql, QMap<QString, QVariant>());
+}
+
 QStringList FetchSqlite::tables(QSql::TableType type)
 {
     QMutexLocker lock(&m_mutex);
 
+    updateCopy();
     auto db = openDbConnection(m_databaseFile);
     return db.tables(type);
 }
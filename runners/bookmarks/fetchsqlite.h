@@ -23,6 +23,7 @@
 #include <QSqlDatabase>
 #include <QList>
 #include <QVariantMap>
+#include <QDateTime>
 
 #include <QVariant>
 #include <QString>
@@ -44,7 +45,13 @@ public:
     QStringList tables(QSql::TableType type = QSql::Tables);
 
 private:
+    void updateCopy();
+    void closeConnections();
+
+    QString const m_originalFile;
     QString const m_databaseFile;
+    QDateTime m_copiedLastModified;
+    qint64 m_copiedSize = -1;
     QMutex m_mutex;
 };
 
@@ -21,6 +21,7 @@
 #include "testchromebookmarks.h"
 #include <QTest>
 #include <QDir>
+#include <QTemporaryDir>
 #include "browsers/chrome.h"
 #include "browsers/chromefindprofile.h"
 #include "favicon.h"
@@ -121,5 +122,49 @@ void TestChromeBookmarks::itShouldFindBookmarksFromAllProfiles()
     verifyMatch(matches[3], "bookmark in secondProfile", "http://secondprofile.com/", 0.18, QueryMatch::PossibleMatch);
 }
 
+void TestChromeBookmarks::itShouldReadChangedBookmarksInTheNextSession()
+{
+    QTemporaryDir dir;
+    const QString bookmarksFile = dir.filePath("Bookmarks");
+    QVERIFY(QFile::copy("chrome-config-home/Chrome-Bookmarks-Sample.json", bookmarksFile));
+
+    FakeFindProfile finder(QList<Profile>() << Profile(bookmarksFile, new FallbackFavicon(this)));
+    Chrome *chrome = new Chrome(&finder, this);
+    chrome->prepare();
+    QCOMPARE(chrome->match("any", true).size(), 3);
+    QCOMPARE(chrome->match("somefolder", false).size(), 1);
+    chrome->teardown();
+
+    // bookmarks are kept until the file changes
+    chrome->prepare();
+    QCOMPARE(chrome->match("any", true).size(), 3);
+    chrome->teardown();
+
+    QVERIFY(QFile::remove(bookmarksFile));
+    QVERIFY(QFile::copy("chrome-config-home/Chrome-Bookmarks-SecondProfile.json", bookmarksFile));
+    chrome->prepare();
+    QList<BookmarkMatch> matches = chrome->match("any", true);
+    QCOMPARE(matches.size(), 1);
+    verifyMatch(matches[0], "bookmark in secondProfile", "http://secondprofile.com/", 0.18, QueryMatch::PossibleMatch);
+    QCOMPARE(chrome->match("somefolder", false).size(), 0);
+}
+
+void TestChromeBookmarks::itShouldReadChangedBookmarksInARunningSession()
+{
+    QTemporaryDir dir;
+    const QString bookmarksFile = dir.filePath("Bookmarks");
+    QVERIFY(QFile::copy("chrome-config-home/Chrome-Bookmarks-Sample.json", bookmarksFile));
+
+    FakeFindProfile finder(QList<Profile>() << Profile(bookmarksFile, new FallbackFavicon(this)));
+    Chrome *chrome = new Chrome(&finder, this);
+    chrome->prepare();
+    QCOMPARE(chrome->match("any", true).size(), 3);
+
+    // picked up through the watch on the file, without another prepare()
+    QVERIFY(QFile::remove(bookmarksFile));
+    QVERIFY(QFile::copy("chrome-config-home/Chrome-Bookmarks-SecondProfile.json", bookmarksFile));
+    QTRY_COMPARE(chrome->match("any", true).size(), 1);
+    QCOMPARE(chrome->match("secondprofile", false).size(), 1);
+}
 
 QTEST_MAIN(TestChromeBookmarks);
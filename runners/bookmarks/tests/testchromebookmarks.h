@@ -48,6 +48,8 @@ private Q_SLOTS:
   void itShouldFindOnlyMatches();
   void itShouldClearResultAfterCallingTeardown();
   void itShouldFindBookmarksFromAllProfiles();
+  void itShouldReadChangedBookmarksInTheNextSession();
+  void itShouldReadChangedBookmarksInARunningSession();
 
 private:
     QScopedPointer<FakeFindProfile> m_findBookmarksInCurrentDirectory;
@@ -0,0 +1,300 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfaviconcache.h"
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QTest>
+#include "faviconcache.h"
+#include "faviconfromblob.h"
+#include "fetchsqlite.h"
+
+namespace {
+    const QString s_connection = QStringLiteral("testfaviconcache");
+
+    QByteArray pngData(int size)
+    {
+        QImage image(size, size, QImage::Format_ARGB32);
+        image.fill(Qt::red);
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "PNG");
+        return data;
+    }
+}
+
+void TestFaviconCache::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestFaviconCache::init()
+{
+    QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).removeRecursively();
+    createDatabase();
+}
+
+QString TestFaviconCache::cacheDirectory() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/favicons");
+}
+
+QStringList TestFaviconCache::iconFiles() const
+{
+    return QDir(cacheDirectory()).entryList(QDir::Files);
+}
+
+void TestFaviconCache::createDatabase()
+{
+    // the tables and columns of the Firefox favicons.sqlite that are read
+    m_databaseDir.reset(new QTemporaryDir);
+    m_databaseFile = m_databaseDir->filePath(QStringLiteral("favicons.sqlite"));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), s_connection);
+        db.setDatabaseName(m_databaseFile);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec(QStringLiteral("CREATE TABLE moz_icons (id INTEGER PRIMARY KEY, data BLOB, width INTEGER)")));
+        QVERIFY(query.exec(QStringLiteral("CREATE TABLE moz_pages_w_icons (id INTEGER PRIMARY KEY, page_url TEXT)")));
+        QVERIFY(query.exec(QStringLiteral("CREATE TABLE moz_icons_to_pages (page_id INTEGER, icon_id INTEGER)")));
+    }
+    QSqlDatabase::removeDatabase(s_connection);
+}
+
+void TestFaviconCache::addIcons(const QStringList &pageUrls, int size)
+{
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), s_connection);
+        db.setDatabaseName(m_databaseFile);
+        QVERIFY(db.open());
+        QVERIFY(db.transaction());
+        const QByteArray data = pngData(size);
+        QSqlQuery query(db);
+        for (const QString &pageUrl : pageUrls) {
+            query.prepare(QStringLiteral("INSERT INTO moz_icons (data, width) VALUES (?, ?)"));
+            query.addBindValue(data);
+            query.addBindValue(size);
+            QVERIFY(query.exec());
+            const QVariant icon = query.lastInsertId();
+            query.prepare(QStringLiteral("INSERT INTO moz_pages_w_icons (page_url) VALUES (?)"));
+            query.addBindValue(pageUrl);
+            QVERIFY(query.exec());
+            const QVariant page = query.lastInsertId();
+            query.prepare(QStringLiteral("INSERT INTO moz_icons_to_pages (page_id, icon_id) VALUES (?, ?)"));
+            query.addBindValue(page);
+            query.addBindValue(icon);
+            QVERIFY(query.exec());
+        }
+        QVERIFY(db.commit());
+    }
+    QSqlDatabase::removeDatabase(s_connection);
+}
+
+void TestFaviconCache::itShouldKeyIconsByHost()
+{
+    QCOMPARE(FaviconCache::key(QStringLiteral("https://kde.org/announcements/")), QStringLiteral("kde.org"));
+    QCOMPARE(FaviconCache::key(QStringLiteral("https://kde.org/?page=2")), QStringLiteral("kde.org"));
+    QCOMPARE(FaviconCache::key(QStringLiteral("about:blank")), QStringLiteral("about:blank"));
+}
+
+void TestFaviconCache::itShouldStoreScaledIconsAcrossInstances()
+{
+    {
+        FaviconCache cache;
+        QVERIFY(cache.icon(QStringLiteral("kde.org")).isNull());
+        QVERIFY(!cache.insert(QStringLiteral("kde.org"), pngData(128)).isNull());
+        QVERIFY(!cache.icon(QStringLiteral("kde.org")).isNull());
+    }
+
+    // decoded and scaled down once, to the size of a match icon
+    const QStringList files = iconFiles();
+    QCOMPARE(files.count(), 1);
+    QCOMPARE(QImage(QDir(cacheDirectory()).filePath(files.first())).size(), QSize(64, 64));
+
+    FaviconCache cache;
+    QVERIFY(!cache.icon(QStringLiteral("kde.org")).isNull());
+    QVERIFY(cache.icon(QStringLiteral("planet.kde.org")).isNull());
+}
+
+void TestFaviconCache::itShouldRejectInvalidImages()
+{
+    FaviconCache cache;
+    QVERIFY(cache.insert(QStringLiteral("kde.org"), QByteArrayLiteral("<html>")).isNull());
+    QVERIFY(cache.icon(QStringLiteral("kde.org")).isNull());
+    QVERIFY(iconFiles().isEmpty());
+}
+
+void TestFaviconCache::itShouldExpireOldIcons()
+{
+    {
+        FaviconCache cache;
+        QVERIFY(!cache.insert(QStringLiteral("kde.org"), pngData(16)).isNull());
+    }
+
+    QFile file(QDir(cacheDirectory()).filePath(iconFiles().value(0)));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.setFileTime(QDateTime::currentDateTime().addDays(-8), QFileDevice::FileModificationTime));
+    file.close();
+
+    FaviconCache cache;
+    QVERIFY(cache.icon(QStringLiteral("kde.org")).isNull());
+
+    // storing it again renews it
+    QVERIFY(!cache.insert(QStringLiteral("kde.org"), pngData(16)).isNull());
+    QVERIFY(!FaviconCache().icon(QStringLiteral("kde.org")).isNull());
+}
+
+void TestFaviconCache::itShouldRemoveTheOldestIconsWhenFull()
+{
+    FaviconCache cache;
+    const QByteArray data = pngData(1);
+    for (int i = 0; i < 2000; ++i) {
+        cache.insert(QStringLiteral("host%1.example").arg(i), data);
+    }
+    QCOMPARE(iconFiles().count(), 2000);
+
+    // one more removes the oldest tenth
+    cache.insert(QStringLiteral("onemore.example"), data);
+    QCOMPARE(iconFiles().count(), 1800);
+}
+
+void TestFaviconCache::itShouldRemoveOldProfileDirectories()
+{
+    const QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    const QString oldDirectory = cacheLocation + QStringLiteral("/KRunner-Favicons-Default");
+    QVERIFY(QDir().mkpath(oldDirectory));
+    QFile oldIcon(oldDirectory + QStringLiteral("/icon.png"));
+    QVERIFY(oldIcon.open(QIODevice::WriteOnly));
+    oldIcon.write(pngData(16));
+    oldIcon.close();
+    // the copy of a Chrome database is no icon directory
+    QFile database(cacheLocation + QStringLiteral("/KRunner-Chrome-Favicons-Default.sqlite"));
+    QVERIFY(database.open(QIODevice::WriteOnly));
+    database.close();
+
+    FaviconCache cache;
+    QVERIFY(!QFile::exists(oldDirectory));
+    QVERIFY(database.exists());
+}
+
+void TestFaviconCache::itShouldLookUpIconsInBatches_data()
+{
+    QTest::addColumn<int>("count");
+
+    // 500 URLs are looked up in one query
+    QTest::newRow("one") << 1;
+    QTest::newRow("one batch less one") << 499;
+    QTest::newRow("one batch") << 500;
+    QTest::newRow("one batch and one") << 501;
+    QTest::newRow("two batches") << 1000;
+    QTest::newRow("two batches and one") << 1001;
+}
+
+void TestFaviconCache::itShouldLookUpIconsInBatches()
+{
+    QFETCH(int, count);
+
+    // the cache is shared by all tests, so every row has its own hosts
+    const QString tag = QString::fromLatin1(QTest::currentDataTag()).replace(QLatin1Char(' '), QLatin1Char('-'));
+    QStringList urls;
+    for (int i = 0; i < count; ++i) {
+        urls << QStringLiteral("https://%1-%2.example/page").arg(tag).arg(i);
+    }
+    addIcons(urls, 16);
+    // without an icon
+    urls << QStringLiteral("https://%1-missing.example/").arg(tag);
+
+    FetchSqlite fetchSqlite(m_databaseFile, m_databaseDir->filePath(QStringLiteral("copy.sqlite")));
+    QScopedPointer<FaviconFromBlob> favicon(FaviconFromBlob::firefox(&fetchSqlite));
+    favicon->prepare();
+    favicon->prefetch(urls);
+    favicon->teardown();
+
+    for (int i = 0; i < count; ++i) {
+        QVERIFY2(!FaviconCache::self()->icon(FaviconCache::key(urls.at(i))).isNull(), qPrintable(urls.at(i)));
+    }
+    QVERIFY(FaviconCache::self()->icon(FaviconCache::key(urls.last())).isNull());
+    QCOMPARE(iconFiles().count(), count);
+}
+
+void TestFaviconCache::itShouldUseTheLargestIcon()
+{
+    const QString url = QStringLiteral("https://largest.example/");
+    addIcons({url}, 16);
+    addIcons({url}, 32);
+    addIcons({url}, 24);
+
+    FetchSqlite fetchSqlite(m_databaseFile, m_databaseDir->filePath(QStringLiteral("copy.sqlite")));
+    QScopedPointer<FaviconFromBlob> favicon(FaviconFromBlob::firefox(&fetchSqlite));
+    favicon->prepare();
+    favicon->prefetch({url});
+
+    const QStringList files = iconFiles();
+    QCOMPARE(files.count(), 1);
+    QCOMPARE(QImage(QDir(cacheDirectory()).filePath(files.first())).size(), QSize(32, 32));
+}
+
+void TestFaviconCache::itShouldNotLookUpMissingIconsAgainInASession()
+{
+    const QString url = QStringLiteral("https://latecomer.example/");
+
+    FetchSqlite fetchSqlite(m_databaseFile, m_databaseDir->filePath(QStringLiteral("copy.sqlite")));
+    QScopedPointer<FaviconFromBlob> favicon(FaviconFromBlob::firefox(&fetchSqlite));
+    favicon->prepare();
+    favicon->prefetch({url});
+    QVERIFY(FaviconCache::self()->icon(FaviconCache::key(url)).isNull());
+
+    // the browser got the icon, but it is only looked up again in the next session
+    addIcons({url}, 16);
+    favicon->prefetch({url});
+    QVERIFY(FaviconCache::self()->icon(FaviconCache::key(url)).isNull());
+    favicon->teardown();
+
+    favicon->prepare();
+    favicon->prefetch({url});
+    QVERIFY(!FaviconCache::self()->icon(FaviconCache::key(url)).isNull());
+}
+
+void TestFaviconCache::benchmarkCachedIcons()
+{
+    QStringList urls;
+    for (int i = 0; i < 200; ++i) {
+        urls << QStringLiteral("https://benchmark-%1.example/page").arg(i);
+    }
+    addIcons(urls, 16);
+
+    FetchSqlite fetchSqlite(m_databaseFile, m_databaseDir->filePath(QStringLiteral("copy.sqlite")));
+    QScopedPointer<FaviconFromBlob> favicon(FaviconFromBlob::firefox(&fetchSqlite));
+    favicon->prepare();
+    favicon->prefetch(urls);
+
+    // what the runner does for every query once the icons are cached
+    QBENCHMARK {
+        favicon->prefetch(urls);
+        for (const QString &url : qAsConst(urls)) {
+            favicon->iconFor(url);
+        }
+    }
+}
+
+QTEST_MAIN(TestFaviconCache);
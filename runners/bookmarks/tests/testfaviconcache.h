@@ -0,0 +1,56 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TESTFAVICONCACHE_H
+#define TESTFAVICONCACHE_H
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QTemporaryDir>
+
+class TestFaviconCache : public QObject
+{
+Q_OBJECT
+public:
+    explicit TestFaviconCache(QObject* parent = nullptr) : QObject(parent) {}
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void itShouldKeyIconsByHost();
+    void itShouldStoreScaledIconsAcrossInstances();
+    void itShouldRejectInvalidImages();
+    void itShouldExpireOldIcons();
+    void itShouldRemoveTheOldestIconsWhenFull();
+    void itShouldRemoveOldProfileDirectories();
+    void itShouldLookUpIconsInBatches_data();
+    void itShouldLookUpIconsInBatches();
+    void itShouldUseTheLargestIcon();
+    void itShouldNotLookUpMissingIconsAgainInASession();
+    void benchmarkCachedIcons();
+
+private:
+    QString cacheDirectory() const;
+    QStringList iconFiles() const;
+    void createDatabase();
+    void addIcons(const QStringList &pageUrls, int size);
+
+    QScopedPointer<QTemporaryDir> m_databaseDir;
+    QString m_databaseFile;
+};
+
+#endif // TESTFAVICONCACHE_H
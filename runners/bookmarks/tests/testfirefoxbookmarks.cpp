@@ -0,0 +1,124 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfirefoxbookmarks.h"
+#include <QTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <KConfigGroup>
+#include <KSharedConfig>
+#include "browsers/firefox.h"
+
+namespace {
+    const QString s_connection = QStringLiteral("testfirefoxbookmarks");
+}
+
+void TestFirefoxBookmarks::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestFirefoxBookmarks::init()
+{
+    // a places.sqlite with just the tables and columns the runner reads
+    m_profileDir.reset(new QTemporaryDir);
+    m_placesFile = m_profileDir->filePath(QStringLiteral("places.sqlite"));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), s_connection);
+        db.setDatabaseName(m_placesFile);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec(QStringLiteral("CREATE TABLE moz_places (id INTEGER PRIMARY KEY, url TEXT)")));
+        QVERIFY(query.exec(QStringLiteral("CREATE TABLE moz_bookmarks (id INTEGER PRIMARY KEY, type INTEGER, fk INTEGER, title TEXT)")));
+    }
+    QSqlDatabase::removeDatabase(s_connection);
+
+    KConfigGroup config(KSharedConfig::openConfig(QStringLiteral("kdeglobals")), QStringLiteral("General"));
+    config.writeEntry("dbfile", m_placesFile);
+    config.sync();
+}
+
+void TestFirefoxBookmarks::addBookmark(const QString &title, const QString &url)
+{
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), s_connection);
+        db.setDatabaseName(m_placesFile);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        query.prepare(QStringLiteral("INSERT INTO moz_places (url) VALUES (?)"));
+        query.addBindValue(url);
+        QVERIFY(query.exec());
+        const QVariant place = query.lastInsertId();
+        query.prepare(QStringLiteral("INSERT INTO moz_bookmarks (type, fk, title) VALUES (1, ?, ?)"));
+        query.addBindValue(place);
+        query.addBindValue(title);
+        QVERIFY(query.exec());
+    }
+    QSqlDatabase::removeDatabase(s_connection);
+}
+
+void TestFirefoxBookmarks::itShouldFindNothingWhenPrepareIsNotCalled()
+{
+    addBookmark(QStringLiteral("KDE"), QStringLiteral("https://kde.org/"));
+
+    Firefox firefox;
+    QCOMPARE(firefox.match(QStringLiteral("kde"), false).size(), 0);
+}
+
+void TestFirefoxBookmarks::itShouldSkipPlaceUrls()
+{
+    addBookmark(QStringLiteral("KDE"), QStringLiteral("https://kde.org/"));
+    addBookmark(QStringLiteral("Most Visited"), QStringLiteral("place:sort=8&maxResults=10"));
+
+    Firefox firefox;
+    firefox.prepare();
+    const QList<BookmarkMatch> matches = firefox.match(QStringLiteral("any"), true);
+    QCOMPARE(matches.size(), 1);
+    QCOMPARE(matches.first().asQueryMatch(nullptr).data().toString(), QStringLiteral("https://kde.org/"));
+}
+
+void TestFirefoxBookmarks::itShouldReadChangedBookmarksInARunningSession()
+{
+    addBookmark(QStringLiteral("KDE"), QStringLiteral("https://kde.org/"));
+
+    Firefox firefox;
+    firefox.prepare();
+    QCOMPARE(firefox.match(QStringLiteral("any"), true).size(), 1);
+
+    // picked up through the watch on the database, without another prepare()
+    addBookmark(QStringLiteral("Plasma"), QStringLiteral("https://plasma-mobile.org/"));
+    QTRY_COMPARE(firefox.match(QStringLiteral("any"), true).size(), 2);
+    QCOMPARE(firefox.match(QStringLiteral("plasma"), false).size(), 1);
+}
+
+void TestFirefoxBookmarks::itShouldReadChangedBookmarksInTheNextSession()
+{
+    addBookmark(QStringLiteral("KDE"), QStringLiteral("https://kde.org/"));
+
+    Firefox firefox;
+    firefox.prepare();
+    QCOMPARE(firefox.match(QStringLiteral("any"), true).size(), 1);
+    firefox.teardown();
+    QCOMPARE(firefox.match(QStringLiteral("any"), true).size(), 0);
+
+    addBookmark(QStringLiteral("Plasma"), QStringLiteral("https://plasma-mobile.org/"));
+    firefox.prepare();
+    QCOMPARE(firefox.match(QStringLiteral("any"), true).size(), 2);
+}
+
+QTEST_MAIN(TestFirefoxBookmarks);
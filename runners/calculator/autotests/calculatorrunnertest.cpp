@@ -0,0 +1,148 @@
+/*
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) version 3, or any
+ *   later version accepted by the membership of KDE e.V. (or its
+ *   successor approved by the membership of KDE e.V.), which shall
+ *   act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QLocale>
+#include <QObject>
+#include <QSet>
+#include <QTest>
+
+#include <krunner/querymatch.h>
+#include <krunner/runnercontext.h>
+
+#include "../calculatorrunner.h"
+
+class CalculatorRunnerTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void testArithmetic_data();
+    void testArithmetic();
+    void testRepeatedQuery();
+    void testRandomNotCached();
+
+    void benchmarkTyping_data();
+    void benchmarkTyping();
+
+private:
+    static QString result(CalculatorRunner &runner, const QString &query);
+};
+
+void CalculatorRunnerTest::initTestCase()
+{
+    // decimal points and the rounding of the results depend on it
+    QLocale::setDefault(QLocale::c());
+}
+
+QString CalculatorRunnerTest::result(CalculatorRunner &runner, const QString &query)
+{
+    Plasma::RunnerContext context;
+    context.setQuery(query);
+    runner.match(context);
+
+    const QList<Plasma::QueryMatch> matches = context.matches();
+    return matches.isEmpty() ? QString() : matches.first().text();
+}
+
+void CalculatorRunnerTest::testArithmetic_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("precedence") << QStringLiteral("2+3*4") << QStringLiteral("14");
+    QTest::newRow("parentheses") << QStringLiteral("(2+3)*4") << QStringLiteral("20");
+    QTest::newRow("power") << QStringLiteral("2^10") << QStringLiteral("1024");
+    QTest::newRow("unary minus") << QStringLiteral("-2^2") << QStringLiteral("-4");
+    QTest::newRow("integer division") << QStringLiteral("144/12") << QStringLiteral("12");
+    QTest::newRow("fraction") << QStringLiteral("3/4") << QStringLiteral("0.75");
+    QTest::newRow("trailing equals") << QStringLiteral("6*7=") << QStringLiteral("42");
+}
+
+void CalculatorRunnerTest::testArithmetic()
+{
+    QFETCH(QString, query);
+    QFETCH(QString, expected);
+
+    CalculatorRunner runner(this, QVariantList());
+    QCOMPARE(result(runner, query), expected);
+}
+
+void CalculatorRunnerTest::testRepeatedQuery()
+{
+    CalculatorRunner runner(this, QVariantList());
+
+    // the second time the result comes from the cache
+    const QString first = result(runner, QStringLiteral("=sqrt(2)"));
+    QVERIFY(first.startsWith(QLatin1String("1.41421")));
+    QCOMPARE(result(runner, QStringLiteral("=sqrt(2)")), first);
+    QCOMPARE(result(runner, QStringLiteral("1.5*4")), QStringLiteral("6"));
+    QCOMPARE(result(runner, QStringLiteral("1.5*4")), QStringLiteral("6"));
+}
+
+void CalculatorRunnerTest::testRandomNotCached()
+{
+    CalculatorRunner runner(this, QVariantList());
+
+#ifdef ENABLE_QALCULATE
+    const QString query = QStringLiteral("=rand()");
+#else
+    const QString query = QStringLiteral("=random()");
+#endif
+
+    // two random numbers in a row may well be equal, five hardly
+    QSet<QString> results;
+    for (int i = 0; i < 5; ++i) {
+        const QString value = result(runner, query);
+        QVERIFY(!value.isEmpty());
+        results.insert(value);
+    }
+    QVERIFY(results.count() > 1);
+}
+
+void CalculatorRunnerTest::benchmarkTyping_data()
+{
+    QTest::addColumn<QString>("expression");
+
+    QTest::newRow("integers") << QStringLiteral("1234+5678*(90-12)");
+    QTest::newRow("decimals") << QStringLiteral("12.5*(3.25+4)/7");
+    QTest::newRow("functions") << QStringLiteral("=sqrt(2)*sin(1)+cos(2)");
+}
+
+void CalculatorRunnerTest::benchmarkTyping()
+{
+    QFETCH(QString, expression);
+
+    // each keystroke queries what was typed so far
+    QStringList queries;
+    for (int length = 1; length <= expression.length(); ++length) {
+        queries << expression.left(length);
+    }
+
+    CalculatorRunner runner(this, QVariantList());
+
+    QBENCHMARK {
+        for (const QString &query : qAsConst(queries)) {
+            result(runner, query);
+        }
+    }
+}
+
+QTEST_MAIN(CalculatorRunnerTest)
+
+#include "calculatorrunnertest.moc"
@@ -25,12 +25,15 @@
 #include "qalculate_engine.h"
 #else
 #include <QJSEngine>
-#include <QGuiApplication>
-#include <QClipboard>
+#include <QThread>
 #endif
 
+#include <QClipboard>
+#include <QGuiApplication>
 #include <QIcon>
 #include <QDebug>
+#include <QMutexLocker>
+#include <QSet>
 
 #include <KLocalizedString>
 #include <krunner/querymatch.h>
@@ -39,8 +42,225 @@ static const QString s_copyToClipboardId = QStringLiteral("copyToClipboard");
 
 K_EXPORT_PLASMA_RUNNER(calculatorrunner, CalculatorRunner)
 
+// results are kept for the last expressions typed, which are looked at again while editing
+static const int s_maxCachedResults = 100;
+
+// integers up to this are exact as double as well, and printed without exponent by all engines
+static const qint64 s_maxExactInteger = Q_INT64_C(999999999999999);
+
+namespace {
+
+/**
+ * Evaluates arithmetic on integers, failing for everything else so that it is
+ * left to the engine. Precedence follows the engines: ^ binds stronger than
+ * unary minus and is right associative.
+ */
+class ArithmeticParser
+{
+public:
+    explicit ArithmeticParser(const QString &expression)
+        : m_expression(expression)
+    {
+    }
+
+    bool evaluate(qint64 *result)
+    {
+        return parseSum(result) && m_pos == m_expression.size();
+    }
+
+private:
+    bool accept(char c)
+    {
+        if (m_pos < m_expression.size() && m_expression.at(m_pos) == QLatin1Char(c)) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    static bool inRange(qint64 value)
+    {
+        return qAbs(value) <= s_maxExactInteger;
+    }
+
+    bool parseSum(qint64 *value)
+    {
+        if (!parseProduct(value)) {
+            return false;
+        }
+        while (true) {
+            qint64 rhs;
+            if (accept('+')) {
+                if (!parseProduct(&rhs)) {
+                    return false;
+                }
+                *value += rhs;
+            } else if (accept('-')) {
+                if (!parseProduct(&rhs)) {
+                    return false;
+                }
+                *value -= rhs;
+            } else {
+                return true;
+            }
+            if (!inRange(*value)) {
+                return false;
+            }
+        }
+    }
+
+    bool parseProduct(qint64 *value)
+    {
+        if (!parseUnary(value)) {
+            return false;
+        }
+        while (true) {
+            qint64 rhs;
+            if (accept('*')) {
+                if (!parseUnary(&rhs)) {
+                    return false;
+                }
+                if (rhs != 0 && qAbs(*value) > s_maxExactInteger / qAbs(rhs)) {
+                    return false;
+                }
+                *value *= rhs;
+            } else if (accept('/')) {
+                if (!parseUnary(&rhs)) {
+                    return false;
+                }
+                // fractions and division by zero are formatted by the engine
+                if (rhs == 0 || *value % rhs != 0) {
+                    return false;
+                }
+                *value /= rhs;
+            } else {
+                return true;
+            }
+        }
+    }
+
+    bool parseUnary(qint64 *value)
+    {
+        if (accept('-')) {
+            if (!parseUnary(value)) {
+                return false;
+            }
+            *value = -*value;
+            return true;
+        }
+        if (accept('+')) {
+            return parseUnary(value);
+        }
+        return parsePower(value);
+    }
+
+    bool parsePower(qint64 *value)
+    {
+        if (!parsePrimary(value)) {
+            return false;
+        }
+        if (!accept('^')) {
+            return true;
+        }
+
+        qint64 exponent;
+        if (!parseUnary(&exponent)) {
+            return false;
+        }
+        // fractions and 0^0 are left to the engine
+        if (exponent < 0 || (exponent == 0 && *value == 0)) {
+            return false;
+        }
+
+        const qint64 base = *value;
+        if (qAbs(base) <= 1) {
+            *value = (base == -1 && exponent % 2 == 0) ? 1 : base;
+            return true;
+        }
+
+        // overflows after at most 50 steps
+        *value = 1;
+        for (qint64 i = 0; i < exponent; ++i) {
+            if (qAbs(*value) > s_maxExactInteger / qAbs(base)) {
+                return false;
+            }
+            *value *= base;
+        }
+        return true;
+    }
+
+    bool parsePrimary(qint64 *value)
+    {
+        if (accept('(')) {
+            return parseSum(value) && accept(')');
+        }
+
+        const int start = m_pos;
+        while (m_pos < m_expression.size() && m_expression.at(m_pos) >= QLatin1Char('0')
+               && m_expression.at(m_pos) <= QLatin1Char('9')) {
+            ++m_pos;
+        }
+        const int length = m_pos - start;
+        // leading zeros mean octal numbers to the script engine
+        if (length == 0 || length > 15 || (length > 1 && m_expression.at(start) == QLatin1Char('0'))) {
+            return false;
+        }
+        *value = m_expression.midRef(start, length).toLongLong();
+        return true;
+    }
+
+    const QString &m_expression;
+    int m_pos = 0;
+};
+
+}
+
+#ifndef ENABLE_QALCULATE
+/**
+ * A script engine with the helpers used for every calculation set up already.
+ * Each thread matching keeps its own, as QJSEngine may only be used by one.
+ */
+class ScriptEngine
+{
+public:
+    ScriptEngine()
+    {
+        // user input must not be able to change what later calculations see
+        m_engine.evaluate(QStringLiteral("Object.freeze(Math)"));
+
+        //ECMAScript has issues with the last digit in simple rational computations
+        //This script rounds off the last digit; see bug 167986
+        m_round = m_engine.evaluate(QStringLiteral("(function(result) {\
+                                                        var exponent = 14-(1+Math.floor(Math.log(Math.abs(result))/Math.log(10)));\
+                                                        var order=Math.pow(10,exponent);\
+                                                        return (order > 0? Math.round(result*order)/order : 0);\
+                                                    })"));
+    }
+
+    QJSValue evaluate(const QString &term)
+    {
+        return m_engine.evaluate(QStringLiteral("(function() { var result = %1; return result; })()").arg(term));
+    }
+
+    QJSValue round(const QJSValue &result)
+    {
+        return m_round.call({result});
+    }
+
+    QThread *thread() const
+    {
+        return m_engine.thread();
+    }
+
+private:
+    QJSEngine m_engine;
+    QJSValue m_round;
+};
+#endif
+
 CalculatorRunner::CalculatorRunner( QObject* parent, const QVariantList &args )
     : Plasma::AbstractRunner(parent, args)
+    , m_results(s_maxCachedResults)
 {
     Q_UNUSED(args)
 
@@ -67,6 +287,8 @@ CalculatorRunner::~CalculatorRunner()
 {
     #ifdef ENABLE_QALCULATE
     delete m_engine;
+    #else
+    qDeleteAll(m_scriptEngines);
     #endif
 }
 
@@ -259,13 +481,19 @@ void CalculatorRunner::match(Plasma::RunnerContext &context)
         return;
     }
 
-    userFriendlySubstitutions(cmd);
-    #ifndef ENABLE_QALCULATE
-    cmd.replace(QRegExp(QStringLiteral("([a-zA-Z]+)")), QStringLiteral("Math.\\1")); //needed for accessing math funktions like sin(),....
-    #endif
-
     bool isApproximate = false;
-    QString result = calculate(cmd, &isApproximate);
+    QString result;
+    qint64 value;
+    if (calculateArithmetic(cmd, &value)) {
+        result = QString::number(value);
+    } else {
+        userFriendlySubstitutions(cmd);
+        #ifndef ENABLE_QALCULATE
+        cmd.replace(QRegExp(QStringLiteral("([a-zA-Z]+)")), QStringLiteral("Math.\\1")); //needed for accessing math funktions like sin(),....
+        #endif
+
+        result = calculate(cmd, &isApproximate);
+    }
     if (!result.isEmpty() && result != cmd) {
         if (toHex) {
             result = QLatin1String("0x") + QString::number(result.toInt(), 16).toUpper();
@@ -284,7 +512,97 @@ void CalculatorRunner::match(Plasma::RunnerContext &context)
     }
 }
 
+bool CalculatorRunner::calculateArithmetic(const QString &expression, qint64 *result)
+{
+    return ArithmeticParser(expression).evaluate(result);
+}
+
+bool CalculatorRunner::isDeterministic(const QString &expression)
+{
+    // everything else, including units, is left uncached rather than telling
+    // apart which of the engine's names are safe to cache
+    static const QSet<QString> s_deterministicNames = {
+        QStringLiteral("math"), QStringLiteral("abs"), QStringLiteral("sign"),
+        QStringLiteral("floor"), QStringLiteral("ceil"), QStringLiteral("round"), QStringLiteral("trunc"),
+        QStringLiteral("min"), QStringLiteral("max"), QStringLiteral("pow"), QStringLiteral("sqrt"), QStringLiteral("cbrt"),
+        QStringLiteral("exp"), QStringLiteral("ln"), QStringLiteral("log"), QStringLiteral("log2"), QStringLiteral("log10"),
+        QStringLiteral("sin"), QStringLiteral("cos"), QStringLiteral("tan"),
+        QStringLiteral("asin"), QStringLiteral("acos"), QStringLiteral("atan"), QStringLiteral("atan2"),
+        QStringLiteral("sinh"), QStringLiteral("cosh"), QStringLiteral("tanh"),
+        QStringLiteral("pi"), QStringLiteral("e"),
+    };
+
+    for (int i = 0; i < expression.size(); ++i) {
+        const QChar c = expression.at(i);
+        // currency symbols are converted at the current exchange rate
+        if (c.category() == QChar::Symbol_Currency) {
+            return false;
+        }
+        if (!c.isLetter()) {
+            continue;
+        }
+
+        const int start = i;
+        while (i + 1 < expression.size() && expression.at(i + 1).isLetterOrNumber()) {
+            ++i;
+        }
+        if (!s_deterministicNames.contains(expression.mid(start, i - start + 1).toLower())) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 QString CalculatorRunner::calculate(const QString& term, bool *isApproximate)
+{
+    // random numbers and times have to be calculated again every time
+    const bool cacheable = isDeterministic(term);
+
+    if (cacheable) {
+        QMutexLocker locker(&m_resultsMutex);
+        if (const Result *cached = m_results.object(term)) {
+            *isApproximate = cached->isApproximate;
+            return cached->value;
+        }
+    }
+
+    Result *result = new Result;
+    result->isApproximate = false;
+    result->value = evaluate(term, &result->isApproximate);
+    *isApproximate = result->isApproximate;
+    const QString value = result->value;
+
+    if (!cacheable) {
+        delete result;
+        return value;
+    }
+
+    QMutexLocker locker(&m_resultsMutex);
+    m_results.insert(term, result);
+    return value;
+}
+
+#ifndef ENABLE_QALCULATE
+ScriptEngine *CalculatorRunner::scriptEngine()
+{
+    QThread *thread = QThread::currentThread();
+
+    QMutexLocker locker(&m_scriptEnginesMutex);
+    ScriptEngine *&engine = m_scriptEngines[thread];
+    // a new thread of the pool may have taken the place of one which ended
+    if (engine && engine->thread() != thread) {
+        delete engine;
+        engine = nullptr;
+    }
+    if (!engine) {
+        engine = new ScriptEngine;
+    }
+    return engine;
+}
+#endif
+
+QString CalculatorRunner::evaluate(const QString& term, bool *isApproximate)
 {
     #ifdef ENABLE_QALCULATE
     QString result;
@@ -299,8 +617,8 @@ QString CalculatorRunner::calculate(const QString& term, bool *isApproximate)
     #else
     Q_UNUSED(isApproximate);
     //qDebug() << "calculating" << term;
-    QJSEngine eng;
-    QJSValue result = eng.evaluate(QStringLiteral("var result = %1; result").arg(term));
+    ScriptEngine *eng = scriptEngine();
+    QJSValue result = eng->evaluate(term);
 
     if (result.isError()) {
         return QString();
@@ -315,11 +633,7 @@ QString CalculatorRunner::calculate(const QString& term, bool *isApproximate)
         return resultString;
     }
 
-    //ECMAScript has issues with the last digit in simple rational computations
-    //This script rounds off the last digit; see bug 167986
-    QString roundedResultString = eng.evaluate(QStringLiteral("var exponent = 14-(1+Math.floor(Math.log(Math.abs(result))/Math.log(10)));\
-                                                var order=Math.pow(10,exponent);\
-                                                (order > 0? Math.round(result*order)/order : 0)")).toString();
+    QString roundedResultString = eng->round(result).toString();
 
     roundedResultString.replace(QLatin1Char('.'), QLocale().decimalPoint(), Qt::CaseInsensitive);
 
@@ -331,11 +645,8 @@ void CalculatorRunner::run(const Plasma::RunnerContext &context, const Plasma::Q
 {
     Q_UNUSED(context);
     if (match.selectedAction() == action(s_copyToClipboardId)) {
-#ifdef ENABLE_QALCULATE
-        m_engine->copyToClipboard();
-#else
+        // not the last result of the engine, the match may come from the cache
         QGuiApplication::clipboard()->setText(match.text());
-#endif
     }
 }
 
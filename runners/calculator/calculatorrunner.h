@@ -20,10 +20,16 @@
 #ifndef CALCULATORRUNNER_H
 #define CALCULATORRUNNER_H
 
+#include <QCache>
+#include <QHash>
 #include <QMimeData>
+#include <QMutex>
 
 #ifdef ENABLE_QALCULATE
 class QalculateEngine;
+#else
+class QThread;
+class ScriptEngine;
 #endif
 
 #include <krunner/abstractrunner.h>
@@ -47,13 +53,47 @@ class CalculatorRunner : public Plasma::AbstractRunner
         QMimeData * mimeDataForMatch(const Plasma::QueryMatch &match) override;
 
     private:
+        /**
+         * Evaluates @p expression natively if it only consists of integers,
+         * + - * / ^ and parentheses and its value is an integer.
+         * @return whether the expression could be evaluated this way
+         */
+        static bool calculateArithmetic(const QString &expression, qint64 *result);
+        /**
+         * @return whether @p expression, as handed to the engine, only uses
+         * functions and constants whose value never changes, unlike random
+         * numbers, the current time or exchange rates
+         */
+        static bool isDeterministic(const QString &expression);
         QString calculate(const QString& term, bool *isApproximate);
+        QString evaluate(const QString& term, bool *isApproximate);
         void userFriendlySubstitutions(QString& cmd);
         void powSubstitutions(QString& cmd);
         void hexSubstitutions(QString& cmd);
 
+        struct Result {
+            QString value;
+            bool isApproximate;
+        };
+
+        /** deterministic results by the expression handed to the engine, protected by m_resultsMutex */
+        QCache<QString, Result> m_results;
+        QMutex m_resultsMutex;
+
         #ifdef ENABLE_QALCULATE
         QalculateEngine* m_engine;
+        #else
+        /**
+         * The engine of the calling thread, created when it calculates the first time.
+         * A QJSEngine may only be used from the thread it lives in, and match() runs
+         * in the threads of the runner manager's pool, so the engines cannot be set
+         * up ahead in the constructor or in init(), which run in the main thread.
+         */
+        ScriptEngine *scriptEngine();
+
+        /** engines by the thread using them, protected by m_scriptEnginesMutex */
+        QHash<QThread *, ScriptEngine *> m_scriptEngines;
+        QMutex m_scriptEnginesMutex;
         #endif
 };
 
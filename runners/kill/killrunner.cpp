@@ -22,6 +22,8 @@
 #include <QAction>
 #include <QDebug>
 #include <QIcon>
+#include <QMutexLocker>
+#include <QtConcurrentRun>
 
 #include <KProcess>
 #include <KUser>
@@ -34,6 +36,9 @@
 
 K_EXPORT_PLASMA_RUNNER(kill, KillRunner)
 
+// how long a snapshot of the processes is used before reading them again
+static const qint64 s_snapshotTimeout = 2000;
+
 KillRunner::KillRunner(QObject *parent, const QVariantList& args)
         : Plasma::AbstractRunner(parent, args),
           m_processes(nullptr)
@@ -43,15 +48,12 @@ KillRunner::KillRunner(QObject *parent, const QVariantList& args)
     reloadConfiguration();
 
     connect(this, &Plasma::AbstractRunner::prepare, this, &KillRunner::prep);
-    connect(this, &Plasma::AbstractRunner::teardown, this, &KillRunner::cleanup);
-
-    m_delayedCleanupTimer.setInterval(50);
-    m_delayedCleanupTimer.setSingleShot(true);
-    connect(&m_delayedCleanupTimer, &QTimer::timeout, this, &KillRunner::cleanup);
 }
 
 KillRunner::~KillRunner()
 {
+    m_backgroundUpdate.waitForFinished();
+    delete m_processes;
 }
 
 
@@ -72,23 +74,38 @@ void KillRunner::reloadConfiguration()
 
 void KillRunner::prep()
 {
-    m_delayedCleanupTimer.stop();
+    // Without a trigger word every query is matched, so get the processes
+    // while the user is typing. With one, the processes are only read once
+    // the trigger word was typed.
+    if (m_triggerWord.isEmpty() && m_backgroundUpdate.isFinished()) {
+        m_backgroundUpdate = QtConcurrent::run(this, &KillRunner::updateSnapshot);
+    }
 }
 
-void KillRunner::cleanup()
+void KillRunner::updateSnapshot()
 {
-    if (!m_processes) {
+    QMutexLocker locker(&m_updateMutex);
+    if (m_snapshotAge.isValid() && !m_snapshotAge.hasExpired(s_snapshotTimeout)) {
         return;
     }
 
-    if (m_prepLock.tryLockForWrite()) {
-        delete m_processes;
-        m_processes = nullptr;
+    if (!m_processes) {
+        m_processes = new KSysGuard::Processes();
+    }
+    m_processes->updateAllProcesses();
 
-        m_prepLock.unlock();
-    } else {
-        m_delayedCleanupTimer.stop();
+    const QList<KSysGuard::Process *> processlist = m_processes->getAllProcesses();
+    QVector<ProcessEntry> snapshot;
+    snapshot.reserve(processlist.count());
+    foreach (const KSysGuard::Process *process, processlist) {
+        const QString name = process->name();
+        snapshot.append({quint64(process->pid()), name, name.toLower(), getUserName(process->uid()),
+                         qreal(process->userUsage() + process->sysUsage())});
     }
+
+    QWriteLocker snapshotLocker(&m_snapshotLock);
+    m_snapshot.swap(snapshot);
+    m_snapshotAge.start();
 }
 
 void KillRunner::match(Plasma::RunnerContext &context)
@@ -99,41 +116,31 @@ void KillRunner::match(Plasma::RunnerContext &context)
         return;
     }
 
-    m_prepLock.lockForRead();
-    if (!m_processes) {
-        m_prepLock.unlock();
-        m_prepLock.lockForWrite();
-        if (!m_processes) {
-            suspendMatching(true);
-            m_processes = new KSysGuard::Processes();
-            m_processes->updateAllProcesses();
-            suspendMatching(false);
-        }
-    }
-    m_prepLock.unlock();
-
     term = term.right(term.length() - m_triggerWord.length());
 
     if (term.length() < 2)  {
         return;
     }
 
-    QList<Plasma::QueryMatch> matches;
-    const QList<KSysGuard::Process *> processlist = m_processes->getAllProcesses();
-    foreach (const KSysGuard::Process *process, processlist) {
-        if (!context.isValid()) {
-            return;
-        }
+    // returns right away if the snapshot is recent enough, and waits for an update already running
+    updateSnapshot();
+    if (!context.isValid()) {
+        return;
+    }
 
-        const QString name = process->name();
-        if (!name.contains(term, Qt::CaseInsensitive)) {
+    const QString lowerTerm = term.toLower();
+
+    QList<Plasma::QueryMatch> matches;
+    QReadLocker locker(&m_snapshotLock);
+    for (const ProcessEntry &process : qAsConst(m_snapshot)) {
+        if (!process.lowerName.contains(lowerTerm)) {
             //Process doesn't match the search term
             continue;
         }
 
-        const quint64 pid = process->pid();
-        const qlonglong uid = process->uid();
-        const QString user = getUserName(uid);
+        const QString &name = process.name;
+        const quint64 pid = process.pid;
+        const QString &user = process.user;
 
         QVariantList data;
         data << pid << user;
@@ -148,18 +155,19 @@ void KillRunner::match(Plasma::RunnerContext &context)
         // Set the relevance
         switch (m_sorting) {
         case KillRunnerConfig::CPU:
-            match.setRelevance((process->userUsage() + process->sysUsage()) / 100);
+            match.setRelevance(process.usage / 100);
             break;
         case KillRunnerConfig::CPUI:
-            match.setRelevance(1 - (process->userUsage() + process->sysUsage()) / 100);
+            match.setRelevance(1 - process.usage / 100);
             break;
         case KillRunnerConfig::NONE:
-            match.setRelevance(name.compare(term, Qt::CaseInsensitive) == 0 ? 1 : 9);
+            match.setRelevance(process.lowerName == lowerTerm ? 1 : 9);
             break;
         }
 
         matches << match;
     }
+    locker.unlock();
 
     qDebug() << "match count is" << matches.count();
     context.addMatches(matches);
@@ -214,12 +222,21 @@ QList<QAction*> KillRunner::actionsForMatch(const Plasma::QueryMatch &match)
 
 QString KillRunner::getUserName(qlonglong uid)
 {
+    auto it = m_userNames.constFind(uid);
+    if (it != m_userNames.constEnd()) {
+        return *it;
+    }
+
+    QString name;
     KUser user(uid);
     if (user.isValid()) {
-        return user.loginName();
+        name = user.loginName();
+    } else {
+        qDebug() << QStringLiteral("No user with UID %1 was found").arg(uid);
+        name = QStringLiteral("root");//No user with UID uid was found, so root is used
     }
-    qDebug() << QStringLiteral("No user with UID %1 was found").arg(uid);
-    return QStringLiteral("root");//No user with UID uid was found, so root is used
+    m_userNames.insert(uid, name);
+    return name;
 }
 
 #include "killrunner.moc"
@@ -20,8 +20,12 @@
 #ifndef KILLRUNNER_H
 #define KILLRUNNER_H
 
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
 #include <QReadWriteLock>
-#include <QTimer>
+#include <QVector>
 
 #include <KRunner/AbstractRunner>
 
@@ -49,9 +53,22 @@ public:
 
 private Q_SLOTS:
     void prep();
-    void cleanup();
 
 private:
+    /** The data of a process needed for matching, copied out of m_processes */
+    struct ProcessEntry {
+        quint64 pid;
+        QString name;
+        /** name in lower case, compared with the lower case term */
+        QString lowerName;
+        QString user;
+        /** CPU usage in percent */
+        qreal usage;
+    };
+
+    /** Updates m_snapshot unless it was updated less than a moment ago */
+    void updateSnapshot();
+
     /** @param uid the uid of the user
       * @return the username of the user with the UID uid
       */
@@ -63,14 +80,24 @@ private:
     /** How to sort */
     KillRunnerConfig::Sort m_sorting;
 
-    /** process lister */
+    /** process lister, kept between sessions so it only needs to read what changed */
     KSysGuard::Processes *m_processes;
 
-    /** lock for initializing m_processes */
-    QReadWriteLock m_prepLock;
+    /** user names by uid, these hardly ever change */
+    QHash<qlonglong, QString> m_userNames;
+
+    /** lock for m_processes, m_userNames and m_snapshotAge, held while updating */
+    QMutex m_updateMutex;
+
+    /** the processes as of the last update */
+    QVector<ProcessEntry> m_snapshot;
+    QElapsedTimer m_snapshotAge;
+
+    /** lock for m_snapshot */
+    QReadWriteLock m_snapshotLock;
 
-    /** timer for retrying the cleanup due to lock contention */
-    QTimer m_delayedCleanupTimer;
+    /** update started in the background when a session starts */
+    QFuture<void> m_backgroundUpdate;
 };
 
 #endif
@@ -21,7 +21,10 @@
 
 #include <QAction>
 #include <QDir>
+#include <QFileInfo>
 #include <QMimeData>
+#include <QMutexLocker>
+#include <QSet>
 
 #include <KDesktopFile>
 #include <KConfigGroup>
@@ -40,13 +43,8 @@ RecentDocuments::RecentDocuments(QObject *parent, const QVariantList& args)
 {
     Q_UNUSED(args);
     setObjectName( QStringLiteral("Recent Documents" ));
-    loadRecentDocuments();
-    // listen for changes to the list of recent documents
-    KDirWatch *recentDocWatch = new KDirWatch(this);
-    recentDocWatch->addDir(KRecentDocument::recentDocumentDirectory(), KDirWatch::WatchFiles);
-    connect(recentDocWatch, &KDirWatch::created, this, &RecentDocuments::loadRecentDocuments);
-    connect(recentDocWatch, &KDirWatch::deleted, this, &RecentDocuments::loadRecentDocuments);
-    connect(recentDocWatch, &KDirWatch::dirty, this, &RecentDocuments::loadRecentDocuments);
+    // the documents are only read once they are searched for the first time
+    connect(this, &Plasma::AbstractRunner::prepare, this, &RecentDocuments::prepareForMatchSession);
     addSyntax(Plasma::RunnerSyntax(QStringLiteral(":q:"), i18n("Looks for documents recently used with names matching :q:.")));
 
     addAction(s_openParentDirId, QIcon::fromTheme(QStringLiteral("document-open-folder")), i18n("Open Containing Folder"));
@@ -56,63 +54,118 @@ RecentDocuments::~RecentDocuments()
 {
 }
 
-void RecentDocuments::loadRecentDocuments()
+RecentDocuments::Document RecentDocuments::readDocument(const QString &desktopFile, const QDateTime &lastModified)
 {
-    m_recentdocuments = KRecentDocument::recentDocuments();
-}
+    KDesktopFile config(desktopFile);
+
+    Document document;
+    document.desktopFile = desktopFile;
+    document.lastModified = lastModified;
+    document.url = QUrl(config.readUrl());
+    document.name = config.readName();
+    document.iconName = config.readIcon();
+    document.lowerName = document.name.toLower();
+    document.lowerUrl = document.url.toDisplayString(QUrl::PreferLocalFile).toLower();
+
+    const QUrl folderUrl = document.url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash);
+    if (folderUrl.isLocalFile()) {
+        const QString homePath = QDir::homePath();
+        document.folder = folderUrl.toLocalFile();
+        if (document.folder.startsWith(homePath)) {
+            document.folder.replace(0, homePath.length(), QStringLiteral("~"));
+        }
+    } else {
+        document.folder = folderUrl.toDisplayString();
+    }
 
+    return document;
+}
 
-void RecentDocuments::match(Plasma::RunnerContext &context)
+// Called in the main thread
+void RecentDocuments::prepareForMatchSession()
 {
-    if (m_recentdocuments.isEmpty()) {
+    if (m_loaded) {
         return;
     }
+    m_loaded = true;
+
+    loadRecentDocuments();
+    // listen for changes to the list of recent documents
+    KDirWatch *recentDocWatch = new KDirWatch(this);
+    recentDocWatch->addDir(KRecentDocument::recentDocumentDirectory(), KDirWatch::WatchFiles);
+    connect(recentDocWatch, &KDirWatch::created, this, &RecentDocuments::loadRecentDocuments);
+    connect(recentDocWatch, &KDirWatch::deleted, this, &RecentDocuments::loadRecentDocuments);
+    connect(recentDocWatch, &KDirWatch::dirty, this, &RecentDocuments::loadRecentDocuments);
+}
 
+// Called in the main thread
+void RecentDocuments::loadRecentDocuments()
+{
+    QHash<QString, Document> known;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const Document &document : qAsConst(m_documents)) {
+            known.insert(document.desktopFile, document);
+        }
+    }
+
+    // only the files which are new or were changed since they were read are parsed
+    QVector<Document> documents;
+    QSet<QUrl> knownUrls;
+    const QStringList desktopFiles = KRecentDocument::recentDocuments();
+    for (const QString &desktopFile : desktopFiles) {
+        const QDateTime lastModified = QFileInfo(desktopFile).lastModified();
+
+        auto it = known.constFind(desktopFile);
+        const Document document = (it != known.constEnd() && it->lastModified == lastModified)
+                                  ? *it : readDocument(desktopFile, lastModified);
+
+        // avoid duplicates
+        if (knownUrls.contains(document.url)) {
+            continue;
+        }
+        knownUrls.insert(document.url);
+        documents.append(document);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_documents = documents;
+}
+
+
+void RecentDocuments::match(Plasma::RunnerContext &context)
+{
     const QString term = context.query();
     if (term.length() < 3) {
         return;
     }
 
-    const QString homePath = QDir::homePath();
+    QVector<Document> documents;
+    {
+        QMutexLocker locker(&m_mutex);
+        documents = m_documents;
+    }
 
-    // avoid duplicates
-    QSet<QUrl> knownUrls;
+    const QString lowerTerm = term.toLower();
 
-    foreach (const QString &document, m_recentdocuments) {
-        if (!context.isValid()) {
-            return;
+    QList<Plasma::QueryMatch> matches;
+    for (const Document &document : qAsConst(documents)) {
+        if (!document.lowerName.contains(lowerTerm) && !document.lowerUrl.contains(lowerTerm)) {
+            continue;
         }
 
-        if (document.contains(term, Qt::CaseInsensitive)) {
-            KDesktopFile config(document);
-
-            const QUrl url = QUrl(config.readUrl());
-            if (knownUrls.contains(url)) {
-                continue;
-            }
-
-            knownUrls.insert(url);
-
-            Plasma::QueryMatch match(this);
-            match.setType(Plasma::QueryMatch::PossibleMatch);
-            match.setRelevance(1.0);
-            match.setIconName(config.readIcon());
-            match.setData(url);
-            match.setText(config.readName());
-
-            QUrl folderUrl = url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash);
-            if (folderUrl.isLocalFile()) {
-                QString folderPath = folderUrl.toLocalFile();
-                if (folderPath.startsWith(homePath)) {
-                    folderPath.replace(0, homePath.length(), QStringLiteral("~"));
-                }
-                match.setSubtext(folderPath);
-            } else {
-                match.setSubtext(folderUrl.toDisplayString());
-            }
-
-            context.addMatch(match);
-        }
+        Plasma::QueryMatch match(this);
+        match.setType(Plasma::QueryMatch::PossibleMatch);
+        match.setRelevance(1.0);
+        match.setIconName(document.iconName);
+        match.setData(document.url);
+        match.setText(document.name);
+        match.setSubtext(document.folder);
+        matches << match;
+    }
+
+    if (context.isValid()) {
+        context.addMatches(matches);
     }
 }
 
@@ -22,7 +22,12 @@
 
 #include <krunner/abstractrunner.h>
 
+#include <QDateTime>
+#include <QHash>
 #include <QIcon>
+#include <QMutex>
+#include <QUrl>
+#include <QVector>
 
 class RecentDocuments : public Plasma::AbstractRunner {
     Q_OBJECT
@@ -39,10 +44,31 @@ class RecentDocuments : public Plasma::AbstractRunner {
         QMimeData * mimeDataForMatch(const Plasma::QueryMatch &match) override;
 
     private Q_SLOTS:
+        void prepareForMatchSession();
         void loadRecentDocuments();
 
     private:
-        QStringList m_recentdocuments;
+        /** A recent document, read from its .desktop file once */
+        struct Document {
+            QString desktopFile;
+            QDateTime lastModified;
+            QUrl url;
+            QString name;
+            QString iconName;
+            /** the folder containing the document, as shown to the user */
+            QString folder;
+            /** name and URL in lower case, compared with the lower case term */
+            QString lowerName;
+            QString lowerUrl;
+        };
+
+        static Document readDocument(const QString &desktopFile, const QDateTime &lastModified);
+
+        /** in the order of KRecentDocument, without duplicate URLs; protected by m_mutex */
+        QVector<Document> m_documents;
+        QMutex m_mutex;
+        /** whether the documents were read and are watched for changes, only used in the main thread */
+        bool m_loaded = false;
 };
 
 
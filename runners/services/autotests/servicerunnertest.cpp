@@ -22,11 +22,15 @@
 #include <QDir>
 #include <QFile>
 #include <QObject>
+#include <QScopedPointer>
 #include <QStandardPaths>
+#include <QTemporaryDir>
 #include <QTest>
 
+#include <KDesktopFile>
 #include <KSycoca>
 
+#include "../serviceindex.h"
 #include "../servicerunner.h"
 
 #include <locale.h>
@@ -41,6 +45,16 @@ private Q_SLOTS:
     void testChromeAppsRelevance();
     void testKonsoleVsYakuakeComment();
     void testSystemSettings();
+    void testIndexMatches();
+    void testRefinedQuery();
+
+    void benchmarkIndexQuery_data();
+    void benchmarkIndexQuery();
+
+private:
+    KService::List syntheticServices(int count);
+
+    QScopedPointer<ServiceIndex> m_benchmarkIndex;
 };
 
 void ServiceRunnerTest::initTestCase()
@@ -159,6 +173,143 @@ void ServiceRunnerTest::testSystemSettings()
     QVERIFY(!foreignSystemSettingsFound);
 }
 
+KService::List ServiceRunnerTest::syntheticServices(int count)
+{
+    static const char *const syllables[] = {
+        "fi", "re", "fox", "kon", "so", "le", "dol", "phin", "ka", "te",
+        "mu", "sic", "vi", "de", "o", "pho", "to", "mail", "chat", "web"
+    };
+    const int syllableCount = sizeof(syllables) / sizeof(syllables[0]);
+
+    QTemporaryDir dir;
+    KService::List services;
+    services.reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+        QString name;
+        for (int n = i, j = 0; j < 3; n /= syllableCount, ++j) {
+            name += QLatin1String(syllables[n % syllableCount]);
+        }
+        name[0] = name[0].toUpper();
+
+        const QString path = dir.filePath(QStringLiteral("synthetic%1.desktop").arg(i));
+        KDesktopFile file(path);
+        KConfigGroup group = file.desktopGroup();
+        group.writeEntry("Type", "Application");
+        group.writeEntry("Name", name);
+        group.writeEntry("GenericName", QStringLiteral("Synthetic %1 Viewer").arg(QLatin1String(syllables[i % syllableCount])));
+        group.writeEntry("Comment", QStringLiteral("Application number %1 of the benchmark").arg(i));
+        group.writeEntry("Exec", QStringLiteral("%1 %f").arg(name.toLower()));
+        group.writeXdgListEntry("Keywords", QStringList{QLatin1String(syllables[(i / 3) % syllableCount]), QStringLiteral("bench")});
+        group.writeXdgListEntry("Categories", QStringList{QStringLiteral("Utility"), QStringLiteral("X-Synthetic")});
+        group.writeXdgListEntry("Actions", QStringList{QStringLiteral("new")});
+        KConfigGroup action = file.actionGroup(QStringLiteral("new"));
+        action.writeEntry("Name", QStringLiteral("New %1 Window").arg(name));
+        action.writeEntry("Exec", QStringLiteral("%1 --new").arg(name.toLower()));
+        file.sync();
+
+        services << KService::Ptr(new KService(&file, path));
+    }
+
+    return services;
+}
+
+void ServiceRunnerTest::testIndexMatches()
+{
+    ServiceIndex index;
+    index.setServices(syntheticServices(400), KService::List());
+    QCOMPARE(index.count(), 400);
+
+    // names are three syllables, the first cycling fastest
+    QCOMPARE(index.exactNameMatches(QStringLiteral("FIFIFI")).count(), 1);
+    QCOMPARE(index.exactNameMatches(QStringLiteral("fifi")).count(), 0);
+
+    // every name containing "fox", which is 1 in 20 for each of the three syllables
+    // that are all covered by the first 400 services for the first two of them
+    const KService::List foxes = index.nameOrExecMatches(QStringLiteral("fox"));
+    QCOMPARE(foxes.count(), 39);
+    for (const KService::Ptr &service : foxes) {
+        QVERIFY(service->name().contains(QLatin1String("fox"), Qt::CaseInsensitive));
+    }
+
+    // all words need to be found in the same field
+    QVERIFY(!index.fieldMatches(QStringLiteral("synthetic viewer").splitRef(QLatin1Char(' '))).isEmpty());
+    QVERIFY(index.fieldMatches(QStringLiteral("synthetic benchmark").splitRef(QLatin1Char(' '))).isEmpty());
+
+    QCOMPARE(index.categoryMatches(QStringLiteral("x-synth")).count(), 400);
+    QCOMPARE(index.actionMatches(QStringLiteral("new fififi")).count(), 1);
+    QVERIFY(index.actionMatches(QStringLiteral("old")).isEmpty());
+}
+
+void ServiceRunnerTest::testRefinedQuery()
+{
+    // Typing on from "kon" only looks at what was found for it, which must not
+    // lose anything a fresh query for "konsole" finds.
+    const auto matchTexts = [](ServiceRunner &runner, const QString &query) {
+        Plasma::RunnerContext context;
+        context.setQuery(query);
+        runner.match(context);
+
+        QStringList texts;
+        for (const Plasma::QueryMatch &match : context.matches()) {
+            texts << QStringLiteral("%1 %2").arg(match.text()).arg(match.relevance());
+        }
+        texts.sort();
+        return texts;
+    };
+
+    ServiceRunner refinedRunner(this, QVariantList());
+    matchTexts(refinedRunner, QStringLiteral("kon"));
+    matchTexts(refinedRunner, QStringLiteral("kons"));
+    const QStringList refined = matchTexts(refinedRunner, QStringLiteral("konsole"));
+
+    ServiceRunner freshRunner(this, QVariantList());
+    const QStringList fresh = matchTexts(freshRunner, QStringLiteral("konsole"));
+
+    QVERIFY(!fresh.isEmpty());
+    QCOMPARE(refined, fresh);
+
+    // going back to a shorter term searches everything again
+    QCOMPARE(matchTexts(refinedRunner, QStringLiteral("kon")), matchTexts(freshRunner, QStringLiteral("kon")));
+}
+
+void ServiceRunnerTest::benchmarkIndexQuery_data()
+{
+    QTest::addColumn<QString>("term");
+
+    QTest::newRow("1 character") << QStringLiteral("f");
+    QTest::newRow("2 characters") << QStringLiteral("fi");
+    QTest::newRow("3 characters") << QStringLiteral("fir");
+    QTest::newRow("4 characters") << QStringLiteral("fire");
+    QTest::newRow("5 characters") << QStringLiteral("firef");
+}
+
+void ServiceRunnerTest::benchmarkIndexQuery()
+{
+    QFETCH(QString, term);
+
+    // all 8000 syllable combinations, more than any real system has installed
+    if (!m_benchmarkIndex) {
+        m_benchmarkIndex.reset(new ServiceIndex);
+        m_benchmarkIndex->setServices(syntheticServices(8000), KService::List());
+    }
+    ServiceIndex &index = *m_benchmarkIndex;
+
+    const QVector<QStringRef> words = term.splitRef(QLatin1Char(' '));
+
+    // the same queries the runner does for a term of that length
+    QBENCHMARK {
+        index.exactNameMatches(term);
+        if (term.length() < 3) {
+            index.nameOrExecMatches(term);
+        } else {
+            index.fieldMatches(words);
+            index.actionMatches(term);
+        }
+        index.categoryMatches(term);
+    }
+}
+
 QTEST_MAIN(ServiceRunnerTest)
 
 #include "servicerunnertest.moc"
@@ -0,0 +1,386 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "serviceindex.h"
+
+#include <QElapsedTimer>
+
+#include <KServiceAction>
+#include <KServiceTypeTrader>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+#include "debug.h"
+
+namespace {
+
+quint64 trigram(const QChar *chars)
+{
+    return (quint64(chars[0].unicode()) << 32) | (quint64(chars[1].unicode()) << 16) | chars[2].unicode();
+}
+
+QStringList foldedList(const QStringList &list)
+{
+    QStringList folded;
+    folded.reserve(list.size());
+    for (const QString &item : list) {
+        folded << item.toCaseFolded();
+    }
+    return folded;
+}
+
+}  // namespace
+
+ServiceIndex::ServiceIndex()
+{
+}
+
+ServiceIndex::~ServiceIndex()
+{
+}
+
+void ServiceIndex::invalidate()
+{
+    QWriteLocker locker(&m_lock);
+    m_valid = false;
+}
+
+void ServiceIndex::setServices(const KService::List &applications, const KService::List &kcmodules)
+{
+    QWriteLocker locker(&m_lock);
+    build(applications, kcmodules);
+}
+
+int ServiceIndex::count()
+{
+    ensureBuilt();
+
+    QReadLocker locker(&m_lock);
+    return m_entries.count();
+}
+
+void ServiceIndex::ensureBuilt()
+{
+    {
+        QReadLocker locker(&m_lock);
+        if (m_valid) {
+            return;
+        }
+    }
+
+    QWriteLocker locker(&m_lock);
+    // another thread might have been faster
+    if (!m_valid) {
+        build(KServiceTypeTrader::self()->query(QStringLiteral("Application")),
+              KServiceTypeTrader::self()->query(QStringLiteral("KCModule")));
+    }
+}
+
+void ServiceIndex::build(const KService::List &applications, const KService::List &kcmodules)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_entries.clear();
+    m_names.clear();
+    m_trigrams.clear();
+
+    m_entries.reserve(applications.count() + kcmodules.count());
+    for (const KService::Ptr &service : applications) {
+        addEntry(service, true);
+    }
+    for (const KService::Ptr &service : kcmodules) {
+        addEntry(service, false);
+    }
+
+    for (auto it = m_trigrams.begin(); it != m_trigrams.end(); ++it) {
+        it->squeeze();
+    }
+
+    m_valid = true;
+    ++m_generation;
+
+    qCDebug(RUNNER_SERVICES) << "Indexed" << m_entries.count() << "services with" << m_trigrams.count()
+                             << "trigrams in" << timer.elapsed() << "ms";
+}
+
+void ServiceIndex::addEntry(const KService::Ptr &service, bool application)
+{
+    const int id = m_entries.count();
+
+    Entry entry;
+    entry.service = service;
+    entry.application = application;
+    entry.hasExec = !service->exec().isEmpty();
+    entry.noDisplay = service->noDisplay();
+
+    entry.name = service->name().toCaseFolded();
+    entry.genericName = service->genericName().toCaseFolded();
+    entry.comment = service->comment().toCaseFolded();
+    entry.exec = service->exec().toCaseFolded();
+    entry.keywords = foldedList(service->keywords());
+    entry.categories = foldedList(service->categories());
+    const QList<KServiceAction> actions = service->actions();
+    for (const KServiceAction &action : actions) {
+        entry.actions << action.text().toCaseFolded();
+    }
+
+    if (application) {
+        m_names[entry.name].append(id);
+    }
+
+    addTrigrams(entry.name, id);
+    addTrigrams(entry.genericName, id);
+    addTrigrams(entry.comment, id);
+    addTrigrams(entry.exec, id);
+    for (const QString &keyword : qAsConst(entry.keywords)) {
+        addTrigrams(keyword, id);
+    }
+    for (const QString &category : qAsConst(entry.categories)) {
+        addTrigrams(category, id);
+    }
+    for (const QString &action : qAsConst(entry.actions)) {
+        addTrigrams(action, id);
+    }
+
+    m_entries.append(entry);
+}
+
+void ServiceIndex::addTrigrams(const QString &text, int entry)
+{
+    const QChar *chars = text.constData();
+    for (int i = 0; i + 3 <= text.size(); ++i) {
+        QVector<int> &entries = m_trigrams[trigram(chars + i)];
+        // entries are added in order, so this keeps the lists sorted and unique
+        if (entries.isEmpty() || entries.last() != entry) {
+            entries.append(entry);
+        }
+    }
+}
+
+QVector<int> ServiceIndex::candidates(const QString &folded, const Candidates *within) const
+{
+    const bool restricted = within && within->generation == m_generation;
+
+    if (folded.size() < 3) {
+        if (restricted) {
+            return within->entries;
+        }
+        QVector<int> all(m_entries.count());
+        std::iota(all.begin(), all.end(), 0);
+        return all;
+    }
+
+    QVector<const QVector<int> *> lists;
+    if (restricted) {
+        lists << &within->entries;
+    }
+    const QChar *chars = folded.constData();
+    for (int i = 0; i + 3 <= folded.size(); ++i) {
+        const auto it = m_trigrams.constFind(trigram(chars + i));
+        if (it == m_trigrams.constEnd()) {
+            return {};
+        }
+        lists << &(*it);
+    }
+
+    // start with the rarest trigram to keep the intermediate results small
+    std::sort(lists.begin(), lists.end(), [](const QVector<int> *a, const QVector<int> *b) {
+        return a->size() < b->size();
+    });
+
+    QVector<int> result = *lists.first();
+    for (int i = 1; i < lists.size() && !result.isEmpty(); ++i) {
+        QVector<int> intersection;
+        std::set_intersection(result.constBegin(), result.constEnd(),
+                              lists.at(i)->constBegin(), lists.at(i)->constEnd(),
+                              std::back_inserter(intersection));
+        result = intersection;
+    }
+
+    return result;
+}
+
+void ServiceIndex::addHits(Candidates *hits, const QVector<int> &entries) const
+{
+    if (!hits) {
+        return;
+    }
+
+    if (hits->generation != m_generation) {
+        hits->generation = m_generation;
+        hits->entries.clear();
+    }
+
+    QVector<int> merged;
+    merged.reserve(hits->entries.size() + entries.size());
+    std::set_union(hits->entries.constBegin(), hits->entries.constEnd(),
+                   entries.constBegin(), entries.constEnd(),
+                   std::back_inserter(merged));
+    hits->entries = merged;
+}
+
+bool ServiceIndex::contains(const QStringList &list, const QString &folded)
+{
+    for (const QString &item : list) {
+        if (item.contains(folded)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+KService::List ServiceIndex::exactNameMatches(const QString &term, const Candidates *within, Candidates *hits)
+{
+    ensureBuilt();
+
+    QReadLocker locker(&m_lock);
+    const bool restricted = within && within->generation == m_generation;
+
+    KService::List services;
+    QVector<int> matched;
+    for (int id : m_names.value(term.toCaseFolded())) {
+        if (restricted && !std::binary_search(within->entries.constBegin(), within->entries.constEnd(), id)) {
+            continue;
+        }
+        const Entry &entry = m_entries.at(id);
+        if (entry.hasExec) {
+            services << entry.service;
+            matched << id;
+        }
+    }
+    addHits(hits, matched);
+    return services;
+}
+
+KService::List ServiceIndex::nameOrExecMatches(const QString &term, const Candidates *within, Candidates *hits)
+{
+    ensureBuilt();
+
+    const QString folded = term.toCaseFolded();
+
+    QReadLocker locker(&m_lock);
+    KService::List services;
+    QVector<int> matched;
+    for (int id : candidates(folded, within)) {
+        const Entry &entry = m_entries.at(id);
+        if (!entry.hasExec) {
+            continue;
+        }
+        if ((!entry.name.isEmpty() && entry.name.contains(folded)) || entry.exec.contains(folded)) {
+            services << entry.service;
+            matched << id;
+        }
+    }
+    addHits(hits, matched);
+    return services;
+}
+
+KService::List ServiceIndex::fieldMatches(const QVector<QStringRef> &words, const Candidates *within, Candidates *hits)
+{
+    if (words.isEmpty()) {
+        return {};
+    }
+
+    ensureBuilt();
+
+    QStringList folded;
+    folded.reserve(words.size());
+    for (const QStringRef &word : words) {
+        folded << word.toString().toCaseFolded();
+    }
+
+    const auto containsAll = [&folded](const QString &field) {
+        if (field.isEmpty()) {
+            return false;
+        }
+        for (const QString &word : qAsConst(folded)) {
+            if (!field.contains(word)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    QReadLocker locker(&m_lock);
+    KService::List services;
+    QVector<int> matched;
+    // every alternative requires the first word to be somewhere
+    for (int id : candidates(folded.first(), within)) {
+        const Entry &entry = m_entries.at(id);
+        if (!entry.hasExec) {
+            continue;
+        }
+
+        bool keywordsMatch = !entry.keywords.isEmpty();
+        for (const QString &word : qAsConst(folded)) {
+            if (!keywordsMatch) {
+                break;
+            }
+            keywordsMatch = contains(entry.keywords, word);
+        }
+
+        if (keywordsMatch || containsAll(entry.genericName) || containsAll(entry.name)
+                || entry.exec.contains(folded.first()) || containsAll(entry.comment)) {
+            services << entry.service;
+            matched << id;
+        }
+    }
+    addHits(hits, matched);
+    return services;
+}
+
+KService::List ServiceIndex::categoryMatches(const QString &term, const Candidates *within, Candidates *hits)
+{
+    ensureBuilt();
+
+    const QString folded = term.toCaseFolded();
+
+    QReadLocker locker(&m_lock);
+    KService::List services;
+    QVector<int> matched;
+    for (int id : candidates(folded, within)) {
+        const Entry &entry = m_entries.at(id);
+        if (entry.application && entry.hasExec && contains(entry.categories, folded)) {
+            services << entry.service;
+            matched << id;
+        }
+    }
+    addHits(hits, matched);
+    return services;
+}
+
+KService::List ServiceIndex::actionMatches(const QString &term, const Candidates *within, Candidates *hits)
+{
+    ensureBuilt();
+
+    const QString folded = term.toCaseFolded();
+
+    QReadLocker locker(&m_lock);
+    KService::List services;
+    QVector<int> matched;
+    for (int id : candidates(folded, within)) {
+        const Entry &entry = m_entries.at(id);
+        if (entry.application && !entry.noDisplay && contains(entry.actions, folded)) {
+            services << entry.service;
+            matched << id;
+        }
+    }
+    addHits(hits, matched);
+    return services;
+}
@@ -0,0 +1,154 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SERVICEINDEX_H
+#define SERVICEINDEX_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QVector>
+
+#include <KService>
+
+/**
+ * An in-memory index of the Application and KCModule services in sycoca.
+ *
+ * The searchable fields of every service are case folded once when the index
+ * is built and all of them are broken up into trigrams, so a query only has to
+ * look at the services which contain all trigrams of the search term instead of
+ * having KServiceTypeTrader parse a query and evaluate it for every service.
+ *
+ * The queries mirror the trader queries the runner used before, returning the
+ * services in the same order. The index is rebuilt lazily on the first query
+ * after invalidate(), which is called whenever sycoca changes. All methods are
+ * thread-safe, as the runner matches in several threads at once.
+ */
+class ServiceIndex
+{
+public:
+    /**
+     * A set of indexed services, which the queries can be restricted to.
+     *
+     * Collecting the services a query matched allows answering a query for a
+     * term that extends the previous term by only looking at those again.
+     * A set becomes meaningless when the index is rebuilt, queries then simply
+     * ignore it.
+     */
+    class Candidates
+    {
+    public:
+        bool isEmpty() const { return entries.isEmpty(); }
+        int count() const { return entries.count(); }
+
+    private:
+        friend class ServiceIndex;
+
+        int generation = -1;
+        // sorted
+        QVector<int> entries;
+    };
+
+    ServiceIndex();
+    ~ServiceIndex();
+
+    /**
+     * Marks the index as outdated, it is rebuilt from sycoca on the next query.
+     */
+    void invalidate();
+
+    /**
+     * Replaces the services the index is built from, instead of querying sycoca.
+     * Services in both lists are also returned twice, just like separate
+     * trader queries for both service types would.
+     */
+    void setServices(const KService::List &applications, const KService::List &kcmodules);
+
+    int count();
+
+    /*
+     * All queries only consider the services in @p within, if given, and add
+     * the services they return to @p hits.
+     */
+
+    /**
+     * @return the applications whose name equals @p term, ignoring case
+     */
+    KService::List exactNameMatches(const QString &term, const Candidates *within = nullptr, Candidates *hits = nullptr);
+
+    /**
+     * @return the applications and KCModules whose name or command contains @p term
+     */
+    KService::List nameOrExecMatches(const QString &term, const Candidates *within = nullptr, Candidates *hits = nullptr);
+
+    /**
+     * @return the applications and KCModules of which one keyword, the generic name,
+     * the name or the comment contains all of the @p words, or whose command
+     * contains the first of them
+     */
+    KService::List fieldMatches(const QVector<QStringRef> &words, const Candidates *within = nullptr, Candidates *hits = nullptr);
+
+    /**
+     * @return the applications with a category containing @p term
+     */
+    KService::List categoryMatches(const QString &term, const Candidates *within = nullptr, Candidates *hits = nullptr);
+
+    /**
+     * @return the displayed applications with an action whose text contains @p term
+     */
+    KService::List actionMatches(const QString &term, const Candidates *within = nullptr, Candidates *hits = nullptr);
+
+private:
+    struct Entry {
+        KService::Ptr service;
+        bool application = false;
+        bool hasExec = false;
+        bool noDisplay = false;
+
+        // case folded
+        QString name;
+        QString genericName;
+        QString comment;
+        QString exec;
+        QStringList keywords;
+        QStringList categories;
+        QStringList actions;
+    };
+
+    void ensureBuilt();
+    void build(const KService::List &applications, const KService::List &kcmodules);
+    void addEntry(const KService::Ptr &service, bool application);
+    void addTrigrams(const QString &text, int entry);
+
+    /**
+     * @return the entries of @p within which might contain @p folded in any
+     * of their fields, in index order
+     */
+    QVector<int> candidates(const QString &folded, const Candidates *within) const;
+    void addHits(Candidates *hits, const QVector<int> &entries) const;
+
+    static bool contains(const QStringList &list, const QString &folded);
+
+    QReadWriteLock m_lock;
+    bool m_valid = false;
+    // increased with every build, to tell whether a Candidates set is current
+    int m_generation = 0;
+
+    QVector<Entry> m_entries;
+    QHash<QString, QVector<int>> m_names;
+    QHash<quint64, QVector<int>> m_trigrams;
+};
+
+#endif
@@ -21,6 +21,7 @@
 #include "servicerunner.h"
 
 #include <QMimeData>
+#include <QMutexLocker>
 
 #include <QDebug>
 #include <QDir>
@@ -32,8 +33,8 @@
 #include <KLocalizedString>
 #include <KRun>
 #include <KService>
-#include <KServiceTypeTrader>
 #include <KStringHandler>
+#include <KSycoca>
 
 #include "debug.h"
 
@@ -51,8 +52,12 @@ int weightedLength(const QString &query) {
 class ServiceFinder
 {
 public:
-    ServiceFinder(ServiceRunner *runner)
+    ServiceFinder(ServiceRunner *runner, ServiceIndex *index,
+                  const ServiceIndex::Candidates *within, ServiceIndex::Candidates *hits)
          : m_runner(runner)
+         , m_index(index)
+         , m_within(within)
+         , m_hits(hits)
     {}
 
 
@@ -134,34 +139,6 @@ private:
         return relevanceIncrement;
     }
 
-    QString generateQuery(QVector<QStringRef> &strList)
-    {
-        QString keywordTemplate = QStringLiteral("exist Keywords");
-        QString genericNameTemplate = QStringLiteral("exist GenericName");
-        QString nameTemplate = QStringLiteral("exist Name");
-        QString commentTemplate = QStringLiteral("exist Comment");
-
-        // Search for applications which are executable and the term case-insensitive matches any of
-        // * a substring of one of the keywords
-        // * a substring of the GenericName field
-        // * a substring of the Name field
-        // Note that before asking for the content of e.g. Keywords and GenericName we need to ask if
-        // they exist to prevent a tree evaluation error if they are not defined.
-        foreach (QStringRef str, strList)
-        {
-            keywordTemplate += QStringLiteral(" and '%1' ~subin Keywords").arg(str.toString());
-            genericNameTemplate += QStringLiteral(" and '%1' ~~ GenericName").arg(str.toString());
-            nameTemplate += QStringLiteral(" and '%1' ~~ Name").arg(str.toString());
-            commentTemplate += QStringLiteral(" and '%1' ~~ Comment").arg(str.toString());
-        }
-
-        QString finalQuery = QStringLiteral("exist Exec and ( (%1) or (%2) or (%3) or ('%4' ~~ Exec) or (%5) )")
-            .arg(keywordTemplate, genericNameTemplate, nameTemplate, strList[0].toString(), commentTemplate);
-
-        qCDebug(RUNNER_SERVICES) << "Final query : " << finalQuery;
-        return finalQuery;
-    }
-
     void setupMatch(const KService::Ptr &service, Plasma::QueryMatch &match)
     {
         const QString name = service->name();
@@ -187,10 +164,7 @@ private:
         }
 
         // Search for applications which are executable and case-insensitively match the search term
-        // See http://techbase.kde.org/Development/Tutorials/Services/Traders#The_KTrader_Query_Language
-        // if the following is unclear to you.
-        query = QStringLiteral("exist Exec and ('%1' =~ Name)").arg(term);
-        KService::List services = KServiceTypeTrader::self()->query(QStringLiteral("Application"), query);
+        KService::List services = m_index->exactNameMatches(term, m_within, m_hits);
 
         if (services.isEmpty()) {
             return;
@@ -215,17 +189,22 @@ private:
         QVector<QStringRef> queryList = term.splitRef(QLatin1Char(' '));
 
         // If the term length is < 3, no real point searching the Keywords and GenericName
+        KService::List services;
         if (weightedTermLength < 3) {
-            query = QStringLiteral("exist Exec and ( (exist Name and '%1' ~~ Name) or ('%1' ~~ Exec) )").arg(term);
+            services = m_index->nameOrExecMatches(term, m_within, m_hits);
         } else {
+            // Search for applications which are executable and each word of the term
+            // case-insensitively matches any of
+            // * a substring of one of the keywords
+            // * a substring of the GenericName field
+            // * a substring of the Name field
+            // * a substring of the Comment field
+            // or the first word is a substring of the Exec field.
             //Match using subsequences (Bug: 262837)
-            query = generateQuery(queryList);
+            services = m_index->fieldMatches(queryList, m_within, m_hits);
         }
 
-        KService::List services = KServiceTypeTrader::self()->query(QStringLiteral("Application"), query);
-        services += KServiceTypeTrader::self()->query(QStringLiteral("KCModule"), query);
-
-        qCDebug(RUNNER_SERVICES) << "got " << services.count() << " services from " << query;
+        qCDebug(RUNNER_SERVICES) << "got " << services.count() << " services for " << term;
         foreach (const KService::Ptr &service, services) {
             if (disqualify(service)) {
                 continue;
@@ -295,8 +274,7 @@ private:
     void matchCategories()
     {
         //search for applications whose categories contains the query
-        query = QStringLiteral("exist Exec and (exist Categories and '%1' ~subin Categories)").arg(term);
-        auto services = KServiceTypeTrader::self()->query(QStringLiteral("Application"), query);
+        const KService::List services = m_index->categoryMatches(term, m_within, m_hits);
 
         foreach (const KService::Ptr &service, services) {
             qCDebug(RUNNER_SERVICES) << service->name() << "is an exact match!" << service->storageId() << service->exec();
@@ -329,14 +307,10 @@ private:
             return;
         }
 
-        query = QStringLiteral("exist Actions"); // doesn't work
-        auto services = KServiceTypeTrader::self()->query(QStringLiteral("Application"));//, query);
+        // only the applications with a matching action, the index skips hidden ones
+        const KService::List services = m_index->actionMatches(term, m_within, m_hits);
 
         foreach (const KService::Ptr &service, services) {
-            if (service->noDisplay()) {
-                continue;
-            }
-
             foreach (const KServiceAction &action, service->actions()) {
                 if (action.text().isEmpty() || action.exec().isEmpty() || hasSeen(action)) {
                     continue;
@@ -372,10 +346,12 @@ private:
     }
 
     ServiceRunner *m_runner;
+    ServiceIndex *m_index;
+    const ServiceIndex::Candidates *m_within;
+    ServiceIndex::Candidates *m_hits;
     QSet<QString> m_seen;
 
     QList<Plasma::QueryMatch> matches;
-    QString query;
     QString term;
     int weightedTermLength;
 };
@@ -389,6 +365,10 @@ ServiceRunner::ServiceRunner(QObject *parent, const QVariantList &args)
     setPriority(AbstractRunner::HighestPriority);
 
     addSyntax(Plasma::RunnerSyntax(QStringLiteral(":q:"), i18n("Finds applications whose name or description match :q:")));
+
+    connect(KSycoca::self(), QOverload<const QStringList &>::of(&KSycoca::databaseChanged), this, &ServiceRunner::sycocaChanged);
+    connect(this, &Plasma::AbstractRunner::prepare, this, &ServiceRunner::resetSession);
+    connect(this, &Plasma::AbstractRunner::teardown, this, &ServiceRunner::resetSession);
 }
 
 ServiceRunner::~ServiceRunner()
@@ -417,10 +397,43 @@ QIcon ServiceRunner::categoryIcon(const QString& category) const
 
 void ServiceRunner::match(Plasma::RunnerContext &context)
 {
+    if (!context.isValid()) {
+        return;
+    }
+
+    const QString term = context.query();
+
+    QString previousTerm;
+    ServiceIndex::Candidates previousCandidates;
+    {
+        QMutexLocker locker(&m_sessionMutex);
+        previousTerm = m_sessionTerm;
+        previousCandidates = m_sessionCandidates;
+    }
+
+    // Every query for a term of three or more characters returns a subset of what it
+    // returned for any shorter start of that term, so while typing only the services
+    // found for the previous term need to be looked at again.
+    const bool refine = !previousTerm.isEmpty() && term.startsWith(previousTerm)
+                        && weightedLength(previousTerm) >= 3;
+
+    ServiceIndex::Candidates candidates;
+
     // This helper class aids in keeping state across numerous
     // different queries that together form the matches set.
-    ServiceFinder finder(this);
+    ServiceFinder finder(this, &m_index, refine ? &previousCandidates : nullptr, &candidates);
     finder.match(context);
+
+    QMutexLocker locker(&m_sessionMutex);
+    m_sessionTerm = term;
+    m_sessionCandidates = candidates;
+}
+
+void ServiceRunner::resetSession()
+{
+    QMutexLocker locker(&m_sessionMutex);
+    m_sessionTerm.clear();
+    m_sessionCandidates = ServiceIndex::Candidates();
 }
 
 void ServiceRunner::run(const Plasma::RunnerContext &context, const Plasma::QueryMatch &match)
@@ -442,6 +455,14 @@ void ServiceRunner::run(const Plasma::RunnerContext &context, const Plasma::Quer
     }
 }
 
+void ServiceRunner::sycocaChanged(const QStringList &changedResources)
+{
+    if (changedResources.contains(QLatin1String("services")) || changedResources.contains(QLatin1String("apps"))
+            || changedResources.contains(QLatin1String("xdgdata-apps"))) {
+        m_index.invalidate();
+    }
+}
+
 QMimeData * ServiceRunner::mimeDataForMatch(const Plasma::QueryMatch &match)
 {
     KService::Ptr service = KService::serviceByStorageId(match.data().toString());
@@ -20,11 +20,15 @@
 #define SERVICERUNNER_H
 
 
+#include <QMutex>
+
 #include <KService>
 
 //#include <KRunner/AbstractRunner>
 #include <krunner/abstractrunner.h>
 
+#include "serviceindex.h"
+
 /**
  * This class looks for matches in the set of .desktop files installed by
  * applications. This way the user can type exactly what they see in the
@@ -50,6 +54,18 @@ class ServiceRunner : public Plasma::AbstractRunner
 
     protected:
         void setupMatch(const KService::Ptr &service, Plasma::QueryMatch &action);
+
+    private Q_SLOTS:
+        void sycocaChanged(const QStringList &changedResources);
+        void resetSession();
+
+    private:
+        ServiceIndex m_index;
+
+        // the last term of the current match session and what was found for it
+        QMutex m_sessionMutex;
+        QString m_sessionTerm;
+        ServiceIndex::Candidates m_sessionCandidates;
 };
 
 
@@ -24,7 +24,9 @@
 
 #include <QDebug>
 #include <QIcon>
+#include <QIconEngine>
 #include <QMutexLocker>
+#include <QPainter>
 #include <KWindowSystem>
 #include <KLocalizedString>
 
@@ -35,10 +37,64 @@
 
 K_EXPORT_PLASMA_RUNNER(windows, WindowsRunner)
 
+// the properties the runner looks at, changes to others do not need the window to be fetched again
+static const NET::Properties s_windowInfoProperties = NET::WMWindowType | NET::WMDesktop | NET::WMState |
+                                                      NET::XAWMState | NET::WMName;
+static const NET::Properties2 s_windowInfoProperties2 = NET::WM2WindowClass | NET::WM2WindowRole | NET::WM2AllowedActions;
+
+/**
+ * Provides the icon of a window, which is only fetched from the window system
+ * once it is painted for the first time, in the main thread. Most windows
+ * found while typing never end up being shown.
+ */
+class WindowIconEngine : public QIconEngine
+{
+public:
+    explicit WindowIconEngine(WId window)
+        : m_window(window)
+    {
+    }
+
+    void paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state) override
+    {
+        painter->drawPixmap(rect, pixmap(rect.size(), mode, state));
+    }
+
+    QPixmap pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state) override
+    {
+        return icon().pixmap(size, mode, state);
+    }
+
+    QSize actualSize(const QSize &size, QIcon::Mode mode, QIcon::State state) override
+    {
+        return icon().actualSize(size, mode, state);
+    }
+
+    QIconEngine *clone() const override
+    {
+        return new WindowIconEngine(m_window);
+    }
+
+private:
+    QIcon icon()
+    {
+        if (!m_fetched) {
+            m_icon = QIcon(KWindowSystem::icon(m_window));
+            m_fetched = true;
+        }
+        return m_icon;
+    }
+
+    WId const m_window;
+    bool m_fetched = false;
+    QIcon m_icon;
+};
+
 WindowsRunner::WindowsRunner(QObject* parent, const QVariantList& args)
     : AbstractRunner(parent, args),
       m_inSession(false),
-      m_ready(false)
+      m_ready(false),
+      m_windowsKnown(false)
 {
     Q_UNUSED(args)
     setObjectName( QLatin1String("Windows") );
@@ -61,6 +117,13 @@ WindowsRunner::WindowsRunner(QObject* parent, const QVariantList& args)
 
     connect(this, &Plasma::AbstractRunner::prepare, this, &WindowsRunner::prepareForMatchSession);
     connect(this, &Plasma::AbstractRunner::teardown, this, &WindowsRunner::matchSessionComplete);
+
+    // the windows are kept between sessions, only changed ones are fetched again
+    connect(KWindowSystem::self(), &KWindowSystem::windowAdded, this, &WindowsRunner::windowAdded);
+    connect(KWindowSystem::self(), &KWindowSystem::windowRemoved, this, &WindowsRunner::windowRemoved);
+    connect(KWindowSystem::self(),
+            static_cast<void (KWindowSystem::*)(WId, NET::Properties, NET::Properties2)>(&KWindowSystem::windowChanged),
+            this, &WindowsRunner::windowChanged);
 }
 
 WindowsRunner::~WindowsRunner()
@@ -75,27 +138,36 @@ void WindowsRunner::gatherInfo()
         return;
     }
 
-    foreach (const WId w, KWindowSystem::windows()) {
-        KWindowInfo info(w, NET::WMWindowType | NET::WMDesktop |
-                                                        NET::WMState | NET::XAWMState |
-                                                        NET::WMName,
-                                                    NET::WM2WindowClass | NET::WM2WindowRole | NET::WM2AllowedActions);
-        if (info.valid()) {
-            // ignore NET::Tool and other special window types
-            NET::WindowType wType = info.windowType(NET::NormalMask | NET::DesktopMask | NET::DockMask |
-                                                    NET::ToolbarMask | NET::MenuMask | NET::DialogMask |
-                                                    NET::OverrideMask | NET::TopMenuMask |
-                                                    NET::UtilityMask | NET::SplashMask);
-
-            if (wType != NET::Normal && wType != NET::Override && wType != NET::Unknown &&
-                wType != NET::Dialog && wType != NET::Utility) {
-                continue;
-            }
-            m_windows.insert(w, info);
-            m_icons.insert(w, QIcon(KWindowSystem::icon(w)));
+    if (!m_windowsKnown) {
+        foreach (const WId w, KWindowSystem::windows()) {
+            m_dirtyWindows.insert(w);
         }
+        m_windowsKnown = true;
     }
 
+    // only the windows which appeared or changed since the last session
+    foreach (const WId w, m_dirtyWindows) {
+        KWindowInfo info(w, s_windowInfoProperties, s_windowInfoProperties2);
+        if (!info.valid()) {
+            m_windows.remove(w);
+            continue;
+        }
+
+        // ignore NET::Tool and other special window types
+        NET::WindowType wType = info.windowType(NET::NormalMask | NET::DesktopMask | NET::DockMask |
+                                                NET::ToolbarMask | NET::MenuMask | NET::DialogMask |
+                                                NET::OverrideMask | NET::TopMenuMask |
+                                                NET::UtilityMask | NET::SplashMask);
+
+        if (wType != NET::Normal && wType != NET::Override && wType != NET::Unknown &&
+            wType != NET::Dialog && wType != NET::Utility) {
+            m_windows.remove(w);
+            continue;
+        }
+        m_windows.insert(w, info);
+    }
+    m_dirtyWindows.clear();
+
     for (int i=1; i<=KWindowSystem::numberOfDesktops(); i++) {
         m_desktopNames << KWindowSystem::desktopName(i);
     }
@@ -119,8 +191,34 @@ void WindowsRunner::matchSessionComplete()
     m_inSession = false;
     m_ready = false;
     m_desktopNames.clear();
-    m_icons.clear();
-    m_windows.clear();
+}
+
+// Called in the main thread
+void WindowsRunner::windowAdded(WId window)
+{
+    QMutexLocker locker(&m_mutex);
+    m_dirtyWindows.insert(window);
+}
+
+// Called in the main thread
+void WindowsRunner::windowRemoved(WId window)
+{
+    QMutexLocker locker(&m_mutex);
+    m_dirtyWindows.remove(window);
+    m_windows.remove(window);
+    m_icons.remove(window);
+}
+
+// Called in the main thread
+void WindowsRunner::windowChanged(WId window, NET::Properties properties, NET::Properties2 properties2)
+{
+    QMutexLocker locker(&m_mutex);
+    if (properties & NET::WMIcon) {
+        m_icons.remove(window);
+    }
+    if ((properties & s_windowInfoProperties) || (properties2 & s_windowInfoProperties2)) {
+        m_dirtyWindows.insert(window);
+    }
 }
 
 // Called in the secondary thread
@@ -337,8 +435,7 @@ void WindowsRunner::run(const Plasma::RunnerContext& context, const Plasma::Quer
     WindowAction action = WindowAction(parts[0].toInt());
     WId w(parts[1].toULong());
 
-    KWindowInfo info(w, NET::WMWindowType | NET::WMDesktop | NET::WMState | NET::XAWMState | NET::WMName,
-                     NET::WM2WindowClass | NET::WM2WindowRole | NET::WM2AllowedActions);
+    KWindowInfo info(w, s_windowInfoProperties, s_windowInfoProperties2);
     if (!info.valid()) {
         return;
     }
@@ -422,7 +519,7 @@ Plasma::QueryMatch WindowsRunner::windowMatch(const KWindowInfo& info, WindowAct
     Plasma::QueryMatch match(this);
     match.setType(type);
     match.setData(QString(QString::number((int)action) + QLatin1Char('_') + QString::number(info.win())));
-    match.setIcon(m_icons[info.win()]);
+    match.setIcon(windowIcon(info.win()));
     match.setText(info.name());
     QString desktopName;
     int desktop = info.desktop();
@@ -465,6 +562,15 @@ Plasma::QueryMatch WindowsRunner::windowMatch(const KWindowInfo& info, WindowAct
     return match;
 }
 
+QIcon WindowsRunner::windowIcon(WId window)
+{
+    auto it = m_icons.find(window);
+    if (it == m_icons.end()) {
+        it = m_icons.insert(window, QIcon(new WindowIconEngine(window)));
+    }
+    return *it;
+}
+
 bool WindowsRunner::actionSupported(const KWindowInfo& info, WindowAction action)
 {
     switch (action) {
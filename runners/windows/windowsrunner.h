@@ -21,7 +21,11 @@
 
 #include <KRunner/AbstractRunner>
 
+#include <QIcon>
 #include <QMutex>
+#include <QSet>
+
+#include <netwm_def.h>
 
 class KWindowInfo;
 
@@ -40,6 +44,9 @@ class WindowsRunner : public Plasma::AbstractRunner
         void prepareForMatchSession();
         void matchSessionComplete();
         void gatherInfo();
+        void windowAdded(WId window);
+        void windowRemoved(WId window);
+        void windowChanged(WId window, NET::Properties properties, NET::Properties2 properties2);
 
     private:
         enum WindowAction {
@@ -56,14 +63,17 @@ class WindowsRunner : public Plasma::AbstractRunner
         Plasma::QueryMatch windowMatch(const KWindowInfo& info, WindowAction action, qreal relevance = 1.0,
                                        Plasma::QueryMatch::Type type = Plasma::QueryMatch::ExactMatch);
         bool actionSupported(const KWindowInfo& info, WindowAction action);
+        QIcon windowIcon(WId window);
 
         QHash<WId, KWindowInfo> m_windows; // protected by m_mutex
-        QHash<WId, QIcon> m_icons; // protected by m_mutex
+        QSet<WId> m_dirtyWindows; // windows to fetch again, protected by m_mutex
+        QHash<WId, QIcon> m_icons; // fetched when painted, protected by m_mutex
         QStringList m_desktopNames; // protected by m_mutex
         QMutex m_mutex;
 
         bool m_inSession : 1; // only used in the main thread
         bool m_ready : 1; // protected by m_mutex
+        bool m_windowsKnown : 1; // protected by m_mutex
 };
 
 #endif // WINDOWSRUNNER_H
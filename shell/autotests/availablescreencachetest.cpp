@@ -0,0 +1,271 @@
+/********************************************************************
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include <QObject>
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include "../availablescreencache.h"
+
+static const int s_screenCount = 8;
+static const int s_panelsPerScreen = 8;
+
+class AvailableScreenCacheTest : public QObject
+{
+Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void testValues();
+    void testCoalescing();
+    void testOnlyChangedScreens();
+    void testNoChange();
+    void testValuesWhileInvalid();
+    void testScreenRemoved();
+
+private:
+    enum Edge { Left, Right, Top, Bottom };
+
+    struct Panel {
+        int screen;
+        Edge edge;
+        int thickness;
+    };
+
+    QRect screenGeometry(int screen) const;
+    QRect rect(int screen);
+    QRegion region(int screen);
+    QRegion expectedRegion(int screen) const;
+
+    QList<int> m_screens;
+    QList<Panel> m_panels;
+    int m_rectComputations = 0;
+    int m_regionComputations = 0;
+    AvailableScreenCache *m_cache = nullptr;
+};
+
+QRect AvailableScreenCacheTest::screenGeometry(int screen) const
+{
+    return QRect(screen * 1920, 0, 1920, 1080);
+}
+
+QRect AvailableScreenCacheTest::rect(int screen)
+{
+    ++m_rectComputations;
+
+    QRect r = screenGeometry(screen);
+    for (const Panel &panel : qAsConst(m_panels)) {
+        if (panel.screen != screen) {
+            continue;
+        }
+
+        switch (panel.edge) {
+        case Left:
+            r.setLeft(r.left() + panel.thickness);
+            break;
+        case Right:
+            r.setRight(r.right() - panel.thickness);
+            break;
+        case Top:
+            r.setTop(r.top() + panel.thickness);
+            break;
+        case Bottom:
+            r.setBottom(r.bottom() - panel.thickness);
+            break;
+        }
+    }
+    return r;
+}
+
+QRegion AvailableScreenCacheTest::region(int screen)
+{
+    ++m_regionComputations;
+
+    return expectedRegion(screen);
+}
+
+QRegion AvailableScreenCacheTest::expectedRegion(int screen) const
+{
+    const QRect geometry = screenGeometry(screen);
+
+    QRegion r = geometry;
+    for (const Panel &panel : m_panels) {
+        if (panel.screen != screen) {
+            continue;
+        }
+
+        switch (panel.edge) {
+        case Left:
+            r -= QRect(geometry.left(), geometry.top(), panel.thickness, 200);
+            break;
+        case Right:
+            r -= QRect(geometry.right() - panel.thickness + 1, geometry.top(), panel.thickness, 200);
+            break;
+        case Top:
+            r -= QRect(geometry.left(), geometry.top(), 200, panel.thickness);
+            break;
+        case Bottom:
+            r -= QRect(geometry.left(), geometry.bottom() - panel.thickness + 1, 200, panel.thickness);
+            break;
+        }
+    }
+    return r;
+}
+
+void AvailableScreenCacheTest::init()
+{
+    m_screens.clear();
+    m_panels.clear();
+
+    for (int screen = 0; screen < s_screenCount; ++screen) {
+        m_screens << screen;
+
+        for (int i = 0; i < s_panelsPerScreen; ++i) {
+            m_panels << Panel{screen, Edge(i % 4), 20 + i};
+        }
+    }
+
+    m_cache = new AvailableScreenCache(
+        [this]() { return m_screens; },
+        [this](int screen) { return rect(screen); },
+        [this](int screen) { return region(screen); });
+
+    m_cache->invalidate();
+    QCoreApplication::processEvents();
+
+    QCOMPARE(m_cache->recomputations(), 1);
+
+    m_rectComputations = 0;
+    m_regionComputations = 0;
+}
+
+void AvailableScreenCacheTest::cleanup()
+{
+    delete m_cache;
+    m_cache = nullptr;
+}
+
+void AvailableScreenCacheTest::testValues()
+{
+    for (int screen : qAsConst(m_screens)) {
+        // two panels on each edge, 20 + 24, 21 + 25, ...
+        QCOMPARE(m_cache->availableScreenRect(screen), QRect(screen * 1920 + 44, 48, 1920 - 44 - 46, 1080 - 48 - 50));
+        QCOMPARE(m_cache->availableScreenRegion(screen), expectedRegion(screen));
+    }
+
+    // all of it came from the cache
+    QCOMPARE(m_rectComputations, 0);
+    QCOMPARE(m_regionComputations, 0);
+}
+
+void AvailableScreenCacheTest::testCoalescing()
+{
+    QSignalSpy rectsSpy(m_cache, &AvailableScreenCache::availableScreenRectsChanged);
+    QSignalSpy regionsSpy(m_cache, &AvailableScreenCache::availableScreenRegionsChanged);
+
+    // every panel changes, which used to mean each of them notifying every containment
+    for (Panel &panel : m_panels) {
+        panel.thickness += 2;
+        m_cache->invalidate();
+    }
+
+    QCOMPARE(m_cache->recomputations(), 1);
+    QCoreApplication::processEvents();
+
+    QCOMPARE(m_cache->recomputations(), 2);
+    QCOMPARE(m_rectComputations, s_screenCount);
+    QCOMPARE(m_regionComputations, s_screenCount);
+    QCOMPARE(rectsSpy.count(), 1);
+    QCOMPARE(regionsSpy.count(), 1);
+}
+
+void AvailableScreenCacheTest::testOnlyChangedScreens()
+{
+    QSignalSpy rectSpy(m_cache, &AvailableScreenCache::availableScreenRectChanged);
+    QSignalSpy regionSpy(m_cache, &AvailableScreenCache::availableScreenRegionChanged);
+    QSignalSpy rectsSpy(m_cache, &AvailableScreenCache::availableScreenRectsChanged);
+
+    for (Panel &panel : m_panels) {
+        if (panel.screen == 3) {
+            panel.thickness += 10;
+            m_cache->invalidate();
+        }
+    }
+    QCoreApplication::processEvents();
+
+    QCOMPARE(m_cache->recomputations(), 2);
+    QCOMPARE(rectSpy.count(), 1);
+    QCOMPARE(rectSpy.first().first().toInt(), 3);
+    QCOMPARE(regionSpy.count(), 1);
+    QCOMPARE(regionSpy.first().first().toInt(), 3);
+    QCOMPARE(rectsSpy.count(), 1);
+    QCOMPARE(m_cache->availableScreenRegion(3), expectedRegion(3));
+}
+
+void AvailableScreenCacheTest::testNoChange()
+{
+    QSignalSpy rectSpy(m_cache, &AvailableScreenCache::availableScreenRectChanged);
+    QSignalSpy rectsSpy(m_cache, &AvailableScreenCache::availableScreenRectsChanged);
+    QSignalSpy regionsSpy(m_cache, &AvailableScreenCache::availableScreenRegionsChanged);
+
+    // e.g. a panel which got shown again at the same place
+    m_cache->invalidate();
+    m_cache->invalidate();
+    QCoreApplication::processEvents();
+
+    QCOMPARE(m_cache->recomputations(), 2);
+    QCOMPARE(rectSpy.count(), 0);
+    QCOMPARE(rectsSpy.count(), 0);
+    QCOMPARE(regionsSpy.count(), 0);
+}
+
+void AvailableScreenCacheTest::testValuesWhileInvalid()
+{
+    m_panels.first().thickness += 100;
+    m_cache->invalidate();
+
+    // asked before the recomputation, the value is computed on the spot
+    QCOMPARE(m_cache->availableScreenRect(0).left(), 144);
+    QCOMPARE(m_rectComputations, 1);
+
+    QCoreApplication::processEvents();
+
+    QCOMPARE(m_cache->availableScreenRect(0).left(), 144);
+    QCOMPARE(m_rectComputations, 1 + s_screenCount);
+}
+
+void AvailableScreenCacheTest::testScreenRemoved()
+{
+    QSignalSpy rectSpy(m_cache, &AvailableScreenCache::availableScreenRectChanged);
+    QSignalSpy rectsSpy(m_cache, &AvailableScreenCache::availableScreenRectsChanged);
+
+    m_screens.removeLast();
+    m_cache->invalidate();
+    QCoreApplication::processEvents();
+
+    // nothing to tell about a single screen, but the overall state changed
+    QCOMPARE(rectSpy.count(), 0);
+    QCOMPARE(rectsSpy.count(), 1);
+}
+
+QTEST_MAIN(AvailableScreenCacheTest)
+
+#include "availablescreencachetest.moc"
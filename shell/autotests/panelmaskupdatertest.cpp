@@ -0,0 +1,155 @@
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QObject>
+
+#include <QElapsedTimer>
+#include <QTest>
+
+#include "../panelmaskupdater.h"
+
+static const int s_resizeSteps = 50;
+
+class PanelMaskUpdaterTest : public QObject
+{
+Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void testResize();
+    void testNoChange();
+    void testChanges();
+    void testInvalidate();
+
+private:
+    PanelMaskUpdater::Mask m_mask;
+    QList<PanelMaskUpdater::Mask> m_sent;
+    PanelMaskUpdater *m_updater = nullptr;
+};
+
+void PanelMaskUpdaterTest::init()
+{
+    m_mask = PanelMaskUpdater::Mask();
+    m_mask.window = 1;
+    m_mask.background = true;
+    m_mask.compositing = true;
+    m_mask.region = QRegion(0, 0, 100, 30);
+
+    m_sent.clear();
+
+    m_updater = new PanelMaskUpdater([this]() { return m_mask; },
+                                     [this](const PanelMaskUpdater::Mask &mask) { m_sent << mask; });
+}
+
+void PanelMaskUpdaterTest::cleanup()
+{
+    delete m_updater;
+    m_updater = nullptr;
+}
+
+void PanelMaskUpdaterTest::testResize()
+{
+    // long enough for all steps to happen within one interval
+    m_updater->setInterval(500);
+
+    // a panel growing step by step, with the event loop running in between
+    // as it does for each frame of an animation
+    for (int i = 1; i <= s_resizeSteps; ++i) {
+        m_mask.region = QRegion(0, 0, 100 + i * 10, 30);
+        m_updater->update();
+        QCoreApplication::processEvents();
+    }
+
+    QVERIFY(m_sent.isEmpty());
+
+    QTRY_COMPARE(m_updater->sentUpdates(), 1);
+    QCOMPARE(m_sent.count(), 1);
+    QCOMPARE(m_sent.last().region, QRegion(0, 0, 100 + s_resizeSteps * 10, 30));
+
+    // a steady stream of updates is sent once per interval, not once per step
+    m_updater->setInterval(20);
+
+    QElapsedTimer timer;
+    timer.start();
+    int steps = 0;
+    while (timer.elapsed() < 200) {
+        ++steps;
+        m_mask.region = QRegion(0, 0, 100, 30 + steps);
+        m_updater->update();
+        QTest::qWait(1);
+    }
+
+    QTRY_COMPARE(m_sent.last().region, QRegion(0, 0, 100, 30 + steps));
+
+    // the updates were sent while the panel was being resized, but at most
+    // once for each interval that passed
+    const int streamUpdates = m_updater->sentUpdates() - 1;
+    QVERIFY(streamUpdates > 2);
+    QVERIFY(streamUpdates <= timer.elapsed() / m_updater->interval() + 1);
+}
+
+void PanelMaskUpdaterTest::testNoChange()
+{
+    m_updater->update();
+    QTRY_COMPARE(m_updater->sentUpdates(), 1);
+
+    m_updater->update();
+    QTest::qWait(m_updater->interval() * 3);
+
+    QCOMPARE(m_updater->sentUpdates(), 1);
+    QCOMPARE(m_sent.count(), 1);
+}
+
+void PanelMaskUpdaterTest::testChanges()
+{
+    m_updater->update();
+    QTRY_COMPARE(m_updater->sentUpdates(), 1);
+
+    // a new window
+    m_mask.window = 2;
+    m_updater->update();
+    QTRY_COMPARE(m_updater->sentUpdates(), 2);
+    QCOMPARE(m_sent.last().window, WId(2));
+
+    m_mask.compositing = false;
+    m_updater->update();
+    QTRY_COMPARE(m_updater->sentUpdates(), 3);
+    QCOMPARE(m_sent.last().compositing, false);
+
+    m_mask.background = false;
+    m_mask.region = QRegion();
+    m_updater->update();
+    QTRY_COMPARE(m_updater->sentUpdates(), 4);
+    QCOMPARE(m_sent.last().background, false);
+}
+
+void PanelMaskUpdaterTest::testInvalidate()
+{
+    m_updater->update();
+    QTRY_COMPARE(m_updater->sentUpdates(), 1);
+
+    // e.g. the panel was shown again, the same mask has to be sent again
+    m_updater->invalidate();
+    QTRY_COMPARE(m_updater->sentUpdates(), 2);
+    QCOMPARE(m_sent.count(), 2);
+    QCOMPARE(m_sent.at(0), m_sent.at(1));
+}
+
+QTEST_MAIN(PanelMaskUpdaterTest)
+
+#include "panelmaskupdatertest.moc"
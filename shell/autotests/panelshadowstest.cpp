@@ -0,0 +1,191 @@
+/********************************************************************
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include <QObject>
+
+#include <QSet>
+#include <QTest>
+#include <QWindow>
+#include <QX11Info>
+
+#include <KWindowSystem>
+
+#include <xcb/xcb.h>
+
+#include "../panelshadows_p.h"
+
+// the property holds 8 pixmaps followed by 4 margins
+static const int s_pixmapCount = 8;
+// the 8 shadow tiles and 7 empty ones for missing borders
+static const int s_maxSharedPixmaps = 15;
+static const int s_windowCount = 40;
+
+class PanelShadowsTest : public QObject
+{
+Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testSharedPixmaps();
+    void testEnabledBorders();
+    void testThemeChange();
+
+private:
+    QVector<quint32> shadowProperty(const QWindow *window) const;
+    QSet<quint32> pixmapsInUse() const;
+
+    QList<QWindow *> m_windows;
+};
+
+static Plasma::FrameSvg::EnabledBorders bordersFor(int window)
+{
+    // what panels on each of the edges and free floating dialogs use
+    static const Plasma::FrameSvg::EnabledBorders borders[] = {
+        Plasma::FrameSvg::AllBorders,
+        Plasma::FrameSvg::TopBorder,
+        Plasma::FrameSvg::BottomBorder,
+        Plasma::FrameSvg::LeftBorder,
+        Plasma::FrameSvg::RightBorder,
+        Plasma::FrameSvg::TopBorder | Plasma::FrameSvg::LeftBorder | Plasma::FrameSvg::RightBorder,
+    };
+    return borders[window % (sizeof(borders) / sizeof(borders[0]))];
+}
+
+QVector<quint32> PanelShadowsTest::shadowProperty(const QWindow *window) const
+{
+    xcb_connection_t *c = QX11Info::connection();
+
+    const QByteArray name = QByteArrayLiteral("_KDE_NET_WM_SHADOW");
+    xcb_intern_atom_reply_t *atom = xcb_intern_atom_reply(c, xcb_intern_atom(c, false, name.length(), name.constData()), nullptr);
+    if (!atom) {
+        return {};
+    }
+
+    xcb_get_property_reply_t *reply = xcb_get_property_reply(c,
+        xcb_get_property(c, false, window->winId(), atom->atom, XCB_ATOM_CARDINAL, 0, 12), nullptr);
+    free(atom);
+    if (!reply) {
+        return {};
+    }
+
+    QVector<quint32> values;
+    const quint32 *data = reinterpret_cast<const quint32 *>(xcb_get_property_value(reply));
+    for (int i = 0; i < xcb_get_property_value_length(reply) / 4; ++i) {
+        values << data[i];
+    }
+    free(reply);
+
+    return values;
+}
+
+QSet<quint32> PanelShadowsTest::pixmapsInUse() const
+{
+    QSet<quint32> pixmaps;
+    for (const QWindow *window : m_windows) {
+        const QVector<quint32> property = shadowProperty(window);
+        for (int i = 0; i < qMin(property.count(), s_pixmapCount); ++i) {
+            pixmaps.insert(property.at(i));
+        }
+    }
+    return pixmaps;
+}
+
+void PanelShadowsTest::initTestCase()
+{
+    if (!KWindowSystem::isPlatformX11()) {
+        QSKIP("The shadow pixmaps are only shared on X11");
+    }
+    if (!PanelShadows::self()->hasElement(QStringLiteral("shadow-left"))) {
+        QSKIP("The theme has no shadows");
+    }
+
+    for (int i = 0; i < s_windowCount; ++i) {
+        QWindow *window = new QWindow;
+        window->create();
+        m_windows << window;
+
+        PanelShadows::self()->addWindow(window, bordersFor(i));
+    }
+}
+
+void PanelShadowsTest::cleanupTestCase()
+{
+    for (QWindow *window : qAsConst(m_windows)) {
+        PanelShadows::self()->removeWindow(window);
+    }
+    qDeleteAll(m_windows);
+    m_windows.clear();
+}
+
+void PanelShadowsTest::testSharedPixmaps()
+{
+    // each pixmap is one upload of a tile, which no longer depends on the number of windows
+    const QSet<quint32> pixmaps = pixmapsInUse();
+    QVERIFY(!pixmaps.isEmpty());
+    QVERIFY(pixmaps.count() <= s_maxSharedPixmaps);
+
+    for (int i = 0; i < m_windows.count(); ++i) {
+        QCOMPARE(shadowProperty(m_windows.at(i)).count(), s_pixmapCount + 4);
+        // windows with the same borders have the very same shadow
+        QCOMPARE(shadowProperty(m_windows.at(i)), shadowProperty(m_windows.at(i % 6)));
+    }
+}
+
+void PanelShadowsTest::testEnabledBorders()
+{
+    const QSet<quint32> pixmaps = pixmapsInUse();
+    QWindow *window = m_windows.first();
+    const QVector<quint32> before = shadowProperty(window);
+
+    PanelShadows::self()->setEnabledBorders(window, bordersFor(0));
+    QCOMPARE(shadowProperty(window), before);
+
+    PanelShadows::self()->setEnabledBorders(window, bordersFor(1));
+    QCOMPARE(shadowProperty(window), shadowProperty(m_windows.at(1)));
+
+    // switching borders only combines the existing pixmaps differently
+    QCOMPARE(pixmapsInUse(), pixmaps);
+
+    PanelShadows::self()->setEnabledBorders(window, bordersFor(0));
+    QCOMPARE(shadowProperty(window), before);
+}
+
+void PanelShadowsTest::testThemeChange()
+{
+    for (int i = 0; i < 3; ++i) {
+        PanelShadows::self()->setImagePath(i % 2 ? QStringLiteral("widgets/panel-background")
+                                                 : QStringLiteral("dialogs/background"));
+        QCoreApplication::processEvents();
+
+        if (!PanelShadows::self()->hasElement(QStringLiteral("shadow-left"))) {
+            continue;
+        }
+
+        // the old pixmaps are freed and one new set is shared again
+        QVERIFY(pixmapsInUse().count() <= s_maxSharedPixmaps);
+    }
+
+    PanelShadows::self()->setImagePath(QStringLiteral("widgets/panel-background"));
+    QCoreApplication::processEvents();
+}
+
+QTEST_MAIN(PanelShadowsTest)
+
+#include "panelshadowstest.moc"
@@ -0,0 +1,151 @@
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QObject>
+
+#include <QLoggingCategory>
+#include <QTest>
+
+#include <Plasma/Applet>
+#include <Plasma/Containment>
+#include <Plasma/Corona>
+
+#include "../startupprofiler.h"
+
+static QStringList s_messages;
+
+static void collectMessage(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    Q_UNUSED(type)
+
+    if (qstrcmp(context.category, "kde.plasmashell.startup") == 0) {
+        s_messages << message;
+    }
+}
+
+class TestCorona : public Plasma::Corona
+{
+    Q_OBJECT
+public:
+    explicit TestCorona(QObject *parent = nullptr)
+        : Plasma::Corona(parent)
+    {
+    }
+
+    QRect screenGeometry(int id) const override
+    {
+        Q_UNUSED(id)
+        return QRect(0, 0, 1024, 768);
+    }
+};
+
+class StartupProfilerTest : public QObject
+{
+Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testStages();
+    void testAdditions();
+    void testViews();
+
+private:
+    QtMessageHandler m_previousHandler = nullptr;
+};
+
+void StartupProfilerTest::initTestCase()
+{
+    QLoggingCategory::setFilterRules(QStringLiteral("kde.plasmashell.startup.debug=true"));
+}
+
+void StartupProfilerTest::init()
+{
+    s_messages.clear();
+    m_previousHandler = qInstallMessageHandler(collectMessage);
+}
+
+void StartupProfilerTest::cleanup()
+{
+    qInstallMessageHandler(m_previousHandler);
+}
+
+void StartupProfilerTest::testStages()
+{
+    TestCorona corona;
+    StartupProfiler *profiler = new StartupProfiler(&corona);
+
+    profiler->beginStage(QStringLiteral("first"));
+    profiler->beginStage(QStringLiteral("second"));
+    profiler->endStage();
+    // there is no stage left to end
+    profiler->endStage();
+    profiler->mark(QStringLiteral("Done"));
+
+    QCOMPARE(s_messages.count(), 3);
+    QVERIFY(s_messages.at(0).startsWith(QLatin1String("Stage \"first\" took")));
+    QVERIFY(s_messages.at(1).startsWith(QLatin1String("Stage \"second\" took")));
+    QVERIFY(s_messages.at(2).startsWith(QLatin1String("\"Done\" after")));
+}
+
+void StartupProfilerTest::testAdditions()
+{
+    TestCorona corona;
+    StartupProfiler *profiler = new StartupProfiler(&corona);
+
+    // nothing is logged outside of a stage
+    Plasma::Containment *before = corona.createContainment(QString());
+    QVERIFY(before);
+    before->createApplet(QStringLiteral("org.kde.test.nonexistent"));
+    QVERIFY(s_messages.isEmpty());
+
+    profiler->beginStage(QStringLiteral("layout"));
+
+    Plasma::Containment *containment = corona.createContainment(QString());
+    QVERIFY(containment);
+    Plasma::Applet *applet = containment->createApplet(QStringLiteral("org.kde.test.nonexistent"));
+    QVERIFY(applet);
+
+    profiler->endStage();
+
+    QCOMPARE(s_messages.count(), 3);
+    QVERIFY(s_messages.at(0).startsWith(QLatin1String("Containment")));
+    QVERIFY(s_messages.at(0).contains(QLatin1String("after the previous containment or applet")));
+    QVERIFY(s_messages.at(1).startsWith(QLatin1String("Applet")));
+    QVERIFY(s_messages.at(1).contains(QStringLiteral("in containment %1 added").arg(containment->id())));
+    QVERIFY(s_messages.at(1).contains(QLatin1String("after the previous containment or applet")));
+    QVERIFY(s_messages.at(2).startsWith(QLatin1String("Stage \"layout\" took")));
+}
+
+void StartupProfilerTest::testViews()
+{
+    TestCorona corona;
+    StartupProfiler *profiler = new StartupProfiler(&corona);
+
+    profiler->viewCreated(QStringLiteral("Desktop"), QStringLiteral("DP-1"), 12);
+    profiler->viewCreated(QStringLiteral("Panel"), QStringLiteral("HDMI-1"), 3);
+
+    QCOMPARE(s_messages, QStringList({
+        QStringLiteral("\"Desktop\" view of screen \"DP-1\" created in 12 ms"),
+        QStringLiteral("\"Panel\" view of screen \"HDMI-1\" created in 3 ms")
+    }));
+}
+
+QTEST_MAIN(StartupProfilerTest)
+
+#include "startupprofilertest.moc"
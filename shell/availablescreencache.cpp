@@ -0,0 +1,115 @@
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "availablescreencache.h"
+
+AvailableScreenCache::AvailableScreenCache(const ScreensFunction &screens, const RectFunction &rect,
+                                           const RegionFunction &region, QObject *parent)
+    : QObject(parent)
+    , m_screens(screens)
+    , m_rect(rect)
+    , m_region(region)
+{
+    m_recomputeTimer.setSingleShot(true);
+    m_recomputeTimer.setInterval(0);
+    connect(&m_recomputeTimer, &QTimer::timeout, this, &AvailableScreenCache::recompute);
+}
+
+QRect AvailableScreenCache::availableScreenRect(int screen) const
+{
+    if (m_valid) {
+        const auto it = m_rects.constFind(screen);
+        if (it != m_rects.constEnd()) {
+            return *it;
+        }
+    }
+
+    return m_rect(screen);
+}
+
+QRegion AvailableScreenCache::availableScreenRegion(int screen) const
+{
+    if (m_valid) {
+        const auto it = m_regions.constFind(screen);
+        if (it != m_regions.constEnd()) {
+            return *it;
+        }
+    }
+
+    return m_region(screen);
+}
+
+void AvailableScreenCache::invalidate()
+{
+    m_valid = false;
+    m_recomputeTimer.start();
+}
+
+int AvailableScreenCache::recomputations() const
+{
+    return m_recomputations;
+}
+
+void AvailableScreenCache::recompute()
+{
+    ++m_recomputations;
+
+    QHash<int, QRect> rects;
+    QHash<int, QRegion> regions;
+
+    const QList<int> screens = m_screens();
+    for (int screen : screens) {
+        rects.insert(screen, m_rect(screen));
+        regions.insert(screen, m_region(screen));
+    }
+
+    // screens which were added or removed change the overall state, even
+    // though there is no single screen to tell about for removed ones
+    const bool screensChanged = rects.count() != m_rects.count();
+
+    QList<int> changedRects;
+    QList<int> changedRegions;
+
+    for (int screen : screens) {
+        const auto oldRect = m_rects.constFind(screen);
+        if (oldRect == m_rects.constEnd() || *oldRect != rects.value(screen)) {
+            changedRects << screen;
+        }
+
+        const auto oldRegion = m_regions.constFind(screen);
+        if (oldRegion == m_regions.constEnd() || *oldRegion != regions.value(screen)) {
+            changedRegions << screen;
+        }
+    }
+
+    m_rects = rects;
+    m_regions = regions;
+    m_valid = true;
+
+    for (int screen : qAsConst(changedRects)) {
+        emit availableScreenRectChanged(screen);
+    }
+    for (int screen : qAsConst(changedRegions)) {
+        emit availableScreenRegionChanged(screen);
+    }
+
+    if (screensChanged || !changedRects.isEmpty()) {
+        emit availableScreenRectsChanged();
+    }
+    if (screensChanged || !changedRegions.isEmpty()) {
+        emit availableScreenRegionsChanged();
+    }
+}
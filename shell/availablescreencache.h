@@ -0,0 +1,92 @@
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef AVAILABLESCREENCACHE_H
+#define AVAILABLESCREENCACHE_H
+
+#include <QHash>
+#include <QObject>
+#include <QRect>
+#include <QRegion>
+#include <QTimer>
+
+#include <functional>
+
+/**
+ * The available rect and region of each screen, what is left of it once
+ * the panels are taken away.
+ *
+ * Any number of invalidate() calls result in a single recomputation once
+ * control returns to the event loop, after which the change signals are
+ * emitted only for the screens whose value changed. Until then, the
+ * values are computed on request and not cached.
+ */
+class AvailableScreenCache : public QObject
+{
+    Q_OBJECT
+public:
+    typedef std::function<QList<int>()> ScreensFunction;
+    typedef std::function<QRect(int)> RectFunction;
+    typedef std::function<QRegion(int)> RegionFunction;
+
+    /**
+     * @param screens returns the ids of all screens
+     * @param rect computes the available rect of a screen
+     * @param region computes the available region of a screen
+     */
+    AvailableScreenCache(const ScreensFunction &screens, const RectFunction &rect,
+                         const RegionFunction &region, QObject *parent = nullptr);
+
+    QRect availableScreenRect(int screen) const;
+    QRegion availableScreenRegion(int screen) const;
+
+    /**
+     * The available geometry of some screen may have changed, schedules
+     * a recomputation of all of them
+     */
+    void invalidate();
+
+    /**
+     * @return how often the values of all screens were computed
+     */
+    int recomputations() const;
+
+Q_SIGNALS:
+    void availableScreenRectChanged(int screen);
+    void availableScreenRegionChanged(int screen);
+
+    /**
+     * Emitted after the signals of single screens, if the rect of any
+     * screen changed or a screen was added or removed
+     */
+    void availableScreenRectsChanged();
+    void availableScreenRegionsChanged();
+
+private:
+    void recompute();
+
+    ScreensFunction m_screens;
+    RectFunction m_rect;
+    RegionFunction m_region;
+
+    QHash<int, QRect> m_rects;
+    QHash<int, QRegion> m_regions;
+    bool m_valid = false;
+    int m_recomputations = 0;
+    QTimer m_recomputeTimer;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "panelmaskupdater.h"
+
+// one frame at 60 Hz
+static const int s_defaultInterval = 16;
+
+bool PanelMaskUpdater::Mask::operator==(const Mask &other) const
+{
+    return window == other.window && background == other.background
+        && compositing == other.compositing && region == other.region;
+}
+
+bool PanelMaskUpdater::Mask::operator!=(const Mask &other) const
+{
+    return !(*this == other);
+}
+
+PanelMaskUpdater::PanelMaskUpdater(const MaskFunction &mask, const SendFunction &send, QObject *parent)
+    : QObject(parent)
+    , m_mask(mask)
+    , m_send(send)
+{
+    m_sendTimer.setSingleShot(true);
+    m_sendTimer.setInterval(s_defaultInterval);
+    connect(&m_sendTimer, &QTimer::timeout, this, &PanelMaskUpdater::send);
+}
+
+void PanelMaskUpdater::setInterval(int msec)
+{
+    m_sendTimer.setInterval(msec);
+}
+
+int PanelMaskUpdater::interval() const
+{
+    return m_sendTimer.interval();
+}
+
+void PanelMaskUpdater::update()
+{
+    // not restarted, so that a steady stream of updates is sent once per interval
+    if (!m_sendTimer.isActive()) {
+        m_sendTimer.start();
+    }
+}
+
+void PanelMaskUpdater::invalidate()
+{
+    m_sent = false;
+    update();
+}
+
+int PanelMaskUpdater::sentUpdates() const
+{
+    return m_sentUpdates;
+}
+
+void PanelMaskUpdater::send()
+{
+    const Mask mask = m_mask();
+
+    if (m_sent && mask == m_sentMask) {
+        return;
+    }
+
+    m_send(mask);
+
+    ++m_sentUpdates;
+    m_sent = true;
+    m_sentMask = mask;
+}
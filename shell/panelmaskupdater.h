@@ -0,0 +1,95 @@
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PANELMASKUPDATER_H
+#define PANELMASKUPDATER_H
+
+#include <QObject>
+#include <QRegion>
+#include <QTimer>
+#include <QWindow>
+
+#include <functional>
+
+/**
+ * Sends the mask of a panel, along with its blur and background contrast
+ * regions, to the window system.
+ *
+ * Any number of update() calls within one interval, by default the duration
+ * of a frame, result in a single send once the interval is over. Nothing is
+ * sent when the mask, window and settings are the same as the ones sent
+ * last.
+ */
+class PanelMaskUpdater : public QObject
+{
+    Q_OBJECT
+public:
+    struct Mask {
+        WId window = 0;
+        bool background = false;
+        bool compositing = false;
+        QRegion region;
+
+        bool operator==(const Mask &other) const;
+        bool operator!=(const Mask &other) const;
+    };
+
+    typedef std::function<Mask()> MaskFunction;
+    typedef std::function<void(const Mask &)> SendFunction;
+
+    /**
+     * @param mask computes the current mask of the panel
+     * @param send sends a mask to the window system
+     */
+    PanelMaskUpdater(const MaskFunction &mask, const SendFunction &send, QObject *parent = nullptr);
+
+    /**
+     * Sets the time over which updates are merged, usually the duration of
+     * a frame on the screen of the panel
+     */
+    void setInterval(int msec);
+    int interval() const;
+
+    /**
+     * The mask may have changed, schedules sending it
+     */
+    void update();
+
+    /**
+     * Forgets what was sent, so that the next update sends the mask even if
+     * it did not change, and schedules it. To be used when the window system
+     * or the theme may no longer match what was sent.
+     */
+    void invalidate();
+
+    /**
+     * @return how often a mask was sent
+     */
+    int sentUpdates() const;
+
+private:
+    void send();
+
+    MaskFunction m_mask;
+    SendFunction m_send;
+
+    Mask m_sentMask;
+    bool m_sent = false;
+    int m_sentUpdates = 0;
+    QTimer m_sendTimer;
+};
+
+#endif
@@ -66,6 +66,7 @@ public:
     void clearPixmaps();
     void setupPixmaps();
     Qt::HANDLE createPixmap(const QPixmap& source);
+    unsigned long x11Pixmap(const QPixmap &source);
     void initPixmap(const QString &element);
     QPixmap initEmptyPixmap(const QSize &size);
     void updateShadow(const QWindow *window, Plasma::FrameSvg::EnabledBorders);
@@ -92,6 +93,10 @@ public:
     QPixmap m_emptyHorizontalPix;
 
 #if HAVE_X11
+    // server side pixmaps of the tiles by the cache key of their source,
+    // shared by all windows and all combinations of enabled borders
+    QHash<qint64, unsigned long> m_x11Pixmaps;
+
     //! xcb connection
     xcb_connection_t* _connection;
 
@@ -150,6 +155,11 @@ void PanelShadows::addWindow(const QWindow *window, Plasma::FrameSvg::EnabledBor
         return;
     }
 
+    if (d->m_windows.contains(window)) {
+        setEnabledBorders(window, enabledBorders);
+        return;
+    }
+
     d->m_windows[window] = enabledBorders;
     d->updateShadow(window, enabledBorders);
     connect(window, &QObject::destroyed, this, [this, window]() {
@@ -181,6 +191,11 @@ void PanelShadows::setEnabledBorders(const QWindow *window, Plasma::FrameSvg::En
         return;
     }
 
+    // the pixmaps are shared, only the property of this window changes, if at all
+    if (d->m_windows.value(window) == enabledBorders) {
+        return;
+    }
+
     d->m_windows[window] = enabledBorders;
     d->updateShadow(window, enabledBorders);
 }
@@ -267,6 +282,20 @@ Qt::HANDLE PanelShadows::Private::createPixmap(const QPixmap& source)
 
 }
 
+unsigned long PanelShadows::Private::x11Pixmap(const QPixmap &source)
+{
+#if HAVE_X11
+    auto it = m_x11Pixmaps.constFind(source.cacheKey());
+    if (it == m_x11Pixmaps.constEnd()) {
+        it = m_x11Pixmaps.insert(source.cacheKey(), reinterpret_cast<unsigned long>(createPixmap(source)));
+    }
+    return *it;
+#else
+    Q_UNUSED(source)
+    return 0;
+#endif
+}
+
 void PanelShadows::Private::initPixmap(const QString &element)
 {
     m_shadowPixmaps << q->pixmap(element);
@@ -325,78 +354,78 @@ void PanelShadows::Private::setupData(Plasma::FrameSvg::EnabledBorders enabledBo
     }
     //shadow-top
     if (enabledBorders & Plasma::FrameSvg::TopBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_shadowPixmaps[0]));
+        data[enabledBorders] << x11Pixmap(m_shadowPixmaps[0]);
     } else {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyHorizontalPix));
+        data[enabledBorders] << x11Pixmap(m_emptyHorizontalPix);
     }
 
     //shadow-topright
     if (enabledBorders & Plasma::FrameSvg::TopBorder &&
         enabledBorders & Plasma::FrameSvg::RightBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_shadowPixmaps[1]));
+        data[enabledBorders] << x11Pixmap(m_shadowPixmaps[1]);
     } else if (enabledBorders & Plasma::FrameSvg::TopBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerTopPix));
+        data[enabledBorders] << x11Pixmap(m_emptyCornerTopPix);
     } else if (enabledBorders & Plasma::FrameSvg::RightBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerRightPix));
+        data[enabledBorders] << x11Pixmap(m_emptyCornerRightPix);
     } else {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerPix));
+        data[enabledBorders] << x11Pixmap(m_emptyCornerPix);
     }
 
     //shadow-right
     if (enabledBorders & Plasma::FrameSvg::RightBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_shadowPixmaps[2]));
+        data[enabledBorders] << x11Pixmap(m_shadowPixmaps[2]);
     } else {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyVerticalPix));
+        data[enabledBorders] << x11Pixmap(m_emptyVerticalPix);
     }
 
     //shadow-bottomright
     if (enabledBorders & Plasma::FrameSvg::BottomBorder &&
         enabledBorders & Plasma::FrameSvg::RightBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_shadowPixmaps[3]));
+        data[enabledBorders] << x11Pixmap(m_shadowPixmaps[3]);
     } else if (enabledBorders & Plasma::FrameSvg::BottomBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerBottomPix));
+        data[enabledBorders] << x11Pixmap(m_emptyCornerBottomPix);
     } else if (enabledBorders & Plasma::FrameSvg::RightBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerRightPix));
+        data[enabledBorders] << x11Pixmap(m_emptyCornerRightPix);
     } else {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerPix));
+        data[enabledBorders] << x11Pixmap(m_emptyCornerPix);
     }
 
     //shadow-bottom
     if (enabledBorders & Plasma::FrameSvg::BottomBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_shadowPixmaps[4]));
+        data[enabledBorders] << x11Pixmap(m_shadowPixmaps[4]);
     } else {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyHorizontalPix));
+        data[enabledBorders] << x11Pixmap(m_emptyHorizontalPix);
     }
 
     //shadow-bottomleft
     if (enabledBorders & Plasma::FrameSvg::BottomBorder &&
         enabledBorders & Plasma::FrameSvg::LeftBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_shadowPixmaps[5]));
+        data[enabledBorders] << x11Pixmap(m_shadowPixmaps[5]);
     } else if (enabledBorders & Plasma::FrameSvg::BottomBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerBottomPix));
+        data[enabledBorders] << x11Pixmap(m_emptyCornerBottomPix);
     } else if (enabledBorders & Plasma::FrameSvg::LeftBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerLeftPix));
+        data[enabledBorders] << x11Pixmap(m_emptyCornerLeftPix);
     } else {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerPix));
+        data[enabledBorders] << x11Pixmap(m_emptyCornerPix);
     }
 
     //shadow-left
     if (enabledBorders & Plasma::FrameSvg::LeftBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_shadowPixmaps[6]));
+        data[enabledBorders] << x11Pixmap(m_shadowPixmaps[6]);
     } else {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyVerticalPix));
+        data[enabledBorders] << x11Pixmap(m_emptyVerticalPix);
     }
 
     //shadow-topleft
     if (enabledBorders & Plasma::FrameSvg::TopBorder &&
         enabledBorders & Plasma::FrameSvg::LeftBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_shadowPixmaps[7]));
+        data[enabledBorders] << x11Pixmap(m_shadowPixmaps[7]);
     } else if (enabledBorders & Plasma::FrameSvg::TopBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerTopPix));
+        data[enabledBorders] << x11Pixmap(m_emptyCornerTopPix);
     } else if (enabledBorders & Plasma::FrameSvg::LeftBorder) {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerLeftPix));
+        data[enabledBorders] << x11Pixmap(m_emptyCornerLeftPix);
     } else {
-        data[enabledBorders] << reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerPix));
+        data[enabledBorders] << x11Pixmap(m_emptyCornerPix);
     }
 #endif
 
@@ -462,33 +491,12 @@ void PanelShadows::Private::freeX11Pixmaps()
         return;
     }
 
-    foreach (const QPixmap &pixmap, m_shadowPixmaps) {
-        if (!pixmap.isNull()) {
-            XFreePixmap(display, reinterpret_cast<unsigned long>(createPixmap(pixmap)));
+    for (auto it = m_x11Pixmaps.constBegin(); it != m_x11Pixmaps.constEnd(); ++it) {
+        if (*it) {
+            XFreePixmap(display, *it);
         }
     }
-
-    if (!m_emptyCornerPix.isNull()) {
-        XFreePixmap(display, reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerPix)));
-    }
-    if (!m_emptyCornerBottomPix.isNull()) {
-        XFreePixmap(display, reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerBottomPix)));
-    }
-    if (!m_emptyCornerLeftPix.isNull()) {
-        XFreePixmap(display, reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerLeftPix)));
-    }
-    if (!m_emptyCornerRightPix.isNull()) {
-        XFreePixmap(display, reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerRightPix)));
-    }
-    if (!m_emptyCornerTopPix.isNull()) {
-        XFreePixmap(display, reinterpret_cast<unsigned long>(createPixmap(m_emptyCornerTopPix)));
-    }
-    if (!m_emptyVerticalPix.isNull()) {
-        XFreePixmap(display, reinterpret_cast<unsigned long>(createPixmap(m_emptyVerticalPix)));
-    }
-    if (!m_emptyHorizontalPix.isNull()) {
-        XFreePixmap(display, reinterpret_cast<unsigned long>(createPixmap(m_emptyHorizontalPix)));
-    }
+    m_x11Pixmaps.clear();
 #endif
 }
 
@@ -66,7 +66,9 @@ PanelView::PanelView(ShellCorona *corona, QScreen *targetScreen, QWindow *parent
        m_corona(corona),
        m_visibilityMode(NormalPanel),
        m_backgroundHints(Plasma::Types::StandardBackground),
-       m_shellSurface(nullptr)
+       m_shellSurface(nullptr),
+       m_maskUpdater([this]() { return currentMask(); },
+                     [this](const PanelMaskUpdater::Mask &mask) { sendMask(mask); })
 {
     if (targetScreen) {
         setPosition(targetScreen->geometry().center());
@@ -78,7 +80,10 @@ PanelView::PanelView(ShellCorona *corona, QScreen *targetScreen, QWindow *parent
     setColor(QColor(Qt::transparent));
     setFlags(Qt::FramelessWindowHint|Qt::WindowDoesNotAcceptFocus);
 
-    connect(&m_theme, &Plasma::Theme::themeChanged, this, &PanelView::updateMask);
+    connect(&m_theme, &Plasma::Theme::themeChanged, this, [this]() {
+        //the blur and contrast settings may have changed with the same mask
+        m_maskUpdater.invalidate();
+    });
     connect(this, &PanelView::backgroundHintsChanged, this, &PanelView::updateMask);
     connect(this, &PanelView::backgroundHintsChanged, this, &PanelView::updateEnabledBorders);
     // TODO: add finished/componentComplete signal to QuickViewSharedEngine,
@@ -228,7 +233,7 @@ void PanelView::setOffset(int offset)
     positionPanel();
     emit offsetChanged();
     m_corona->requestApplicationConfigSync();
-    emit m_corona->availableScreenRegionChanged();
+    m_corona->invalidateAvailableScreenGeometry();
 }
 
 int PanelView::thickness() const
@@ -764,7 +769,7 @@ void PanelView::resizeEvent(QResizeEvent *ev)
         m_shellSurface->setPosition(pos);
     }
     m_strutsTimer.start(STRUTSTIMERDELAY);
-    emit m_corona->availableScreenRegionChanged();
+    m_corona->invalidateAvailableScreenGeometry();
 
     PlasmaQuick::ContainmentView::resizeEvent(ev);
 
@@ -777,6 +782,7 @@ void PanelView::moveEvent(QMoveEvent *ev)
 {
     updateEnabledBorders();
     m_strutsTimer.start(STRUTSTIMERDELAY);
+    m_corona->invalidateAvailableScreenGeometry();
     PlasmaQuick::ContainmentView::moveEvent(ev);
 #if PLASMA_VERSION < QT_VERSION_CHECK(5,59,0)
     updateMask();
@@ -786,6 +792,11 @@ void PanelView::moveEvent(QMoveEvent *ev)
 void PanelView::integrateScreen()
 {
     connect(m_screenToFollow.data(), &QScreen::geometryChanged, this, &PanelView::restore);
+    //the mask changes many times in a row while the panel gets resized,
+    //moved or animated, it is sent at most once per frame of the screen
+    if (m_screenToFollow->refreshRate() > 0) {
+        m_maskUpdater.setInterval(qMax(1, qRound(1000 / m_screenToFollow->refreshRate())));
+    }
     updateMask();
     KWindowSystem::setOnAllDesktops(winId(), true);
     KWindowSystem::setType(winId(), NET::Dock);
@@ -807,6 +818,8 @@ void PanelView::showEvent(QShowEvent *event)
 {
     PlasmaQuick::ContainmentView::showEvent(event);
 
+    //the window system forgets the blur and contrast of a hidden window
+    m_maskUpdater.invalidate();
     integrateScreen();
 }
 
@@ -1003,32 +1016,47 @@ QPointF PanelView::positionAdjustedForContainment(const QPointF &point) const
 
 void PanelView::updateMask()
 {
-    if (m_backgroundHints == Plasma::Types::NoBackground) {
-        KWindowEffects::enableBlurBehind(winId(), false);
-        KWindowEffects::enableBackgroundContrast(winId(), false);
-        setMask(QRegion());
-    } else {
-        QRegion mask;
+    m_maskUpdater.update();
+}
 
+PanelMaskUpdater::Mask PanelView::currentMask() const
+{
+    PanelMaskUpdater::Mask mask;
+    mask.window = winId();
+    mask.background = m_backgroundHints != Plasma::Types::NoBackground;
+    mask.compositing = KWindowSystem::compositingActive();
+
+    if (mask.background) {
         QQuickItem *rootObject = this->rootObject();
         if (rootObject) {
             const QVariant maskProperty = rootObject->property("panelMask");
             if (static_cast<QMetaType::Type>(maskProperty.type()) == QMetaType::QRegion) {
-                mask = maskProperty.value<QRegion>();
+                mask.region = maskProperty.value<QRegion>();
             }
         }
+    }
 
-        KWindowEffects::enableBlurBehind(winId(), m_theme.blurBehindEnabled(), mask);
-        KWindowEffects::enableBackgroundContrast(winId(), m_theme.backgroundContrastEnabled(),
-                                                          m_theme.backgroundContrast(),
-                                                          m_theme.backgroundIntensity(),
-                                                          m_theme.backgroundSaturation(),
-                                                          mask);
+    return mask;
+}
 
-        if (KWindowSystem::compositingActive()) {
+void PanelView::sendMask(const PanelMaskUpdater::Mask &mask)
+{
+    if (!mask.background) {
+        KWindowEffects::enableBlurBehind(mask.window, false);
+        KWindowEffects::enableBackgroundContrast(mask.window, false);
+        setMask(QRegion());
+    } else {
+        KWindowEffects::enableBlurBehind(mask.window, m_theme.blurBehindEnabled(), mask.region);
+        KWindowEffects::enableBackgroundContrast(mask.window, m_theme.backgroundContrastEnabled(),
+                                                              m_theme.backgroundContrast(),
+                                                              m_theme.backgroundIntensity(),
+                                                              m_theme.backgroundSaturation(),
+                                                              mask.region);
+
+        if (mask.compositing) {
             setMask(QRegion());
         } else {
-            setMask(mask);
+            setMask(mask.region);
         }
     }
 }
@@ -21,11 +21,14 @@
 
 #include <QPointer>
 #include <Plasma/Theme>
+#include <QRegion>
 #include <QTimer>
 
 #include <PlasmaQuick/ContainmentView>
 #include <PlasmaQuick/ConfigView>
 
+#include "panelmaskupdater.h"
+
 class ShellCorona;
 
 namespace KWayland
@@ -217,6 +220,8 @@ private:
     void visibilityModeToWayland();
     bool edgeActivated() const;
     bool canSetStrut() const;
+    PanelMaskUpdater::Mask currentMask() const;
+    void sendMask(const PanelMaskUpdater::Mask &mask);
 
     int m_offset;
     int m_maxLength;
@@ -241,6 +246,8 @@ private:
     QPointer<QScreen> m_screenToFollow;
     QMetaObject::Connection m_transientWindowVisibleWatcher;
 
+    PanelMaskUpdater m_maskUpdater;
+
     static const int STRUTSTIMERDELAY = 200;
 };
 
@@ -290,16 +290,30 @@ QStringList ScriptEngine::pendingUpdateScripts(Plasma::Corona *corona)
         return QStringList();
     }
 
-    const QString appName = corona->package().metadata().pluginName();
+    return pendingUpdateScripts(updateScripts(corona->package().metadata().pluginName()));
+}
+
+QStringList ScriptEngine::updateScripts(const QString &shellPluginName)
+{
     QStringList scripts;
 
-    const QStringList dirs = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, "plasma/shells/" + appName + QStringLiteral("/contents/updates"), QStandardPaths::LocateDirectory);
+    if (shellPluginName.isEmpty()) {
+        return scripts;
+    }
+
+    const QStringList dirs = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, "plasma/shells/" + shellPluginName + QStringLiteral("/contents/updates"), QStandardPaths::LocateDirectory);
     for (const QString& dir : dirs) {
         QDirIterator it(dir, QStringList() << QStringLiteral("*.js"));
         while (it.hasNext()) {
             scripts.append(it.next());
         }
     }
+
+    return scripts;
+}
+
+QStringList ScriptEngine::pendingUpdateScripts(const QStringList &scripts)
+{
     QStringList scriptPaths;
 
     if (scripts.isEmpty()) {
@@ -56,6 +56,17 @@ public:
 
     static QStringList pendingUpdateScripts(Plasma::Corona *corona);
 
+    /**
+     * @return all update scripts of the shell @p shellPluginName. This only
+     * reads directories, so it can be called from any thread.
+     */
+    static QStringList updateScripts(const QString &shellPluginName);
+
+    /**
+     * @return the scripts of @p scripts which were not run yet, and marks them as run
+     */
+    static QStringList pendingUpdateScripts(const QStringList &scripts);
+
     Plasma::Corona *corona() const;
     QJSValue wrap(Plasma::Applet *w);
     QJSValue wrap(Plasma::Containment *c);
@@ -26,6 +26,7 @@
 
 #include <QApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QMenu>
 #include <QQmlContext>
 #include <QDBusConnection>
@@ -34,6 +35,7 @@
 
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <QtConcurrent>
 
 #include <kactioncollection.h>
 #include <klocalizedstring.h>
@@ -74,6 +76,7 @@
 #include "config-ktexteditor.h" // HAVE_KTEXTEDITOR
 
 #include "alternativeshelper.h"
+#include "availablescreencache.h"
 #include "desktopview.h"
 #include "panelview.h"
 #include "scripting/scriptengine.h"
@@ -83,6 +86,8 @@
 #include "plasmashelladaptor.h"
 #include "debug.h"
 #include "futureutil.h"
+#include "startupdebug.h"
+#include "startupprofiler.h"
 
 #ifndef NDEBUG
     #define CHECK_SCREEN_INVARIANTS screenInvariants();
@@ -102,10 +107,16 @@ ShellCorona::ShellCorona(QObject *parent)
     : Plasma::Corona(parent),
       m_config(KSharedConfig::openConfig(QStringLiteral("plasmarc"))),
       m_screenPool(new ScreenPool(KSharedConfig::openConfig(), this)),
+      m_availableScreenCache(new AvailableScreenCache(
+          [this]() { return m_desktopViewforId.keys(); },
+          [this](int id) { return computeAvailableScreenRect(id); },
+          [this](int id) { return computeAvailableScreenRegion(id); },
+          this)),
       m_activityController(new KActivities::Controller(this)),
       m_addPanelAction(nullptr),
       m_addPanelsMenu(nullptr),
       m_interactiveConsole(nullptr),
+      m_startupProfiler(nullptr),
       m_waylandPlasmaShell(nullptr),
       m_closingDown(false)
 {
@@ -124,7 +135,10 @@ ShellCorona::ShellCorona(QObject *parent)
         executeSetupPlasmoidScript(c, c);
     });
 
-    connect(this, &Plasma::Corona::availableScreenRectChanged, this, &Plasma::Corona::availableScreenRegionChanged);
+    connect(m_availableScreenCache, &AvailableScreenCache::availableScreenRectsChanged,
+            this, &Plasma::Corona::availableScreenRectChanged);
+    connect(m_availableScreenCache, &AvailableScreenCache::availableScreenRegionsChanged,
+            this, &Plasma::Corona::availableScreenRegionChanged);
 
     m_appConfigSyncTimer.setSingleShot(true);
     m_appConfigSyncTimer.setInterval(s_configSyncDelay);
@@ -693,8 +707,32 @@ void ShellCorona::load()
 
     disconnect(m_activityController, &KActivities::Controller::serviceStatusChanged, this, &ShellCorona::load);
 
+    if (!m_startupProfiler) {
+        m_startupProfiler = new StartupProfiler(this);
+    }
+
+    // Looking for update scripts only reads directories, so it is done
+    // while the layout is loaded. The layout itself is parsed by
+    // Plasma::Corona into a KSharedConfig, which belongs to this thread.
+    const QString shellPluginName = package().metadata().isValid() ? package().metadata().pluginName() : QString();
+    QFuture<QStringList> updateScripts = QtConcurrent::run([shellPluginName]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        const QStringList scripts = WorkspaceScripting::ScriptEngine::updateScripts(shellPluginName);
+
+        qCDebug(PLASMASHELL_STARTUP) << "Found" << scripts.count() << "update scripts in" << timer.elapsed() << "ms";
+
+        return scripts;
+    });
+
+    m_startupProfiler->beginStage(QStringLiteral("screens"));
+
     m_screenPool->load();
 
+    // parsing the config and creating containments and applets, which are profiled one by one
+    m_startupProfiler->beginStage(QStringLiteral("layout"));
+
     //TODO: a kconf_update script is needed
     QString configFileName(QStringLiteral("plasma-") + m_shell + QStringLiteral("-appletsrc"));
 
@@ -708,9 +746,14 @@ void ShellCorona::load()
         // from the config file. Maybe if the config file is not empty,
         // but still does not have any containments
         loadDefaultLayout();
-        processUpdateScripts();
+
+        m_startupProfiler->beginStage(QStringLiteral("update scripts"));
+        processUpdateScripts(updateScripts.result());
     } else {
-        processUpdateScripts();
+        m_startupProfiler->beginStage(QStringLiteral("update scripts"));
+        processUpdateScripts(updateScripts.result());
+
+        m_startupProfiler->beginStage(QStringLiteral("containment assignment"));
         const auto containments = this->containments();
         for (Plasma::Containment *containment : containments) {
             if (containment->containmentType() == Plasma::Types::PanelContainment || containment->containmentType() == Plasma::Types::CustomPanelContainment) {
@@ -734,6 +777,8 @@ void ShellCorona::load()
         }
     }
 
+    m_startupProfiler->beginStage(QStringLiteral("views"));
+
     //NOTE: this is needed in case loadLayout() did *not* call loadDefaultLayout()
     //it needs to be after of loadLayout() as it would always create new
     //containments on each startup otherwise
@@ -741,13 +786,21 @@ void ShellCorona::load()
         //the containments may have been created already by the startup script
         //check their existence in order to not have duplicated desktopviews
         if (!m_desktopViewforId.contains(m_screenPool->id(screen->name()))) {
+            QElapsedTimer timer;
+            timer.start();
+
             addOutput(screen);
+
+            m_startupProfiler->viewCreated(QStringLiteral("Desktop"), screen->name(), timer.elapsed());
         }
     }
     connect(qGuiApp, &QGuiApplication::screenAdded, this, &ShellCorona::addOutput, Qt::UniqueConnection);
     connect(qGuiApp, &QGuiApplication::primaryScreenChanged, this, &ShellCorona::primaryOutputChanged, Qt::UniqueConnection);
     connect(qGuiApp, &QGuiApplication::screenRemoved, this, &ShellCorona::handleScreenRemoved, Qt::UniqueConnection);
 
+    m_startupProfiler->endStage();
+    m_startupProfiler->mark(QStringLiteral("Layout loaded"));
+
     if (!m_waitingPanels.isEmpty()) {
         m_waitingPanelsTimer.start();
     }
@@ -996,9 +1049,9 @@ void ShellCorona::loadDefaultLayout()
     Q_EMIT startupCompleted();
 }
 
-void ShellCorona::processUpdateScripts()
+void ShellCorona::processUpdateScripts(const QStringList &updateScripts)
 {
-    const QStringList scripts = WorkspaceScripting::ScriptEngine::pendingUpdateScripts(this);
+    const QStringList scripts = WorkspaceScripting::ScriptEngine::pendingUpdateScripts(updateScripts);
     if (scripts.isEmpty()) {
         return;
     }
@@ -1042,6 +1095,11 @@ QRect ShellCorona::screenGeometry(int id) const
 }
 
 QRegion ShellCorona::availableScreenRegion(int id) const
+{
+    return m_availableScreenCache->availableScreenRegion(id);
+}
+
+QRegion ShellCorona::computeAvailableScreenRegion(int id) const
 {
     DesktopView* view = m_desktopViewforId.value(id);
     if (!view) {
@@ -1062,6 +1120,16 @@ QRegion ShellCorona::availableScreenRegion(int id) const
 }
 
 QRect ShellCorona::availableScreenRect(int id) const
+{
+    return m_availableScreenCache->availableScreenRect(id);
+}
+
+void ShellCorona::invalidateAvailableScreenGeometry()
+{
+    m_availableScreenCache->invalidate();
+}
+
+QRect ShellCorona::computeAvailableScreenRect(int id) const
 {
     DesktopView *view = m_desktopViewforId.value(id);
     if (!view) {
@@ -1124,6 +1192,8 @@ void ShellCorona::removeDesktop(DesktopView *desktopView)
     m_desktopViewforId.erase(itDesktop);
     delete desktopView;
 
+    invalidateAvailableScreenGeometry();
+
     emit screenRemoved(idx);
 }
 
@@ -1258,8 +1328,7 @@ void ShellCorona::addOutput(QScreen* screen)
         const int id = m_screenPool->id(screen->name());
         if (id >= 0) {
             emit screenGeometryChanged(id);
-            emit availableScreenRegionChanged();
-            emit availableScreenRectChanged();
+            invalidateAvailableScreenGeometry();
         }
     });
 
@@ -1288,7 +1357,7 @@ void ShellCorona::addOutput(QScreen* screen)
         m_waitingPanelsTimer.start();
     }
 
-    emit availableScreenRectChanged();
+    invalidateAvailableScreenGeometry();
     emit screenAdded(m_screenPool->id(screen->name()));
 
     CHECK_SCREEN_INVARIANTS
@@ -1301,14 +1370,20 @@ void ShellCorona::checkAllDesktopsUiReady(bool ready)
     for (auto v : qAsConst(m_desktopViewforId)) {
         if (!v->containment()->isUiReady())
             return;
+    }
+
+    qDebug() << "Plasma Shell startup completed";
+    QDBusMessage ksplashProgressMessage = QDBusMessage::createMethodCall(QStringLiteral("org.kde.KSplash"),
+                                    QStringLiteral("/KSplash"),
+                                    QStringLiteral("org.kde.KSplash"),
+                                    QStringLiteral("setStage"));
+    ksplashProgressMessage.setArguments(QList<QVariant>() << QStringLiteral("desktop"));
+    QDBusConnection::sessionBus().asyncCall(ksplashProgressMessage);
 
-        qDebug() << "Plasma Shell startup completed";
-        QDBusMessage ksplashProgressMessage = QDBusMessage::createMethodCall(QStringLiteral("org.kde.KSplash"),
-                                        QStringLiteral("/KSplash"),
-                                        QStringLiteral("org.kde.KSplash"),
-                                        QStringLiteral("setStage"));
-        ksplashProgressMessage.setArguments(QList<QVariant>() << QStringLiteral("desktop"));
-        QDBusConnection::sessionBus().asyncCall(ksplashProgressMessage);
+    if (m_startupProfiler) {
+        m_startupProfiler->mark(QStringLiteral("UI of all desktops ready"));
+        m_startupProfiler->deleteLater();
+        m_startupProfiler = nullptr;
     }
 }
 
@@ -1360,24 +1435,35 @@ void ShellCorona::createWaitingPanels()
 
         //TODO: does a similar check make sense?
         //Q_ASSERT(qBound(0, requestedScreen, m_screenPool->count() - 1) == requestedScreen);
+        QElapsedTimer timer;
+        timer.start();
+
         QScreen *screen = desktopView->screenToFollow();
         PanelView* panel = new PanelView(this, screen);
         if (panel->rendererInterface()->graphicsApi() != QSGRendererInterface::Software) {
             connect(panel, &QQuickWindow::sceneGraphError, this, &ShellCorona::glInitializationFailed);
         }
-        connect(panel, &QWindow::visibleChanged, this, &Plasma::Corona::availableScreenRectChanged);
-        connect(panel, &PanelView::locationChanged, this, &Plasma::Corona::availableScreenRectChanged);
-        connect(panel, &PanelView::visibilityModeChanged, this, &Plasma::Corona::availableScreenRectChanged);
-        connect(panel, &PanelView::thicknessChanged, this, &Plasma::Corona::availableScreenRectChanged);
+        connect(panel, &QWindow::visibleChanged, this, &ShellCorona::invalidateAvailableScreenGeometry);
+        connect(panel, &PanelView::locationChanged, this, &ShellCorona::invalidateAvailableScreenGeometry);
+        connect(panel, &PanelView::visibilityModeChanged, this, &ShellCorona::invalidateAvailableScreenGeometry);
+        connect(panel, &PanelView::thicknessChanged, this, &ShellCorona::invalidateAvailableScreenGeometry);
 
         m_panelViews[cont] = panel;
         panel->setContainment(cont);
         cont->reactToScreenChange();
 
         connect(cont, &QObject::destroyed, this, &ShellCorona::panelContainmentDestroyed);
+
+        if (m_startupProfiler) {
+            m_startupProfiler->viewCreated(QStringLiteral("Panel"), screen->name(), timer.elapsed());
+        }
     }
     m_waitingPanels = stillWaitingPanels;
-    emit availableScreenRectChanged();
+    invalidateAvailableScreenGeometry();
+
+    if (m_startupProfiler) {
+        m_startupProfiler->mark(QStringLiteral("Panel views created"));
+    }
 }
 
 void ShellCorona::panelContainmentDestroyed(QObject *cont)
@@ -1387,7 +1473,7 @@ void ShellCorona::panelContainmentDestroyed(QObject *cont)
     //don't make things relayout when the application is quitting
     //NOTE: qApp->closingDown() is still false here
     if (!m_closingDown) {
-        emit availableScreenRectChanged();
+        invalidateAvailableScreenGeometry();
     }
 }
 
@@ -1772,7 +1858,9 @@ Plasma::Containment *ShellCorona::setContainmentTypeForScreen(int screen, const
     //Save now as we now have a screen, so lastScreen will not be -1
     newContainment->save(newCg);
     requestConfigSync();
+    // the geometry did not change, but the new containment needs to know about it
     emit availableScreenRectChanged();
+    emit availableScreenRegionChanged();
 
     return newContainment;
 }
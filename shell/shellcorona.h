@@ -37,7 +37,9 @@ class DesktopView;
 class PanelView;
 class QMenu;
 class QScreen;
+class AvailableScreenCache;
 class ScreenPool;
+class StartupProfiler;
 
 namespace KActivities
 {
@@ -114,6 +116,12 @@ public:
 
     QString defaultContainmentPlugin() const;
 
+    /**
+     * The available geometry of some screen may have changed, e.g. because
+     * a panel moved. Change signals follow once the event loop is reached.
+     */
+    void invalidateAvailableScreenGeometry();
+
 Q_SIGNALS:
     void glInitializationFailed();
 
@@ -183,9 +191,9 @@ protected Q_SLOTS:
     void loadDefaultLayout() override;
 
     /**
-     * Execute any update script
+     * Execute the update scripts of @p updateScripts which were not run yet
      */
-    void processUpdateScripts();
+    void processUpdateScripts(const QStringList &updateScripts);
 
     int screenForContainment(const Plasma::Containment *containment) const override;
 
@@ -230,10 +238,14 @@ private:
 
     void insertContainment(const QString &activity, int screenNum, Plasma::Containment *containment);
 
+    QRegion computeAvailableScreenRegion(int id) const;
+    QRect computeAvailableScreenRect(int id) const;
+
     KSharedConfig::Ptr m_config;
     QString m_configPath;
 
     ScreenPool *m_screenPool;
+    AvailableScreenCache *m_availableScreenCache;
     QString m_shell;
     KActivities::Controller *m_activityController;
     //map from screen number to desktop view, qmap as order is important
@@ -248,6 +260,8 @@ private:
     KPackage::Package m_lookAndFeelPackage;
     QSet<QScreen*> m_redundantOutputs;
     KDeclarative::QmlObjectSharedEngine *m_interactiveConsole;
+    // only while starting up
+    StartupProfiler *m_startupProfiler;
 
     QTimer m_waitingPanelsTimer;
     QTimer m_appConfigSyncTimer;
@@ -0,0 +1,97 @@
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "startupprofiler.h"
+#include "startupdebug.h"
+
+#include <Plasma/Applet>
+#include <Plasma/Containment>
+#include <Plasma/Corona>
+
+StartupProfiler::StartupProfiler(Plasma::Corona *corona)
+    : QObject(corona)
+{
+    m_startup.start();
+    m_lastCreation.start();
+
+    connect(corona, &Plasma::Corona::containmentCreated, this, &StartupProfiler::containmentCreated);
+}
+
+StartupProfiler::~StartupProfiler()
+{
+    endStage();
+}
+
+void StartupProfiler::beginStage(const QString &name)
+{
+    endStage();
+
+    m_stageName = name;
+    m_stage.start();
+    m_lastCreation.start();
+}
+
+void StartupProfiler::endStage()
+{
+    if (m_stageName.isEmpty()) {
+        return;
+    }
+
+    qCDebug(PLASMASHELL_STARTUP) << "Stage" << m_stageName << "took" << m_stage.elapsed() << "ms";
+
+    m_stageName.clear();
+}
+
+void StartupProfiler::mark(const QString &event)
+{
+    qCDebug(PLASMASHELL_STARTUP) << event << "after" << m_startup.elapsed() << "ms";
+}
+
+void StartupProfiler::viewCreated(const QString &view, const QString &screen, qint64 elapsed)
+{
+    qCDebug(PLASMASHELL_STARTUP) << view << "view of screen" << screen << "created in" << elapsed << "ms";
+}
+
+void StartupProfiler::containmentCreated(Plasma::Containment *containment)
+{
+    if (m_stageName.isEmpty()) {
+        return;
+    }
+
+    qCDebug(PLASMASHELL_STARTUP) << "Containment" << containment->pluginMetaData().pluginId() << containment->id()
+                                 << "added" << m_lastCreation.restart() << "ms after the previous containment or applet";
+
+    connect(containment, &Plasma::Containment::appletAdded, this, [this, containment](Plasma::Applet *applet) {
+        appletAdded(containment, applet);
+    });
+
+    connect(containment, &Plasma::Containment::uiReadyChanged, this, [this, containment](bool ready) {
+        if (ready) {
+            mark(QStringLiteral("UI of containment %1 ready").arg(containment->id()));
+        }
+    });
+}
+
+void StartupProfiler::appletAdded(Plasma::Containment *containment, Plasma::Applet *applet)
+{
+    if (m_stageName.isEmpty()) {
+        return;
+    }
+
+    qCDebug(PLASMASHELL_STARTUP) << "Applet" << applet->pluginMetaData().pluginId() << applet->id()
+                                 << "in containment" << containment->id()
+                                 << "added" << m_lastCreation.restart() << "ms after the previous containment or applet";
+}
@@ -0,0 +1,79 @@
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+
+namespace Plasma {
+    class Applet;
+    class Containment;
+    class Corona;
+}
+
+/**
+ * Measures where the time goes while the shell starts up and writes it to
+ * the kde.plasmashell.startup logging category.
+ *
+ * Startup is split into stages, which are timed as a whole. While a stage
+ * runs, each containment and applet that is added is logged with the time
+ * since the containment or applet added before it; Plasma does not signal
+ * when the creation of an applet starts, so this is the gap between two
+ * additions rather than the time one applet took. The views are timed one
+ * by one for each screen. Once the stages are over, the time until the UI
+ * of each containment is ready is logged.
+ */
+class StartupProfiler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StartupProfiler(Plasma::Corona *corona);
+    ~StartupProfiler() override;
+
+    /**
+     * Ends the current stage, if any, and begins the stage @p name
+     */
+    void beginStage(const QString &name);
+
+    /**
+     * Ends the current stage
+     */
+    void endStage();
+
+    /**
+     * Logs that @p event happened, with the time since startup began
+     */
+    void mark(const QString &event);
+
+    /**
+     * Logs that the @p view of the screen @p screen took @p elapsed ms to be created
+     */
+    void viewCreated(const QString &view, const QString &screen, qint64 elapsed);
+
+private:
+    void containmentCreated(Plasma::Containment *containment);
+    void appletAdded(Plasma::Containment *containment, Plasma::Applet *applet);
+
+    QElapsedTimer m_startup;
+    QElapsedTimer m_stage;
+    QString m_stageName;
+    // since the last containment or applet was added
+    QElapsedTimer m_lastCreation;
+};
+
+#endif